@@ -91,6 +91,68 @@
  *       v 0.19 (01/03/2012) - i. Included and tested neighbourhood type and life rule switch in
  *                                the gca create command.
  *                             ii. Added a configuration edit mode when running in Graphics mode.
+ *       v 0.20 (19/10/2026) - i. Sampled operations (entropy, param, freq and pop) now run on
+ *                                a multi-threaded sampling engine, see GCALab_sampler.c. Results
+ *                                are reproducible for a given -seed regardless of -j.
+ *                             ii. pop command can average over -n samples.
+ *                             iii. entropy and param can stop sampling early once the
+ *                                  confidence interval is within -tol.
+ *                             iv. Added the sweep command for evaluating measures over
+ *                                 ranges of rule space on a single shared topology.
+ *                             v. sweep only evaluates S, W, G, C and T once per rule 
+ *                                equivalence class, results can be kept in a -cache file.
+ *                             vi. param over a -l range computes C and T in one memoised
+ *                                 pass (for CA that fit in a single chunk).
+ *                             vii. workspace workers block on a condition variable instead
+ *                                  of polling their state and queue.
+ *                             viii. workspaces can have several workers (new-work n numworkers),
+ *                                   commands on different targets run concurrently, read only
+ *                                   operations on a snapshot of their target.
+ *                             ix. commands from all workspaces run on one work-stealing pool
+ *                                 of -w workers (see GCALab_sched.c), new-work n maxrunning
+ *                                 limits how many commands of a workspace run at once. Added
+ *                                 the stats command.
+ *                             x. the command queue is an unbounded lock-free segmented queue
+ *                                (see GCALab_queue.c), parameters are copied into one arena
+ *                                per command.
+ *                             xi. results are kept in a growable store, large payloads are 
+ *                                 spilled to an mmap'd scratch file (-s,--scratch dir).
+ *                             xii. every command is profiled (see GCALab_prof.c), added
+ *                                  the profile command.
+ *                             xiii. running commands can be cancelled (del-cmd) and paused
+ *                                   (stop-q) and report progress (print-q), sampled 
+ *                                   param jobs checkpoint to -ckpt file and resume from it.
+ *                             xiv. batch scripts are read into a dependency graph and
+ *                                  spread over workspaces (-j), batch mode exits with
+ *                                  a status code.
+ *                             xv. server mode (-d) keeps workspaces loaded and runs the
+ *                                 commands of clients connecting to a UNIX socket.
+ *                             xvi. param, freq, entropy and sweep jobs given a -part file 
+ *                                  can be split over processes (--shard i/n) and merged
+ *                                  (--merge) into the result of a single run.
+ *                             xvii. save -g writes a binary container that load maps
+ *                                   into memory, -text writes the old format.
+ *                             xviii. record attaches a recorder that appends every step
+ *                                    of a GCA to a file (see GCALab_rec.c), and exports
+ *                                    time ranges of recordings to bitmaps.
+ *                             xix. gca -z keeps all but the most recent rows of the window
+ *                                  compressed, for long windows.
+ *                             xx. gca -m reads OFF, OBJ, STL, VRML and PLY meshes, by extension.
+ *                             xxi. export writes results as .npy (or raw) arrays with a JSON
+ *                                  description, for analysis outside GCALab.
+ *                             xxii. gca keeps graphs (and generated meshes) in a persistent
+ *                                   cache (-t,--topo-cache dir) keyed by the mesh faces.
+ *                             xxiii. snapshot writes a whole workspace (GCAs, results and
+ *                                    queue) from a forked child, restore maps it back into
+ *                                    a new workspace.
+ *                             xxiv. GCAs can be kept out of core (-o,--out-of-core dir), with
+ *                                   their rows and graph in files and a 2 row window.
+ *                             xxv. gca -g builds the graph from a text or binary edge list
+ *                                  (see GCALab_graph.c), for topologies that are not meshes.
+ *                             xxvi. read only operations snapshot just the rows of their target,
+ *                                   rotate waits for earlier readers of its target to finish.
+ *                             xxvii. read only operations evolve out-of-core GCAs on an in-memory
+ *                                    window of the default size.
  *
  * Description: Main Program for Graph Cellular Automata generation, simulation,
  *              analysis and Visualisation.
@@ -131,6 +193,10 @@ GCALab_Op GCALab_Ops[GCALAB_MAXNUM_OPS];
 unsigned int GCALab_numOps;
 unsigned char GCALab_mode;
 unsigned int cur_ws;
+/*per-thread snapshot of the target of a read only operation*/
+pthread_key_t GCALab_SnapshotKey;
+/*per-thread stream for the output of commands (e.g., a server client's)*/
+pthread_key_t GCALab_OutKey;
 #ifdef WITH_GRAPHICS
 /* light settings*/
 GLfloat ambientLight[] = { 0.1f, 0.1f, 0.1f, 1.0f };
@@ -157,6 +223,7 @@ char stateInitials[6] = {'I','R','P','Q','E'};
 char* statenames[6] = {"Idle","Running","Paused","Exiting","Error"};
 char cellsymbols[8] = {' ','O','*','-','x','+','#','^'};
 
+#ifndef GCALAB_NO_MAIN
 /**
  * @brief entry point of the GCALab Program
  * @param argc the number of commandline args
@@ -166,6 +233,7 @@ int main(int argc, char **argv)
 {
 	GCALab_CL_Options* CL_opt;
 	char rc;
+	int status;
 #ifdef WITH_GRAPHICS
 	glutInit(&argc,argv);
 #endif
@@ -181,7 +249,14 @@ int main(int argc, char **argv)
 			GCALab_TextMode(CL_opt);
 			break;
 		case GCALAB_BATCH_MODE:
-			GCALab_BatchMode(CL_opt);
+			status = GCALab_BatchMode(CL_opt);
+			free(CL_opt);
+			exit(status);
+			break;
+		case GCALAB_SERVER_MODE:
+			status = GCALab_ServerMode(CL_opt);
+			free(CL_opt);
+			exit(status);
 			break;
 		default:
 			fprintf(stderr,"ERROR: You Should not see this!\n");
@@ -192,6 +267,7 @@ int main(int argc, char **argv)
 	free(CL_opt);
 	pthread_exit(NULL);
 } 
+#endif
 
 /** 
  * @brief starts a GCALab session in text-only mode
@@ -255,23 +331,43 @@ void GCALab_GraphicsMode(GCALab_CL_Options* opts)
 
 /**
  * @brief Runs Commands is batch mode, i.e., reads commands from a file
+ * @details The whole script is read first, then independent GCAs are run on 
+ * separate workspaces (see GCALab_RunBatch()).
  * @param opts User provided start up commandline args
+ * @returns the exit status, GCALAB_BATCH_OK if every command succeeded.
  */
-char GCALab_BatchMode(GCALab_CL_Options* opts)
+int GCALab_BatchMode(GCALab_CL_Options* opts)
 {
-	char **userinput;
-	int numargs;
+	GCALab_Batch batch;
+	int status;
 	char rc;
 	GCALab_SplashScreen();
 	
-	while(1)
+	rc = GCALab_ParseBatch(&batch,opts->ScriptFile);
+	if (rc == GCALAB_MEM_ERROR)
 	{
-		/*get user input*/
-		userinput = GCALab_ReadScriptCommand(opts->ScriptFile,&numargs);
-		opts->ScriptFile = NULL;
-		rc = GCALab_Process_Command(numargs,userinput);
 		GCALab_HandleErr(rc);
 	}
+	if (rc != GCALAB_SUCCESS)
+	{
+		fprintf(stderr,"Could not read script %s.\n",(opts->ScriptFile != NULL) ? opts->ScriptFile : "");
+		GCALab_FreeBatch(&batch);
+		return GCALAB_BATCH_NO_SCRIPT;
+	}
+	status = GCALab_RunBatch(&batch,(opts->jobs > 0) ? opts->jobs : GCALab_NumWorkers());
+	GCALab_FreeBatch(&batch);
+	return status;
+}
+
+/**
+ * @brief Runs GCALab as a job server, i.e., takes commands from clients 
+ * connecting to a UNIX domain socket (see GCALab_RunServer()).
+ * @param opts User provided start up commandline args
+ * @returns the exit status if the server could not be started.
+ */
+int GCALab_ServerMode(GCALab_CL_Options* opts)
+{
+	return GCALab_RunServer(opts->SocketPath);
 }
 
 /**
@@ -285,6 +381,7 @@ char GCALab_BatchMode(GCALab_CL_Options* opts)
 char GCALab_Init(int argc,char **argv,GCALab_CL_Options **opts)
 {
 	char *args,*desc;
+	char rc;
 	GCALab_Global = (GCALab_WS **)malloc(GCALAB_MAX_WORKSPACES*sizeof(GCALab_WS*));
 	if(!(GCALab_Global))
 	{
@@ -302,10 +399,22 @@ char GCALab_Init(int argc,char **argv,GCALab_CL_Options **opts)
 	
 	GCALab_numCmds = 0;
 	GCALab_numOps = 0;
+	pthread_key_create(&GCALab_SnapshotKey,NULL);
+	pthread_key_create(&GCALab_OutKey,NULL);
+	GCALab_SetScratchDir((opts[0])->ScratchDir);
+	GCALab_SetTopologyCache((opts[0])->TopoCacheDir);
+	GCALab_SetOutOfCore((opts[0])->OutOfCoreDir);
+	GCALab_SetShardMode((opts[0])->shardmode,(opts[0])->shard,(opts[0])->nshards);
+	/*all workspaces share one pool of workers*/
+	rc = GCALab_StartScheduler((opts[0])->numworkers,&GCALab_RunCommandTask);
+	if (rc <= 0)
+	{
+		return rc;
+	}
 	
 	/*register commands*/
-	args = "n";
-	desc = "Creates a new workspace with n CA slots.";
+	args = "n [maxrunning]";
+	desc = "Creates a new workspace with n CA slots (running up to maxrunning commands at once).";
 	GCALab_Register_Command("new-work",&GCALab_CMD_NewWorkSpace,args,desc);
 	args = "none";
 	desc = "Print the current workspace.";
@@ -320,14 +429,17 @@ char GCALab_Init(int argc,char **argv,GCALab_CL_Options **opts)
 	desc = "Enqueues the GCA operation to the current command queue.";
 	GCALab_Register_Command("q-cmd",&GCALab_CMD_QueueCommand,args,desc);
 	args = "cmd_id";
-	desc = "Sets GCA operation to cmd_id to be ignored.";
+	desc = "Sets GCA operation to cmd_id to be ignored, a running operation is stopped.";
 	GCALab_Register_Command("del-cmd",&GCALab_CMD_DeleteCommand,args,desc);
 	args = "none";
 	desc = "The current queue will start processing.";
 	GCALab_Register_Command("exec-q",&GCALab_CMD_ExecuteQueue,args,desc);
 	args = "none";
-	desc = "The current queue will pause after completion of the current operation.";
+	desc = "The current queue will pause, running read only operations stop and resume on exec-q.";
 	GCALab_Register_Command("stop-q",&GCALab_CMD_StopQueue,args,desc);
+	args = "none";
+	desc = "Prints the commands in the current queue and the progress of running ones.";
+	GCALab_Register_Command("print-q",&GCALab_CMD_PrintQueue,args,desc);
 	args = "ca_id";
 	desc = "Prints GCA with id ca_id in the current workspace.";
 	GCALab_Register_Command("print-ca",&GCALab_CMD_PrintCA,args,desc);
@@ -341,45 +453,66 @@ char GCALab_Init(int argc,char **argv,GCALab_CL_Options **opts)
 	desc = "Exit GCALab.";
 	GCALab_Register_Command("quit",&GCALab_CMD_Quit,args,desc);
 	args = "none";
+	desc = "Prints scheduler worker utilisation and steal counts.";
+	GCALab_Register_Command("stats",&GCALab_CMD_PrintStats,args,desc);
+	args = "[-f csvfile]";
+	desc = "Prints time, memory and work counters of the finished commands in the current workspace (or writes them to csvfile).";
+	GCALab_Register_Command("profile",&GCALab_CMD_Profile,args,desc);
+	args = "none";
 	desc = "Prints this help menu.";
 	GCALab_Register_Command("help",&GCALab_CMD_PrintHelp,args,desc);
 	args = "none";
 	desc = "Prints available compute commands.";
 	GCALab_Register_Command("list-cmds",&GCALab_CMD_PrintOperations,args,desc);
+	args = "file [-w]";
+	desc = "Writes the current workspace (GCAs, results and queue) to file in the background (-w waits for it).";
+	GCALab_Register_Command("snapshot",&GCALab_CMD_Snapshot,args,desc);
+	args = "file";
+	desc = "Restores a workspace snapshot into a new workspace.";
+	GCALab_Register_Command("restore",&GCALab_CMD_Restore,args,desc);
 	/*register operations*/	
 	args = "none";
 	desc = "No Operation";
-	GCALab_Register_Operation("nop",&GCALab_OP_NOP,args,desc);
+	GCALab_Register_Operation("nop",&GCALab_OP_NOP,0,args,desc);
 	args = "i -f filename";
 	desc = "Loads a *.gca file into the current workspace";
-	GCALab_Register_Operation("load",&GCALab_OP_Load,args,desc);
-	args = "i -f filename (-g | -r)";
-	desc = "Save a GCA or result with id to file";
-	GCALab_Register_Operation("save",&GCALab_OP_Save,args,desc);
+	GCALab_Register_Operation("load",&GCALab_OP_Load,GCALAB_OP_EXCLUSIVE | GCALAB_OP_CREATE,args,desc);
+	args = "i -f filename (-g [-text] | -r)";
+	desc = "Save a GCA (binary unless -text) or result with id to file";
+	GCALab_Register_Operation("save",&GCALab_OP_Save,GCALAB_OP_EXCLUSIVE,args,desc);
+	args = "i -f prefix [-all] [-raw]";
+	desc = "Writes result i (or every result with -all) to prefix.i.npy (raw prefix.i.bin with -raw), described in prefix.json";
+	GCALab_Register_Operation("export",&GCALab_OP_Export,GCALAB_OP_EXCLUSIVE,args,desc);
 	args = "i -t Tfinal [-I] [-f icfile | -c (random | point | checker | stripe)]";
 	desc = "simulates the id to Tfinal";
-	GCALab_Register_Operation("sim",&GCALab_OP_Simulate,args,desc);
-	args = "i (((-m meshfile | -t numcells genus) -s numstates -r (code | totalistic | thresh | life ) rulecode) | -eca numCells numNeighbours rulecode) [-c (random | point | checker | stripe)] [-w windowsize] [-nh (neumann | moore)]";
+	GCALab_Register_Operation("sim",&GCALab_OP_Simulate,GCALAB_OP_WRITE,args,desc);
+	args = "i (((-m meshfile | -t numcells genus | -g edgefile) -s numstates -r (code | totalistic | thresh | life ) rulecode) | -eca numCells numNeighbours rulecode) [-c (random | point | checker | stripe)] [-w windowsize [-z keyint]] [-nh (neumann | moore)]";
 	desc = "Creates a new graph cellular automaton in the current workspace";
-	GCALab_Register_Operation("gca",&GCALab_OP_GCA,args,desc);
+	GCALab_Register_Operation("gca",&GCALab_OP_GCA,GCALAB_OP_EXCLUSIVE | GCALAB_OP_CREATE,args,desc);
     args = "i [-p prob]";
     desc = "Rotate neighbourhoods with probability p";
-	GCALab_Register_Operation("rotate",&GCALab_OP_Rotate,args,desc);
-	args = "i -n numsamples -t timesteps -e entropytype -p";
+	GCALab_Register_Operation("rotate",&GCALab_OP_Rotate,GCALAB_OP_WRITE | GCALAB_OP_TOPOLOGY,args,desc);
+	args = "i -n numsamples -t timesteps -e entropytype -p [-j numthreads] [-seed seed] [-tol halfwidth [-conf level]] [-part file]";
 	desc = "Computes entropy measures of graph cellular automaton at i";
-	GCALab_Register_Operation("entropy",&GCALab_OP_Entropy,args,desc);
-	args = "i -p paramtype [-l config0 configN | -n numSamples -t maxT]";
+	GCALab_Register_Operation("entropy",&GCALab_OP_Entropy,GCALAB_OP_READ,args,desc);
+	args = "i -p paramtype [-l config0 configN | -n numSamples -t maxT] [-j numthreads] [-seed seed] [-tol halfwidth [-conf level]] [-ckpt file] [-part file]";
 	desc = "Computes complexity parameters such as Langton's lambda";
-	GCALab_Register_Operation("param",&GCALab_OP_Param,args,desc);
+	GCALab_Register_Operation("param",&GCALab_OP_Param,GCALAB_OP_READ,args,desc);
 	args = "i";
 	desc = "Computes pre-images of the current configuration of the graph cellular automaton at i";
-	GCALab_Register_Operation("pre",&GCALab_OP_Reverse,args,desc);
-	args = "i (-n numsamples | -l config0 configN)";
+	GCALab_Register_Operation("pre",&GCALab_OP_Reverse,GCALAB_OP_READ,args,desc);
+	args = "i (-n numsamples | -l config0 configN) [-j numthreads] [-seed seed] [-part file]";
 	desc = "Computes state frequency histogram for each cell in the graph cellular automaton at i";
-	GCALab_Register_Operation("freq",&GCALab_OP_Freq,args,desc);
-	args = "i -t timesteps";
+	GCALab_Register_Operation("freq",&GCALab_OP_Freq,GCALAB_OP_READ,args,desc);
+	args = "i -t timesteps [-n numsamples] [-j numthreads] [-seed seed]";
 	desc = "Computes the non-quiescient population density over time.";
-	GCALab_Register_Operation("pop",&GCALab_OP_Pop,args,desc);
+	GCALab_Register_Operation("pop",&GCALab_OP_Pop,GCALAB_OP_READ,args,desc);
+	args = "i -r (code | totalistic | thresh | life) rule0 ruleN -measures m1,m2,... [-n numsamples] [-t timesteps] [-maxt maxT] [-j numthreads] [-seed seed] [-nocanon] [-cache cachefile] [-f csvfile] [-part file]";
+	desc = "Computes measures (lambda,Z,S,W,G,C,T) for every rule in a range on the topology of i";
+	GCALab_Register_Operation("sweep",&GCALab_OP_Sweep,GCALAB_OP_READ,args,desc);
+	args = "i (-f recfile [-k keyint] | -stop | -x t0 t1 -o bmpfile [-f recfile])";
+	desc = "Records every step of a GCA, stops recording or exports steps t0 to t1 of a recording";
+	GCALab_Register_Operation("record",&GCALab_OP_Record,GCALAB_OP_EXCLUSIVE,args,desc);
 	return GCALAB_SUCCESS;
 }
 
@@ -406,15 +539,17 @@ void GCALab_Register_Command(char *id,char (*f)(int,char**),char * args, char *
  * @brief Registers a compute operation
  * @param id the name of the operation.
  * @param f function pointer to handle the operation.
+ * @param flags how the operation accesses the workspace (GCALAB_OP_READ, etc.).
  * @param args a human readable list of arguments.
  * @param desc a human readable summary of the operation.
  */
-void GCALab_Register_Operation(char *id,char (*f)(unsigned char,unsigned int,int,char**,GCALabOutput**),char* args,char * desc)
+void GCALab_Register_Operation(char *id,char (*f)(unsigned char,unsigned int,int,char**,GCALabOutput**),unsigned char flags,char* args,char * desc)
 {
 	if (GCALab_numOps < GCALAB_MAXNUM_OPS)
 	{
 		GCALab_Ops[GCALab_numOps].id = id;
 		GCALab_Ops[GCALab_numOps].f = f;
+		GCALab_Ops[GCALab_numOps].flags = flags;
 		GCALab_Ops[GCALab_numOps].args = args;
 		GCALab_Ops[GCALab_numOps].desc = desc;
 		GCALab_numOps++;
@@ -502,26 +637,26 @@ void GCALab_HandleErr(char rc)
 		switch (rc)
 		{
 			case GCALAB_MEM_ERROR:
-				fprintf(stderr,"OUT OF MEMORY!!!\n");
+				fprintf(GCALab_Err(),"OUT OF MEMORY!!!\n");
 				GCALab_HandleErr(GCALAB_FATAL_ERROR);
 				break;
 			case GCALAB_FATAL_ERROR:
-				fprintf(stderr,"A fatal error occurred. Aborting.\n");
+				fprintf(GCALab_Err(),"A fatal error occurred. Aborting.\n");
 				exit(1);
 				break;
 			case GCALAB_INVALID_OPTION:
-				fprintf(stderr,"Invalid command option.\n");
+				fprintf(GCALab_Err(),"Invalid command option.\n");
 				break;
 			case GCALAB_UNKNOWN_OPTION:
-				fprintf(stderr,"Unknown command.\n");
+				fprintf(GCALab_Err(),"Unknown command.\n");
 				break;
 			case GCALAB_CL_PARSE_ERROR:
 				break;
 			case GCALAB_INVALID_WS_ERROR:
-				fprintf(stderr,"Invalid Workspace Id.\n");
+				fprintf(GCALab_Err(),"Invalid Workspace Id.\n");
 				break;
 			case GCALAB_THREAD_ERROR:
-				fprintf(stderr,"Something funky happened with a thread.\n");
+				fprintf(GCALab_Err(),"Something funky happened with a thread.\n");
 				GCALab_HandleErr(GCALAB_FATAL_ERROR);
 				break;
 		}
@@ -545,55 +680,68 @@ unsigned int GCALab_GetCommandCode(char* cmd)
 }
 
 /**
- * @brief Processing thread attached to a workspace.
- * @param params thread args, just the workspace id.
+ * @brief Runs a command that was pushed to the scheduler, called by a scheduler worker.
+ * @details Once the command is done any commands of the workspace that it was 
+ * holding back are scheduled.
+ * @param task the workspace and queue record of the command.
  */
-void * GCALab_Worker(void *params)
+void GCALab_RunCommandTask(GCALab_Task *task)
 {
 	unsigned char ws_id;
-	unsigned char exit,error;
 	char rc;
-	ws_id = (unsigned int)(unsigned long long)params;
+	ws_id = task->ws_id;
+
+	GCALab_LockWS(ws_id);
+	WS(ws_id)->numdispatched--;
+	rc = GCALab_DoCommand(ws_id,task->cmd);
+	if (rc <=0 )
+	{
+		WS(ws_id)->state = GCALAB_WS_STATE_ERROR;
+	}
+	else if (WS(ws_id)->state == GCALAB_WS_STATE_PROCESSING && WS(ws_id)->numrunning == 0 
+		&& WS(ws_id)->numdispatched == 0)
+	{
+		WS(ws_id)->state = GCALAB_WS_STATE_IDLE;
+	}
+	GCALab_Schedule(ws_id);
+	GCALab_SignalWS(ws_id);
+	GCALab_UnLockWS(ws_id);
+}
 
-	exit = 0;
-	error = 0;
-	while(!exit)
+/**
+ * @brief pushes every command of a workspace that is ready to run to the scheduler.
+ * @details Nothing is scheduled while the workspace is paused, or once it has more 
+ * than maxrunning commands in flight. The caller must hold the workspace lock.
+ * @param ws_id the workspace to schedule.
+ */
+void GCALab_Schedule(unsigned char ws_id)
+{
+	GCALab_Task task;
+	GCALab_CmdRecord *cmd;
+	/*pairs with the barrier in GCALab_QueueCommand(), either we see the new 
+	 * command or the producer sees a free slot and schedules it itself*/
+	__sync_synchronize();
+	if (WS(ws_id)->state != GCALAB_WS_STATE_IDLE && WS(ws_id)->state != GCALAB_WS_STATE_PROCESSING)
+	{
+		return;
+	}
+	while (WS(ws_id)->numrunning + WS(ws_id)->numdispatched < WS(ws_id)->maxrunning)
 	{
-		/*Worker thread finite state machine*/
-		switch(GCALab_GetState(ws_id))
+		cmd = GCALab_NextReadyCommand(ws_id);
+		if (cmd == NULL)
 		{
-			case GCALAB_WS_STATE_ERROR:
-				exit = 1;
-				error = 1;
-				break;
-			case GCALAB_WS_STATE_PAUSED:
-				/*just rest for a while*/
-				sleep(1);
-				break;
-			case GCALAB_WS_STATE_PROCESSING:
-				/*the next command*/
-				rc = GCALab_DoNextCommand(ws_id);
-				if (rc <=0 ) GCALab_SetState(ws_id,GCALAB_WS_STATE_ERROR);
-				if (GCALab_GetState(ws_id) == GCALAB_WS_STATE_PROCESSING)
-				{
-					GCALab_SetState(ws_id,GCALAB_WS_STATE_IDLE);
-				}
-				break;
-			case GCALAB_WS_STATE_IDLE:
-				/*check if a command is available*/
-				if(!GCALab_CommandQueueEmpty(ws_id))
-				{
-					/*if so then set state to processing*/
-					GCALab_SetState(ws_id,GCALAB_WS_STATE_PROCESSING);
-				}
-				break;
-			case GCALAB_WS_STATE_EXITING:
-				exit = 1;
-				break;
+			break;
+		}
+		task.ws_id = ws_id;
+		task.cmd = cmd;
+		if (GCALab_SchedulerPush(&task) <= 0)
+		{
+			break;
 		}
-		usleep(1);
+		cmd->state = GCALAB_CMD_DISPATCHED;
+		WS(ws_id)->numdispatched++;
+		WS(ws_id)->state = GCALAB_WS_STATE_PROCESSING;
 	}
-	pthread_exit((void*)((long long)error));
 }
 
 /**
@@ -605,70 +753,331 @@ unsigned char GCALab_CommandQueueEmpty(unsigned char ws_id)
 {
 	unsigned char empty;
 	GCALab_LockWS(ws_id);
-	empty = (WS(ws_id)->numcommands == 0);
+	empty = (GCALab_QueueLength(&(WS(ws_id)->queue)) == 0);
 	GCALab_UnLockWS(ws_id);
 	return empty;
 }
 
 /**
- * @brief executes the next command in the given command queue.
+ * @brief finds the first queued command that may start now.
+ * @details Commands on the same target run in queue order: a reader must wait for 
+ * earlier writers to finish, and a writer for earlier writers to finish and earlier
+ * readers to start running (readers work on a snapshot). Writers that change the topology
+ * wait for earlier readers to finish, as snapshots share the graph. Exclusive commands wait for all 
+ * earlier commands to finish, and nothing after them starts until they are done.
+ * Only the first GCALAB_SCHED_LOOKAHEAD commands are considered.
+ * The caller must hold the workspace lock.
+ * @param ws_id the workspace to schedule.
+ * @returns the command, NULL if nothing can start.
+ */
+GCALab_CmdRecord *GCALab_NextReadyCommand(unsigned char ws_id)
+{
+	GCALab_CmdQueue *q;
+	GCALab_CmdRecord *cmd,*prev;
+	unsigned int i;
+	unsigned char flags,pflags,ready;
+	q = &(WS(ws_id)->queue);
+	cmd = GCALab_QueueFirst(q);
+	for (i=0;cmd != NULL && i<GCALAB_SCHED_LOOKAHEAD;i++,cmd = GCALab_QueueNext(q,cmd))
+	{
+		flags = GCALab_Ops[cmd->cmd_id].flags;
+		if (cmd->state != GCALAB_CMD_QUEUED)
+		{
+			/*nothing may overtake a started exclusive command*/
+			if ((flags & GCALAB_OP_EXCLUSIVE) && cmd->state != GCALAB_CMD_DONE)
+			{
+				return NULL;
+			}
+			continue;
+		}
+		/*a workspace snapshot is waiting for the writers to stop*/
+		if (WS(ws_id)->holdwriters && (flags & (GCALAB_OP_WRITE | GCALAB_OP_EXCLUSIVE)))
+		{
+			if (flags & GCALAB_OP_EXCLUSIVE)
+			{
+				return NULL;
+			}
+			continue;
+		}
+		ready = 1;
+		for (prev=GCALab_QueueFirst(q);prev != cmd && ready;prev = GCALab_QueueNext(q,prev))
+		{
+			pflags = GCALab_Ops[prev->cmd_id].flags;
+			if (prev->state == GCALAB_CMD_DONE)
+			{
+				continue;
+			}
+			if (flags & GCALAB_OP_EXCLUSIVE)
+			{
+				ready = 0;
+			}
+			else if (prev->trgt_id == cmd->trgt_id)
+			{
+				if (pflags & GCALAB_OP_WRITE)
+				{
+					ready = 0;
+				}
+				else if ((flags & GCALAB_OP_WRITE) && (pflags & GCALAB_OP_READ) && prev->state != GCALAB_CMD_RUNNING)
+				{
+					ready = 0;
+				}
+				else if ((flags & GCALAB_OP_TOPOLOGY) && (pflags & GCALAB_OP_READ))
+				{
+					/*running readers still use the graph*/
+					ready = 0;
+				}
+			}
+		}
+		if (ready)
+		{
+			return cmd;
+		}
+		/*nothing may overtake a queued exclusive command either*/
+		if (flags & GCALAB_OP_EXCLUSIVE)
+		{
+			return NULL;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief progress callback of a running command (see GCA_SetProgress()).
+ * @param arg the command record
+ * @param done the amount of work done
+ * @param total the total amount of work, 0 if unknown
+ * @returns 1 if the command has been asked to stop, 0 otherwise.
+ */
+unsigned char GCALab_CmdProgress(void *arg,unsigned long long done,unsigned long long total)
+{
+	GCALab_CmdRecord *cmd;
+	cmd = (GCALab_CmdRecord *)arg;
+	if (total > 0)
+	{
+		cmd->done = done;
+		cmd->total = total;
+	}
+	if (cmd->cancel)
+	{
+		cmd->stopped = 1;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief executes a command in the given command queue.
+ * @details The caller must hold the workspace lock, it is released while the 
+ * operation runs. Read only operations are given a snapshot of their target, 
+ * see GCALab_GetGCA(). A command that stops because it was paused is queued 
+ * again with its snapshot, one that was aborted is dropped with its result.
  * @param ws_id the workspace id to process
+ * @param cmd the queued command
  */
-char GCALab_DoNextCommand(unsigned char ws_id)
+char GCALab_DoCommand(unsigned char ws_id,GCALab_CmdRecord *cmd)
 {
 	unsigned int cmd_id,trgt_id;
 	int nparams;
-	int index,i;
 	char **params;
 	char rc;
 	GCALabOutput *res;
+	GraphCellularAutomaton *snapshot;
+	GCALab_Profile *prof;
+	GCA_Progress progress;
+	unsigned char runnable;
 
 	res = NULL;
+	rc = GCALAB_INVALID_OPTION;
 	
-	GCALab_LockWS(ws_id);
 	/*get command data*/
-	index = WS(ws_id)->qhead;
-	cmd_id = WS(ws_id)->commandqueue[index];
-	trgt_id = WS(ws_id)->commandtarget[index];
-	nparams = WS(ws_id)->numparams[index];
-	params = strvncpy(WS(ws_id)->commandparams[index],nparams,GCALAB_MAX_STRLEN);
-	/*remove command from queue*/
-	WS(ws_id)->qhead = (WS(ws_id)->qhead+1)%GCALAB_COMMAND_BUFFER_SIZE;
-	WS(ws_id)->numcommands--;
-	if (nparams != 0)
+	cmd_id = cmd->cmd_id;
+	trgt_id = cmd->trgt_id;
+	nparams = cmd->numparams;
+	params = cmd->params;
+	/*mark command as running*/
+	cmd->state = GCALAB_CMD_RUNNING;
+	WS(ws_id)->numrunning++;
+	/*operations that modify their target are not run if it does not exist*/
+	runnable = !(GCALab_Ops[cmd_id].flags & GCALAB_OP_WRITE) || (trgt_id < WS(ws_id)->numGCA 
+		&& WS(ws_id)->GCAList[trgt_id] != NULL);
+	/*a resumed command carries on with the snapshot it started with*/
+	snapshot = cmd->snapshot;
+	cmd->snapshot = NULL;
+	if (snapshot == NULL && (GCALab_Ops[cmd_id].flags & GCALAB_OP_READ) && trgt_id < WS(ws_id)->numGCA 
+		&& WS(ws_id)->GCAList[trgt_id] != NULL)
 	{
-		WS(ws_id)->numparams[index] = 0;
-		for(i=0;i<nparams;i++)
+		/*later writers may start as soon as we have our own rows, the graph and LUT
+		 * are shared (only topology writers change them, and they wait for us)*/
+		snapshot = CloneGCAWindow(WS(ws_id)->GCAList[trgt_id],GCALab_ReadWindowSize(WS(ws_id)->GCAList[trgt_id]));
+	}
+	/*kept in the record while running, so a workspace snapshot can save it*/
+	cmd->snapshot = snapshot;
+	/*profiling is skipped if there is no memory for it*/
+	if ((prof = (GCALab_Profile *)malloc(sizeof(GCALab_Profile))) != NULL)
+	{
+		prof->cmd_id = cmd_id;
+		prof->trgt_id = trgt_id;
+		prof->res_id = -1;
+		prof->rule_type = 0;
+		prof->rule = 0;
+		prof->N = 0;
+		if (trgt_id < WS(ws_id)->numGCA && WS(ws_id)->GCAList[trgt_id] != NULL)
 		{
-			free(WS(ws_id)->commandparams[index][i]);
+			prof->rule_type = WS(ws_id)->GCAList[trgt_id]->params->rule_type;
+			prof->rule = WS(ws_id)->GCAList[trgt_id]->params->rule;
+			prof->N = WS(ws_id)->GCAList[trgt_id]->params->N;
 		}
-		free(WS(ws_id)->commandparams[index]);
 	}
 	GCALab_UnLockWS(ws_id);
 
 	/*do processing*/
-	rc = (*(GCALab_Ops[cmd_id].f))(ws_id,trgt_id,nparams,params, &res);
-
-	/*clean up copied params*/
-	for (i=0;i<nparams;i++)
+	if (prof != NULL)
 	{
-		free(params[i]);
+		GCALab_ProfileBegin(prof);
 	}
-	free(params);
-	
+	progress.f = &GCALab_CmdProgress;
+	progress.arg = (void*)cmd;
+	GCA_SetProgress(&progress);
+	if (runnable && (snapshot != NULL || !(GCALab_Ops[cmd_id].flags & GCALAB_OP_READ)))
+	{
+		pthread_setspecific(GCALab_SnapshotKey,(void*)snapshot);
+		rc = (*(GCALab_Ops[cmd_id].f))(ws_id,trgt_id,nparams,params, &res);
+		pthread_setspecific(GCALab_SnapshotKey,NULL);
+	}
+	GCA_SetProgress(NULL);
+	if (prof != NULL)
+	{
+		GCALab_ProfileEnd(prof);
+	}
+
 	GCALab_LockWS(ws_id);
-	if (res != NULL)
+	if (cmd->stopped)
 	{
-		if (WS(ws_id)->numresults < GCALAB_MAX_RESULTS)
+		/*the result of a stopped command only covers part of the work*/
+		if (res != NULL)
+		{
+			free(res->data);
+			free(res);
+			res = NULL;
+		}
+		if (cmd->cancel == GCALAB_CMD_PAUSE)
 		{
-			WS(ws_id)->results[WS(ws_id)->numresults] = res;
-			WS(ws_id)->numresults++;
+			cmd->cancel = 0;
+			cmd->stopped = 0;
+			cmd->state = GCALAB_CMD_QUEUED;
+			WS(ws_id)->numrunning--;
+			free(prof);
+			return GCALAB_SUCCESS;
 		}
 	}
-	/*Cleanup command*/
-	GCALab_UnLockWS(ws_id);
+	cmd->snapshot = NULL;
+	if (snapshot != NULL)
+	{
+		FreeGCA(snapshot);
+	}
+	/*clean up params*/
+	free(cmd->params);
+	cmd->params = NULL;
+	cmd->numparams = 0;
+	WS(ws_id)->numrunning--;
+	cmd->res = res;
+	cmd->prof = prof;
+	cmd->rc = rc;
+	cmd->state = GCALAB_CMD_DONE;
+	GCALab_RetireCommands(ws_id);
 	return GCALAB_SUCCESS;
 }
+
+/**
+ * @brief removes finished commands from the head of the queue, appending their 
+ * results and profiles in queue order.
+ * @details The caller must hold the workspace lock, it is still held when the 
+ * notify callbacks of the commands are called.
+ * @param ws_id the workspace id to process
+ */
+void GCALab_RetireCommands(unsigned char ws_id)
+{
+	GCALab_CmdRecord *cmd;
+	GCALabOutput *res;
+	int res_id;
+	void (*notify)(void*,char,int);
+	void *notify_arg;
+	char rc;
+	while ((cmd = GCALab_QueueFirst(&(WS(ws_id)->queue))) != NULL)
+	{
+		if (cmd->state != GCALAB_CMD_DONE)
+		{
+			break;
+		}
+		res = cmd->res;
+		res_id = -1;
+		if (res != NULL && GCALab_AddResult(&(WS(ws_id)->results),res) == GCALAB_SUCCESS)
+		{
+			res_id = (int)(WS(ws_id)->results.num) - 1;
+		}
+		if (cmd->prof != NULL)
+		{
+			cmd->prof->res_id = res_id;
+		}
+		if (cmd->prof != NULL && GCALab_AddProfile(&(WS(ws_id)->profiles),cmd->prof) != GCALAB_SUCCESS)
+		{
+			free(cmd->prof);
+		}
+		notify = cmd->notify;
+		notify_arg = cmd->notify_arg;
+		rc = cmd->rc;
+		/*remove command from queue*/
+		GCALab_QueuePop(&(WS(ws_id)->queue));
+		if (notify != NULL)
+		{
+			(*notify)(notify_arg,rc,res_id);
+		}
+	}
+}
+
+/**
+ * @brief gets the GCA an operation should work on.
+ * @details For read only operations this is the snapshot taken when the command 
+ * started, so other commands may modify the workspace copy in the meantime.
+ * @param ws_id the workspace id
+ * @param trgt_id the target GCA id
+ */
+GraphCellularAutomaton *GCALab_GetGCA(unsigned char ws_id,unsigned int trgt_id)
+{
+	GraphCellularAutomaton *snapshot;
+	snapshot = (GraphCellularAutomaton *)pthread_getspecific(GCALab_SnapshotKey);
+	return (snapshot != NULL) ? snapshot : WS(ws_id)->GCAList[trgt_id];
+}
+
+/**
+ * @brief Sends the output of the commands run by the calling thread to a stream.
+ * @param fp the stream, NULL for stdout and stderr again.
+ */
+void GCALab_SetOutput(FILE *fp)
+{
+	pthread_setspecific(GCALab_OutKey,(void*)fp);
+}
+
+/**
+ * @brief gets the stream commands print their output to (see GCALab_SetOutput()).
+ */
+FILE *GCALab_Out(void)
+{
+	FILE *fp;
+	fp = (FILE *)pthread_getspecific(GCALab_OutKey);
+	return (fp != NULL) ? fp : stdout;
+}
+
+/**
+ * @brief gets the stream commands print their errors to (see GCALab_SetOutput()).
+ */
+FILE *GCALab_Err(void)
+{
+	FILE *fp;
+	fp = (FILE *)pthread_getspecific(GCALab_OutKey);
+	return (fp != NULL) ? fp : stderr;
+}
+
 /**
  * @brief Prints Author and affiliation information
  */
@@ -730,6 +1139,14 @@ void GCALab_PrintUsage()
 	printf("\t [-g,--graphics]\n\t\t : start in interactive mode\n");
 	printf("\t [-i,--interactive]\n\t\t : start in interactive mode\n");
 	printf("\t [-b,--batch]\n\t\t : start in batch mode\n");
+	printf("\t [-d,--daemon socket]\n\t\t : start a job server listening on the UNIX socket\n");
+	printf("\t [-w,--workers n]\n\t\t : number of worker threads (default one per processor)\n");
+	printf("\t [-j,--jobs n]\n\t\t : number of workspaces a batch script is spread over (default one per worker)\n");
+	printf("\t [-s,--scratch dir]\n\t\t : directory for spilled results (default $TMPDIR or /tmp)\n");
+	printf("\t [-t,--topo-cache dir]\n\t\t : directory for cached graphs and generated meshes (default none)\n");
+	printf("\t [-o,--out-of-core dir]\n\t\t : keep the rows and graphs of new GCAs in files in dir (default none)\n");
+	printf("\t [--shard i/n]\n\t\t : run shard i of n of every operation given a -part file\n");
+	printf("\t [--merge]\n\t\t : merge the shards of every operation given a -part file\n");
 }
 
 /**
@@ -942,6 +1359,16 @@ void GCALab_InitCL_Options(GCALab_CL_Options* opts)
 	opts->save_CA = 0;
 	opts->CAInputFilename = "";
 	opts->CAOutputFilename = "";
+	opts->numworkers = GCALAB_DEFAULT_WORKERS;
+	opts->jobs = 0;
+	opts->ScriptFile = NULL;
+	opts->SocketPath = NULL;
+	opts->ScratchDir = NULL;
+	opts->TopoCacheDir = NULL;
+	opts->OutOfCoreDir = NULL;
+	opts->shardmode = GCALAB_SHARD_NONE;
+	opts->shard = 0;
+	opts->nshards = 1;
 }
 
 /**
@@ -986,6 +1413,25 @@ GCALab_CL_Options* GCALab_ParseCommandLineArgs(int argc, char **argv)
 					case 'g':
 						CL_opt->mode = GCALAB_GRAPHICS_MODE;
 						break;
+					case 'd':
+						CL_opt->mode = GCALAB_SERVER_MODE;
+						CL_opt->SocketPath = argv[++i];
+						break;
+					case 'w':
+						CL_opt->numworkers = (unsigned int)atoi(argv[++i]);
+						break;
+					case 'j':
+						CL_opt->jobs = (unsigned int)atoi(argv[++i]);
+						break;
+					case 's':
+						CL_opt->ScratchDir = argv[++i];
+						break;
+					case 't':
+						CL_opt->TopoCacheDir = argv[++i];
+						break;
+					case 'o':
+						CL_opt->OutOfCoreDir = argv[++i];
+						break;
 				}
 				
 				j++;
@@ -1006,6 +1452,44 @@ GCALab_CL_Options* GCALab_ParseCommandLineArgs(int argc, char **argv)
 			{
 				CL_opt->mode = GCALAB_GRAPHICS_MODE;
 			}
+			else if(!strcmp(argv[i],"--daemon"))
+			{
+				CL_opt->mode = GCALAB_SERVER_MODE;
+				CL_opt->SocketPath = argv[++i];
+			}
+			else if(!strcmp(argv[i],"--workers"))
+			{
+				CL_opt->numworkers = (unsigned int)atoi(argv[++i]);
+			}
+			else if(!strcmp(argv[i],"--jobs"))
+			{
+				CL_opt->jobs = (unsigned int)atoi(argv[++i]);
+			}
+			else if(!strcmp(argv[i],"--scratch"))
+			{
+				CL_opt->ScratchDir = argv[++i];
+			}
+			else if(!strcmp(argv[i],"--topo-cache"))
+			{
+				CL_opt->TopoCacheDir = argv[++i];
+			}
+			else if(!strcmp(argv[i],"--out-of-core"))
+			{
+				CL_opt->OutOfCoreDir = argv[++i];
+			}
+			else if(!strcmp(argv[i],"--shard"))
+			{
+				if (GCALab_ParseShard(argv[++i],&(CL_opt->shard),&(CL_opt->nshards)) <= 0)
+				{
+					GCALab_PrintUsage();
+					return NULL;
+				}
+				CL_opt->shardmode = GCALAB_SHARD_RUN;
+			}
+			else if(!strcmp(argv[i],"--merge"))
+			{
+				CL_opt->shardmode = GCALAB_SHARD_MERGE;
+			}
 			else /*unknown option*/
 			{
 				GCALab_PrintUsage();
@@ -1014,6 +1498,11 @@ GCALab_CL_Options* GCALab_ParseCommandLineArgs(int argc, char **argv)
 			
 		}
 	}
+	/*one worker per job unless told otherwise*/
+	if (CL_opt->numworkers == GCALAB_DEFAULT_WORKERS)
+	{
+		CL_opt->numworkers = CL_opt->jobs;
+	}
 	
 	return CL_opt;	
 }
@@ -1022,11 +1511,11 @@ GCALab_CL_Options* GCALab_ParseCommandLineArgs(int argc, char **argv)
  * @brief Creates a new processing workspace, 
  * @details the user can set the limit on the number of CA objects the workspace can hold.
  * @param GCALimit the maximum number of CA that can be handled by this workspace
+ * @param maxrunning the max number of commands that may run at once (the default if <= 0)
  */
-char GCALab_NewWorkSpace(int GCALimit)
+char GCALab_NewWorkSpace(int GCALimit,int maxrunning)
 {
 	GCALab_WS *new_ws;
-	int rc;
 
 	if (GCALab_numWS < GCALAB_MAX_WORKSPACES)
 	{
@@ -1043,6 +1532,10 @@ char GCALab_NewWorkSpace(int GCALimit)
 		{
 			return GCALAB_MEM_ERROR;
 		}
+		if(!(new_ws->GCARecorder = (GCALab_Recorder **)malloc(GCALimit*sizeof(GCALab_Recorder*))))
+		{
+			return GCALAB_MEM_ERROR;
+		}
 
 		new_ws->numGCA = 0;
 		if (GCALimit > 0)
@@ -1055,49 +1548,32 @@ char GCALab_NewWorkSpace(int GCALimit)
 		}
 
 		/*result data memory*/
-		new_ws->numresults = 0;
-		if (!(new_ws->results = (GCALabOutput**)malloc(GCALAB_MAX_RESULTS*sizeof(GCALabOutput*))))
-		{
-			return GCALAB_MEM_ERROR;
-		}
-		/*set up the command queue*/
-		if (!(new_ws->commandqueue = (unsigned int *)malloc(GCALAB_COMMAND_BUFFER_SIZE*sizeof(unsigned int))))
-		{
-			return GCALAB_MEM_ERROR;
-		}
-		memset((void*)(new_ws->commandqueue),0,GCALAB_COMMAND_BUFFER_SIZE*sizeof(unsigned int));
-		if (!(new_ws->commandtarget = (unsigned int *)malloc(GCALAB_COMMAND_BUFFER_SIZE*sizeof(unsigned int))))
+		if (GCALab_InitResults(&(new_ws->results)) != GCALAB_SUCCESS)
 		{
 			return GCALAB_MEM_ERROR;
 		}
-		memset((void*)(new_ws->commandtarget),0,GCALAB_COMMAND_BUFFER_SIZE*sizeof(unsigned int));
-		if (!(new_ws->commandparams = (char***)malloc(GCALAB_COMMAND_BUFFER_SIZE*sizeof(char**))))
+		if (GCALab_InitProfileLog(&(new_ws->profiles)) != GCALAB_SUCCESS)
 		{
 			return GCALAB_MEM_ERROR;
 		}
-		memset((void*)(new_ws->commandparams),0,GCALAB_COMMAND_BUFFER_SIZE*sizeof(char**));
-		if (!(new_ws->numparams = (int *)malloc(GCALAB_COMMAND_BUFFER_SIZE*sizeof(int))))
+		/*set up the command queue*/
+		if (GCALab_InitQueue(&(new_ws->queue)) != GCALAB_SUCCESS)
 		{
 			return GCALAB_MEM_ERROR;
 		}
-		memset((void*)(new_ws->numparams),0,GCALAB_COMMAND_BUFFER_SIZE*sizeof(int));
+		new_ws->maxrunning = (maxrunning > 0) ? (unsigned int)maxrunning : GCALAB_DEFAULT_WS_THREADS;
 
 
-		new_ws->numcommands = 0;
-		new_ws->qhead = 0;
-		new_ws->qtail = 0;
+		new_ws->numrunning = 0;
+		new_ws->numdispatched = 0;
+		new_ws->holdwriters = 0;
 
 		GCALab_Global[GCALab_numWS] = new_ws;
-		/*init worker thread*/
+		/*commands are run by the scheduler workers*/
 		new_ws->state = GCALAB_WS_STATE_IDLE;
 		/*because the main thread updates the queue*/
 		pthread_mutex_init(&(new_ws->wslock),NULL);
-
-		rc = pthread_create(&(new_ws->worker),NULL,GCALab_Worker,(void*)(unsigned long long)GCALab_numWS);
-		if (rc)
-		{
-			return GCALAB_THREAD_ERROR;
-		}
+		pthread_cond_init(&(new_ws->wscond),NULL);
 
 		GCALab_numWS++;
 		return GCALAB_SUCCESS;
@@ -1108,6 +1584,53 @@ char GCALab_NewWorkSpace(int GCALimit)
 	}
 }
 
+/**
+ * @brief Frees the most recently created workspace and gives its id back.
+ * @details Used to undo a workspace that could not be set up (e.g., a failed restore),
+ * nothing of it may have been scheduled and its lock must not be held. Queued commands 
+ * are dropped with their snapshots, results and profiles.
+ */
+void GCALab_DropWorkSpace(void)
+{
+	GCALab_WS *ws;
+	GCALab_CmdRecord *cmd;
+	int i;
+
+	if (GCALab_numWS == 0)
+	{
+		return;
+	}
+	ws = GCALab_Global[GCALab_numWS - 1];
+	for (cmd = GCALab_QueueFirst(&(ws->queue));cmd != NULL;cmd = GCALab_QueueNext(&(ws->queue),cmd))
+	{
+		free(cmd->params);
+		FreeGCA(cmd->snapshot);
+		if (cmd->res != NULL)
+		{
+			free(cmd->res->data);
+			free(cmd->res);
+		}
+		free(cmd->prof);
+	}
+	GCALab_FreeQueue(&(ws->queue));
+	GCALab_FreeResults(&(ws->results));
+	GCALab_FreeProfileLog(&(ws->profiles));
+	for (i=0;i<ws->numGCA;i++)
+	{
+		GCALab_CloseRecorder(ws->GCARecorder[i]);
+		FreeMesh(ws->GCAGeometry[i]);
+		FreeGCA(ws->GCAList[i]);
+	}
+	free(ws->GCAList);
+	free(ws->GCAGeometry);
+	free(ws->GCARecorder);
+	pthread_mutex_destroy(&(ws->wslock));
+	pthread_cond_destroy(&(ws->wscond));
+	free(ws);
+	GCALab_numWS--;
+	GCALab_Global[GCALab_numWS] = NULL;
+}
+
 /**
  * @brief aquire a lock on the given workspace
  * @param ws_id the workspace to lock
@@ -1126,56 +1649,111 @@ void GCALab_UnLockWS(unsigned char ws_id)
 	pthread_mutex_unlock(&(GCALab_Global[ws_id]->wslock));
 }
 
+/**
+ * @brief wait for a change to the queue or state of the given workspace
+ * @param ws_id the workspace to wait on, the caller must hold its lock
+ */
+void GCALab_WaitWS(unsigned char ws_id)
+{
+	pthread_cond_wait(&(GCALab_Global[ws_id]->wscond),&(GCALab_Global[ws_id]->wslock));
+}
+
+/**
+ * @brief wake everything waiting on the given workspace
+ * @param ws_id the workspace that changed, the caller must hold its lock
+ */
+void GCALab_SignalWS(unsigned char ws_id)
+{
+	pthread_cond_broadcast(&(GCALab_Global[ws_id]->wscond));
+}
+
 /**
  * @brief appends the given command string to the command queue of the given workspace.
+ * @details The workspace lock is only taken if the workspace may be able to start 
+ * the command right away, otherwise it is picked up when a running command finishes.
  * @param ws_id workspace to modify
  * @param command_id the op-code of the user queued command
  * @param target_id the location of the results in the data array
- * @param params list of args to the user command
+ * @param params list of args to the user command, they are copied
  * @param nparams the number of args to teh user command
  */
 char GCALab_QueueCommand(unsigned char ws_id,unsigned int command_id,unsigned int target_id,char **params,int numparams)
 {
-	unsigned int ind;
-	/*aquire lock on the workspace*/
-	GCALab_LockWS(ws_id);
-	if (WS(ws_id)->numcommands == GCALAB_COMMAND_BUFFER_SIZE)
+	return GCALab_QueueCommandNotify(ws_id,command_id,target_id,params,numparams,NULL,NULL);
+}
+
+/**
+ * @brief as GCALab_QueueCommand(), and calls notify once the command is retired.
+ * @details notify is called with the workspace lock held, so it must not 
+ * take it (or queue commands).
+ * @param notify called with notify_arg, the return code of the operation and
+ * the id of its result (-1 if it has none)
+ * @param notify_arg passed to notify
+ */
+char GCALab_QueueCommandNotify(unsigned char ws_id,unsigned int command_id,unsigned int target_id,char **params,int numparams,
+	void (*notify)(void*,char,int),void *notify_arg)
+{
+	char **arena;
+	char rc;
+	if (!(arena = GCALab_ParamArena(params,numparams)))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	rc = GCALab_QueuePush(&(WS(ws_id)->queue),command_id,target_id,arena,numparams,notify,notify_arg);
+	if (rc != GCALAB_SUCCESS)
+	{
+		free(arena);
+		return rc;
+	}
+	/*pairs with the barrier in GCALab_Schedule()*/
+	__sync_synchronize();
+	if (WS(ws_id)->numrunning + WS(ws_id)->numdispatched < WS(ws_id)->maxrunning)
 	{
+		GCALab_LockWS(ws_id);
+		GCALab_Schedule(ws_id);
+		GCALab_SignalWS(ws_id);
 		GCALab_UnLockWS(ws_id);
-		return GCALAB_QUEUE_FULL;
-	}
-	ind = WS(ws_id)->qtail;
-	WS(ws_id)->commandqueue[ind] = command_id;
-	WS(ws_id)->commandtarget[ind] = target_id;
-	WS(ws_id)->commandparams[ind] = params;
-	WS(ws_id)->numparams[ind] = numparams;
-	WS(ws_id)->qtail = (WS(ws_id)->qtail+1)%GCALAB_COMMAND_BUFFER_SIZE;
-	WS(ws_id)->numcommands++;
-	GCALab_UnLockWS(ws_id);
+	}
 	return GCALAB_SUCCESS;
 }
 
 /**
  * @brief cancels the the command located at address index of the command 
  * queue of the given workspace.
+ * @details A command that is already running is asked to stop, long operations 
+ * stop at their next progress report (see GCA_SetProgress()) and are retired 
+ * without a result, others finish as normal.
  * @param ws_id the workspace we are modifying
  * @param index the index of the command in the queue
  */
 char GCALab_CancelCommand(unsigned char ws_id,unsigned int index)
 {
+	GCALab_CmdRecord *cmd;
+	unsigned int i;
 	GCALab_LockWS(ws_id);
-	if ((index >= 0) && (index < GCALAB_COMMAND_BUFFER_SIZE))
+	cmd = GCALab_QueueFirst(&(WS(ws_id)->queue));
+	for (i=0;i<index && cmd != NULL;i++)
+	{
+		cmd = GCALab_QueueNext(&(WS(ws_id)->queue),cmd);
+	}
+	/*commands that have not started become a nop, running ones are asked to stop*/
+	if (cmd != NULL && (cmd->state == GCALAB_CMD_QUEUED || cmd->state == GCALAB_CMD_DISPATCHED))
 	{
-		WS(ws_id)->commandqueue[index] = GCALAB_NOP;
-		WS(ws_id)->commandtarget[index] = 0;
-		/*clean up parameter memory if there were any*/
-		if (WS(ws_id)->numparams[index] > 0)
+		cmd->cmd_id = GCALAB_NOP;
+		cmd->trgt_id = 0;
+		/*clean up parameter memory*/
+		free(cmd->params);
+		cmd->params = NULL;
+		cmd->numparams = 0;
+		if (cmd->snapshot != NULL)
 		{
-			free(WS(ws_id)->commandparams[index]);
-			WS(ws_id)->commandparams[index] = NULL;
-			WS(ws_id)->numparams[index] = 0;
+			FreeGCA(cmd->snapshot);
+			cmd->snapshot = NULL;
 		}
-
+	}
+	else if (cmd != NULL && cmd->state == GCALAB_CMD_RUNNING)
+	{
+		cmd->cancel = GCALAB_CMD_ABORT;
 	}
 	GCALab_UnLockWS(ws_id);
 	return GCALAB_SUCCESS;
@@ -1189,18 +1767,33 @@ char GCALab_ProcessCommandQueue(unsigned char ws_id)
 {
 	GCALab_LockWS(ws_id);
 	WS(ws_id)->state = GCALAB_WS_STATE_IDLE;
+	GCALab_Schedule(ws_id);
+	GCALab_SignalWS(ws_id);
 	GCALab_UnLockWS(ws_id);
 	return GCALAB_SUCCESS;
 }
 
 /**
  * @brief Tells workspace to halt processing
+ * @details Running read only commands are asked to stop, they are queued again 
+ * and resume when the queue is processed again.
  * @param ws_id the workspace to modify
  */
 char GCALab_PauseCommandQueue(unsigned char ws_id)
 {
+	GCALab_CmdRecord *cmd;
 	GCALab_LockWS(ws_id);
+	for (cmd = GCALab_QueueFirst(&(WS(ws_id)->queue));cmd != NULL;cmd = GCALab_QueueNext(&(WS(ws_id)->queue),cmd))
+	{
+		/*a modified target can not be rolled back, so writers always finish*/
+		if (cmd->state == GCALAB_CMD_RUNNING && cmd->cancel == 0 
+			&& (GCALab_Ops[cmd->cmd_id].flags & GCALAB_OP_READ))
+		{
+			cmd->cancel = GCALAB_CMD_PAUSE;
+		}
+	}
 	WS(ws_id)->state = GCALAB_WS_STATE_PAUSED;
+	GCALab_SignalWS(ws_id);
 	GCALab_UnLockWS(ws_id);
 	return GCALAB_SUCCESS;
 }
@@ -1211,16 +1804,27 @@ char GCALab_PauseCommandQueue(unsigned char ws_id)
  */
 char GCALab_PrintCommandQueue(unsigned char ws_id)
 {
-	int i,j,k;
+	GCALab_CmdRecord *cmd;
+	int i;
 	GCALab_LockWS(ws_id);
-	j = WS(ws_id)->qhead;
-	fprintf(stdout,"%d %d\n",WS(ws_id)->qhead,WS(ws_id)->qtail);
-	fprintf(stdout,"Priority\tCode\tTarget\t#Parameters\n");
-	fprintf(stdout,"-----------------------------------\n");
-	for(i=0;i < WS(ws_id)->numcommands;i++)
+	fprintf(GCALab_Out(),"Priority\tCode\tTarget\t#Parameters\tProgress\n");
+	fprintf(GCALab_Out(),"---------------------------------------------------\n");
+	cmd = GCALab_QueueFirst(&(WS(ws_id)->queue));
+	for(i=0;cmd != NULL;i++,cmd = GCALab_QueueNext(&(WS(ws_id)->queue),cmd))
 	{
-		k = (i+j)%GCALAB_COMMAND_BUFFER_SIZE;
-		fprintf(stdout,"\t%d\t%u\t%u\t%d\n",i,WS(ws_id)->commandqueue[k],WS(ws_id)->commandtarget[k],WS(ws_id)->numparams[k]);
+		fprintf(GCALab_Out(),"\t%d\t%u\t%u\t%d",i,cmd->cmd_id,cmd->trgt_id,cmd->numparams);
+		if (cmd->state == GCALAB_CMD_RUNNING && cmd->total > 0)
+		{
+			fprintf(GCALab_Out(),"\t%.1f%%\n",100.0*((double)cmd->done)/((double)cmd->total));
+		}
+		else if (cmd->state == GCALAB_CMD_RUNNING)
+		{
+			fprintf(GCALab_Out(),"\trunning\n");
+		}
+		else
+		{
+			fprintf(GCALab_Out(),"\t%s\n",(cmd->state == GCALAB_CMD_DONE) ? "done" : "queued");
+		}
 	}
 	GCALab_UnLockWS(ws_id);
 	return GCALAB_SUCCESS;
@@ -1249,6 +1853,7 @@ void GCALab_SetState(unsigned char ws_id,unsigned int state)
 {
 	GCALab_LockWS(ws_id);
 	GCALab_Global[ws_id]->state = state;
+	GCALab_SignalWS(ws_id);
 	GCALab_UnLockWS(ws_id);
 	return;
 }
@@ -1265,27 +1870,38 @@ void GCALab_ShutDown(char rc)
 	/*if so then prompt the user*/
 	if (GCALab_mode == GCALAB_BATCH_MODE)
 	{
-		int sum;
-		sum = -1;
-		while (sum != 0)
+		/*wait for every workspace to finish its queue*/
+		for (i=0;i<GCALab_numWS;i++)
 		{
-			sum = 0;
-			for (i=0;i<GCALab_numWS;i++)
+			GCALab_LockWS(i);
+			while ((GCALab_QueueLength(&(WS(i)->queue)) > 0 || WS(i)->state == GCALAB_WS_STATE_PROCESSING) 
+				&& WS(i)->state != GCALAB_WS_STATE_ERROR)
 			{
-				GCALab_LockWS(i);
-				sum += WS(i)->numcommands;
-				GCALab_UnLockWS(i);
+				GCALab_WaitWS(i);
 			}
-			usleep(1);
+			GCALab_UnLockWS(i);
 		}
-
 	}
 	for (i=0;i<GCALab_numWS;i++)
 	{
 		GCALab_SetState(i,GCALAB_WS_STATE_EXITING);
 	}
-	exit(0);
-}
+	/*snapshots being written are only there once they are renamed*/
+	GCALab_WaitSnapshots();
+	/*recordings are only complete once their index is written*/
+	for (i=0;i<GCALab_numWS;i++)
+	{
+		int j;
+		for (j=0;j<WS(i)->numGCA;j++)
+		{
+			if (WS(i)->GCARecorder[j] != NULL)
+			{
+				GCALab_FinishRecorder(WS(i)->GCARecorder[j]);
+			}
+		}
+	}
+	exit(0);
+}
 
 /**
  * @brief Prints the help menu
@@ -1294,12 +1910,12 @@ void GCALab_PrintHelp(void)
 {
 	int i;
 
-	fprintf(stdout,"\nCommand List:\n");
-	fprintf(stdout,"-------------\n");
-	fprintf(stdout,"Command:\t[args]\tDescription\n");
+	fprintf(GCALab_Out(),"\nCommand List:\n");
+	fprintf(GCALab_Out(),"-------------\n");
+	fprintf(GCALab_Out(),"Command:\t[args]\tDescription\n");
 	for (i=0;i<GCALab_numCmds;i++)
 	{
-		fprintf(stdout,"%s:\t[%s]\t%s\n",GCALab_Cmds[i].id,GCALab_Cmds[i].args,GCALab_Cmds[i].desc);
+		fprintf(GCALab_Out(),"%s:\t[%s]\t%s\n",GCALab_Cmds[i].id,GCALab_Cmds[i].args,GCALab_Cmds[i].desc);
 	}
 
 	return;
@@ -1312,12 +1928,12 @@ void GCALab_PrintOperations(void)
 {
 	int i;
 
-	fprintf(stdout,"\nOperations List:\n");
-	fprintf(stdout,"-----------------\n");
+	fprintf(GCALab_Out(),"\nOperations List:\n");
+	fprintf(GCALab_Out(),"-----------------\n");
 	for (i=0;i<GCALab_numOps;i++)
 	{
-		fprintf(stdout,"\tSynopsis: %s %s\n",GCALab_Ops[i].id,GCALab_Ops[i].args);
-		fprintf(stdout,"\tDescription: %s\n\n",GCALab_Ops[i].desc);
+		fprintf(GCALab_Out(),"\tSynopsis: %s %s\n",GCALab_Ops[i].id,GCALab_Ops[i].args);
+		fprintf(GCALab_Out(),"\tDescription: %s\n\n",GCALab_Ops[i].desc);
 	}
 	return;
 }
@@ -1329,25 +1945,27 @@ void GCALab_PrintOperations(void)
 char GCALab_PrintWorkSpace(unsigned char ws_id)
 {
 	int i;
+	GCALabOutput *res;
 
-	fprintf(stdout,"Work Space ID: %hhu\n",ws_id);
-	fprintf(stdout,"GCA (%d): ",GCALab_Global[ws_id]->numGCA);
+	fprintf(GCALab_Out(),"Work Space ID: %hhu\n",ws_id);
+	fprintf(GCALab_Out(),"GCA (%d): ",GCALab_Global[ws_id]->numGCA);
 	for (i=0;i<GCALab_Global[ws_id]->numGCA;i++)
 	{
-		fprintf(stdout,"(%d,%u,%u) ",i,GCALab_Global[ws_id]->GCAList[i]->params->rule,GCALab_Global[ws_id]->GCAList[i]->params->N);
+		fprintf(GCALab_Out(),"(%d,%u,%u) ",i,GCALab_Global[ws_id]->GCAList[i]->params->rule,GCALab_Global[ws_id]->GCAList[i]->params->N);
 	}
-	fprintf(stdout,"\n");
+	fprintf(GCALab_Out(),"\n");
 	
-	fprintf(stdout,"Results (%d): ",GCALab_Global[ws_id]->numresults);
-	for (i=0;i<GCALab_Global[ws_id]->numresults;i++)
+	fprintf(GCALab_Out(),"Results (%u): ",GCALab_Global[ws_id]->results.num);
+	for (i=0;i<GCALab_Global[ws_id]->results.num;i++)
 	{
-		fprintf(stdout,"(%d,%d,%s)",i,GCALab_Global[ws_id]->results[i]->type,GCALab_Global[ws_id]->results[i]->id);
+		res = GCALab_GetResult(&(GCALab_Global[ws_id]->results),i);
+		fprintf(GCALab_Out(),"(%d,%d,%s)",i,res->type,res->id);
 	}
-	fprintf(stdout,"\n");
+	fprintf(GCALab_Out(),"\n");
 
-	fprintf(stdout,"Queued Commands (%d):\n",GCALab_Global[ws_id]->numcommands);
-	fprintf(stdout,"Current State: ");
-	fprintf(stdout,"%s\n",statenames[GCALab_Global[ws_id]->state]);
+	fprintf(GCALab_Out(),"Queued Commands (%llu):\n",GCALab_QueueLength(&(GCALab_Global[ws_id]->queue)));
+	fprintf(GCALab_Out(),"Current State: ");
+	fprintf(GCALab_Out(),"%s\n",statenames[GCALab_Global[ws_id]->state]);
 	return GCALAB_SUCCESS;
 }
 
@@ -1356,11 +1974,11 @@ char GCALab_PrintWorkSpace(unsigned char ws_id)
 char GCALab_ListWorkSpaces(void)
 {
 	int i;
-	fprintf(stdout,"ID\tCA\tQL\tST\n");
+	fprintf(GCALab_Out(),"ID\tCA\tQL\tST\n");
 	for (i=0;i<GCALab_numWS;i++)
 	{
-		fprintf(stdout,"%d\t%d\t%u\t",i,GCALab_Global[i]->numGCA,GCALab_Global[i]->numcommands);
-		fprintf(stdout,"%c\n",stateInitials[GCALab_Global[i]->state]);
+		fprintf(GCALab_Out(),"%d\t%d\t%llu\t",i,GCALab_Global[i]->numGCA,GCALab_QueueLength(&(GCALab_Global[i]->queue)));
+		fprintf(GCALab_Out(),"%c\n",stateInitials[GCALab_Global[i]->state]);
 	}
 	return GCALAB_SUCCESS;
 }
@@ -1378,23 +1996,23 @@ char GCALab_PrintCA(unsigned char ws_id,unsigned int gca_id)
 
 	GCA = WS(ws_id)->GCAList[gca_id];
 
-	fprintf(stdout,"#cells: %u\n",GCA->params->N);
-	fprintf(stdout,"k-neighbourhood: %u\n",GCA->params->k);
-	fprintf(stdout,"rule code: %u\n",GCA->params->rule);
-	fprintf(stdout,"rule type: %u\n",GCA->params->rule_type);
-	fprintf(stdout,"time-window: %d\n",GCA->params->WSIZE);
-	fprintf(stdout,"Configuration at t = 0\n");
+	fprintf(GCALab_Out(),"#cells: %u\n",GCA->params->N);
+	fprintf(GCALab_Out(),"k-neighbourhood: %u\n",GCA->params->k);
+	fprintf(GCALab_Out(),"rule code: %u\n",GCA->params->rule);
+	fprintf(GCALab_Out(),"rule type: %u\n",GCA->params->rule_type);
+	fprintf(GCALab_Out(),"time-window: %d\n",GCA->params->WSIZE);
+	fprintf(GCALab_Out(),"Configuration at t = 0\n");
 	for(i=0;i<GCA->params->N;i++)
 	{
-		fprintf(stdout,"%c",cellsymbols[GetCellStatePacked_external(GCA,GCA->ic,i)]);
+		fprintf(GCALab_Out(),"%c",cellsymbols[GetCellStatePacked_external(GCA,GCA->ic,i)]);
 	}
-	fprintf(stdout,"\n");
-	fprintf(stdout,"Configuration at t = %d\n",GCA->t);
+	fprintf(GCALab_Out(),"\n");
+	fprintf(GCALab_Out(),"Configuration at t = %d\n",GCA->t);
 	for(i=0;i<GCA->params->N;i++)
 	{
-		fprintf(stdout,"%c",cellsymbols[GetCellStatePacked_external(GCA,GCA->config,i)]);
+		fprintf(GCALab_Out(),"%c",cellsymbols[GetCellStatePacked_external(GCA,GCA->config,i)]);
 	}
-	fprintf(stdout,"\n");
+	fprintf(GCALab_Out(),"\n");
 
 	return GCALAB_SUCCESS;
 }
@@ -1418,9 +2036,9 @@ char GCALab_PrintSTP(unsigned char ws_id,unsigned int gca_id)
 	{
 		for (j=0;j<GCA->params->N;j++)
 		{
-			fprintf(stdout,"%c",cellsymbols[GetCellStatePacked(GCA,j,i)]);	
+			fprintf(GCALab_Out(),"%c",cellsymbols[GetCellStatePacked(GCA,j,i)]);	
 		}
-		fprintf(stdout,"\n");
+		fprintf(GCALab_Out(),"\n");
 	}
 
 	return GCALAB_SUCCESS;
@@ -1429,18 +2047,25 @@ char GCALab_PrintSTP(unsigned char ws_id,unsigned int gca_id)
 /* GCALab_PrintResults(): Prints compute results
  */
 char GCALab_PrintResults(unsigned char ws_id,unsigned int res_id)
+{
+	return GCALab_FPrintResults(GCALab_Out(),ws_id,res_id);
+}
+
+/* GCALab_FPrintResults(): Prints result data to a file
+ */
+char GCALab_FPrintResults(FILE *fp,unsigned char ws_id,unsigned int res_id)
 {
 	GCALabOutput *res;
 	int i;
-	if (res_id < 0 || res_id >= WS(ws_id)->numresults)
+	res = GCALab_GetResult(&(WS(ws_id)->results),res_id);
+	if (res == NULL)
 	{
 		return	GCALAB_INVALID_OPTION;
 	}
 	
-	res = WS(ws_id)->results[res_id];
-	fprintf(stdout,"type: %d\n",res->type);
-	fprintf(stdout,"id: %s\n",res->id);
-	fprintf(stdout,"data length: %u\n",res->datalen);
+	fprintf(fp,"type: %d\n",res->type);
+	fprintf(fp,"id: %s\n",res->id);
+	fprintf(fp,"data length: %u\n",res->datalen);
 	switch(res->type)
 	{
 		case FLOAT32:
@@ -1449,7 +2074,17 @@ char GCALab_PrintResults(unsigned char ws_id,unsigned int res_id)
 			d = (float*)res->data;
 			for (i=0;i<res->datalen;i++)
 			{
-				fprintf(stdout,"%f\n",d[i]);
+				fprintf(fp,"%f\n",d[i]);
+			}
+		}
+			break;
+		case FLOAT64:
+		{	
+			double *d;
+			d = (double*)res->data;
+			for (i=0;i<res->datalen;i++)
+			{
+				fprintf(fp,"%f\n",d[i]);
 			}
 		}
 			break;
@@ -1459,7 +2094,7 @@ char GCALab_PrintResults(unsigned char ws_id,unsigned int res_id)
 			d = (unsigned int*)res->data;
 			for (i=0;i<res->datalen;i++)
 			{
-				fprintf(stdout,"%u\n",d[i]);
+				fprintf(fp,"%u\n",d[i]);
 			}
 		}
 			break;
@@ -1469,7 +2104,7 @@ char GCALab_PrintResults(unsigned char ws_id,unsigned int res_id)
 			d = (chunk*)res->data;
 			for (i=0;i<res->datalen;i++)
 			{
-				fprintf(stdout,"%X\n",d[i]);
+				fprintf(fp,"%X\n",d[i]);
 			}
 		}
 			break;
@@ -1477,32 +2112,72 @@ char GCALab_PrintResults(unsigned char ws_id,unsigned int res_id)
 	return GCALAB_SUCCESS;
 }
 
-/* strvncpy(): makes a copy of an array of strings 
+/* GCALab_PrintProfiles(): Prints the profiles of finished commands, either as
+ *                         a table with a cell update rate summary per rule type,
+ *                         or as csv
  */
-char** strvncpy(char **strv,int c, int n)
+char GCALab_PrintProfiles(unsigned char ws_id,FILE *fp,unsigned char csv)
 {
-	char** strv_cp;
-	int i;
+	static const char *rulenames[4] = {"thresh","totalistic","code","life"};
+	GCALab_Profile *p;
+	double updates[4],cpu[4];
+	unsigned int num[4];
+	unsigned int i;
+	unsigned char r;
 
-	if(!(strv_cp = (char**)malloc(c*sizeof(char*))))
+	GCALab_LockWS(ws_id);
+	if (csv)
 	{
-		return NULL;
+		fprintf(fp,"ws,seq,op,target,rule_type,rule,N,result,wall_s,cpu_s,maxrss_bytes,steps,cell_updates,nhelim,preimages,cell_updates_per_s\n");
 	}
-
-	for (i=0;i<c;i++)
+	else
+	{
+		fprintf(fp,"#\tOp\tTarget\tRule\tN\tResult\tWall (s)\tCPU (s)\tSteps\t\tCell updates\tUpdates/s\tNhElim\tPre-images\tPeak RSS (KB)\n");
+		fprintf(fp,"---------------------------------------------------------------------------------------------------------------------------------------\n");
+	}
+	memset((void*)num,0,4*sizeof(unsigned int));
+	memset((void*)updates,0,4*sizeof(double));
+	memset((void*)cpu,0,4*sizeof(double));
+	for (i=0;i<WS(ws_id)->profiles.num;i++)
 	{
-		if(!(strv_cp[i] = (char*)malloc(n*sizeof(char))))
+		p = WS(ws_id)->profiles.profs[i];
+		r = (p->rule_type < 4) ? p->rule_type : 0;
+		if (csv)
 		{
-			return NULL;
+			fprintf(fp,"%u,%u,%s,%u,%s,%u,%u,%d,%g,%g,%llu,%llu,%llu,%llu,%llu,%g\n",ws_id,i,
+				GCALab_Ops[p->cmd_id].id,p->trgt_id,(p->N > 0) ? rulenames[r] : "",p->rule,p->N,p->res_id,
+				p->wall,1e-9*(double)(p->cpu_ns),p->maxrss,p->counters.steps,p->counters.cellupdates,
+				p->counters.nhelim,p->counters.preimages,(p->wall > 0.0) ? (double)(p->counters.cellupdates)/p->wall : 0.0);
+		}
+		else
+		{
+			fprintf(fp,"%u\t%s\t%u\t%u\t%u\t%d\t%.4f\t\t%.4f\t\t%llu\t\t%llu\t\t%.3g\t\t%llu\t%llu\t\t%llu\n",i,
+				GCALab_Ops[p->cmd_id].id,p->trgt_id,p->rule,p->N,p->res_id,p->wall,1e-9*(double)(p->cpu_ns),
+				p->counters.steps,p->counters.cellupdates,(p->wall > 0.0) ? (double)(p->counters.cellupdates)/p->wall : 0.0,
+				p->counters.nhelim,p->counters.preimages,p->maxrss/1024);
+		}
+		if (p->N > 0 && p->counters.cellupdates > 0)
+		{
+			num[r]++;
+			updates[r] += (double)(p->counters.cellupdates);
+			cpu[r] += 1e-9*(double)(p->cpu_ns);
 		}
 	}
-
-	for (i=0;i<c;i++)
+	if (!csv)
 	{
-		strncpy(strv_cp[i],strv[i],n);
+		fprintf(fp,"\nRule type\tCommands\tCell updates\tCPU (s)\t\tUpdates/CPU s\n");
+		fprintf(fp,"-------------------------------------------------------------\n");
+		for (r=0;r<4;r++)
+		{
+			if (num[r] > 0)
+			{
+				fprintf(fp,"%s\t\t%u\t\t%.0f\t\t%.4f\t\t%.3g\n",rulenames[r],num[r],updates[r],cpu[r],
+					(cpu[r] > 0.0) ? updates[r]/cpu[r] : 0.0);
+			}
+		}
 	}
-
-	return strv_cp;
+	GCALab_UnLockWS(ws_id);
+	return GCALAB_SUCCESS;
 }
 
 #ifdef WITH_GRAPHICS
@@ -1849,7 +2524,7 @@ void GCALab_Graphics_KeyPressed (unsigned char key, int x, int y)
 			break;
 		case '}':
 			/*next result*/
-			cur_res = (cur_res >= WS(cur_ws)->numresults-1) ?  WS(cur_ws)->numresults-1 : cur_res + 1;
+			cur_res = (cur_res >= WS(cur_ws)->results.num-1) ?  WS(cur_ws)->results.num-1 : cur_res + 1;
 			fprintf(stdout,"Result %d selected\n",cur_res);
 			break;
 		case '{':
@@ -2061,10 +2736,10 @@ char GCALab_CMD_NewWorkSpace(int argc, char **argv)
 	else
 	{
 		lim = atoi(argv[1]);
-		rc = GCALab_NewWorkSpace(lim);
+		rc = GCALab_NewWorkSpace(lim,(argc > 2) ? atoi(argv[2]) : 0);
 		if (rc != GCALAB_SUCCESS) return rc;
 		cur_ws = GCALab_numWS - 1;
-		printf("New Workspace created! ID = %d\n",cur_ws);
+		fprintf(GCALab_Out(),"New Workspace created! ID = %d\n",cur_ws);
 		return GCALAB_SUCCESS;
 	}
 }
@@ -2124,7 +2799,7 @@ char GCALab_CMD_ChangeWorkSpace(int argc, char **argv)
 		/*only update if the id was valid*/
 		if (rc == GCALAB_INVALID_WS_ERROR) return rc;
 		cur_ws = new_ws;
-		fprintf(stdout,"Current Workspace is ID = %d\n",cur_ws);
+		fprintf(GCALab_Out(),"Current Workspace is ID = %d\n",cur_ws);
 		return GCALAB_SUCCESS;
 	}
 }
@@ -2144,7 +2819,6 @@ char GCALab_CMD_QueueCommand(int argc, char **argv)
 		unsigned int cmd_code;
 		unsigned int target;
 		int numparams;
-		char ** params;
 		int i,s;
 		/*first get the id map for the command*/
 		s = 1;
@@ -2164,14 +2838,10 @@ char GCALab_CMD_QueueCommand(int argc, char **argv)
 			
 		/*everything else is specific to the command*/
 		numparams = argc - (s+2);
-		/*make a copy*/
-		params = strvncpy(argv+(s+2),numparams,GCALAB_MAX_STRLEN);
-		rc = GCALab_TestPointer((void*)params);
-		if (rc == GCALAB_MEM_ERROR) return rc;
 		rc = GCALab_ValidWSId(cur_ws);
 		if (rc < 0) return rc;
-		/*push it to the queue*/
-		return GCALab_QueueCommand(cur_ws,cmd_code,target,params,numparams);	
+		/*push it to the queue (it makes a copy)*/
+		return GCALab_QueueCommand(cur_ws,cmd_code,target,argv+(s+2),numparams);	
 	}
 }
 
@@ -2220,6 +2890,18 @@ char GCALab_CMD_StopQueue(int argc, char **argv)
 	return GCALab_PauseCommandQueue(cur_ws);
 }
 
+/* GCALab_CMD_PrintQueue(): GCALab command to print the command queue
+ *                          of the current workspace.
+ */
+char GCALab_CMD_PrintQueue(int argc, char **argv)
+{
+	char rc;
+	rc = GCALab_ValidWSId(cur_ws);
+	/*only continue if the id was valid*/
+	if (rc == GCALAB_INVALID_WS_ERROR) return rc;
+	return GCALab_PrintCommandQueue(cur_ws);
+}
+
 /* GCALab_CMD_PrintCA(): GCALab command to print CA summary
  */
 char GCALab_CMD_PrintCA(int argc, char **argv)
@@ -2287,6 +2969,73 @@ char GCALab_CMD_Quit(int argc, char **argv)
 	GCALab_ShutDown(GCALAB_SUCCESS);
 }
 
+/* GCALab_CMD_PrintStats(): GCALab command to print scheduler statistics
+ */
+char GCALab_CMD_PrintStats(int argc, char **argv)
+{
+	GCALab_PrintSchedulerStats(GCALab_Out());
+	return GCALAB_SUCCESS;
+}
+
+/* GCALab_CMD_Profile(): GCALab command to print the profiles of the finished
+ *                       commands in the current workspace
+ */
+char GCALab_CMD_Profile(int argc, char **argv)
+{
+	FILE *fp;
+	char rc;
+	rc = GCALab_ValidWSId(cur_ws);
+	if (rc == GCALAB_INVALID_WS_ERROR) return rc;
+	if (argc == 1)
+	{
+		return GCALab_PrintProfiles(cur_ws,GCALab_Out(),0);
+	}
+	else if (argc == 3 && !strcmp(argv[1],"-f"))
+	{
+		if (!(fp = fopen(argv[2],"w")))
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+		rc = GCALab_PrintProfiles(cur_ws,fp,1);
+		fclose(fp);
+		return rc;
+	}
+	return GCALAB_INVALID_OPTION;
+}
+
+
+/* GCALab_CMD_Snapshot(): GCALab command to write the current workspace to a
+ *                        snapshot file
+ */
+char GCALab_CMD_Snapshot(int argc, char **argv)
+{
+	char rc;
+	if (argc < 2)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	rc = GCALab_ValidWSId(cur_ws);
+	if (rc == GCALAB_INVALID_WS_ERROR) return rc;
+	return GCALab_SnapshotWS(cur_ws,argv[1],(argc > 2 && !strcmp(argv[2],"-w")));
+}
+
+/* GCALab_CMD_Restore(): GCALab command to restore a snapshot file into a new
+ *                       workspace
+ */
+char GCALab_CMD_Restore(int argc, char **argv)
+{
+	unsigned char ws_id;
+	char rc;
+	if (argc < 2)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	rc = GCALab_RestoreWS(argv[1],&ws_id);
+	if (rc != GCALAB_SUCCESS) return rc;
+	cur_ws = ws_id;
+	fprintf(GCALab_Out(),"Workspace restored! ID = %d\n",cur_ws);
+	return GCALAB_SUCCESS;
+}
 
 /*compute operations*/
 
@@ -2303,6 +3052,7 @@ char GCALab_OP_Load(unsigned char ws_id,unsigned int trgt_id,int nparams, char *
 {
 	char *filename;
 	int i;
+	char rc;
 	GraphCellularAutomaton *GCA;
 	mesh *m;
 	filename = NULL;
@@ -2318,10 +3068,22 @@ char GCALab_OP_Load(unsigned char ws_id,unsigned int trgt_id,int nparams, char *
 	m = NULL;
 	if (filename != NULL)
 	{
+		/*both the binary container and the text format are read*/
 		GCALab_fio_loadCA(filename,&GCA,&m);
 	}
+	if (GCA == NULL)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	if ((rc = GCALab_OutOfCore(GCA)) <= 0)
+	{
+		FreeGCA(GCA);
+		FreeMesh(m);
+		return rc;
+	}
 	WS(ws_id)->GCAList[WS(ws_id)->numGCA] = GCA;
 	WS(ws_id)->GCAGeometry[WS(ws_id)->numGCA] = m;
+	WS(ws_id)->GCARecorder[WS(ws_id)->numGCA] = NULL;
 	WS(ws_id)->numGCA++;
 	return GCALAB_SUCCESS;
 }
@@ -2332,12 +3094,14 @@ char GCALab_OP_Save(unsigned char ws_id,unsigned int trgt_id,int nparams, char *
 {
 	char *filename;
 	unsigned char gca_res_flag;
+	unsigned char text_flag;
 	int i;
 	GraphCellularAutomaton *GCA;
 	mesh *m;
 	GCALabOutput *data;
 	filename = NULL;
 	gca_res_flag = 0;
+	text_flag = 0;
 	for (i=0;i<nparams;i++)
 	{
 		if(!strcmp(params[i],"-f"))
@@ -2352,30 +3116,130 @@ char GCALab_OP_Save(unsigned char ws_id,unsigned int trgt_id,int nparams, char *
 		{
 			gca_res_flag = 1;
 		}
+		else if (!strcmp(params[i],"-text"))
+		{
+			text_flag = 1;
+		}
 	}
 	if (gca_res_flag)
 	{
 		GCA = WS(ws_id)->GCAList[trgt_id];
 		m = WS(ws_id)->GCAGeometry[trgt_id];
-		GCALab_fio_saveCA(filename,GCA,m);	
+		if (text_flag)
+		{
+			GCALab_fio_saveCA(filename,GCA,m);	
+		}
+		else if (GCALab_fio_saveCABin(filename,GCA,m) != WRITE_SUCCESS)
+		{
+			return GCALAB_INVALID_OPTION;
+		}
 	}
 	else
 	{
-		data = WS(ws_id)->results[trgt_id];
+		data = GCALab_GetResult(&(WS(ws_id)->results),trgt_id);
+		if (data == NULL)
+		{
+			return GCALAB_INVALID_OPTION;
+		}
 		GCALab_fio_saveData(filename,data->id,data->data,data->datalen,data->type);
 	}
 	return GCALAB_SUCCESS;
 }
 
+/* GCALab_OP_Export(): Write result data as binary arrays with a JSON description
+ */
+char GCALab_OP_Export(unsigned char ws_id,unsigned int trgt_id,int nparams, char ** params,GCALabOutput **res)
+{
+	char *prefix;
+	char *name;
+	unsigned char all_flag;
+	unsigned char raw_flag;
+	unsigned int first,last,n,j;
+	size_t len;
+	int i;
+	GCALabOutput *data;
+	GCALab_NPYArray *arrays;
+	char rc;
+	prefix = NULL;
+	all_flag = 0;
+	raw_flag = 0;
+	for (i=0;i<nparams;i++)
+	{
+		if(!strcmp(params[i],"-f"))
+		{
+			prefix = params[++i];
+		}
+		else if (!strcmp(params[i],"-all"))
+		{
+			all_flag = 1;
+		}
+		else if (!strcmp(params[i],"-raw"))
+		{
+			raw_flag = 1;
+		}
+	}
+	if (prefix == NULL)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	/*every result of the workspace, or just result i*/
+	first = (all_flag) ? 0 : trgt_id;
+	last = (all_flag) ? WS(ws_id)->results.num : trgt_id + 1;
+	if (first >= last || GCALab_GetResult(&(WS(ws_id)->results),last-1) == NULL)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	n = last - first;
+	arrays = (GCALab_NPYArray *)malloc(n*sizeof(GCALab_NPYArray));
+	/*file names of the arrays, then of the description*/
+	len = strlen(prefix) + 24;
+	name = (char *)malloc((n+1)*len);
+	if (arrays == NULL || name == NULL)
+	{
+		free(arrays);
+		free(name);
+		return GCALAB_MEM_ERROR;
+	}
+	rc = GCALAB_SUCCESS;
+	for (j=0;j<n && rc == GCALAB_SUCCESS;j++)
+	{
+		data = GCALab_GetResult(&(WS(ws_id)->results),first + j);
+		arrays[j].file = name + j*len;
+		sprintf(arrays[j].file,"%s.%u.%s",prefix,first + j,(raw_flag) ? "bin" : "npy");
+		arrays[j].name = data->id;
+		arrays[j].id = first + j;
+		arrays[j].N = data->datalen;
+		arrays[j].type = (unsigned char)data->type;
+		arrays[j].raw = raw_flag;
+		if (GCALab_fio_saveNPY(arrays[j].file,data->data,data->datalen,(unsigned char)data->type,raw_flag,&(arrays[j].offset)) != WRITE_SUCCESS)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+	}
+	/*the description goes in prefix.json*/
+	if (rc == GCALAB_SUCCESS)
+	{
+		sprintf(name + n*len,"%s.json",prefix);
+		if (GCALab_fio_saveNPYMeta(name + n*len,arrays,n) != WRITE_SUCCESS)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+	}
+	free(arrays);
+	free(name);
+	return rc;
+}
+
 /* GCALab_OP_Simulate(): direct simulation of CA evolution
  */
 char GCALab_OP_Simulate(unsigned char ws_id,unsigned int trgt_id,int nparams, char ** params,GCALabOutput **res)
 {
-	unsigned int Tfinal;
+	unsigned int Tfinal,t;
 	unsigned char reInit,ic_type;
 	int i;
 	char *ic_filename;
 	GraphCellularAutomaton *GCA;
+	GCALab_Recorder *rec;
 	reInit = 0;
 	for (i=0;i<nparams;i++)
 	{
@@ -2417,14 +3281,34 @@ char GCALab_OP_Simulate(unsigned char ws_id,unsigned int trgt_id,int nparams, ch
 		}
 	}
 	
-	GCA = WS(ws_id)->GCAList[trgt_id];
+	GCA = GCALab_GetGCA(ws_id,trgt_id);
+	rec = WS(ws_id)->GCARecorder[trgt_id];
 	if (reInit)
 	{
 		ResetCA(GCA);
 		SetCAIC(GCA,NULL,ic_type);
+		if (rec != NULL)
+		{
+			GCALab_RecordStep(rec,GCA);
+		}
 	}
 	
-	CASimTSteps(GCA,Tfinal);
+	if (rec == NULL)
+	{
+		CASimTSteps(GCA,Tfinal);
+		return GCALAB_SUCCESS;
+	}
+	/*as CASimTSteps(), but every step is recorded*/
+	if (Tfinal < GCA->t)
+	{
+		ResetCA(GCA);
+		GCALab_RecordStep(rec,GCA);
+	}
+	do
+	{
+		t = CANextStep(GCA);
+		GCALab_RecordStep(rec,GCA);
+	} while (t != Tfinal);
 	return GCALAB_SUCCESS;
 }
 
@@ -2432,19 +3316,21 @@ char GCALab_OP_Simulate(unsigned char ws_id,unsigned int trgt_id,int nparams, ch
  */
 char GCALab_OP_GCA(unsigned char ws_id,unsigned int trgt_id,int nparams, char ** params,GCALabOutput **res)
 {
-	char *meshfile;
-	unsigned int NCell,genus,windowsize,r;
+	char *meshfile,*edgefile;
+	unsigned int NCell,genus,windowsize,r,keyint;
 	unsigned char r_type,nh_type;
-	unsigned char s,k,eca,ic_type;
+	unsigned char s,k,eca,ic_type,compress;
 	int  i;
 	char rc;
 	GraphCellularAutomaton *GCA;
-	CellularAutomatonParameters *CAparams;
 	mesh *m;
 
 	windowsize = 0;
 	meshfile = NULL;
+	edgefile = NULL;
 	eca = 0;
+	compress = 0;
+	keyint = 0;
 	nh_type = DEFAULT_NEIGHBOURHOOD_TYPE;
 	for (i=0;i<nparams;i++)
 	{
@@ -2452,6 +3338,10 @@ char GCALab_OP_GCA(unsigned char ws_id,unsigned int trgt_id,int nparams, char **
 		{
 			meshfile = params[++i];
 		}
+		else if(!strcmp(params[i],"-g"))
+		{
+			edgefile = params[++i];
+		}
 		else if(!strcmp(params[i],"-t"))
 		{
 			NCell = (unsigned int)atoi(params[++i]);
@@ -2490,6 +3380,11 @@ char GCALab_OP_GCA(unsigned char ws_id,unsigned int trgt_id,int nparams, char **
 		{
 			windowsize = (unsigned int)atoi(params[++i]);
 		}
+		else if(!strcmp(params[i],"-z"))
+		{
+			keyint = (unsigned int)atoi(params[++i]);
+			compress = 1;
+		}
 		else if(!strcmp(params[i],"-eca"))
 		{
 			NCell = (unsigned int)atoi(params[++i]);
@@ -2535,6 +3430,7 @@ char GCALab_OP_GCA(unsigned char ws_id,unsigned int trgt_id,int nparams, char **
 		}
 	}
 
+	windowsize = GCALab_WindowSize(windowsize);
 	if (eca)
 	{
 		/*create an elementary CA with N cells, k-neighbourhood and wolfram code r*/
@@ -2546,30 +3442,35 @@ char GCALab_OP_GCA(unsigned char ws_id,unsigned int trgt_id,int nparams, char **
 			return rc;
 		}
 	}
+	else if (edgefile != NULL)
+	{
+		/*an imported graph has no geometry, it is parsed by as many threads as there are workers*/
+		m = NULL;
+		rc = GCALab_ImportGCA(edgefile,GCALab_NumWorkers(),s,r_type,r,windowsize,&GCA);
+		if (rc <= 0)
+		{
+			return rc;
+		}
+	}
 	else
 	{
 		if (meshfile != NULL)
 		{
 			/*this is not ideal by is ok for now*/
-			m = LoadMesh(meshfile,OFF_FORMAT);
+			m = LoadMesh(meshfile,MeshFormat(meshfile));
 		}
 		else
 		{
 			//printf("get here!\n");
-			m = CreateMeshTopology(NCell,genus);
+			m = GCALab_CreateMeshTopology(NCell,genus);
 		}
 		rc = GCALab_TestPointer((void*)m);
 		if (rc <= 0)
 		{
 			return rc;
 		}
-		CAparams = CreateCAParams(nh_type,m,s,r_type,r,windowsize);
-		rc = GCALab_TestPointer((void*)CAparams);
-		if (rc <= 0)
-		{
-			return rc;
-		}
-		GCA = CreateGCA(CAparams);
+		/*the graph comes from the topology cache if there is one*/
+		GCA = GCALab_CreateGCA(nh_type,m,s,r_type,r,windowsize);
 		rc = GCALab_TestPointer((void*)GCA);
 		if (rc <= 0)
 		{
@@ -2577,10 +3478,23 @@ char GCALab_OP_GCA(unsigned char ws_id,unsigned int trgt_id,int nparams, char **
 		}
 	}
 		
+	/*an out-of-core GCA pages its rows from a file, a compressed window then keeps the older ones in memory*/
+	if ((rc = GCALab_OutOfCore(GCA)) <= 0)
+	{
+		FreeGCA(GCA);
+		return rc;
+	}
+	/*a compressed window is only worthwhile for long windows, so keep it optional*/
+	if (compress && GCA->params->WSIZE > GCA_WINDOW_DENSE && !CompressWindow(GCA,keyint))
+	{
+		FreeGCA(GCA);
+		return GCALAB_MEM_ERROR;
+	}
 	ResetCA(GCA);
 	SetCAIC(GCA,NULL,ic_type);
 	WS(ws_id)->GCAList[WS(ws_id)->numGCA] = GCA;
 	WS(ws_id)->GCAGeometry[WS(ws_id)->numGCA] = m;
+	WS(ws_id)->GCARecorder[WS(ws_id)->numGCA] = NULL;
 	WS(ws_id)->numGCA++;
 	
 	return GCALAB_SUCCESS;
@@ -2595,7 +3509,7 @@ char GCALab_OP_Rotate(unsigned char ws_id,unsigned int trgt_id, int nparams, cha
     GraphCellularAutomaton *GCA;
     p = 0.5;
 	/*Grab a reference to the CA we want to play with*/
-	GCA = WS(ws_id)->GCAList[trgt_id];
+	GCA = GCALab_GetGCA(ws_id,trgt_id);
     for (i=0;i<nparams;i++)
     {
         if (!strcmp(params[i],"-p"))
@@ -2618,6 +3532,216 @@ char GCALab_OP_Rotate(unsigned char ws_id,unsigned int trgt_id, int nparams, cha
 	
     return GCALAB_SUCCESS;
 }
+/* GCALab_Sample_InitScratch(): allocates per-thread scratch memory for a sampled
+ * operation
+ */
+void *GCALab_Sample_InitScratch(GraphCellularAutomaton *GCA,void *args)
+{
+	GCALab_SampleArgs *a;
+	GCALab_SampleScratch *w;
+	unsigned int N,s,T;
+	a = (GCALab_SampleArgs *)args;
+	N = GCA->params->N;
+	s = (unsigned int)GCA->params->s;
+	T = a->T;
+
+	w = (GCALab_SampleScratch *)malloc(sizeof(GCALab_SampleScratch));
+	if (w == NULL)
+	{
+		return NULL;
+	}
+	memset((void*)w,0,sizeof(GCALab_SampleScratch));
+	switch(a->op)
+	{
+		case GCALAB_ENTROPY:
+			w->p = (float*)malloc(N*s*sizeof(float));
+			w->logs_p = (float*)malloc(N*s*sizeof(float));
+			w->S_i = (float*)malloc(N*sizeof(float));
+			w->flags = (unsigned char*)malloc(N*sizeof(unsigned char));
+			w->count = (unsigned int*)malloc(N*s*sizeof(unsigned int));
+			w->pt = (float*)malloc(N*T*sizeof(float));
+			w->logs_pt = (float*)malloc(N*T*sizeof(float));
+			w->countt = (unsigned int*)malloc(N*T*sizeof(unsigned int));
+			w->wl = (unsigned int*)malloc(N*sizeof(unsigned int));
+			w->Q = (unsigned int *)malloc((GCA->LUT_size)*sizeof(unsigned int));
+			w->logQ = (float *)malloc((GCA->LUT_size)*sizeof(float));
+			w->IE = (float *)malloc(T*sizeof(float));
+			if (!(w->p && w->logs_p && w->S_i && w->flags && w->count && w->pt 
+				&& w->logs_pt && w->countt && w->wl && w->Q && w->logQ && w->IE))
+			{
+				GCALab_Sample_Reduce((void*)w,NULL);
+				return NULL;
+			}
+			break;
+		case GCALAB_STATE_FREQUENCIES:
+			w->count = (unsigned int*)malloc(N*s*sizeof(unsigned int));
+			w->freqs = (unsigned int*)malloc(N*s*sizeof(unsigned int));
+			if (!(w->count && w->freqs))
+			{
+				GCALab_Sample_Reduce((void*)w,NULL);
+				return NULL;
+			}
+			memset((void*)(w->freqs),0,N*s*sizeof(unsigned int));
+			break;
+		case GCALAB_POP_DENSITY:
+			w->dense = (float*)malloc(T*sizeof(float));
+			if (!(w->dense))
+			{
+				GCALab_Sample_Reduce((void*)w,NULL);
+				return NULL;
+			}
+			break;
+	}
+	return (void*)w;
+}
+
+/* GCALab_Sample_Reduce(): merges per-thread state frequencies and frees scratch memory
+ */
+void GCALab_Sample_Reduce(void *scratch,void *args)
+{
+	GCALab_SampleArgs *a;
+	GCALab_SampleScratch *w;
+	unsigned int i;
+	a = (GCALab_SampleArgs *)args;
+	w = (GCALab_SampleScratch *)scratch;
+
+	if (a != NULL && a->freqs != NULL && w->freqs != NULL)
+	{
+		for (i=0;i<a->nfreqs;i++)
+		{
+			a->freqs[i] += w->freqs[i];
+		}
+	}
+	free(w->p);
+	free(w->logs_p);
+	free(w->S_i);
+	free(w->pt);
+	free(w->logs_pt);
+	free(w->logQ);
+	free(w->IE);
+	free(w->dense);
+	free(w->flags);
+	free(w->count);
+	free(w->countt);
+	free(w->wl);
+	free(w->Q);
+	free(w->freqs);
+	free(w);
+}
+
+/* GCALab_Sample_Entropy(): entropy measures of a single sample
+ */
+void GCALab_Sample_Entropy(GraphCellularAutomaton *GCA,void *scratch,void *args,double *vals)
+{
+	GCALab_SampleArgs *a;
+	GCALab_SampleScratch *w;
+	float I_mu,I_sigma;
+	unsigned int i;
+	a = (GCALab_SampleArgs *)args;
+	w = (GCALab_SampleScratch *)scratch;
+
+	switch(a->type)
+	{
+		case GCALAB_SHANNON_ENTROPY:
+			vals[0] = ShannonEntropy(GCA,a->T,w->p,w->logs_p,w->S_i,w->flags,w->count);
+			break;
+		case GCALAB_WORD_ENTROPY:
+			vals[0] = WordEntropy(GCA,a->T,w->pt,w->logs_pt,w->S_i,w->flags,w->countt,w->wl);
+			break;
+		case GCALAB_ALL_ENTROPY:
+			/*both measures are taken from the same initial condition*/
+			vals[0] = ShannonEntropy(GCA,a->T,w->p,w->logs_p,w->S_i,w->flags,w->count);
+			ResetCA(GCA);
+			vals[1] = WordEntropy(GCA,a->T,w->pt,w->logs_pt,w->S_i,w->flags,w->countt,w->wl);
+			break;
+		case GCALAB_INPUT_ENTROPY:
+			InputEntropy(GCA,a->T,&I_mu,&I_sigma,w->Q,w->logQ,w->IE);
+			vals[0] = I_mu;
+			vals[1] = I_sigma;
+			for (i=0;i<a->T;i++)
+			{
+				vals[i+2] = w->IE[i];
+			}
+			break;
+	}
+}
+
+/* GCALab_Sample_Param(): Garden-of-Eden, cycle and transient measures of a single sample
+ */
+void GCALab_Sample_Param(GraphCellularAutomaton *GCA,void *scratch,void *args,double *vals)
+{
+	GCALab_SampleArgs *a;
+	unsigned int length;
+	a = (GCALab_SampleArgs *)args;
+
+	switch(a->type)
+	{
+		case GCALAB_G_PARAM:
+			vals[0] = (double)IsGOE(GCA);
+			break;
+		case GCALAB_C_PARAM:
+			length = CASimToAttLength(GCA,a->T);
+			vals[0] = (double)length;
+			vals[1] = (double)(length != 0);
+			break;
+		case GCALAB_T_PARAM:
+			length = CASimToAttLength(GCA,a->T);
+			/*test that we did not start within an attractor cycle*/
+			vals[0] = (GCA->t >= length) ? (double)(GCA->t + 1 - length) : 0.0;
+			vals[1] = (double)(GCA->t >= length);
+			break;
+		case GCALAB_ALL_PARAM:
+			/*all measures from the same initial condition, one simulation for C and T*/
+			vals[0] = (double)IsGOE(GCA);
+			length = CASimToAttLength(GCA,a->T);
+			vals[1] = (double)length;
+			vals[2] = (double)(length != 0);
+			vals[3] = (GCA->t >= length) ? (double)(GCA->t + 1 - length) : 0.0;
+			vals[4] = (double)(GCA->t >= length);
+			break;
+	}
+}
+
+/* GCALab_Sample_Freq(): accumulates state frequencies of a single sample
+ */
+void GCALab_Sample_Freq(GraphCellularAutomaton *GCA,void *scratch,void *args,double *vals)
+{
+	GCALab_SampleArgs *a;
+	GCALab_SampleScratch *w;
+	unsigned int i,n;
+	a = (GCALab_SampleArgs *)args;
+	w = (GCALab_SampleScratch *)scratch;
+
+	/*exhaustive counts only consider Garden-of-Eden configurations*/
+	if (a->goe_only && !IsGOE(GCA))
+	{
+		return;
+	}
+	SumCAImages(GCA,w->count,GCA->ic,1);
+	n = (GCA->params->N)*((unsigned int)GCA->params->s);
+	for (i=0;i<n;i++)
+	{
+		w->freqs[i] += w->count[i];
+	}
+}
+
+/* GCALab_Sample_Pop(): population density over time of a single sample
+ */
+void GCALab_Sample_Pop(GraphCellularAutomaton *GCA,void *scratch,void *args,double *vals)
+{
+	GCALab_SampleArgs *a;
+	GCALab_SampleScratch *w;
+	unsigned int t;
+	a = (GCALab_SampleArgs *)args;
+	w = (GCALab_SampleScratch *)scratch;
+
+	PopDensity(GCA,GCA->ic,a->T,w->dense);
+	for (t=0;t<a->T;t++)
+	{
+		vals[t] = w->dense[t];
+	}
+}
+
 /* GCALab_OP_Entropy(): compute entropy meansures on a given CA
  */
 char GCALab_OP_Entropy(unsigned char ws_id,unsigned int trgt_id,int nparams, char ** params,GCALabOutput **res)
@@ -2625,19 +3749,25 @@ char GCALab_OP_Entropy(unsigned char ws_id,unsigned int trgt_id,int nparams, cha
 	unsigned int numSamples;
 	unsigned int T;
 	unsigned type;
-    unsigned int rotate;
-	int i,j;
+	unsigned int rotate;
+	unsigned int nthreads;
+	unsigned long long seed;
+	double tol,conf;
+	int i;
 	char rc;
+	char *part;
 	GraphCellularAutomaton *GCA;
-	
-	float *p,*logs_p, *S_i,*pt,*logs_pt,*IE,*logQ;
-	unsigned char *flags;
-	unsigned int *count,*countt,*wl,*Q;
-	
-	float S_mu,W_mu,I_mu,I_sigma;
+	GCALab_Sampler smp;
+	GCALab_SampleArgs args;
 	float *result_data;
-	numSamples = 1;
-    rotate = 0;
+	numSamples = 0;
+	part = NULL;
+	tol = 0.0;
+	conf = GCALAB_DEFAULT_CONF;
+	rotate = 0;
+	nthreads = GCALAB_DEFAULT_THREADS;
+	seed = GCALAB_DEFAULT_SEED;
+	T = 0;
 	type = GCALAB_SHANNON_ENTROPY;
 	for (i=0;i<nparams;i++)
 	{
@@ -2649,10 +3779,30 @@ char GCALab_OP_Entropy(unsigned char ws_id,unsigned int trgt_id,int nparams, cha
 		{
 			T = (unsigned int)atoi(params[++i]);
 		}
-        else if (!strcmp(params[i],"-p"))
-        {
-            rotate = 1;
-        }
+		else if (!strcmp(params[i],"-p"))
+		{
+			rotate = 1;
+		}
+		else if (!strcmp(params[i],"-j"))
+		{
+			nthreads = (unsigned int)atoi(params[++i]);
+		}
+		else if (!strcmp(params[i],"-seed"))
+		{
+			seed = strtoull(params[++i],NULL,10);
+		}
+		else if (!strcmp(params[i],"-tol"))
+		{
+			tol = atof(params[++i]);
+		}
+		else if (!strcmp(params[i],"-conf"))
+		{
+			conf = atof(params[++i]);
+		}
+		else if (!strcmp(params[i],"-part"))
+		{
+			part = params[++i];
+		}
 		else if(!strcmp(params[i],"-e"))
 		{
 			char * typestr = params[++i];
@@ -2680,383 +3830,187 @@ char GCALab_OP_Entropy(unsigned char ws_id,unsigned int trgt_id,int nparams, cha
 	}
 
 	/*Grab a reference to the CA we want to play with*/
-	GCA = WS(ws_id)->GCAList[trgt_id];
+	GCA = GCALab_GetGCA(ws_id,trgt_id);
+	
+	args.op = GCALAB_ENTROPY;
+	args.T = T;
+	args.type = type;
+	args.goe_only = 0;
+	args.freqs = NULL;
+	args.nfreqs = 0;
+	GCALab_InitSampler(&smp,GCA,0);
+	smp.nthreads = nthreads;
+	smp.seed = seed;
+	smp.rotate = rotate;
+	smp.init = &GCALab_Sample_InitScratch;
+	smp.sample = &GCALab_Sample_Entropy;
+	smp.reduce = &GCALab_Sample_Reduce;
+	smp.args = (void*)&args;
+	smp.ckpt_tag = ((unsigned long long)type << 32) | T;
+	if (tol > 0.0)
+	{
+		/*-n is now an upper bound on samples*/
+		rc = GCALab_SetSamplerTolerance(&smp,tol,conf);
+		if (rc <= 0)
+		{
+			return rc;
+		}
+		numSamples = (numSamples) ? numSamples : GCALAB_SAMPLER_MAX_SAMPLES;
+	}
+	numSamples = (numSamples) ? numSamples : 1;
+
 	(*res) = (GCALabOutput*)malloc(sizeof(GCALabOutput)); 
+	rc = GCALab_TestPointer((void*)(*res));
+	if (rc <= 0)
+	{
+		return rc;
+	}
+	/*all sampler runs of the operation share the part files*/
+	rc = GCALab_OpenShard(&(smp.shard),part);
+	if (rc <= 0)
+	{
+		free(*res);
+		(*res) = NULL;
+		return rc;
+	}
+	(*res)->type = FLOAT32;
 	switch(type)
 	{
 		case GCALAB_SHANNON_ENTROPY:
-			/*allocate memory first reduce malloc calls*/
-			p = (float*)malloc((GCA->params->N)*((unsigned int)GCA->params->s)*sizeof(float));
-			logs_p = (float*)malloc((GCA->params->N)*((unsigned int)GCA->params->s)*sizeof(float));
-			S_i = (float*)malloc((GCA->params->N)*sizeof(float));
-			flags = (unsigned char*)malloc((GCA->params->N)*sizeof(unsigned char));
-			count = (unsigned int*)malloc((GCA->params->N)*((unsigned int)GCA->params->s)*sizeof(unsigned int));
-
-			rc = GCALab_TestPointer((void*)p);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)logs_p);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)S_i);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)flags);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)count);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			
-			/*compute avg Shannon entropy*/
-			S_mu = 0.0;
-            if (rotate)
-            {
-                for (i=0;i<numSamples;i++)
-                {
-                    for (j=0;j<GCA->params->N;j++)
-                    {
-                        RotateNeighbourhood(GCA,j,rand());
-                    }
-			    	ResetCA(GCA);
-			    	SetCAIC(GCA,NULL,NOISE_IC_TYPE);
-			    	S_mu += ShannonEntropy(GCA,T,p,logs_p,S_i,flags,count);
-            
-                }
-            }
-            else
-            {
-		        for (i=0;i<numSamples;i++)
-			    {
-			    	ResetCA(GCA);
-			    	SetCAIC(GCA,NULL,NOISE_IC_TYPE);
-			    	S_mu += ShannonEntropy(GCA,T,p,logs_p,S_i,flags,count);
-			    }
-            }
-			S_mu = S_mu/((float)numSamples);
-			/*store outputs*/
-			(*res)->type = FLOAT32;
-			sprintf((*res)->id,"(%d):S",trgt_id);
-			(*res)->datalen = 1;
-			result_data = (float*)malloc(sizeof(float));
-			result_data[0] = S_mu;
-			(*res)->data = (void*)result_data;
-
-			/*clean up*/	
-			free(p);
-			free(logs_p);
-			free(S_i);
-			free(flags);
-			free(count);
-			break;
 		case GCALAB_WORD_ENTROPY:
-			/*allocate memory first reduce malloc calls*/
-			pt = (float*)malloc((GCA->params->N)*T*sizeof(float));
-			logs_pt = (float*)malloc((GCA->params->N)*T*sizeof(float));
-			S_i = (float*)malloc((GCA->params->N)*sizeof(float));
-			flags = (unsigned char*)malloc((GCA->params->N)*sizeof(unsigned char));
-			countt = (unsigned int*)malloc((GCA->params->N)*T*sizeof(unsigned int));
-			wl = (unsigned int*)malloc((GCA->params->N)*sizeof(unsigned int));
-			rc = GCALab_TestPointer((void*)pt);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)logs_pt);
-			if (rc <= 0)
+			/*compute avg Shannon or word entropy*/
+			smp.n = numSamples;
+			smp.nvals = 1;
+			if (tol > 0.0)
 			{
-				return rc;
+				GCALab_SamplerMonitor(&smp,0,-1);
 			}
-			rc = GCALab_TestPointer((void*)S_i);
+			rc = GCALab_RunSampler(&smp);
 			if (rc <= 0)
 			{
+				GCALab_CloseShard(smp.shard);
+				free(*res);
+				(*res) = NULL;
 				return rc;
 			}
-			rc = GCALab_TestPointer((void*)flags);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)countt);
+			sprintf((*res)->id,(type == GCALAB_SHANNON_ENTROPY) ? "(%d):S" : "(%d):W",trgt_id);
+			/*with a tolerance the CI and samples used are also returned*/
+			(*res)->datalen = (tol > 0.0) ? 3 : 1;
+			result_data = (float*)malloc(((*res)->datalen)*sizeof(float));
+			rc = GCALab_TestPointer((void*)result_data);
 			if (rc <= 0)
 			{
+				free(smp.sums);
+				GCALab_CloseShard(smp.shard);
+				free(*res);
+				(*res) = NULL;
 				return rc;
 			}
-			rc = GCALab_TestPointer((void*)wl);
-			if (rc <= 0)
+			result_data[0] = (smp.n_used) ? (float)(smp.sums[0]/((double)smp.n_used)) : 0.0;
+			if (tol > 0.0)
 			{
-				return rc;
+				result_data[1] = (float)(smp.stat_ci[0]);
+				result_data[2] = (float)(smp.n_used);
 			}
-
-			/*compute avg word entropy*/
-			W_mu = 0.0;
-            if (rotate)
-            {
-			    for (i=0;i<numSamples;i++)
-			    {
-                    for (j=0;j<GCA->params->N;j++)
-                    {
-                        RotateNeighbourhood(GCA,j,rand());
-                    }
-			    	ResetCA(GCA);
-			    	SetCAIC(GCA,NULL,NOISE_IC_TYPE);
-			        W_mu += WordEntropy(GCA,T,pt,logs_pt,S_i,flags,countt,wl);
-			    }
-            }
-            else
-            {
-			    for (i=0;i<numSamples;i++)
-			    {
-			    	ResetCA(GCA);
-			    	SetCAIC(GCA,NULL,NOISE_IC_TYPE);
-			        W_mu += WordEntropy(GCA,T,pt,logs_pt,S_i,flags,countt,wl);
-			    }
-            }
-
-			W_mu = W_mu/((float)numSamples);
-				
-			/*store outputs*/
-			(*res)->type = FLOAT32;
-			sprintf((*res)->id,"(%d):W",trgt_id);
-			(*res)->datalen = 1;
-			result_data = (float*)malloc(sizeof(float));
-			result_data[0] = W_mu;
 			(*res)->data = (void*)result_data;
-			/*clean up*/	
-			free(pt);
-			free(logs_pt);
-			free(S_i);
-			free(flags);
-			free(countt);
-			free(wl);
+			free(smp.sums);
 			break;
 		case GCALAB_INPUT_ENTROPY:
-			/*allocate memory first reduce malloc calls*/
-			Q =  (unsigned int *)malloc((GCA->LUT_size)*sizeof(unsigned int));
-			logQ = (float *)malloc((GCA->LUT_size)*sizeof(float));
-			IE = (float *) malloc(T*sizeof(unsigned int));
-
-			rc = GCALab_TestPointer((void*)Q);
+			/*compute avg and varience of I for a single initial condition*/
+			smp.n = 1;
+			smp.nvals = T+2;
+			rc = GCALab_RunSampler(&smp);
 			if (rc <= 0)
 			{
+				GCALab_CloseShard(smp.shard);
+				free(*res);
+				(*res) = NULL;
 				return rc;
 			}
-			rc = GCALab_TestPointer((void*)logQ);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)IE);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-
-			/*compute avg and varience of I*/
-            if (rotate)
-            {
-                for (j=0;j<GCA->params->N;j++)
-                {
-                    RotateNeighbourhood(GCA,j,rand());
-                }
-			}
-            ResetCA(GCA);
-			SetCAIC(GCA,NULL,NOISE_IC_TYPE);
-			InputEntropy(GCA,T,&I_mu,&I_sigma,Q,logQ,IE);	
-			/*store outputs*/
-			(*res)->type = FLOAT32;
 			sprintf((*res)->id,"(%d):I",trgt_id);
 			(*res)->datalen = T+2;
 			result_data = (float*)malloc((T+2)*sizeof(float));
-			result_data[0] = I_mu;
-			result_data[1] = I_sigma;
-			for (i=0;i<T;i++)
-			{
-				result_data[i+2] = IE[i];
-			}
-			(*res)->data = (void*)result_data;
-			/*clean up*/	
-			free(Q);
-			free(logQ);
-			free(IE);
-			break;
-		case GCALAB_ALL_ENTROPY:
-			/*allocate memory first reduce malloc calls*/
-			p = (float*)malloc((GCA->params->N)*((unsigned int)GCA->params->s)*sizeof(float));
-			logs_p = (float*)malloc((GCA->params->N)*((unsigned int)GCA->params->s)*sizeof(float));
-			S_i = (float*)malloc((GCA->params->N)*sizeof(float));
-			flags = (unsigned char*)malloc((GCA->params->N)*sizeof(unsigned char));
-			count = (unsigned int*)malloc((GCA->params->N)*((unsigned int)GCA->params->s)*sizeof(unsigned int));
-			pt = (float*)malloc((GCA->params->N)*T*sizeof(float));
-			logs_pt = (float*)malloc((GCA->params->N)*T*sizeof(float));
-			countt = (unsigned int*)malloc((GCA->params->N)*T*sizeof(unsigned int));
-			wl = (unsigned int*)malloc((GCA->params->N)*sizeof(unsigned int));
-			Q =  (unsigned int *)malloc((GCA->LUT_size)*sizeof(unsigned int));
-			logQ = (float *)malloc((GCA->LUT_size)*sizeof(float));
-			IE = (float *) malloc(T*sizeof(unsigned int));
-			rc = GCALab_TestPointer((void*)p);
+			rc = GCALab_TestPointer((void*)result_data);
 			if (rc <= 0)
 			{
+				free(smp.sums);
+				GCALab_CloseShard(smp.shard);
+				free(*res);
+				(*res) = NULL;
 				return rc;
 			}
-			rc = GCALab_TestPointer((void*)logs_p);
-			if (rc <= 0)
+			for (i=0;i<T+2;i++)
 			{
-				return rc;
+				result_data[i] = (float)(smp.sums[i]);
 			}
-			rc = GCALab_TestPointer((void*)S_i);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)flags);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)count);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)pt);
+			(*res)->data = (void*)result_data;
+			free(smp.sums);
+			break;
+		case GCALAB_ALL_ENTROPY:
+			(*res)->datalen = (tol > 0.0) ? T+7 : T+4;
+			result_data = (float*)malloc(((*res)->datalen)*sizeof(float));
+			rc = GCALab_TestPointer((void*)result_data);
 			if (rc <= 0)
 			{
+				GCALab_CloseShard(smp.shard);
+				free(*res);
+				(*res) = NULL;
 				return rc;
 			}
-			rc = GCALab_TestPointer((void*)logs_pt);
-			if (rc <= 0)
+			/*compute avg Shannon and word entropy*/
+			smp.n = numSamples;
+			smp.nvals = 2;
+			if (tol > 0.0)
 			{
-				return rc;
+				GCALab_SamplerMonitor(&smp,0,-1);
+				GCALab_SamplerMonitor(&smp,1,-1);
 			}
-			rc = GCALab_TestPointer((void*)countt);
+			rc = GCALab_RunSampler(&smp);
 			if (rc <= 0)
 			{
+				GCALab_CloseShard(smp.shard);
+				free(result_data);
+				free(*res);
+				(*res) = NULL;
 				return rc;
 			}
-			rc = GCALab_TestPointer((void*)wl);
-			if (rc <= 0)
+			result_data[0] = (smp.n_used) ? (float)(smp.sums[0]/((double)smp.n_used)) : 0.0;
+			result_data[1] = (smp.n_used) ? (float)(smp.sums[1]/((double)smp.n_used)) : 0.0;
+			if (tol > 0.0)
 			{
-				return rc;
+				result_data[T+4] = (float)(smp.stat_ci[0]);
+				result_data[T+5] = (float)(smp.stat_ci[1]);
+				result_data[T+6] = (float)(smp.n_used);
 			}
-			rc = GCALab_TestPointer((void*)Q);
-			if (rc <= 0)
-			{
-				return rc;
-			}
-			rc = GCALab_TestPointer((void*)logQ);
+			free(smp.sums);
+			
+			/*input entropy is a single sample*/
+			smp.tol = 0.0;
+			smp.nstats = 0;
+			/*compute avg and varience of I*/
+			args.type = GCALAB_INPUT_ENTROPY;
+			smp.n = 1;
+			smp.nvals = T+2;
+			rc = GCALab_RunSampler(&smp);
 			if (rc <= 0)
 			{
+				GCALab_CloseShard(smp.shard);
+				free(result_data);
+				free(*res);
+				(*res) = NULL;
 				return rc;
 			}
-			rc = GCALab_TestPointer((void*)IE);
-			if (rc <= 0)
+			for (i=0;i<T+2;i++)
 			{
-				return rc;
+				result_data[i+2] = (float)(smp.sums[i]);
 			}
-			
-			/*compute avg Shannon entropy*/
-			S_mu = 0.0;
-            if (rotate)
-            {
-                for (i=0;i<numSamples;i++)
-                {
-                    for (j=0;j<GCA->params->N;j++)
-                    {
-                        RotateNeighbourhood(GCA,j,rand());
-                    }
-			    	ResetCA(GCA);
-			    	SetCAIC(GCA,NULL,NOISE_IC_TYPE);
-			    	S_mu += ShannonEntropy(GCA,T,p,logs_p,S_i,flags,count);
-            
-                }
-            }
-            else
-            {
-		        for (i=0;i<numSamples;i++)
-			    {
-			    	ResetCA(GCA);
-			    	SetCAIC(GCA,NULL,NOISE_IC_TYPE);
-			    	S_mu += ShannonEntropy(GCA,T,p,logs_p,S_i,flags,count);
-			    }
-            }
-			S_mu = S_mu/((float)numSamples);
-					
-			/*compute avg word entropy*/
-            if (rotate)
-            {
-			    for (i=0;i<numSamples;i++)
-			    {
-                    for (j=0;j<GCA->params->N;j++)
-                    {
-                        RotateNeighbourhood(GCA,j,rand());
-                    }
-			    	ResetCA(GCA);
-			    	SetCAIC(GCA,NULL,NOISE_IC_TYPE);
-			        W_mu += WordEntropy(GCA,T,pt,logs_pt,S_i,flags,countt,wl);
-			    }
-            }
-            else
-            {
-			    for (i=0;i<numSamples;i++)
-			    {
-			    	ResetCA(GCA);
-			    	SetCAIC(GCA,NULL,NOISE_IC_TYPE);
-			        W_mu += WordEntropy(GCA,T,pt,logs_pt,S_i,flags,countt,wl);
-			    }
-            }
-			W_mu = W_mu/((float)numSamples);
-					
-			/*compute avg and varience of I*/
-            if (rotate)
-            {
-                for (j=0;j<GCA->params->N;j++)
-                {
-                    RotateNeighbourhood(GCA,j,rand());
-                }
-			}
-            ResetCA(GCA);
-			SetCAIC(GCA,NULL,NOISE_IC_TYPE);
-			InputEntropy(GCA,T,&I_mu,&I_sigma,Q,logQ,IE);	
+			free(smp.sums);
 			/*store outputs*/
-			(*res)->type = FLOAT32;
 			sprintf((*res)->id,"(%d):A",trgt_id);
-			(*res)->datalen = T+4;
-			result_data = (float*)malloc((T+4)*sizeof(float));
-			result_data[0] = S_mu;
-			result_data[1] = W_mu;
-			result_data[2] = I_mu;
-			result_data[3] = I_sigma;
-			for (i=0;i<T;i++)
-			{
-				result_data[i+4] = IE[i];
-			}
 			(*res)->data = (void*)result_data;
-			/*clean up*/	
-			free(p);
-			free(logs_p);
-			free(S_i);
-			free(flags);
-			free(count);
-			free(pt);
-			free(logs_pt);
-			free(countt);
-			free(wl);
-			free(Q);
-			free(logQ);
-			free(IE);
 			break;
 	}
+	GCALab_CloseShard(smp.shard);
 
 	return GCALAB_SUCCESS;
 }
@@ -3069,10 +4023,29 @@ char GCALab_OP_Param(unsigned char ws_id,unsigned int trgt_id,int nparams, char
 	chunk range[2];
 	float lambdap,Zp,Gp,Cp,Tp;
 	int i;
+	char rc;
 	unsigned int samples,maxT;
+	unsigned int nthreads;
+	unsigned long long seed;
+	double tol,conf;
+	float *result_data;
+	char *ckpt;
+	char *part;
+	unsigned char memo,sampled;
 	GraphCellularAutomaton *GCA;
+	GCALab_Sampler smp;
+	GCALab_SampleArgs args;
 	samples = 0;
 	maxT = 1200;
+	nthreads = GCALAB_DEFAULT_THREADS;
+	seed = GCALAB_DEFAULT_SEED;
+	tol = 0.0;
+	conf = GCALAB_DEFAULT_CONF;
+	type = GCALAB_ALL_PARAM;
+	range[0] = 0;
+	range[1] = 0;
+	ckpt = NULL;
+	part = NULL;
 	for (i=0;i<nparams;i++)
 	{
 		if (!strcmp(params[i],"-p"))
@@ -3120,17 +4093,142 @@ char GCALab_OP_Param(unsigned char ws_id,unsigned int trgt_id,int nparams, char
 		{
 			maxT = (unsigned int)atoi(params[++i]);
 		}
+		else if (!strcmp(params[i],"-j"))
+		{
+			nthreads = (unsigned int)atoi(params[++i]);
+		}
+		else if (!strcmp(params[i],"-seed"))
+		{
+			seed = strtoull(params[++i],NULL,10);
+		}
+		else if (!strcmp(params[i],"-tol"))
+		{
+			tol = atof(params[++i]);
+		}
+		else if (!strcmp(params[i],"-conf"))
+		{
+			conf = atof(params[++i]);
+		}
+		else if (!strcmp(params[i],"-ckpt"))
+		{
+			ckpt = params[++i];
+		}
+		else if (!strcmp(params[i],"-part"))
+		{
+			part = params[++i];
+		}
 	}
 
 	/*Grab a reference to the CA we want to play with*/
-	GCA = WS(ws_id)->GCAList[trgt_id];
+	GCA = GCALab_GetGCA(ws_id,trgt_id);
 	(*res) = (GCALabOutput*)malloc(sizeof(GCALabOutput)); 
+	rc = GCALab_TestPointer((void*)(*res));
+	if (rc <= 0)
+	{
+		return rc;
+	}
+
+	/*exhaustive cycle and transient lengths come from one memoised pass over the range,
+	 * unless they are to be checkpointed or sharded*/
+	memo = 0;
+	if (samples == 0 && tol <= 0.0 && ckpt == NULL && part == NULL && GCA->size == 1 && type >= GCALAB_C_PARAM)
+	{
+		GraphCellularAutomaton *GCA_memo;
+		GCA_memo = CloneGCA(GCA);
+		if (GCA_memo != NULL)
+		{
+			memo = AttTransLength(GCA_memo,range,maxT,&Cp,&Tp);
+			FreeGCA(GCA_memo);
+		}
+	}
+
+	/*G is always sampled, C and T only if they were not memoised*/
+	sampled = (type == GCALAB_G_PARAM || type == GCALAB_ALL_PARAM || (type >= GCALAB_C_PARAM && !memo));
+
+	/*the sampled parameters all share the same sampling set up*/
+	if (sampled)
+	{
+		args.op = GCALAB_PARAM;
+		args.T = maxT;
+		/*only G is left to sample if C and T are memoised*/
+		args.type = (memo) ? GCALAB_G_PARAM : type;
+		args.goe_only = 0;
+		args.freqs = NULL;
+		args.nfreqs = 0;
+		GCALab_InitSampler(&smp,GCA,(args.type == GCALAB_G_PARAM) ? 1 : ((args.type == GCALAB_ALL_PARAM) ? 5 : 2));
+		smp.nthreads = nthreads;
+		smp.seed = seed;
+		smp.sample = &GCALab_Sample_Param;
+		smp.args = (void*)&args;
+		smp.ckpt = ckpt;
+		smp.ckpt_tag = ((unsigned long long)args.type << 32) | maxT;
+		if (tol > 0.0)
+		{
+			/*stopping early only makes sense for random samples*/
+			if (samples == 0 && range[1] > range[0])
+			{
+				free(*res);
+				(*res) = NULL;
+				return GCALAB_INVALID_OPTION;
+			}
+			rc = GCALab_SetSamplerTolerance(&smp,tol,conf);
+			if (rc <= 0)
+			{
+				free(*res);
+				(*res) = NULL;
+				return rc;
+			}
+			samples = (samples) ? samples : GCALAB_SAMPLER_MAX_SAMPLES;
+			/*G, C and T estimates, C and T only count samples that found a cycle*/
+			switch(type)
+			{
+				case GCALAB_G_PARAM:
+					GCALab_SamplerMonitor(&smp,0,-1);
+					break;
+				case GCALAB_C_PARAM:
+				case GCALAB_T_PARAM:
+					GCALab_SamplerMonitor(&smp,0,1);
+					break;
+				case GCALAB_ALL_PARAM:
+					GCALab_SamplerMonitor(&smp,0,-1);
+					GCALab_SamplerMonitor(&smp,1,2);
+					GCALab_SamplerMonitor(&smp,3,4);
+					break;
+			}
+		}
+		if (samples > 0)
+		{
+			smp.n = samples;
+		}
+		else
+		{
+			rc = GCALab_SetSamplerRange(&smp,range,1);
+			if (rc <= 0)
+			{
+				free(*res);
+				(*res) = NULL;
+				return rc;
+			}
+		}
+		rc = GCALab_OpenShard(&(smp.shard),part);
+		if (rc > 0)
+		{
+			rc = GCALab_RunSampler(&smp);
+		}
+		GCALab_CloseShard(smp.shard);
+		if (rc <= 0)
+		{
+			/*e.g., the checkpoint or part files are of another job*/
+			free(*res);
+			(*res) = NULL;
+			return rc;
+		}
+	}
 			
 	switch(type)
 	{
 		case GCALAB_LAMBDA_PARAM:
 		{
-			float *result_data;
 			/*compute Langton's lambda parameter*/
 			lambdap = lambda_param(GCA);
 			/*store outputs*/
@@ -3138,13 +4236,17 @@ char GCALab_OP_Param(unsigned char ws_id,unsigned int trgt_id,int nparams, char
 			sprintf((*res)->id,"(%d):L",trgt_id);
 			(*res)->datalen = 1;
 			result_data = (float*)malloc(sizeof(float));
+			rc = GCALab_TestPointer((void*)result_data);
+			if (rc <= 0)
+			{
+				break;
+			}
 			result_data[0] = lambdap;
 			(*res)->data = (void*)result_data;
 		}	
 			break;
 		case GCALAB_Z_PARAM:
 		{
-			float *result_data;
 			/*compute Wuensche's Z parameter*/
 			Zp = Z_param(GCA);
 			/*store outputs*/
@@ -3152,103 +4254,135 @@ char GCALab_OP_Param(unsigned char ws_id,unsigned int trgt_id,int nparams, char
 			sprintf((*res)->id,"(%d):Z",trgt_id);
 			(*res)->datalen = 1;
 			result_data = (float*)malloc(sizeof(float));
+			rc = GCALab_TestPointer((void*)result_data);
+			if (rc <= 0)
+			{
+				break;
+			}
 			result_data[0] = Zp;
 			(*res)->data = (void*)result_data;
 		}
 			break;
 		case GCALAB_G_PARAM:
 		{
-			float *result_data;
-			/*compute the density of Garden-of-Eden configurations*/
-			if (samples > 0)
-			{
-				Gp = G_density(GCA,NULL,samples);
-			}
-			else
-			{
-				Gp = G_density(GCA,range,0);
-			}
+			/*the density of Garden-of-Eden configurations*/
+			Gp = (smp.n_used) ? (float)(smp.sums[0]/((double)smp.n_used)) : 0.0;
 			/*store outputs*/
 			(*res)->type = FLOAT32;
 			sprintf((*res)->id,"(%d):G",trgt_id);
-			(*res)->datalen = 1;
-			result_data = (float*)malloc(sizeof(float));
+			(*res)->datalen = (tol > 0.0) ? 3 : 1;
+			result_data = (float*)malloc(((*res)->datalen)*sizeof(float));
+			rc = GCALab_TestPointer((void*)result_data);
+			if (rc <= 0)
+			{
+				break;
+			}
 			result_data[0] = Gp;
+			if (tol > 0.0)
+			{
+				result_data[1] = (float)(smp.stat_ci[0]);
+				result_data[2] = (float)(smp.n_used);
+			}
 			(*res)->data = (void*)result_data;
 		}
 			break;
 		case GCALAB_C_PARAM:
 		{
-			float *result_data;
-			/*compute the average attractor cycle length*/
-			if (samples > 0)
-			{
-				Cp = AttLength(GCA,NULL,samples,maxT);
-			}
-			else
+			/*the average attractor cycle length*/
+			if (!memo)
 			{
-				Cp = AttLength(GCA,range,0,maxT);
+				Cp = (smp.sums[1] > 0) ? (float)(smp.sums[0]/smp.sums[1]) : 0.0;
 			}
 			/*store outputs*/
 			(*res)->type = FLOAT32;
 			sprintf((*res)->id,"(%d):C",trgt_id);
-			(*res)->datalen = 1;
-			result_data = (float*)malloc(sizeof(float));
+			(*res)->datalen = (tol > 0.0) ? 3 : 1;
+			result_data = (float*)malloc(((*res)->datalen)*sizeof(float));
+			rc = GCALab_TestPointer((void*)result_data);
+			if (rc <= 0)
+			{
+				break;
+			}
 			result_data[0] = Cp;
+			if (tol > 0.0)
+			{
+				result_data[1] = (float)(smp.stat_ci[0]);
+				result_data[2] = (float)(smp.n_used);
+			}
 			(*res)->data = (void*)result_data;
 		}
 			break;
 		case GCALAB_T_PARAM:
 		{
-			float *result_data;
-			/*compute the average transient path length*/
-			if (samples > 0 )
-			{
-				Tp = TransLength(GCA,NULL,samples,maxT);
-			}
-			else
+			/*the average transient path length*/
+			if (!memo)
 			{
-				Tp = TransLength(GCA,range,0,maxT);
+				Tp = (smp.sums[1] > 0) ? (float)(smp.sums[0]/smp.sums[1]) : 0.0;
 			}
 			/*store outputs*/
 			(*res)->type = FLOAT32;
 			sprintf((*res)->id,"(%d):T",trgt_id);
-			(*res)->datalen = 1;
-			result_data = (float*)malloc(sizeof(float));
+			(*res)->datalen = (tol > 0.0) ? 3 : 1;
+			result_data = (float*)malloc(((*res)->datalen)*sizeof(float));
+			rc = GCALab_TestPointer((void*)result_data);
+			if (rc <= 0)
+			{
+				break;
+			}
 			result_data[0] = Tp;
+			if (tol > 0.0)
+			{
+				result_data[1] = (float)(smp.stat_ci[0]);
+				result_data[2] = (float)(smp.n_used);
+			}
 			(*res)->data = (void*)result_data;
 		}
 			break;
 		case GCALAB_ALL_PARAM:
 		{
-			float *result_data;
 			lambdap = lambda_param(GCA);
 			Zp = Z_param(GCA);
-			if (samples > 0)
+			Gp = (smp.n_used) ? (float)(smp.sums[0]/((double)smp.n_used)) : 0.0;
+			if (!memo)
 			{
-				Gp = G_density(GCA,NULL,samples);
-				Cp = AttLength(GCA,NULL,samples,maxT);
-				Tp = TransLength(GCA,NULL,samples,maxT);
-			}
-			else
-			{
-				Gp = G_density(GCA,range,0);
-				Cp = AttLength(GCA,range,0,maxT);
-				Tp = TransLength(GCA,range,0,maxT);
+				Cp = (smp.sums[2] > 0) ? (float)(smp.sums[1]/smp.sums[2]) : 0.0;
+				Tp = (smp.sums[4] > 0) ? (float)(smp.sums[3]/smp.sums[4]) : 0.0;
 			}
 			(*res)->type = FLOAT32;
 			sprintf((*res)->id,"(%d):PA",trgt_id);
-			(*res)->datalen = 5;
+			(*res)->datalen = (tol > 0.0) ? 9 : 5;
 			result_data = (float*)malloc(((*res)->datalen)*sizeof(float));
+			rc = GCALab_TestPointer((void*)result_data);
+			if (rc <= 0)
+			{
+				break;
+			}
 			result_data[0] = lambdap;
 			result_data[1] = Zp;
 			result_data[2] = Gp;
 			result_data[3] = Cp;
 			result_data[4] = Tp;
+			if (tol > 0.0)
+			{
+				result_data[5] = (float)(smp.stat_ci[0]);
+				result_data[6] = (float)(smp.stat_ci[1]);
+				result_data[7] = (float)(smp.stat_ci[2]);
+				result_data[8] = (float)(smp.n_used);
+			}
 			(*res)->data = (void*)result_data;
 		}
 			break;
 	}
+	if (sampled)
+	{
+		free(smp.sums);
+	}
+	if (rc <= 0)
+	{
+		free(*res);
+		(*res) = NULL;
+		return rc;
+	}
 	return GCALAB_SUCCESS;
 }
 
@@ -3260,7 +4394,7 @@ char GCALab_OP_Reverse(unsigned char ws_id,unsigned int trgt_id,int nparams, cha
 	chunk *preImages;
 	GraphCellularAutomaton *GCA;
 	/*Grab a reference to the CA we want to play with*/
-	GCA = WS(ws_id)->GCAList[trgt_id];
+	GCA = GCALab_GetGCA(ws_id,trgt_id);
 	(*res) = (GCALabOutput*)malloc(sizeof(GCALabOutput)); 
 	
 	preImages = CAGetPreImages(GCA,&numPreImages,NULL);
@@ -3277,13 +4411,22 @@ char GCALab_OP_Freq(unsigned char ws_id,unsigned int trgt_id,int nparams, char *
 {
 	unsigned int numSamples;
 	unsigned int *freqs;
+	unsigned int nthreads;
+	unsigned long long seed;
 	int size;
 	char rc;
 	int i;
 	chunk range[2];
-	chunk *ics;
+	char *part;
 	GraphCellularAutomaton *GCA;
+	GCALab_Sampler smp;
+	GCALab_SampleArgs args;
 	numSamples = 0;
+	nthreads = GCALAB_DEFAULT_THREADS;
+	seed = GCALAB_DEFAULT_SEED;
+	range[0] = 0;
+	range[1] = 0;
+	part = NULL;
 	for (i=0;i<nparams;i++)
 	{
 		if(!strcmp(params[i],"-n"))
@@ -3295,41 +4438,88 @@ char GCALab_OP_Freq(unsigned char ws_id,unsigned int trgt_id,int nparams, char *
 			range[0] = (chunk)atoi(params[++i]);
 			range[1] = (chunk)atoi(params[++i]);
 		}
+		else if (!strcmp(params[i],"-j"))
+		{
+			nthreads = (unsigned int)atoi(params[++i]);
+		}
+		else if (!strcmp(params[i],"-seed"))
+		{
+			seed = strtoull(params[++i],NULL,10);
+		}
+		else if (!strcmp(params[i],"-part"))
+		{
+			part = params[++i];
+		}
 	}
 			
 	/*Grab a reference to the CA we want to play with*/
-	GCA = WS(ws_id)->GCAList[trgt_id];
+	GCA = GCALab_GetGCA(ws_id,trgt_id);
 	(*res) = (GCALabOutput*)malloc(sizeof(GCALabOutput)); 
+	rc = GCALab_TestPointer((void*)(*res));
+	if (rc <= 0)
+	{
+		return rc;
+	}
 				
 	size = (GCA->params->N)*(GCA->params->N);
 	freqs = (unsigned int *)malloc(size*sizeof(unsigned int));
 	rc = GCALab_TestPointer((void*)freqs);
 	if (rc <= 0)
 	{
+		free(*res);
+		(*res) = NULL;
 		return rc;
 	}
 	memset((void*)freqs,0,size*sizeof(unsigned int));
 
+	args.op = GCALAB_STATE_FREQUENCIES;
+	args.T = 0;
+	args.type = 0;
+	args.freqs = freqs;
+	args.nfreqs = (GCA->params->N)*((unsigned int)GCA->params->s);
+	GCALab_InitSampler(&smp,GCA,0);
+	smp.nthreads = nthreads;
+	smp.seed = seed;
+	smp.init = &GCALab_Sample_InitScratch;
+	smp.sample = &GCALab_Sample_Freq;
+	smp.reduce = &GCALab_Sample_Reduce;
+	smp.args = (void*)&args;
+	/*shards count into their own table, a merge adds them up*/
+	smp.counts = freqs;
+	smp.ncounts = args.nfreqs;
 	if (numSamples)
 	{
-		ics = (chunk*)malloc(numSamples*sizeof(chunk));
-		rc = GCALab_TestPointer((void*)ics);
+		args.goe_only = 0;
+		smp.n = numSamples;
+	}
+	else
+	{
+		/*need to count by two's to avoid rotational symmetry*/	
+		args.goe_only = 1;
+		rc = GCALab_SetSamplerRange(&smp,range,2);
 		if (rc <= 0)
 		{
+			free(freqs);
+			free(*res);
+			(*res) = NULL;
 			return rc;
 		}
-
-		for (i=0;i<numSamples;i++)
-		{
-			ics[i] = rand();
-		}
-		SumCAImages(GCA,freqs,ics,numSamples);
-		free(ics);
 	}
-	else
+	smp.ckpt_tag = args.goe_only;
+	rc = GCALab_OpenShard(&(smp.shard),part);
+	if (rc > 0)
 	{
-		SumCAImages(GCA,freqs,range,0);
+		rc = GCALab_RunSampler(&smp);
 	}
+	GCALab_CloseShard(smp.shard);
+	if (rc <= 0)
+	{
+		free(freqs);
+		free(*res);
+		(*res) = NULL;
+		return rc;
+	}
+	free(smp.sums);
 
 	(*res)->type = UINT32;
 	sprintf((*res)->id,"(%d):F",trgt_id);
@@ -3338,33 +4528,89 @@ char GCALab_OP_Freq(unsigned char ws_id,unsigned int trgt_id,int nparams, char *
 	return GCALAB_SUCCESS;
 }
 
+/* GCALab_OP_Pop(): population density over time, averaged over samples
+ */
 char GCALab_OP_Pop(unsigned char ws_id,unsigned int trgt_id,int argc, char ** argv,GCALabOutput **res)
 {
 	unsigned int i,T;
+	unsigned int numSamples;
+	unsigned int nthreads;
+	unsigned long long seed;
 	char rc;
 	float * dense;
 	GraphCellularAutomaton *GCA;
+	GCALab_Sampler smp;
+	GCALab_SampleArgs args;
 	
+	T = 0;
+	numSamples = 1;
+	nthreads = GCALAB_DEFAULT_THREADS;
+	seed = GCALAB_DEFAULT_SEED;
 	for (i=0;i<argc;i++)
 	{
 		if (!strcmp(argv[i],"-t"))
 		{
 			T = (unsigned int)atoi(argv[++i]);
 		}
+		else if (!strcmp(argv[i],"-n"))
+		{
+			numSamples = (unsigned int)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i],"-j"))
+		{
+			nthreads = (unsigned int)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i],"-seed"))
+		{
+			seed = strtoull(argv[++i],NULL,10);
+		}
 	}
 
 	/*Grab a reference to the CA we want to play with*/
-	GCA = WS(ws_id)->GCAList[trgt_id];
+	GCA = GCALab_GetGCA(ws_id,trgt_id);
 	(*res) = (GCALabOutput*)malloc(sizeof(GCALabOutput)); 
+	rc = GCALab_TestPointer((void*)(*res));
+	if (rc <= 0)
+	{
+		return rc;
+	}
 				
 	dense = (float *)malloc(T*sizeof(float));
 	rc = GCALab_TestPointer((void*)dense);
 	if (rc <= 0)
 	{
+		free(*res);
+		(*res) = NULL;
 		return rc;
 	}
 
-	PopDensity(GCA,NULL,T,dense);
+	args.op = GCALAB_POP_DENSITY;
+	args.T = T;
+	args.type = 0;
+	args.goe_only = 0;
+	args.freqs = NULL;
+	args.nfreqs = 0;
+	GCALab_InitSampler(&smp,GCA,T);
+	smp.n = numSamples;
+	smp.nthreads = nthreads;
+	smp.seed = seed;
+	smp.init = &GCALab_Sample_InitScratch;
+	smp.sample = &GCALab_Sample_Pop;
+	smp.reduce = &GCALab_Sample_Reduce;
+	smp.args = (void*)&args;
+	rc = GCALab_RunSampler(&smp);
+	if (rc <= 0)
+	{
+		free(dense);
+		free(*res);
+		(*res) = NULL;
+		return rc;
+	}
+	for (i=0;i<T;i++)
+	{
+		dense[i] = (float)(smp.sums[i]/((double)numSamples));
+	}
+	free(smp.sums);
 
 	(*res)->type = FLOAT32;
 	sprintf((*res)->id,"(%d):D",trgt_id);
@@ -3373,6 +4619,250 @@ char GCALab_OP_Pop(unsigned char ws_id,unsigned int trgt_id,int argc, char ** ar
 	
 	return GCALAB_SUCCESS;
 }
+
+/* GCALab_OP_Sweep(): compute measures over a range of rules on the topology of a CA
+ */
+char GCALab_OP_Sweep(unsigned char ws_id,unsigned int trgt_id,int argc, char ** argv,GCALabOutput **res)
+{
+	int i;
+	char rc;
+	char *filename;
+	char *cachename;
+	char *part;
+	GraphCellularAutomaton *GCA;
+	GCALab_Sweep sw;
+
+	/*Grab a reference to the CA we want to play with*/
+	GCA = GCALab_GetGCA(ws_id,trgt_id);
+	GCALab_InitSweep(&sw,GCA);
+	filename = NULL;
+	cachename = NULL;
+	part = NULL;
+	for (i=0;i<argc;i++)
+	{
+		if (!strcmp(argv[i],"-r"))
+		{
+			char * typestr = argv[++i];
+			if (!strcmp(typestr,"code"))
+			{
+				sw.rule_type = CODE_RULE_TYPE;
+			}
+			else if (!strcmp(typestr,"thresh"))
+			{
+				sw.rule_type = THRESH_RULE_TYPE;
+			}
+			else if (!strcmp(typestr,"totalistic"))
+			{
+				sw.rule_type = COUNT_RULE_TYPE;
+			}
+			else if (!strcmp(typestr,"life"))
+			{
+				sw.rule_type = LIFE_RULE_TYPE;
+			}
+			else
+			{
+				return GCALAB_INVALID_OPTION;
+			}
+			sw.rule0 = (unsigned int)strtoul(argv[++i],NULL,10);
+			sw.rule1 = (unsigned int)strtoul(argv[++i],NULL,10);
+		}
+		else if (!strcmp(argv[i],"-measures"))
+		{
+			rc = GCALab_ParseMeasures(&sw,argv[++i]);
+			if (rc <= 0)
+			{
+				return rc;
+			}
+		}
+		else if (!strcmp(argv[i],"-n"))
+		{
+			sw.n = (unsigned int)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i],"-t"))
+		{
+			sw.T = (unsigned int)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i],"-maxt"))
+		{
+			sw.maxT = (unsigned int)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i],"-j"))
+		{
+			sw.nthreads = (unsigned int)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i],"-seed"))
+		{
+			sw.seed = strtoull(argv[++i],NULL,10);
+		}
+		else if (!strcmp(argv[i],"-nocanon"))
+		{
+			sw.canon = 0;
+		}
+		else if (!strcmp(argv[i],"-cache"))
+		{
+			cachename = argv[++i];
+		}
+		else if (!strcmp(argv[i],"-f"))
+		{
+			filename = argv[++i];
+		}
+		else if (!strcmp(argv[i],"-part"))
+		{
+			part = argv[++i];
+		}
+		else
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+	}
+
+	if (cachename != NULL)
+	{
+		sw.cache = GCALab_OpenCache(cachename);
+		if (sw.cache == NULL)
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+	}
+
+	if (filename != NULL)
+	{
+		sw.fp = fopen(filename,"w");
+		if (sw.fp == NULL)
+		{
+			GCALab_CloseCache(sw.cache);
+			return GCALAB_INVALID_OPTION;
+		}
+	}
+	
+	rc = GCALab_OpenShard(&(sw.shard),part);
+	if (rc > 0)
+	{
+		rc = GCALab_RunSweep(&sw);
+	}
+	GCALab_CloseShard(sw.shard);
+	if (sw.fp != NULL)
+	{
+		fclose(sw.fp);
+	}
+	GCALab_CloseCache(sw.cache);
+	if (rc <= 0)
+	{
+		return rc;
+	}
+
+	(*res) = (GCALabOutput*)malloc(sizeof(GCALabOutput)); 
+	rc = GCALab_TestPointer((void*)(*res));
+	if (rc <= 0)
+	{
+		free(sw.rows);
+		return rc;
+	}
+	/*a row major matrix, one row of (rule, measures...) per rule*/
+	(*res)->type = FLOAT64;
+	sprintf((*res)->id,"(%d):SW",trgt_id);
+	(*res)->datalen = (sw.rule1 - sw.rule0 + 1)*(sw.nmeasures + 1);
+	(*res)->data = (void*)(sw.rows);
+	return GCALAB_SUCCESS;
+}
+
+/* GCALab_OP_Record(): attach a recorder to a CA, detach it, or export a time range
+ * of a recording to a bitmap
+ */
+char GCALab_OP_Record(unsigned char ws_id,unsigned int trgt_id,int argc, char ** argv,GCALabOutput **res)
+{
+	int i;
+	char rc;
+	char *filename;
+	char *bmpname;
+	unsigned char stop,export;
+	unsigned int keyint,t0,t1;
+	GraphCellularAutomaton *GCA;
+	GCALab_Recorder **rec;
+	GCALab_Recording *recording;
+
+	filename = NULL;
+	bmpname = NULL;
+	stop = 0;
+	export = 0;
+	keyint = 0;
+	t0 = 0;
+	t1 = 0;
+	for (i=0;i<argc;i++)
+	{
+		if (!strcmp(argv[i],"-f"))
+		{
+			filename = argv[++i];
+		}
+		else if (!strcmp(argv[i],"-k"))
+		{
+			keyint = (unsigned int)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i],"-stop"))
+		{
+			stop = 1;
+		}
+		else if (!strcmp(argv[i],"-x"))
+		{
+			export = 1;
+			t0 = (unsigned int)atoi(argv[++i]);
+			t1 = (unsigned int)atoi(argv[++i]);
+		}
+		else if (!strcmp(argv[i],"-o"))
+		{
+			bmpname = argv[++i];
+		}
+		else
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+	}
+
+	if (trgt_id >= (unsigned int)(WS(ws_id)->numGCA))
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	GCA = GCALab_GetGCA(ws_id,trgt_id);
+	rec = WS(ws_id)->GCARecorder + trgt_id;
+	if (export)
+	{
+		/*the attached recording unless another is given*/
+		if (bmpname == NULL || (filename == NULL && (*rec) == NULL))
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+		if (filename == NULL)
+		{
+			rc = GCALab_FlushRecorder(*rec);
+			if (rc <= 0)
+			{
+				return rc;
+			}
+			filename = (*rec)->filename;
+		}
+		rc = GCALab_OpenRecording(&recording,filename);
+		if (rc <= 0)
+		{
+			return rc;
+		}
+		rc = GCALab_ExportRecording(recording,t0,t1,bmpname);
+		GCALab_CloseRecording(recording);
+		return rc;
+	}
+
+	/*a new recording replaces the attached one*/
+	rc = GCALab_CloseRecorder(*rec);
+	(*rec) = NULL;
+	if (stop || rc <= 0)
+	{
+		return rc;
+	}
+	if (filename == NULL)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	return GCALab_OpenRecorder(rec,filename,GCA,keyint);
+}
 #else
 int main(){
 	printf("Install a proper operating system!\n");
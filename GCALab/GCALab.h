@@ -64,6 +64,20 @@
 #include "mesh.h"
 #include "GCA.h"
 #include "GCALab_fio.h"
+#include "GCALab_rec.h"
+#include "GCALab_shard.h"
+#include "GCALab_topo.h"
+#include "GCALab_graph.h"
+#include "GCALab_snap.h"
+#include "GCALab_sampler.h"
+#include "GCALab_cache.h"
+#include "GCALab_sweep.h"
+#include "GCALab_queue.h"
+#include "GCALab_results.h"
+#include "GCALab_prof.h"
+#include "GCALab_sched.h"
+#include "GCALab_batch.h"
+#include "GCALab_server.h"
 
 
 /*this error code should be consistent with the error codes in mesh.h*/
@@ -81,6 +95,7 @@
 #define GCALAB_GRAPHICS_MODE 	0
 #define GCALAB_TEXT_MODE 		1
 #define GCALAB_BATCH_MODE 		2
+#define GCALAB_SERVER_MODE 		3
 
 
 #ifndef GCALAB_DEFAULT_MODE
@@ -95,15 +110,13 @@
 #define GCALAB_DEFAULT_MAX_GCA 	25
 #endif
 
-#ifndef GCALAB_COMMAND_BUFFER_SIZE
-#define GCALAB_COMMAND_BUFFER_SIZE	1024
+#ifndef GCALAB_SCHED_LOOKAHEAD
+/*number of unretired commands looked at when searching for one ready to run*/
+#define GCALAB_SCHED_LOOKAHEAD	256
 #endif
 
 #define GCALAB_MAX_STRLEN 128
 
-#ifndef GCALAB_MAX_RESULTS 
-#define GCALAB_MAX_RESULTS 2048
-#endif
 
 
 #define GCALAB_WS_STATE_IDLE 		0
@@ -112,6 +125,45 @@
 #define GCALAB_WS_STATE_EXITING 	3
 #define GCALAB_WS_STATE_ERROR 		5
 
+/*state of a command in a workspace queue*/
+#define GCALAB_CMD_QUEUED 	0
+#define GCALAB_CMD_RUNNING 	1
+#define GCALAB_CMD_DONE 	2
+/*pushed to the scheduler but not yet started*/
+#define GCALAB_CMD_DISPATCHED 	3
+
+/*requests to stop a running command*/
+/*stop and drop the command*/
+#define GCALAB_CMD_ABORT 	1
+/*stop and queue the command again, it resumes (from its checkpoint if it has one) 
+ * when the queue is processed again*/
+#define GCALAB_CMD_PAUSE 	2
+
+/*how an operation accesses the workspace, used to decide which commands can run 
+ * concurrently (no flags means it has no dependencies at all)*/
+/*only reads the target GCA, runs on a private snapshot of it*/
+#define GCALAB_OP_READ 		0x1
+/*modifies the target GCA*/
+#define GCALAB_OP_WRITE 	0x2
+/*modifies the workspace (e.g., adds a GCA) or reads results, runs alone*/
+#define GCALAB_OP_EXCLUSIVE 0x4
+/*appends a new GCA to the workspace (whatever the target), used by batch mode 
+ * to spread GCAs over workspaces*/
+#define GCALAB_OP_CREATE 	0x8
+/*modifies the topology of the target, which read snapshots share, so it also waits 
+ * for earlier readers of the target to finish*/
+#define GCALAB_OP_TOPOLOGY 	0x10
+
+/*number of commands a workspace may run at once*/
+#ifndef GCALAB_DEFAULT_WS_THREADS
+#define GCALAB_DEFAULT_WS_THREADS 1
+#endif
+
+/*number of scheduler workers, 0 for one per processor*/
+#ifndef GCALAB_DEFAULT_WORKERS
+#define GCALAB_DEFAULT_WORKERS 0
+#endif
+
 #define GCALAB_NOP 		0
 #define GCALAB_LOAD 	1
 #define GCALAB_SAVE 	2
@@ -121,6 +173,8 @@
 #define GCALAB_PARAM	6
 #define GCALAB_REVERSE	7
 #define GCALAB_STATE_FREQUENCIES 8
+#define GCALAB_POP_DENSITY 9
+#define GCALAB_SWEEP 10
 
 #define GCALAB_SHANNON_ENTROPY 	0
 #define GCALAB_WORD_ENTROPY 	1
@@ -137,7 +191,7 @@
 #define WS(a) GCALab_Global[(a)]
 
 #ifndef GCALAB_MAXNUM_CMDS
-#define GCALAB_MAXNUM_CMDS 14
+#define GCALAB_MAXNUM_CMDS 32
 #endif
 
 #ifndef GCALAB_MAXNUM_OPS
@@ -149,6 +203,8 @@ typedef struct GCALabworkspace_struct GCALab_WS;
 typedef struct GCALabOutput_struct GCALabOutput;
 typedef struct GCALab_Command_struct GCALab_Cmd;
 typedef struct GCALab_Operation_struct GCALab_Op;
+typedef struct GCALab_SampleArgs_struct GCALab_SampleArgs;
+typedef struct GCALab_SampleScratch_struct GCALab_SampleScratch;
 
 /*output data from compute operations*/
 struct GCALabOutput_struct
@@ -164,20 +220,27 @@ struct GCALabworkspace_struct
 {
 	GraphCellularAutomaton **GCAList;
 	mesh **GCAGeometry;
+	/*recorders attached to the GCA (NULL if not recording)*/
+	GCALab_Recorder **GCARecorder;
 	int numGCA;
 	int maxGCA;
-	int numresults;
-	GCALabOutput **results;
-	unsigned int *	commandqueue;
-	unsigned int *commandtarget;
-	char ***commandparams;
-	int *numparams;
-	unsigned int numcommands;
-	unsigned int qhead;
-	unsigned int qtail;
+	GCALab_ResultStore results;
+	/*profiles of retired commands*/
+	GCALab_ProfileLog profiles;
+	/*queued, running and finished commands, results of finished commands are 
+	 * appended to results in queue order once everything before them is done*/
+	GCALab_CmdQueue queue;
+	unsigned int numrunning;
+	unsigned int numdispatched;
+	/*number of snapshots holding back writers (waiting for running ones to finish,
+	 * or for the child to copy out-of-core GCAs), no new ones are started*/
+	unsigned int holdwriters;
 	unsigned int state;
-	pthread_t worker;
+	/*max number of commands running (or dispatched) at once*/
+	unsigned int maxrunning;
 	pthread_mutex_t wslock;
+	/*signalled whenever the queue or state changes*/
+	pthread_cond_t wscond;
 };
 
 /*command line options*/
@@ -189,8 +252,24 @@ struct GCALab_CL_Options_struct
 	unsigned char load_CA;
 	unsigned char save_CA;
 	char *ScriptFile;	
+	/*socket the server listens on*/
+	char *SocketPath;
 	char *CAInputFilename;
 	char *CAOutputFilename;
+	/*number of scheduler workers*/
+	unsigned int numworkers;
+	/*max number of workspaces a batch script is spread over, 0 for one per worker*/
+	unsigned int jobs;
+	/*directory for result spill files (NULL for the default)*/
+	char *ScratchDir;
+	/*directory for cached graphs and meshes (NULL for no cache)*/
+	char *TopoCacheDir;
+	/*directory for out-of-core GCA rows (NULL to keep GCAs in memory)*/
+	char *OutOfCoreDir;
+	/*shard mode, and the shard this process runs of nshards*/
+	unsigned char shardmode;
+	unsigned int shard;
+	unsigned int nshards;
 };
 
 /*high level GCALab commands - workspace level*/
@@ -212,20 +291,62 @@ struct GCALab_Operation_struct
 	char *id;
 	/*function pointer*/
 	char (*f)(unsigned char, unsigned int,int,char**,GCALabOutput **res);
+	/*workspace access flags*/
+	unsigned char flags;
 	/*help infomation*/
 	char *args;
 	char *desc;
 };
 
+/*arguments shared by all threads of a sampled operation*/
+struct GCALab_SampleArgs_struct
+{
+	/*the operation being sampled (e.g., GCALAB_ENTROPY)*/
+	unsigned int op;
+	/*number of time steps, or max time steps for cycle search*/
+	unsigned int T;
+	/*measure type (e.g., GCALAB_SHANNON_ENTROPY)*/
+	unsigned int type;
+	/*only sample Garden-of-Eden configurations*/
+	unsigned char goe_only;
+	/*accumulated state frequencies (freq operation)*/
+	unsigned int *freqs;
+	unsigned int nfreqs;
+};
+
+/*per-thread scratch memory of a sampled operation*/
+struct GCALab_SampleScratch_struct
+{
+	float *p;
+	float *logs_p;
+	float *S_i;
+	float *pt;
+	float *logs_pt;
+	float *logQ;
+	float *IE;
+	float *dense;
+	unsigned char *flags;
+	unsigned int *count;
+	unsigned int *countt;
+	unsigned int *wl;
+	unsigned int *Q;
+	unsigned int *freqs;
+};
+
 /*function prototypes*/
 char GCALab_Init(int argc,char **argv,GCALab_CL_Options **opts);
 void GCALab_Register_Command(char *id,char (*f)(int, char**),char * args, char * desc);
-void GCALab_Register_Operation(char *id,char (*f)(unsigned char,unsigned int,int,char**,GCALabOutput**),char* args,char * desc);
+void GCALab_Register_Operation(char *id,char (*f)(unsigned char,unsigned int,int,char**,GCALabOutput**),unsigned char flags,char* args,char * desc);
 char GCALab_Process_Command(int nargs,char ** args);
-char GCALab_NewWorkSpace(int GCALimit);
+char GCALab_NewWorkSpace(int GCALimit,int maxrunning);
+void GCALab_DropWorkSpace(void);
 void GCALab_LockWS(unsigned char ws_id);
 void GCALab_UnLockWS(unsigned char ws_id);
+void GCALab_WaitWS(unsigned char ws_id);
+void GCALab_SignalWS(unsigned char ws_id);
 char GCALab_QueueCommand(unsigned char ws_id,unsigned int command_id,unsigned int target_id,char **params,int numparams);
+char GCALab_QueueCommandNotify(unsigned char ws_id,unsigned int command_id,unsigned int target_id,char **params,int numparams,
+	void (*notify)(void*,char,int),void *notify_arg);
 char GCALab_CancelCommand(unsigned char ws_id,unsigned int index);
 char GCALab_ProcessCommandQueue(unsigned char ws_id);
 char GCALab_PauseCommandQueue(unsigned char ws_id);
@@ -236,13 +357,22 @@ void GCALab_SetState(unsigned char ws_id,unsigned int state);
 void GCALab_ShutDown(char rc); 
 unsigned int GCALab_GetCommandCode(char *cmd);
 
-void *GCALab_Worker(void *params);
-char GCALab_DoNextCommand(unsigned char ws_id);
+void GCALab_RunCommandTask(GCALab_Task *task);
+void GCALab_Schedule(unsigned char ws_id);
+GCALab_CmdRecord *GCALab_NextReadyCommand(unsigned char ws_id);
+char GCALab_DoCommand(unsigned char ws_id,GCALab_CmdRecord *cmd);
+void GCALab_RetireCommands(unsigned char ws_id);
+unsigned char GCALab_CmdProgress(void *arg,unsigned long long done,unsigned long long total);
+GraphCellularAutomaton *GCALab_GetGCA(unsigned char ws_id,unsigned int trgt_id);
+void GCALab_SetOutput(FILE *fp);
+FILE *GCALab_Out(void);
+FILE *GCALab_Err(void);
 unsigned char GCALab_CommandQueueEmpty(unsigned char ws_id);
 
 void GCALab_GraphicsMode(GCALab_CL_Options* opts);
 void GCALab_TextMode(GCALab_CL_Options* opts);
-char GCALab_BatchMode(GCALab_CL_Options* opts);
+int GCALab_BatchMode(GCALab_CL_Options* opts);
+int GCALab_ServerMode(GCALab_CL_Options* opts);
 
 /*Graphics Mode*/
 
@@ -268,6 +398,8 @@ void GCALab_PrintOperations(void);
 char GCALab_PrintCA(unsigned char ws_id,unsigned int gca_id);
 char GCALab_PrintSTP(unsigned char ws_id,unsigned int gca_id);
 char GCALab_PrintResults(unsigned char ws_id,unsigned int res_id);
+char GCALab_FPrintResults(FILE *fp,unsigned char ws_id,unsigned int res_id);
+char GCALab_PrintProfiles(unsigned char ws_id,FILE *fp,unsigned char csv);
 
 char ** GCALab_ReadScriptCommand(char * filename, int *numargs);
 
@@ -282,7 +414,6 @@ char GCALab_ValidWSId(unsigned int ws_id);
 
 void GCALab_InitCL_Options(GCALab_CL_Options* opts);
 GCALab_CL_Options* GCALab_ParseCommandLineArgs(int argc, char **argv);
-char** strvncpy(char **strv,int c,int n);
 
 
 /*menu commands*/
@@ -296,15 +427,21 @@ char GCALab_CMD_QueueCommand(int argc, char **argv);
 char GCALab_CMD_DeleteCommand(int argc, char **argv);
 char GCALab_CMD_ExecuteQueue(int argc, char **argv);
 char GCALab_CMD_StopQueue(int argc, char **argv);
+char GCALab_CMD_PrintQueue(int argc, char **argv);
 char GCALab_CMD_PrintCA(int argc, char **argv);
 char GCALab_CMD_PrintSTP(int argc, char ** argv);
 char GCALab_CMD_PrintResults(int argc, char **argv);
 char GCALab_CMD_Quit(int argc, char **argv);
+char GCALab_CMD_PrintStats(int argc, char **argv);
+char GCALab_CMD_Profile(int argc, char **argv);
+char GCALab_CMD_Snapshot(int argc, char **argv);
+char GCALab_CMD_Restore(int argc, char **argv);
 
 /*compute operations*/
 char GCALab_OP_NOP(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
 char GCALab_OP_Load(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
 char GCALab_OP_Save(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
+char GCALab_OP_Export(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
 char GCALab_OP_Simulate(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
 char GCALab_OP_GCA(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
 char GCALab_OP_Rotate(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
@@ -313,5 +450,15 @@ char GCALab_OP_Param(unsigned char ws_id,unsigned int trgt,int argc, char ** arg
 char GCALab_OP_Reverse(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
 char GCALab_OP_Freq(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
 char GCALab_OP_Pop(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
+char GCALab_OP_Sweep(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
+char GCALab_OP_Record(unsigned char ws_id,unsigned int trgt,int argc, char ** argv,GCALabOutput **res);
+
+/*sampler callbacks for compute operations*/
+void *GCALab_Sample_InitScratch(GraphCellularAutomaton *GCA,void *args);
+void GCALab_Sample_Reduce(void *scratch,void *args);
+void GCALab_Sample_Entropy(GraphCellularAutomaton *GCA,void *scratch,void *args,double *vals);
+void GCALab_Sample_Param(GraphCellularAutomaton *GCA,void *scratch,void *args,double *vals);
+void GCALab_Sample_Freq(GraphCellularAutomaton *GCA,void *scratch,void *args,double *vals);
+void GCALab_Sample_Pop(GraphCellularAutomaton *GCA,void *scratch,void *args,double *vals);
 #endif
 #endif
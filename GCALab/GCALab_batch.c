@@ -0,0 +1,788 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_batch.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Batch mode. The whole script is read into a dependency graph,
+ *              the GCAs it creates are spread over a pool of workspaces, and
+ *              every line is started as soon as the lines it depends on are
+ *              done. Scripts written for a single workspace therefore use
+ *              every worker without edits.
+ *
+ *==============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "GCALab.h"
+
+/*defined in GCALab.c*/
+extern unsigned int cur_ws;
+extern unsigned int GCALab_numWS;
+extern GCALab_Op GCALab_Ops[];
+
+/**
+ * @brief Appends an index to a list.
+ */
+static char GCALab_BatchAppend(GCALab_BatchList *l,int i)
+{
+	int *v;
+	unsigned int cap;
+	if (l->num == l->cap)
+	{
+		cap = (l->cap > 0) ? 2*l->cap : 8;
+		if (!(v = (int *)realloc(l->v,cap*sizeof(int))))
+		{
+			return GCALAB_MEM_ERROR;
+		}
+		l->v = v;
+		l->cap = cap;
+	}
+	l->v[l->num] = i;
+	l->num++;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Makes node to wait for node from (nothing if from < 0).
+ */
+static char GCALab_BatchDepend(GCALab_Batch *b,int from,int to)
+{
+	if (from < 0)
+	{
+		return GCALAB_SUCCESS;
+	}
+	b->nodes[to].pending++;
+	return GCALab_BatchAppend(&(b->nodes[from].succ),to);
+}
+
+/**
+ * @brief Makes node n wait for every node in a list.
+ */
+static char GCALab_BatchDependAll(GCALab_Batch *b,GCALab_BatchList *l,int n)
+{
+	unsigned int i;
+	char rc;
+	for (i=0;i<l->num;i++)
+	{
+		if ((rc = GCALab_BatchDepend(b,l->v[i],n)) != GCALAB_SUCCESS)
+		{
+			return rc;
+		}
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Forgets the writers and readers of the chains of script workspace lws
+ * (all workspaces if lws < 0), a barrier now stands in for them.
+ */
+static void GCALab_BatchResetChains(GCALab_Batch *b,int lws)
+{
+	unsigned int i;
+	for (i=0;i<b->numchains;i++)
+	{
+		if (lws < 0 || b->chains[i].lws == lws)
+		{
+			b->chains[i].writer = -1;
+			b->chains[i].readers.num = 0;
+		}
+	}
+}
+
+/**
+ * @brief Adds a node for a script line, the node takes ownership of argv.
+ * @returns the index of the node, -1 if out of memory.
+ */
+static int GCALab_BatchNewNode(GCALab_Batch *b,unsigned char kind,int argc,char **argv)
+{
+	GCALab_BatchNode *nodes;
+	unsigned int cap;
+	if (b->num == b->cap)
+	{
+		cap = (b->cap > 0) ? 2*b->cap : 64;
+		if (!(nodes = (GCALab_BatchNode *)realloc(b->nodes,cap*sizeof(GCALab_BatchNode))))
+		{
+			return -1;
+		}
+		b->nodes = nodes;
+		b->cap = cap;
+	}
+	nodes = b->nodes + b->num;
+	memset((void *)nodes,0,sizeof(GCALab_BatchNode));
+	nodes->kind = kind;
+	nodes->argc = argc;
+	nodes->argv = argv;
+	nodes->lws = -1;
+	nodes->chain = -1;
+	nodes->res_id = -1;
+	nodes->batch = b;
+	b->num++;
+	return (int)(b->num - 1);
+}
+
+/**
+ * @brief Adds a chain for the GCA created by node n in script workspace lws.
+ * @returns the index of the chain, -1 if out of memory.
+ */
+static int GCALab_BatchNewChain(GCALab_Batch *b,int lws,int n)
+{
+	GCALab_BatchChain *chains;
+	unsigned int cap;
+	if (b->numchains == b->capchains)
+	{
+		cap = (b->capchains > 0) ? 2*b->capchains : 16;
+		if (!(chains = (GCALab_BatchChain *)realloc(b->chains,cap*sizeof(GCALab_BatchChain))))
+		{
+			return -1;
+		}
+		b->chains = chains;
+		b->capchains = cap;
+	}
+	chains = b->chains + b->numchains;
+	memset((void *)chains,0,sizeof(GCALab_BatchChain));
+	chains->lws = lws;
+	chains->create = n;
+	chains->writer = n;
+	if (GCALab_BatchAppend(&(b->ws[lws].chains),(int)b->numchains) != GCALAB_SUCCESS)
+	{
+		return -1;
+	}
+	b->numchains++;
+	return (int)(b->numchains - 1);
+}
+
+/**
+ * @brief Gets the chain of a script GCA id.
+ * @returns the chain, -1 if the script has not created the GCA yet.
+ */
+static int GCALab_BatchFindChain(GCALab_Batch *b,int lws,char *id)
+{
+	int gca_id;
+	gca_id = atoi(id);
+	if (gca_id < 0 || gca_id >= (int)b->ws[lws].chains.num)
+	{
+		return -1;
+	}
+	return b->ws[lws].chains.v[gca_id];
+}
+
+/**
+ * @brief Makes node n wait for everything before it in script workspace lws.
+ */
+static char GCALab_BatchWSBarrier(GCALab_Batch *b,int lws,int n)
+{
+	char rc;
+	if ((rc = GCALab_BatchDepend(b,b->ws[lws].barrier,n)) != GCALAB_SUCCESS)
+	{
+		return rc;
+	}
+	if ((rc = GCALab_BatchDependAll(b,&(b->ws[lws].since),n)) != GCALAB_SUCCESS)
+	{
+		return rc;
+	}
+	b->ws[lws].barrier = n;
+	b->ws[lws].since.num = 0;
+	GCALab_BatchResetChains(b,lws);
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Makes node n wait for everything before it.
+ */
+static char GCALab_BatchBarrier(GCALab_Batch *b,int n)
+{
+	unsigned int i;
+	char rc;
+	if ((rc = GCALab_BatchDepend(b,b->barrier,n)) != GCALAB_SUCCESS)
+	{
+		return rc;
+	}
+	if ((rc = GCALab_BatchDependAll(b,&(b->since),n)) != GCALAB_SUCCESS)
+	{
+		return rc;
+	}
+	b->barrier = n;
+	b->since.num = 0;
+	for (i=0;i<b->numws;i++)
+	{
+		b->ws[i].barrier = n;
+		b->ws[i].since.num = 0;
+	}
+	GCALab_BatchResetChains(b,-1);
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Adds the dependencies of operation node n.
+ * @details Operations that create a GCA wait for the last barrier of their
+ * workspace (the order of creation within a workspace is added once chains
+ * are dealt out, see GCALab_RunBatch()), other exclusive operations are barriers.
+ * @returns GCALAB_SUCCESS, or GCALAB_INVALID_OPTION if the target does not exist.
+ */
+static char GCALab_BatchAddOp(GCALab_Batch *b,int n)
+{
+	GCALab_BatchNode *node;
+	GCALab_BatchChain *chain;
+	unsigned char flags;
+	int lws,c,i;
+	char rc;
+
+	node = b->nodes + n;
+	lws = node->lws;
+	flags = GCALab_Ops[node->cmd_id].flags;
+	c = -1;
+	if (flags & GCALAB_OP_CREATE)
+	{
+		if ((c = GCALab_BatchNewChain(b,lws,n)) < 0)
+		{
+			return GCALAB_MEM_ERROR;
+		}
+		rc = GCALab_BatchDepend(b,b->ws[lws].barrier,n);
+	}
+	else if (flags & GCALAB_OP_EXCLUSIVE)
+	{
+		/*save refers to a result unless told it is a GCA*/
+		for (i=2;node->cmd_id == GCALAB_SAVE && i<node->argc && strcmp(node->argv[i],"-g");i++);
+		if ((node->cmd_id != GCALAB_SAVE || i < node->argc) && (c = GCALab_BatchFindChain(b,lws,node->argv[1])) < 0)
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+		rc = GCALab_BatchWSBarrier(b,lws,n);
+	}
+	else if (flags & (GCALAB_OP_READ | GCALAB_OP_WRITE))
+	{
+		if ((c = GCALab_BatchFindChain(b,lws,node->argv[1])) < 0)
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+		chain = b->chains + c;
+		rc = GCALab_BatchDepend(b,(chain->writer >= 0) ? chain->writer : b->ws[lws].barrier,n);
+		if (rc == GCALAB_SUCCESS && (flags & GCALAB_OP_WRITE))
+		{
+			rc = GCALab_BatchDependAll(b,&(chain->readers),n);
+			chain->writer = n;
+			chain->readers.num = 0;
+		}
+		else if (rc == GCALAB_SUCCESS)
+		{
+			rc = GCALab_BatchAppend(&(chain->readers),n);
+		}
+	}
+	else
+	{
+		rc = GCALab_BatchDepend(b,b->ws[lws].barrier,n);
+	}
+	b->nodes[n].chain = c;
+	for (i=2;rc == GCALAB_SUCCESS && i<b->nodes[n].argc;i++)
+	{
+		if (!strcmp(b->nodes[n].argv[i],"-f"))
+		{
+			if ((rc = GCALab_BatchDependAll(b,&(b->files),n)) == GCALAB_SUCCESS)
+			{
+				rc = GCALab_BatchAppend(&(b->files),n);
+			}
+			break;
+		}
+	}
+	if (rc != GCALAB_SUCCESS)
+	{
+		return rc;
+	}
+	if ((rc = GCALab_BatchAppend(&(b->ws[lws].since),n)) != GCALAB_SUCCESS)
+	{
+		return rc;
+	}
+	return GCALab_BatchAppend(&(b->since),n);
+}
+
+/**
+ * @brief Frees the words of a script line.
+ */
+static void GCALab_BatchFreeArgs(int argc,char **argv)
+{
+	int i;
+	for (i=0;i<argc;i++)
+	{
+		free(argv[i]);
+	}
+	free(argv);
+}
+
+/**
+ * @brief Adds a script line to the graph, it takes ownership of argv.
+ * @details Workspace commands (new-work, ch-work) only change the script
+ * workspace that following lines refer to. Queue control commands (exec-q,
+ * stop-q, del-cmd) have no meaning in batch mode and are ignored.
+ * @param lws the current script workspace, updated by workspace commands
+ * @returns GCALAB_SUCCESS, or the error the line would have caused when run.
+ */
+static char GCALab_BatchAddLine(GCALab_Batch *b,int *lws,int argc,char **argv)
+{
+	GCALab_BatchNode *node;
+	unsigned int cmd_id;
+	int n,id;
+	char rc;
+
+	/*the q-cmd prefix is optional*/
+	if (argc > 0 && !strcmp(argv[0],"q-cmd"))
+	{
+		free(argv[0]);
+		memmove((void *)argv,(void *)(argv+1),(argc-1)*sizeof(char*));
+		argc--;
+	}
+	if (argc == 0 || argv[0][0] == '#' || !strcmp(argv[0],"exec-q") || !strcmp(argv[0],"stop-q")
+		|| !strcmp(argv[0],"del-cmd"))
+	{
+		GCALab_BatchFreeArgs(argc,argv);
+		return GCALAB_SUCCESS;
+	}
+	rc = GCALAB_SUCCESS;
+	cmd_id = GCALab_GetCommandCode(argv[0]);
+	if (!strcmp(argv[0],"new-work"))
+	{
+		if (argc < 2)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+		else if (b->numws == GCALAB_MAX_WORKSPACES)
+		{
+			rc = GCALAB_INVALID_WS_ERROR;
+		}
+		else
+		{
+			b->ws[b->numws].barrier = b->barrier;
+			*lws = (int)b->numws;
+			b->numws++;
+		}
+	}
+	else if (!strcmp(argv[0],"ch-work"))
+	{
+		id = (argc > 1) ? atoi(argv[1]) : -1;
+		if (argc < 2)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+		else if (id < 0 || id >= (int)b->numws)
+		{
+			rc = GCALAB_INVALID_WS_ERROR;
+		}
+		else
+		{
+			*lws = id;
+		}
+	}
+	else if (cmd_id != GCALAB_NOP || !strcmp(argv[0],GCALab_Ops[GCALAB_NOP].id))
+	{
+		if (argc < 2)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+		else if (*lws < 0)
+		{
+			rc = GCALAB_INVALID_WS_ERROR;
+		}
+		else if ((n = GCALab_BatchNewNode(b,GCALAB_BATCH_OP,argc,argv)) < 0)
+		{
+			rc = GCALAB_MEM_ERROR;
+		}
+		else
+		{
+			b->nodes[n].cmd_id = cmd_id;
+			b->nodes[n].lws = *lws;
+			if ((rc = GCALab_BatchAddOp(b,n)) != GCALAB_SUCCESS)
+			{
+				/*drop it, nothing depends on it yet*/
+				b->num--;
+				free(b->nodes[n].succ.v);
+			}
+			else
+			{
+				return GCALAB_SUCCESS;
+			}
+		}
+	}
+	else if (!strcmp(argv[0],"print-ca") || !strcmp(argv[0],"print-st") || !strcmp(argv[0],"print-res"))
+	{
+		if (argc < 2)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+		else if (*lws < 0)
+		{
+			rc = GCALAB_INVALID_WS_ERROR;
+		}
+		else if ((n = GCALab_BatchNewNode(b,GCALAB_BATCH_WS_TEXT,argc,argv)) < 0)
+		{
+			rc = GCALAB_MEM_ERROR;
+		}
+		else
+		{
+			node = b->nodes + n;
+			node->lws = *lws;
+			if (strcmp(argv[0],"print-res"))
+			{
+				node->chain = GCALab_BatchFindChain(b,*lws,argv[1]);
+			}
+			if ((rc = GCALab_BatchWSBarrier(b,*lws,n)) == GCALAB_SUCCESS)
+			{
+				rc = GCALab_BatchAppend(&(b->since),n);
+			}
+			return rc;
+		}
+	}
+	else
+	{
+		if ((n = GCALab_BatchNewNode(b,GCALAB_BATCH_TEXT,argc,argv)) < 0)
+		{
+			rc = GCALAB_MEM_ERROR;
+		}
+		else
+		{
+			b->nodes[n].lws = *lws;
+			return GCALab_BatchBarrier(b,n);
+		}
+	}
+	GCALab_BatchFreeArgs(argc,argv);
+	return rc;
+}
+
+/**
+ * @brief Reads a batch script into a dependency graph.
+ * @details Lines that would fail when run (e.g., an operation on a GCA that
+ * does not exist yet) are reported and left out, and the batch is marked
+ * as failed. Reading stops at quit.
+ * @param b the graph to build
+ * @param filename the script
+ * @returns GCALAB_SUCCESS, or GCALAB_INVALID_OPTION if the script can not be read.
+ */
+char GCALab_ParseBatch(GCALab_Batch *b,char *filename)
+{
+	char **argv;
+	int argc,lws;
+	char rc;
+
+	memset((void *)b,0,sizeof(GCALab_Batch));
+	b->barrier = -1;
+	if (filename == NULL)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	if (!(b->ws = (GCALab_BatchWS *)calloc(GCALAB_MAX_WORKSPACES,sizeof(GCALab_BatchWS))))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	lws = -1;
+	argv = GCALab_ReadScriptCommand(filename,&argc);
+	if (argv == NULL && argc == 0)
+	{
+		free(b->ws);
+		b->ws = NULL;
+		return GCALAB_INVALID_OPTION;
+	}
+	while (argv != NULL)
+	{
+		if (argc > 0 && !strcmp(argv[0],"quit"))
+		{
+			GCALab_BatchFreeArgs(argc,argv);
+			break;
+		}
+		rc = GCALab_BatchAddLine(b,&lws,argc,argv);
+		if (rc <= 0)
+		{
+			b->failed = 1;
+			GCALab_HandleErr(rc);
+		}
+		argv = GCALab_ReadScriptCommand(NULL,&argc);
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Marks node n as done and makes the nodes waiting only on it ready.
+ * @param rc the return code of the node
+ * @param res_id the id of the node's result in the workspace it ran on, -1 if none
+ */
+static void GCALab_BatchFinish(GCALab_Batch *b,int n,char rc,int res_id)
+{
+	GCALab_BatchNode *node;
+	unsigned int i;
+	pthread_mutex_lock(&(b->lock));
+	node = b->nodes + n;
+	node->rc = rc;
+	node->res_id = res_id;
+	node->done = 1;
+	if (rc <= 0)
+	{
+		b->failed = 1;
+	}
+	for (i=0;i<node->succ.num;i++)
+	{
+		if (--(b->nodes[node->succ.v[i]].pending) == 0)
+		{
+			b->ready[b->readytail++] = node->succ.v[i];
+		}
+	}
+	b->numdone++;
+	pthread_cond_broadcast(&(b->cond));
+	pthread_mutex_unlock(&(b->lock));
+}
+
+/**
+ * @brief Completion callback of a queued operation (see GCALab_QueueCommandNotify()).
+ */
+static void GCALab_BatchDone(void *arg,char rc,int res_id)
+{
+	GCALab_BatchNode *node;
+	node = (GCALab_BatchNode *)arg;
+	GCALab_BatchFinish(node->batch,(int)(node - node->batch->nodes),rc,res_id);
+}
+
+/**
+ * @brief The workspace a script workspace runs its commands on, i.e., that of
+ * its first GCA.
+ */
+static unsigned char GCALab_BatchHomeWS(GCALab_Batch *b,int lws)
+{
+	if (lws >= 0 && b->ws[lws].chains.num > 0)
+	{
+		return b->chains[b->ws[lws].chains.v[0]].ws_id;
+	}
+	return b->ws0;
+}
+
+/**
+ * @brief Finds the k-th result of script workspace lws, counting the
+ * operations before node n in script order.
+ * @returns GCALAB_SUCCESS, or GCALAB_INVALID_OPTION if there is no such result.
+ */
+static char GCALab_BatchFindResult(GCALab_Batch *b,int n,int k,unsigned char *ws_id,int *res_id)
+{
+	int i;
+	for (i=0;i<n;i++)
+	{
+		if (b->nodes[i].kind == GCALAB_BATCH_OP && b->nodes[i].lws == b->nodes[n].lws && b->nodes[i].res_id >= 0)
+		{
+			if (k == 0)
+			{
+				*ws_id = b->nodes[i].ws_id;
+				*res_id = b->nodes[i].res_id;
+				return GCALAB_SUCCESS;
+			}
+			k--;
+		}
+	}
+	return GCALAB_INVALID_OPTION;
+}
+
+/**
+ * @brief Starts a ready node, operations are queued on the workspace of their
+ * GCA and commands are run straight away.
+ */
+static void GCALab_BatchStart(GCALab_Batch *b,int n)
+{
+	GCALab_BatchNode *node;
+	GCALab_BatchChain *chain;
+	char **argv;
+	unsigned char ws_id;
+	int trgt_id,i;
+	char rc;
+
+	node = b->nodes + n;
+	chain = (node->chain >= 0) ? b->chains + node->chain : NULL;
+	ws_id = (chain != NULL) ? chain->ws_id : GCALab_BatchHomeWS(b,node->lws);
+	trgt_id = (chain != NULL) ? (int)chain->gca_id : ((node->argc > 1) ? atoi(node->argv[1]) : 0);
+	rc = GCALAB_SUCCESS;
+	if (node->kind == GCALAB_BATCH_OP)
+	{
+		if (chain == NULL && node->cmd_id == GCALAB_SAVE)
+		{
+			rc = GCALab_BatchFindResult(b,n,atoi(node->argv[1]),&ws_id,&trgt_id);
+		}
+		node->ws_id = ws_id;
+		if (rc == GCALAB_SUCCESS)
+		{
+			rc = GCALab_QueueCommandNotify(ws_id,node->cmd_id,(unsigned int)trgt_id,node->argv+2,node->argc-2,
+				&GCALab_BatchDone,(void *)node);
+		}
+		if (rc == GCALAB_SUCCESS)
+		{
+			return;
+		}
+	}
+	else if (node->kind == GCALAB_BATCH_WS_TEXT)
+	{
+		if (!strcmp(node->argv[0],"print-res"))
+		{
+			rc = GCALab_BatchFindResult(b,n,atoi(node->argv[1]),&ws_id,&trgt_id);
+		}
+		else if (chain == NULL)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+		if (rc == GCALAB_SUCCESS && !strcmp(node->argv[0],"print-res"))
+		{
+			rc = GCALab_PrintResults(ws_id,(unsigned int)trgt_id);
+		}
+		else if (rc == GCALAB_SUCCESS && !strcmp(node->argv[0],"print-ca"))
+		{
+			rc = GCALab_PrintCA(ws_id,(unsigned int)trgt_id);
+		}
+		else if (rc == GCALAB_SUCCESS)
+		{
+			rc = GCALab_PrintSTP(ws_id,(unsigned int)trgt_id);
+		}
+	}
+	else
+	{
+		/*GCALab_Process_Command() frees its arguments*/
+		if (!(argv = (char **)malloc(node->argc*sizeof(char *))))
+		{
+			rc = GCALAB_MEM_ERROR;
+		}
+		for (i=0;rc == GCALAB_SUCCESS && i<node->argc;i++)
+		{
+			if (!(argv[i] = (char *)malloc(strlen(node->argv[i])+1)))
+			{
+				rc = GCALAB_MEM_ERROR;
+			}
+			else
+			{
+				strcpy(argv[i],node->argv[i]);
+			}
+		}
+		if (rc == GCALAB_SUCCESS)
+		{
+			cur_ws = ws_id;
+			rc = GCALab_Process_Command(node->argc,argv);
+		}
+	}
+	GCALab_HandleErr(rc);
+	GCALab_BatchFinish(b,n,rc,-1);
+}
+
+/**
+ * @brief Runs a batch and waits for it to finish.
+ * @details The GCAs of the script are dealt out round robin over
+ * min(jobs,number of GCAs) new workspaces, each may run as many commands at
+ * once as there are scheduler workers.
+ * @param b the graph built by GCALab_ParseBatch()
+ * @param jobs the max number of workspaces to use
+ * @returns GCALAB_BATCH_OK if every line succeeded, GCALAB_BATCH_FAILED otherwise.
+ */
+int GCALab_RunBatch(GCALab_Batch *b,unsigned int jobs)
+{
+	unsigned int numrun,i,count;
+	int n;
+	char rc;
+
+	numrun = (jobs < b->numchains) ? jobs : b->numchains;
+	if (numrun > GCALAB_MAX_WORKSPACES - GCALab_numWS)
+	{
+		numrun = GCALAB_MAX_WORKSPACES - GCALab_numWS;
+	}
+	if (numrun == 0)
+	{
+		numrun = 1;
+	}
+	b->ws0 = (unsigned char)GCALab_numWS;
+	b->numrun = numrun;
+	for (i=0;i<numrun;i++)
+	{
+		count = b->numchains/numrun + ((i < b->numchains%numrun) ? 1 : 0);
+		rc = GCALab_NewWorkSpace((count > 0) ? (int)count : 1,(int)GCALab_NumWorkers());
+		if (rc != GCALAB_SUCCESS)
+		{
+			GCALab_HandleErr(rc);
+			return GCALAB_BATCH_FAILED;
+		}
+	}
+	/*GCAs of a workspace are created in the order of their ids*/
+	for (i=0;i<b->numchains;i++)
+	{
+		b->chains[i].ws_id = b->ws0 + (unsigned char)(i%numrun);
+		b->chains[i].gca_id = i/numrun;
+		if (i >= numrun && GCALab_BatchDepend(b,b->chains[i-numrun].create,b->chains[i].create) != GCALAB_SUCCESS)
+		{
+			GCALab_HandleErr(GCALAB_MEM_ERROR);
+			return GCALAB_BATCH_FAILED;
+		}
+	}
+
+	if (!(b->ready = (int *)malloc((b->num + 1)*sizeof(int))))
+	{
+		GCALab_HandleErr(GCALAB_MEM_ERROR);
+		return GCALAB_BATCH_FAILED;
+	}
+	for (i=0;i<b->num;i++)
+	{
+		if (b->nodes[i].pending == 0)
+		{
+			b->ready[b->readytail++] = (int)i;
+		}
+	}
+	pthread_mutex_init(&(b->lock),NULL);
+	pthread_cond_init(&(b->cond),NULL);
+	pthread_mutex_lock(&(b->lock));
+	while (b->numdone < b->num)
+	{
+		if (b->readyhead == b->readytail)
+		{
+			pthread_cond_wait(&(b->cond),&(b->lock));
+			continue;
+		}
+		n = b->ready[b->readyhead++];
+		pthread_mutex_unlock(&(b->lock));
+		GCALab_BatchStart(b,n);
+		pthread_mutex_lock(&(b->lock));
+	}
+	pthread_mutex_unlock(&(b->lock));
+	return (b->failed) ? GCALAB_BATCH_FAILED : GCALAB_BATCH_OK;
+}
+
+/**
+ * @brief Frees a batch graph.
+ */
+void GCALab_FreeBatch(GCALab_Batch *b)
+{
+	unsigned int i;
+	for (i=0;i<b->num;i++)
+	{
+		GCALab_BatchFreeArgs(b->nodes[i].argc,b->nodes[i].argv);
+		free(b->nodes[i].succ.v);
+	}
+	for (i=0;i<b->numchains;i++)
+	{
+		free(b->chains[i].readers.v);
+	}
+	if (b->ws != NULL)
+	{
+		for (i=0;i<GCALAB_MAX_WORKSPACES;i++)
+		{
+			free(b->ws[i].chains.v);
+			free(b->ws[i].since.v);
+		}
+	}
+	free(b->nodes);
+	free(b->chains);
+	free(b->ws);
+	free(b->since.v);
+	free(b->files.v);
+	free(b->ready);
+}
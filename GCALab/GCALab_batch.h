@@ -0,0 +1,150 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_batch.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Batch script dependency graph definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_BATCH_H
+#define __GCALAB_BATCH_H
+
+#include <pthread.h>
+
+/*kinds of script line*/
+/*a compute operation*/
+#define GCALAB_BATCH_OP 		0
+/*a command on GCA or results of one script workspace (print-ca, print-st, print-res)*/
+#define GCALAB_BATCH_WS_TEXT 	1
+/*any other command, runs once everything before it is done*/
+#define GCALAB_BATCH_TEXT 		2
+
+/*batch exit status*/
+#define GCALAB_BATCH_OK 		0
+#define GCALAB_BATCH_FAILED 	1
+#define GCALAB_BATCH_NO_SCRIPT 	2
+
+typedef struct GCALab_BatchList_struct GCALab_BatchList;
+typedef struct GCALab_BatchNode_struct GCALab_BatchNode;
+typedef struct GCALab_BatchChain_struct GCALab_BatchChain;
+typedef struct GCALab_BatchWS_struct GCALab_BatchWS;
+typedef struct GCALab_Batch_struct GCALab_Batch;
+
+/*a growable list of node (or chain) indices*/
+struct GCALab_BatchList_struct
+{
+	int *v;
+	unsigned int num;
+	unsigned int cap;
+};
+
+/*one script line*/
+struct GCALab_BatchNode_struct
+{
+	unsigned char kind;
+	/*the words of the line, without any q-cmd prefix*/
+	char **argv;
+	int argc;
+	/*op-code, script workspace and GCA chain (-1 if it has none) of an operation*/
+	unsigned int cmd_id;
+	int lws;
+	int chain;
+	/*nodes that wait for this one, and the number of nodes this one waits for*/
+	GCALab_BatchList succ;
+	unsigned int pending;
+	/*where it ran, its return code and result id (-1 if none) once done*/
+	unsigned char ws_id;
+	char rc;
+	int res_id;
+	unsigned char done;
+	struct GCALab_Batch_struct *batch;
+};
+
+/*The GCAs of a script
+ *
+ * Every gca or load operation starts a new chain, the operations on that GCA
+ * follow it. Chains are dealt out round robin to the workspaces the batch runs
+ * on, so the GCA of a chain has a different id (and workspace) than in the script.
+ */
+struct GCALab_BatchChain_struct
+{
+	int lws;
+	/*the creating node, the last writer and the readers since then*/
+	int create;
+	int writer;
+	GCALab_BatchList readers;
+	/*workspace and GCA id the chain runs on*/
+	unsigned char ws_id;
+	unsigned int gca_id;
+};
+
+/*a workspace as seen by the script*/
+struct GCALab_BatchWS_struct
+{
+	/*chains in order of creation, i.e., indexed by the script's GCA ids*/
+	GCALab_BatchList chains;
+	/*the last node that waited for everything before it, and the nodes since*/
+	int barrier;
+	GCALab_BatchList since;
+};
+
+/*A batch script as a dependency graph
+ *
+ * Reads of a GCA wait for its last writer, writes wait for the last writer and
+ * the reads since. Exclusive operations (e.g., save) and commands that print a
+ * workspace wait for everything before them in their script workspace, other
+ * commands wait for everything before them. Operations that name a file wait
+ * for the earlier ones, so a GCA saved in one workspace can be loaded in another.
+ */
+struct GCALab_Batch_struct
+{
+	GCALab_BatchNode *nodes;
+	unsigned int num;
+	unsigned int cap;
+	GCALab_BatchChain *chains;
+	unsigned int numchains;
+	unsigned int capchains;
+	/*script workspaces (up to GCALAB_MAX_WORKSPACES)*/
+	GCALab_BatchWS *ws;
+	unsigned int numws;
+	/*nodes since the last one that waited for everything*/
+	int barrier;
+	GCALab_BatchList since;
+	/*operations that name a file (-f), they run in script order*/
+	GCALab_BatchList files;
+	/*workspaces the batch runs on*/
+	unsigned char ws0;
+	unsigned int numrun;
+	/*nodes ready to run (FIFO) and the number done*/
+	int *ready;
+	unsigned int readyhead;
+	unsigned int readytail;
+	unsigned int numdone;
+	unsigned char failed;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+char GCALab_ParseBatch(GCALab_Batch *b,char *filename);
+int GCALab_RunBatch(GCALab_Batch *b,unsigned int jobs);
+void GCALab_FreeBatch(GCALab_Batch *b);
+
+#endif
@@ -0,0 +1,256 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_cache.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Persistent cache of measure results. Results are keyed by 
+ *              (topology, canonical rule, measure, parameters) so that a measure
+ *              is only ever computed once per rule equivalence class.
+ *
+ *==============================================================================
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include "GCALab.h"
+
+/**
+ * @brief Hashes a block of memory, chained through h.
+ */
+unsigned long long GCALab_Hash(unsigned long long h,const void *data,size_t len)
+{
+	const unsigned char *bytes;
+	size_t i;
+	bytes = (const unsigned char *)data;
+	for (i=0;i<len;i++)
+	{
+		h ^= (unsigned long long)bytes[i];
+		h *= GCALAB_HASH_PRIME;
+	}
+	return h;
+}
+
+/**
+ * @brief Hashes everything about a GCA that measures depend on other than the rule.
+ *
+ * @details This is the number of cells, neighbourhood size, number of states, window
+ * size and the graph itself.
+ */
+unsigned long long GCALab_HashTopology(GraphCellularAutomaton *GCA)
+{
+	unsigned long long h;
+	unsigned int hdr[4];
+	hdr[0] = GCA->params->N;
+	hdr[1] = GCA->params->k;
+	hdr[2] = (unsigned int)GCA->params->s;
+	hdr[3] = GCA->params->WSIZE;
+	h = GCALab_Hash(GCALAB_HASH_INIT,(void*)hdr,4*sizeof(unsigned int));
+	return GCALab_Hash(h,(void*)GCA->params->graph,(GCA->params->N)*(GCA->params->k-1)*sizeof(unsigned int));
+}
+
+/**
+ * @brief Finds the slot of a key, or the empty slot it would go in.
+ */
+static unsigned int GCALab_CacheSlot(GCALab_Cache *cache,GCALab_CacheRecord *rec)
+{
+	unsigned long long h;
+	unsigned int i;
+	h = rec->topo ^ (rec->rule*GCALAB_HASH_PRIME) ^ (rec->params*31) ^ rec->measure;
+	i = (unsigned int)(h ^ (h >> 32)) & (cache->size - 1);
+	while (cache->used[i])
+	{
+		GCALab_CacheRecord *r;
+		r = cache->table + i;
+		if (r->topo == rec->topo && r->rule == rec->rule && r->params == rec->params && r->measure == rec->measure)
+		{
+			break;
+		}
+		i = (i + 1) & (cache->size - 1);
+	}
+	return i;
+}
+
+/**
+ * @brief Inserts a record into the table, growing it if more than half full.
+ */
+static char GCALab_CacheInsert(GCALab_Cache *cache,GCALab_CacheRecord *rec)
+{
+	unsigned int i;
+	if (2*(cache->count + 1) > cache->size)
+	{
+		GCALab_CacheRecord *table;
+		unsigned char *used;
+		unsigned int size;
+		size = cache->size;
+		table = cache->table;
+		used = cache->used;
+		cache->table = (GCALab_CacheRecord *)malloc(2*size*sizeof(GCALab_CacheRecord));
+		cache->used = (unsigned char *)malloc(2*size*sizeof(unsigned char));
+		if (cache->table == NULL || cache->used == NULL)
+		{
+			free(cache->table);
+			free(cache->used);
+			cache->table = table;
+			cache->used = used;
+			return GCALAB_MEM_ERROR;
+		}
+		memset(cache->used,0,2*size*sizeof(unsigned char));
+		cache->size = 2*size;
+		for (i=0;i<size;i++)
+		{
+			if (used[i])
+			{
+				unsigned int j;
+				j = GCALab_CacheSlot(cache,table + i);
+				cache->table[j] = table[i];
+				cache->used[j] = 1;
+			}
+		}
+		free(table);
+		free(used);
+	}
+	i = GCALab_CacheSlot(cache,rec);
+	if (!cache->used[i])
+	{
+		cache->count++;
+	}
+	cache->table[i] = *rec;
+	cache->used[i] = 1;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Opens a cache file, creating it if it does not exist.
+ *
+ * @details A truncated final record (e.g., from an interrupted write) is ignored.
+ *
+ * @param filename The cache file.
+ *
+ * @returns The cache, or NULL if the file could not be opened or is not a cache file.
+ */
+GCALab_Cache *GCALab_OpenCache(const char *filename)
+{
+	GCALab_Cache *cache;
+	GCALab_CacheRecord rec;
+	char magic[GCALAB_CACHE_MAGIC_LEN];
+	ssize_t nread;
+
+	cache = (GCALab_Cache *)malloc(sizeof(GCALab_Cache));
+	if (cache == NULL)
+	{
+		return NULL;
+	}
+	pthread_mutex_init(&(cache->lock),NULL);
+	cache->size = GCALAB_CACHE_INIT_SIZE;
+	cache->count = 0;
+	cache->table = (GCALab_CacheRecord *)malloc((cache->size)*sizeof(GCALab_CacheRecord));
+	cache->used = (unsigned char *)malloc((cache->size)*sizeof(unsigned char));
+	cache->fd = open(filename,O_RDWR | O_CREAT | O_APPEND,0644);
+	if (cache->table == NULL || cache->used == NULL || cache->fd < 0)
+	{
+		GCALab_CloseCache(cache);
+		return NULL;
+	}
+	memset(cache->used,0,(cache->size)*sizeof(unsigned char));
+
+	nread = read(cache->fd,(void*)magic,GCALAB_CACHE_MAGIC_LEN);
+	if (nread == 0)
+	{
+		/*new file*/
+		if (write(cache->fd,(void*)GCALAB_CACHE_MAGIC,GCALAB_CACHE_MAGIC_LEN) != GCALAB_CACHE_MAGIC_LEN)
+		{
+			GCALab_CloseCache(cache);
+			return NULL;
+		}
+		return cache;
+	}
+	if (nread != GCALAB_CACHE_MAGIC_LEN || memcmp(magic,GCALAB_CACHE_MAGIC,GCALAB_CACHE_MAGIC_LEN))
+	{
+		GCALab_CloseCache(cache);
+		return NULL;
+	}
+	while (read(cache->fd,(void*)&rec,sizeof(GCALab_CacheRecord)) == sizeof(GCALab_CacheRecord))
+	{
+		if (GCALab_CacheInsert(cache,&rec) <= 0)
+		{
+			GCALab_CloseCache(cache);
+			return NULL;
+		}
+	}
+	return cache;
+}
+
+/**
+ * @brief Looks up a result.
+ *
+ * @param cache The cache.
+ * @param rec The key, on success rec->value is set.
+ *
+ * @retval 1 if the result was found.
+ * @retval 0 otherwise.
+ */
+unsigned char GCALab_CacheLookup(GCALab_Cache *cache,GCALab_CacheRecord *rec)
+{
+	unsigned int i;
+	unsigned char found;
+	pthread_mutex_lock(&(cache->lock));
+	i = GCALab_CacheSlot(cache,rec);
+	found = cache->used[i];
+	if (found)
+	{
+		rec->value = cache->table[i].value;
+	}
+	pthread_mutex_unlock(&(cache->lock));
+	return found;
+}
+
+/**
+ * @brief Stores a result in memory and appends it to the cache file.
+ */
+char GCALab_CacheStore(GCALab_Cache *cache,GCALab_CacheRecord *rec)
+{
+	char rc;
+	pthread_mutex_lock(&(cache->lock));
+	rc = GCALab_CacheInsert(cache,rec);
+	if (rc > 0 && write(cache->fd,(void*)rec,sizeof(GCALab_CacheRecord)) != sizeof(GCALab_CacheRecord))
+	{
+		rc = GCALAB_INVALID_OPTION;
+	}
+	pthread_mutex_unlock(&(cache->lock));
+	return rc;
+}
+
+/**
+ * @brief Closes the cache file and frees the cache.
+ */
+void GCALab_CloseCache(GCALab_Cache *cache)
+{
+	if (cache == NULL)
+	{
+		return;
+	}
+	if (cache->fd >= 0)
+	{
+		close(cache->fd);
+	}
+	pthread_mutex_destroy(&(cache->lock));
+	free(cache->table);
+	free(cache->used);
+	free(cache);
+}
@@ -0,0 +1,84 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_cache.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Persistent cache of measure results definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_CACHE_H
+#define __GCALAB_CACHE_H
+
+#include <pthread.h>
+#include "GCA.h"
+
+#ifndef GCALAB_CACHE_INIT_SIZE
+/*initial number of hash table slots (a power of 2)*/
+#define GCALAB_CACHE_INIT_SIZE 1024
+#endif
+
+/*identifies the file format*/
+#define GCALAB_CACHE_MAGIC "GCACACHE"
+#define GCALAB_CACHE_MAGIC_LEN 8
+
+/*FNV-1a 64 bit*/
+#define GCALAB_HASH_INIT 0xcbf29ce484222325ULL
+#define GCALAB_HASH_PRIME 0x100000001b3ULL
+
+/*one cached result, this is also the record layout in the file*/
+typedef struct
+{
+	/*hash of the topology, see GCALab_HashTopology()*/
+	unsigned long long topo;
+	/*hash of the canonical rule table*/
+	unsigned long long rule;
+	/*hash of the measure parameters (samples, seed, etc.)*/
+	unsigned long long params;
+	unsigned int measure;
+	float value;
+} GCALab_CacheRecord;
+
+typedef struct GCALab_Cache_struct GCALab_Cache;
+
+/*A persistent measure cache
+ *
+ * Records are appended to the cache file as they are stored, so a cache survives
+ * an interrupted sweep. All records are loaded into an open addressing hash table
+ * when the file is opened. Lookups and stores are thread safe.
+ */
+struct GCALab_Cache_struct
+{
+	int fd;
+	GCALab_CacheRecord *table;
+	unsigned char *used;
+	unsigned int size;
+	unsigned int count;
+	pthread_mutex_t lock;
+};
+
+unsigned long long GCALab_Hash(unsigned long long h,const void *data,size_t len);
+unsigned long long GCALab_HashTopology(GraphCellularAutomaton *GCA);
+GCALab_Cache *GCALab_OpenCache(const char *filename);
+unsigned char GCALab_CacheLookup(GCALab_Cache *cache,GCALab_CacheRecord *rec);
+char GCALab_CacheStore(GCALab_Cache *cache,GCALab_CacheRecord *rec);
+void GCALab_CloseCache(GCALab_Cache *cache);
+
+#endif
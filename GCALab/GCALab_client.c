@@ -0,0 +1,216 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_client.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Client for the GCALab job server. Sends commands from a script
+ *              (or stdin) to a server started with gcalab -d and prints the
+ *              output and results as they come back.
+ *
+ *              usage: gcalab-client [-v] socket [script]
+ *
+ *              Exits with 0 if every command succeeded, 1 if any failed and
+ *              2 if the server could not be reached.
+ *
+ *==============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "GCALab_server.h"
+
+#define GCALAB_CLIENT_BUFSIZE 65536
+
+/**
+ * @brief Writes all of buf.
+ * @returns 0 on success, -1 on error.
+ */
+static int GCALab_WriteAll(int fd,char *buf,size_t len)
+{
+	ssize_t n;
+	while (len > 0)
+	{
+		n = write(fd,buf,len);
+		if (n < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (n <= 0)
+		{
+			return -1;
+		}
+		buf += n;
+		len -= (size_t)n;
+	}
+	return 0;
+}
+
+/**
+ * @brief Prints a line from the server, protocol lines are checked for failed
+ * commands and only shown if verbose (results always are).
+ * @returns 1 if the line reports a failed command, 0 otherwise.
+ */
+static int GCALab_ClientLine(char *line,int verbose)
+{
+	unsigned int seq;
+	int rc,res_id;
+	if (line[0] != GCALAB_SERVER_TAG)
+	{
+		fputs(line,stdout);
+		return 0;
+	}
+	rc = 1;
+	if (sscanf(line+1,"done %u %d %d",&seq,&rc,&res_id) == 3)
+	{
+		fputs(line,stdout);
+	}
+	else
+	{
+		sscanf(line+1,"ok %d",&rc);
+		if (verbose)
+		{
+			fputs(line,stdout);
+		}
+	}
+	return (rc <= 0);
+}
+
+/**
+ * @brief entry point of the GCALab client
+ */
+int main(int argc,char **argv)
+{
+	struct sockaddr_un addr;
+	struct pollfd fds[2];
+	char inbuf[GCALAB_CLIENT_BUFSIZE];
+	char *outbuf,*line,*nl;
+	size_t outlen,outcap;
+	ssize_t n;
+	int fd,in,verbose,failed,i;
+	char c;
+
+	verbose = 0;
+	i = 1;
+	if (i < argc && !strcmp(argv[i],"-v"))
+	{
+		verbose = 1;
+		i++;
+	}
+	if (i >= argc || strlen(argv[i]) >= sizeof(addr.sun_path))
+	{
+		fprintf(stderr,"usage: %s [-v] socket [script]\n",argv[0]);
+		return 2;
+	}
+	in = STDIN_FILENO;
+	if (i+1 < argc && (in = open(argv[i+1],O_RDONLY)) < 0)
+	{
+		perror(argv[i+1]);
+		return 2;
+	}
+	memset((void *)&addr,0,sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path,argv[i]);
+	if ((fd = socket(AF_UNIX,SOCK_STREAM,0)) < 0 || connect(fd,(struct sockaddr *)&addr,sizeof(addr)) < 0)
+	{
+		perror(argv[i]);
+		return 2;
+	}
+
+	outcap = GCALAB_CLIENT_BUFSIZE;
+	if (!(outbuf = (char *)malloc(outcap)))
+	{
+		return 2;
+	}
+	outlen = 0;
+	failed = 0;
+	fds[0].fd = fd;
+	fds[0].events = POLLIN;
+	fds[1].fd = in;
+	fds[1].events = POLLIN;
+	while (1)
+	{
+		if (poll(fds,(fds[1].fd >= 0) ? 2 : 1,-1) < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			break;
+		}
+		/*commands are passed on as they are, the server splits the lines*/
+		if (fds[1].fd >= 0 && (fds[1].revents & (POLLIN | POLLHUP)))
+		{
+			n = read(in,inbuf,GCALAB_CLIENT_BUFSIZE);
+			if (n > 0 && GCALab_WriteAll(fd,inbuf,(size_t)n) == 0)
+			{
+				continue;
+			}
+			/*end of the commands, the server finishes them and hangs up*/
+			shutdown(fd,SHUT_WR);
+			fds[1].fd = -1;
+		}
+		if (!(fds[0].revents & (POLLIN | POLLHUP)))
+		{
+			continue;
+		}
+		if (outcap - outlen < GCALAB_CLIENT_BUFSIZE)
+		{
+			outcap *= 2;
+			if (!(line = (char *)realloc(outbuf,outcap)))
+			{
+				break;
+			}
+			outbuf = line;
+		}
+		n = read(fd,outbuf + outlen,outcap - outlen - 1);
+		if (n <= 0)
+		{
+			break;
+		}
+		outlen += (size_t)n;
+		outbuf[outlen] = '\0';
+		line = outbuf;
+		while ((nl = strchr(line,'\n')) != NULL)
+		{
+			c = nl[1];
+			nl[1] = '\0';
+			failed |= GCALab_ClientLine(line,verbose);
+			nl[1] = c;
+			line = nl + 1;
+		}
+		outlen -= (size_t)(line - outbuf);
+		memmove(outbuf,line,outlen);
+	}
+	if (outlen > 0)
+	{
+		outbuf[outlen] = '\0';
+		failed |= GCALab_ClientLine(outbuf,verbose);
+	}
+	fflush(stdout);
+	free(outbuf);
+	close(fd);
+	return (failed) ? 1 : 0;
+}
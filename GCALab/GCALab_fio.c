@@ -30,10 +30,144 @@
  *==============================================================================
  */
  
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "GCALab_fio.h"
 char *GCALab_fio_format[14] = {"%f","%lf","%hhu","%hu","%u","%llu","%hhd","%hd","%d","%lld","%hhx","%hx","%x","%llx"};
+/*names and numpy dtypes (without byte order) of the data types*/
+static char *GCALab_fio_typeName[14] = {"FLOAT32","FLOAT64","UINT8","UINT16","UINT32","UINT64","SINT8","SINT16","SINT32","SINT64","HEX8","HEX16","HEX32","HEX64"};
+static char *GCALab_fio_dtype[14] = {"f4","f8","u1","u2","u4","u8","i1","i2","i4","i8","u1","u2","u4","u8"};
+static unsigned char GCALab_fio_typeSize[14] = {4,8,1,2,4,8,1,2,4,8,1,2,4,8};
 unsigned char cellCols[8][3] = {{0,0,0},{255,255,255},{255,0,0},{0,255,0},{255,0,0},{255,0,255},{255,255,0},{0,255,255}};
 
+/** 
+ * @brief Reverses the bits of a byte.
+ */
+static unsigned char GCALab_fio_reverse(unsigned char b)
+{
+	b = (unsigned char)(((b & 0xF0) >> 4) | ((b & 0x0F) << 4));
+	b = (unsigned char)(((b & 0xCC) >> 2) | ((b & 0x33) << 2));
+	return (unsigned char)(((b & 0xAA) >> 1) | ((b & 0x55) << 1));
+}
+
+/**
+ * @brief Creates a space-time pattern image and writes its headers and palette.
+ *
+ * @param stp The writer to initialise.
+ * @param filename The bitmap file to write.
+ * @param N The number of cells, i.e., the width of the image.
+ * @param s The number of cell states.
+ * @param height The number of rows (time steps).
+ *
+ * @retval WRITE_SUCCESS if the image is ready for its rows.
+ * @retval WRITE_FAILED if the file could not be written.
+ * @retval OUT_OF_MEMORY if memory could not be allocated.
+ */
+char GCALab_fio_openSTP(GCALab_STPWriter *stp,char *filename,unsigned int N,unsigned int s,unsigned int height)
+{
+	PALETTE pal;
+	uint32_t colours[256];
+	unsigned int i;
+	uint16_t depth;
+
+	for (stp->log2s=0;s >>= 1;stp->log2s++);
+	if (stp->log2s == 0 || stp->log2s > 8)
+	{
+		return WRITE_FAILED;
+	}
+	depth = (stp->log2s == 1) ? 1 : (stp->log2s <= 4) ? 4 : 8;
+	pal.size = 1 << stp->log2s;
+	for (i=0;i<pal.size;i++)
+	{
+		colours[i] = ((uint32_t)cellCols[i & 7][0] << 16) | ((uint32_t)cellCols[i & 7][1] << 8) | (uint32_t)cellCols[i & 7][2];
+	}
+	pal.colours = colours;
+	stp->N = N;
+	stp->row = NULL;
+	if (!(stp->bmp = CreateBMPFILE_Indexed(filename,N,height,depth,&pal)))
+	{
+		return OUT_OF_MEMORY;
+	}
+	if (!(stp->row = (uint8_t *)malloc(BMP_RowSize(stp->bmp))))
+	{
+		DestroyBMPFILE(stp->bmp);
+		return OUT_OF_MEMORY;
+	}
+	if (BMP_OpenBitMap(stp->bmp,"wb") != NO_ERRORS)
+	{
+		DestroyBMPFILE(stp->bmp);
+		free(stp->row);
+		return WRITE_FAILED;
+	}
+	if (BMP_WriteHeaders(stp->bmp) != NO_ERRORS || BMP_WriteColourPalette(stp->bmp) != NO_ERRORS)
+	{
+		BMP_CloseBitMap(stp->bmp);
+		DestroyBMPFILE(stp->bmp);
+		free(stp->row);
+		return WRITE_FAILED;
+	}
+	return WRITE_SUCCESS;
+}
+
+/**
+ * @brief Writes a configuration as row y of a space-time pattern image.
+ *
+ * @details For s = 2 the packed configuration is copied a byte at a time, only
+ * the bit order within each byte differs.
+ *
+ * @retval WRITE_SUCCESS if the row was written.
+ * @retval WRITE_FAILED otherwise.
+ */
+char GCALab_fio_writeSTPRow(GCALab_STPWriter *stp,unsigned int y,chunk *config)
+{
+	unsigned int i,p,nbytes,depth;
+	state st;
+
+	memset((void *)(stp->row),0,BMP_RowSize(stp->bmp));
+	if (stp->log2s == 1)
+	{
+		/*cells are packed from the low bit, pixels from the high bit*/
+		nbytes = (stp->N + 7)/8;
+		for (i=0;i<nbytes;i++)
+		{
+			stp->row[i] = GCALab_fio_reverse((unsigned char)(config[i/(CHUNK_SIZE_BITS/8)] >> (8*(i%(CHUNK_SIZE_BITS/8)))));
+		}
+		if (stp->N % 8)
+		{
+			stp->row[nbytes-1] &= (uint8_t)(0xFF << (8 - stp->N % 8));
+		}
+	}
+	else
+	{
+		depth = stp->bmp->bmpInfoHeader->colorDepth;
+		p = CHUNK_SIZE_BITS/stp->log2s;
+		for (i=0;i<stp->N;i++)
+		{
+			st = (config[i/p] >> ((i%p)*(stp->log2s))) & ((0x1 << stp->log2s) - 1);
+			stp->row[(i*depth)/8] |= (uint8_t)(st << (8 - depth - (i*depth)%8));
+		}
+	}
+	return (BMP_WriteRow(stp->bmp,y,stp->row) == NO_ERRORS) ? WRITE_SUCCESS : WRITE_FAILED;
+}
+
+/**
+ * @brief Closes a space-time pattern image.
+ *
+ * @retval WRITE_SUCCESS if the file was closed.
+ * @retval WRITE_FAILED otherwise.
+ */
+char GCALab_fio_closeSTP(GCALab_STPWriter *stp)
+{
+	ERROR err;
+	err = BMP_CloseBitMap(stp->bmp);
+	DestroyBMPFILE(stp->bmp);
+	free(stp->row);
+	return (err == NO_ERRORS) ? WRITE_SUCCESS : WRITE_FAILED;
+}
+
 /** @brief Writes CA data to a file
  *
  * @param filename the file to write to.
@@ -48,7 +182,8 @@ char GCALab_fio_saveCA(char *filename,GraphCellularAutomaton *GCA,mesh *m)
 	FILE* fp;
 	unsigned int i,j;
 	char lutfile[255],meshfile[255],graphfile[255],stpfile[255];
-	BMPImage *image;
+	GCALab_STPWriter stp;
+	char rc;
 	if (!(fp = fopen(filename,"w")))
 	{
 		return WRITE_FAILED;
@@ -104,52 +239,21 @@ char GCALab_fio_saveCA(char *filename,GraphCellularAutomaton *GCA,mesh *m)
 		SaveMesh(meshfile,m,OFF_FORMAT);
 	}
 
-	image = (BMPImage *)malloc(sizeof(BMPImage));
-	if (!image)
-	{
-		return WRITE_FAILED; 
-	}
-	image->height = (unsigned long int)GCA->params->WSIZE;
-	image->width = (unsigned long int)(GCA->params->N);
-	image->RGB = (unsigned char **)malloc(image->height*sizeof(unsigned char *));
-	if (!(image->RGB))
+	if (GCALab_fio_openSTP(&stp,stpfile,GCA->params->N,GCA->params->s,GCA->params->WSIZE) != WRITE_SUCCESS)
 	{
 		return WRITE_FAILED;
 	}
-	for (i=0;i<image->height;i++)
+	/*the current configuration is the bottom row*/
+	rc = WRITE_SUCCESS;
+	for (i=0;i<GCA->params->WSIZE && rc == WRITE_SUCCESS;i++)
 	{
-		image->RGB[i] = (unsigned char *)malloc(image->width*sizeof(unsigned char)*3);
-		if (!(image->RGB[i]))
-		{
-			return WRITE_FAILED;
-		}
+		rc = GCALab_fio_writeSTPRow(&stp,i,GetWindowRow(GCA,i));
 	}
-	for (i=GCA->params->WSIZE-1;i>0;i--)
+	if (GCALab_fio_closeSTP(&stp) != WRITE_SUCCESS)
 	{
-		for (j=0;j<GCA->params->N;j++)
-		{
-			unsigned char *col;
-			col = cellCols[GetCellStatePacked(GCA,j,i)];
-			image->RGB[i][j*3] = col[0];
-			image->RGB[i][j*3+1] = col[1];
-			image->RGB[i][j*3+2] = col[2];
-		}
-	}
-	for (j=0;j<GCA->params->N;j++)
-	{
-		unsigned char *col;
-		col = cellCols[GetCellStatePacked(GCA,j,i)];
-		image->RGB[i][j*3] = col[0];
-		image->RGB[i][j*3+1] = col[1];
-		image->RGB[i][j*3+2] = col[2];
+		rc = WRITE_FAILED;
 	}
-	WriteBMP(stpfile,image);
-	for (j=0;j<image->height;j++) 
-		free(image->RGB[j]);
-	free(image->RGB);
-	free(image);
-
-	return WRITE_SUCCESS;
+	return rc;
 };
 
 /**
@@ -334,11 +438,562 @@ char GCALab_fio_saveData(char* filename,char * name, void * data, int N,unsigned
 	return WRITE_SUCCESS;
 }
 
+/**
+ * @brief The numpy dtype of a data type, in the byte order of the host.
+ */
+static void GCALab_fio_descr(unsigned char type,char *descr)
+{
+	unsigned int one;
+	one = 1;
+	descr[0] = (GCALab_fio_typeSize[type] == 1) ? '|' : ((*(unsigned char *)&one) ? '<' : '>');
+	strcpy(descr+1,GCALab_fio_dtype[type]);
+}
+
+/**
+ * @brief Write data variable to a numpy .npy file, or a raw file with no header.
+ *
+ * @details The array is one dimensional, in the byte order of the host, and
+ * written with a single fwrite() so large results go straight to the file.
+ *
+ * @param filename the name of the file to save
+ * @param data pointer to memory containing data
+ * @param N the number of data elements
+ * @param type data type of element, HEXn types are written as unsigned integers
+ * @param raw write the data only, if non-zero
+ * @param offset set to the offset of the data in the file (can be NULL)
+ * @retVal WRITE_SUCCESS on completion.
+ * @retVal WRITE_FAILED on error.
+ */
+char GCALab_fio_saveNPY(char *filename,void *data,unsigned int N,unsigned char type,unsigned char raw,unsigned long long *offset)
+{
+	FILE *fp;
+	char hdr[128];
+	char descr[4];
+	unsigned short hlen;
+	size_t n,len;
+	char rc;
+
+	if (type > HEX64)
+	{
+		return WRITE_FAILED;
+	}
+	if (!(fp = fopen(filename,"wb")))
+	{
+		return WRITE_FAILED;
+	}
+	len = 0;
+	rc = WRITE_SUCCESS;
+	if (!raw)
+	{
+		/*magic, version 1.0, header length, then the header padded so the data is aligned*/
+		GCALab_fio_descr(type,descr);
+		memcpy(hdr,"\x93NUMPY\x01\x00",8);
+		n = 10 + sprintf(hdr+10,"{'descr': '%s', 'fortran_order': False, 'shape': (%u,), }",descr,N);
+		len = (n + 1 + GCALAB_NPY_ALIGN - 1) & ~((size_t)GCALAB_NPY_ALIGN - 1);
+		memset(hdr+n,' ',len-n-1);
+		hdr[len-1] = '\n';
+		hlen = (unsigned short)(len - 10);
+		hdr[8] = (char)(hlen & 0xFF);
+		hdr[9] = (char)(hlen >> 8);
+		if (fwrite(hdr,len,1,fp) != 1)
+		{
+			rc = WRITE_FAILED;
+		}
+	}
+	n = (size_t)N*GCALab_fio_typeSize[type];
+	if (rc == WRITE_SUCCESS && n > 0 && fwrite(data,n,1,fp) != 1)
+	{
+		rc = WRITE_FAILED;
+	}
+	if (fclose(fp) != 0)
+	{
+		rc = WRITE_FAILED;
+	}
+	if (offset != NULL)
+	{
+		*offset = (unsigned long long)len;
+	}
+	return rc;
+}
+
+/**
+ * @brief Writes a JSON string, escaped.
+ */
+static void GCALab_fio_jsonString(FILE *fp,char *str)
+{
+	unsigned char c;
+	fputc('"',fp);
+	for (;(c = (unsigned char)*str) != '\0';str++)
+	{
+		if (c == '"' || c == '\\')
+		{
+			fprintf(fp,"\\%c",c);
+		}
+		else if (c < 0x20)
+		{
+			fprintf(fp,"\\u%04x",c);
+		}
+		else
+		{
+			fputc(c,fp);
+		}
+	}
+	fputc('"',fp);
+}
+
+/**
+ * @brief Writes the JSON description of exported arrays.
+ *
+ * @details Each array is described by its result id and name, data type, numpy
+ * dtype, shape, file (relative to the description) and the offset of the data
+ * in the file, so raw and .npy files can both be mapped directly.
+ *
+ * @param filename the name of the JSON file
+ * @param arrays the exported arrays
+ * @param n the number of arrays
+ * @retVal WRITE_SUCCESS on completion.
+ * @retVal WRITE_FAILED on error.
+ */
+char GCALab_fio_saveNPYMeta(char *filename,GCALab_NPYArray *arrays,unsigned int n)
+{
+	FILE *fp;
+	char descr[4];
+	char *base;
+	unsigned int i;
+
+	if (!(fp = fopen(filename,"w")))
+	{
+		return WRITE_FAILED;
+	}
+	fprintf(fp,"{\n  \"format\": \"%s\",\n  \"arrays\": [",(n > 0 && arrays[0].raw) ? "raw" : "npy");
+	for (i=0;i<n;i++)
+	{
+		GCALab_fio_descr(arrays[i].type,descr);
+		base = strrchr(arrays[i].file,'/');
+		base = (base != NULL) ? base+1 : arrays[i].file;
+		fprintf(fp,"%s\n    {\"id\": %u, \"name\": ",(i > 0) ? "," : "",arrays[i].id);
+		GCALab_fio_jsonString(fp,arrays[i].name);
+		fprintf(fp,", \"type\": \"%s\", \"dtype\": \"%s\", \"shape\": [%u], \"file\": ",
+			GCALab_fio_typeName[arrays[i].type],descr,arrays[i].N);
+		GCALab_fio_jsonString(fp,base);
+		fprintf(fp,", \"offset\": %llu}",arrays[i].offset);
+	}
+	fprintf(fp,"\n  ]\n}\n");
+	if (ferror(fp))
+	{
+		fclose(fp);
+		return WRITE_FAILED;
+	}
+	return (fclose(fp) == 0) ? WRITE_SUCCESS : WRITE_FAILED;
+}
+
+/**
+ * @brief Pads the binary container from offset up to the start of the next section.
+ */
+static char GCALab_fio_pad(FILE *fp,unsigned long long *offset)
+{
+	static const char zeros[GCALAB_GCA_ALIGN] = {0};
+	unsigned long long pad;
+	pad = (GCALAB_GCA_ALIGN - (*offset) % GCALAB_GCA_ALIGN) % GCALAB_GCA_ALIGN;
+	if (pad > 0 && fwrite((void *)zeros,(size_t)pad,1,fp) != 1)
+	{
+		return WRITE_FAILED;
+	}
+	*offset += pad;
+	return WRITE_SUCCESS;
+}
+
+/**
+ * @brief Writes a section of the binary container at offset.
+ */
+static char GCALab_fio_writeSection(FILE *fp,GCALab_GCASection *sec,void *data,unsigned long long len,unsigned long long *offset)
+{
+	sec->offset = (len > 0) ? *offset : 0;
+	sec->len = len;
+	if (len > 0 && fwrite(data,(size_t)len,1,fp) != 1)
+	{
+		return WRITE_FAILED;
+	}
+	*offset += len;
+	return GCALab_fio_pad(fp,offset);
+}
+
+/** @brief Writes a GCA as a binary container at the current position of a file.
+ *
+ * @details Section offsets are relative to the start of the container, so a
+ * container can be embedded in a larger file (see GCALab_snap.c) and mapped from
+ * there with GCALab_fio_mapCABin().
+ *
+ * @param fp the file, left positioned at the end of the container.
+ * @param GCA Graph Cellular Automaton to write.
+ * @param m geometry of the CA topology (can be NULL).
+ * @param len set to the length of the container.
+ * @retVal WRITE_SUCCESS on completion.
+ * @retVal WRITE_FAILED on error.
+ */
+char GCALab_fio_writeCABin(FILE *fp,GraphCellularAutomaton *GCA,mesh *m,unsigned long long *len)
+{
+	GCALab_GCAHeader hdr;
+	unsigned long long offset,rowlen;
+	off_t start;
+	unsigned int i;
+	char rc;
+
+	if (GCA == NULL || (start = ftello(fp)) < 0)
+	{
+		return WRITE_FAILED;
+	}
+	memset((void *)&hdr,0,sizeof(GCALab_GCAHeader));
+	memcpy(hdr.magic,GCALAB_GCA_MAGIC,GCALAB_GCA_MAGIC_LEN);
+	hdr.version = GCALAB_GCA_VERSION;
+	hdr.chunkbits = CHUNK_SIZE_BITS;
+	hdr.N = GCA->params->N;
+	hdr.WSIZE = GCA->params->WSIZE;
+	hdr.rule = GCA->params->rule;
+	hdr.t = GCA->t;
+	hdr.s = GCA->params->s;
+	hdr.rule_type = GCA->params->rule_type;
+	hdr.k = GCA->params->k;
+	hdr.size = GCA->size;
+	if (m != NULL)
+	{
+		hdr.numVerts = m->vList->numVerts;
+		hdr.dim = m->vList->dim;
+		hdr.numFaces = m->fList->numFaces;
+		hdr.maxVerts = m->fList->maxVerts;
+	}
+
+	/*the header is written again at the end, once the sections are placed*/
+	rc = WRITE_FAILED;
+	offset = sizeof(GCALab_GCAHeader);
+	if (fwrite((void *)&hdr,sizeof(GCALab_GCAHeader),1,fp) == 1)
+	{
+		rc = GCALab_fio_pad(fp,&offset);
+	}
+	if (rc == WRITE_SUCCESS)
+	{
+		rc = GCALab_fio_writeSection(fp,hdr.sec + GCALAB_GCA_LUT,(void *)GCA->ruleLUT,(GCA->LUT_size)*sizeof(state),&offset);
+	}
+	if (rc == WRITE_SUCCESS)
+	{
+		rc = GCALab_fio_writeSection(fp,hdr.sec + GCALAB_GCA_GRAPH,(void *)GCA->params->graph,
+			(unsigned long long)(GCA->params->N)*(GCA->params->k-1)*sizeof(unsigned int),&offset);
+	}
+	if (rc == WRITE_SUCCESS)
+	{
+		rc = GCALab_fio_writeSection(fp,hdr.sec + GCALAB_GCA_IC,(void *)GCA->ic,(GCA->size)*sizeof(chunk),&offset);
+	}
+	/*the window rows are not contiguous in memory*/
+	rowlen = (GCA->size)*sizeof(chunk);
+	hdr.sec[GCALAB_GCA_WINDOW].offset = offset;
+	hdr.sec[GCALAB_GCA_WINDOW].len = rowlen*(GCA->params->WSIZE);
+	for (i=0;i<GCA->params->WSIZE && rc == WRITE_SUCCESS;i++)
+	{
+		if (fwrite((void *)GetWindowRow(GCA,i),(size_t)rowlen,1,fp) != 1)
+		{
+			rc = WRITE_FAILED;
+		}
+		offset += rowlen;
+	}
+	if (rc == WRITE_SUCCESS)
+	{
+		rc = GCALab_fio_pad(fp,&offset);
+	}
+	if (rc == WRITE_SUCCESS && m != NULL)
+	{
+		rc = GCALab_fio_writeSection(fp,hdr.sec + GCALAB_GCA_VERTS,(void *)m->vList->verts,
+			(unsigned long long)(hdr.numVerts)*(hdr.dim)*sizeof(float),&offset);
+		if (rc == WRITE_SUCCESS)
+		{
+			rc = GCALab_fio_writeSection(fp,hdr.sec + GCALAB_GCA_FACES,(void *)m->fList->faces,
+				(unsigned long long)(hdr.numFaces)*(hdr.maxVerts)*sizeof(int),&offset);
+		}
+		if (rc == WRITE_SUCCESS)
+		{
+			rc = GCALab_fio_writeSection(fp,hdr.sec + GCALAB_GCA_FACETYPES,(void *)m->fList->faceTypes,
+				(unsigned long long)(hdr.numFaces)*sizeof(unsigned char),&offset);
+		}
+	}
+	if (rc == WRITE_SUCCESS && (fseeko(fp,start,SEEK_SET) != 0 || fwrite((void *)&hdr,sizeof(GCALab_GCAHeader),1,fp) != 1
+		|| fseeko(fp,start + (off_t)offset,SEEK_SET) != 0))
+	{
+		rc = WRITE_FAILED;
+	}
+	*len = offset;
+	return rc;
+}
+
+/** @brief Writes a GCA to a single binary container file.
+ *
+ * @details Unlike GCALab_fio_saveCA() everything is kept, i.e., the parameters, rule
+ * table, graph, mesh (if any), initial condition and the window at the current time
+ * step, so loading the file gives back the same GCA.
+ *
+ * @param filename the file to write to.
+ * @param GCA Graph Cellular Automaton to write to file.
+ * @param m geometry of the CA topology (can be NULL).
+ * @retVal WRITE_SUCCESS on completion.
+ * @retVal WRITE_FAILED on error.
+ */
+char GCALab_fio_saveCABin(char *filename,GraphCellularAutomaton *GCA,mesh *m)
+{
+	FILE *fp;
+	unsigned long long len;
+	char rc;
+
+	if (GCA == NULL || !(fp = fopen(filename,"wb")))
+	{
+		return WRITE_FAILED;
+	}
+	rc = GCALab_fio_writeCABin(fp,GCA,m,&len);
+	if (fclose(fp) != 0)
+	{
+		rc = WRITE_FAILED;
+	}
+	return rc;
+}
+
+/**
+ * @brief Tests that a section of the binary container is inside the file and aligned.
+ */
+static unsigned char GCALab_fio_validSection(GCALab_GCASection *sec,unsigned long long len,size_t filelen)
+{
+	return (sec->len == len && (len == 0 || (sec->offset % GCALAB_GCA_ALIGN == 0 
+		&& sec->offset <= (unsigned long long)filelen && len <= (unsigned long long)filelen - sec->offset)));
+}
+
+/**
+ * @brief Tests that the graph, rule table and faces of a mapped container only hold values 
+ * that can be used as indices.
+ * @details Graph entries must be cells (or 0xFFFFFFFF for no neighbour), rule table entries 
+ * must be states and face entries must be vertices. Nothing else checks these before they are
+ * used to index arrays.
+ */
+static unsigned char GCALab_fio_validValues(GCALab_GCAHeader *hdr,char *base,unsigned long long LUT_size,unsigned char hasmesh)
+{
+	unsigned long long i,n;
+	unsigned int *graph;
+	state *LUT;
+	int *faces;
+	unsigned char *faceTypes;
+	unsigned char j;
+
+	graph = (unsigned int *)(base + hdr->sec[GCALAB_GCA_GRAPH].offset);
+	n = (unsigned long long)(hdr->N)*(hdr->k-1);
+	for (i=0;i<n;i++)
+	{
+		if (graph[i] >= hdr->N && graph[i] != 0xFFFFFFFF)
+		{
+			return 0;
+		}
+	}
+	LUT = (state *)(base + hdr->sec[GCALAB_GCA_LUT].offset);
+	for (i=0;i<LUT_size;i++)
+	{
+		if (LUT[i] >= hdr->s)
+		{
+			return 0;
+		}
+	}
+	if (!hasmesh)
+	{
+		return 1;
+	}
+	faces = (int *)(base + hdr->sec[GCALAB_GCA_FACES].offset);
+	faceTypes = (unsigned char *)(base + hdr->sec[GCALAB_GCA_FACETYPES].offset);
+	for (i=0;i<(unsigned long long)(hdr->numFaces);i++)
+	{
+		if (faceTypes[i] > hdr->maxVerts)
+		{
+			return 0;
+		}
+		for (j=0;j<faceTypes[i];j++)
+		{
+			if (faces[i*(hdr->maxVerts)+j] < 0 || faces[i*(hdr->maxVerts)+j] >= hdr->numVerts)
+			{
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/** @brief Maps a binary container (see GCALab_fio_writeCABin()) into memory.
+ *
+ * @details The graph and rule table are used in place, nothing is read until it is
+ * used, so loading takes the same time for any size of GCA. The mapping is private,
+ * so changes to the graph (e.g., rotations) never reach the file.
+ *
+ * @param fd the file, it can be closed once this returns.
+ * @param start where the container starts in the file.
+ * @param len the length of the container.
+ * @param GCA set to the GCA (NULL on failure).
+ * @param m set to the mesh, if the container has one.
+ * @retVal READ_SUCCESS on completion.
+ * @retVal READ_FAILED if the container could not be mapped or is not valid, including
+ * any graph, rule table or face entry that is out of range.
+ * @retVal OUT_OF_MEMORY on allocation failure.
+ */
+char GCALab_fio_mapCABin(int fd,off_t start,size_t len,GraphCellularAutomaton **GCA,mesh **m)
+{
+	void *map;
+	size_t maplen;
+	off_t mapstart;
+	GCALab_GCAHeader hdr;
+	CellularAutomatonParameters *params;
+	unsigned long long LUT_size,rowlen;
+	chunk *window;
+	unsigned int log2s;
+	state s;
+	char *base;
+	unsigned char hasmesh;
+	unsigned int i;
+
+	*(GCA) = NULL;
+	*(m) = NULL;
+	if (len < sizeof(GCALab_GCAHeader))
+	{
+		return READ_FAILED;
+	}
+	/*mappings start on a page*/
+	mapstart = start - start % (off_t)sysconf(_SC_PAGESIZE);
+	maplen = len + (size_t)(start - mapstart);
+	map = mmap(NULL,maplen,PROT_READ | PROT_WRITE,MAP_PRIVATE,fd,mapstart);
+	if (map == MAP_FAILED)
+	{
+		return READ_FAILED;
+	}
+	base = (char *)map + (start - mapstart);
+	memcpy((void *)&hdr,(void *)base,sizeof(GCALab_GCAHeader));
+
+	/*everything the GCA points into must be in the file*/
+	/*s^k from untrusted bytes, 0 if it does not fit the LUT_size of a GCA*/
+	LUT_size = 1;
+	for (i=0;i<hdr.k && LUT_size != 0;i++)
+	{
+		LUT_size *= hdr.s;
+		LUT_size = (LUT_size > UINT_MAX) ? 0 : LUT_size;
+	}
+	rowlen = (unsigned long long)(hdr.size)*sizeof(chunk);
+	if (memcmp(hdr.magic,GCALAB_GCA_MAGIC,GCALAB_GCA_MAGIC_LEN) || hdr.version != GCALAB_GCA_VERSION 
+		|| hdr.s < 2 || hdr.k < 2 || hdr.N == 0 || hdr.WSIZE == 0 || LUT_size == 0
+		|| !GCALab_fio_validSection(hdr.sec + GCALAB_GCA_LUT,LUT_size*sizeof(state),len)
+		|| !GCALab_fio_validSection(hdr.sec + GCALAB_GCA_GRAPH,(unsigned long long)(hdr.N)*(hdr.k-1)*sizeof(unsigned int),len)
+		|| !GCALab_fio_validSection(hdr.sec + GCALAB_GCA_IC,hdr.sec[GCALAB_GCA_IC].len,len)
+		|| !GCALab_fio_validSection(hdr.sec + GCALAB_GCA_WINDOW,hdr.sec[GCALAB_GCA_WINDOW].len,len))
+	{
+		munmap(map,maplen);
+		return READ_FAILED;
+	}
+	hasmesh = (hdr.sec[GCALAB_GCA_VERTS].len > 0 && hdr.numVerts > 0 && hdr.dim > 0 && hdr.numFaces >= 0 && hdr.maxVerts > 0
+		&& GCALab_fio_validSection(hdr.sec + GCALAB_GCA_VERTS,(unsigned long long)(hdr.numVerts)*(hdr.dim)*sizeof(float),len)
+		&& GCALab_fio_validSection(hdr.sec + GCALAB_GCA_FACES,(unsigned long long)(hdr.numFaces)*(hdr.maxVerts)*sizeof(int),len)
+		&& GCALab_fio_validSection(hdr.sec + GCALAB_GCA_FACETYPES,(unsigned long long)(hdr.numFaces)*sizeof(unsigned char),len));
+	if (!GCALab_fio_validValues(&hdr,base,LUT_size,hasmesh))
+	{
+		munmap(map,maplen);
+		return READ_FAILED;
+	}
+
+	params = (CellularAutomatonParameters*)malloc(sizeof(CellularAutomatonParameters));
+	if (!params)
+	{
+		munmap(map,maplen);
+		return OUT_OF_MEMORY;
+	}
+	params->N = hdr.N;
+	params->WSIZE = hdr.WSIZE;
+	params->rule = hdr.rule;
+	params->s = hdr.s;
+	params->rule_type = hdr.rule_type;
+	params->k = hdr.k;
+	params->graph = (unsigned int *)(base + hdr.sec[GCALAB_GCA_GRAPH].offset);
+
+	/*the state is only used if it was written with the same chunks (see CreateGCA())*/
+	for (log2s=0,s=hdr.s;s >>= 1;log2s++);
+	window = NULL;
+	if (hdr.chunkbits != CHUNK_SIZE_BITS || hdr.size != (unsigned int)ceil((float)((hdr.N)*log2s)/(float)CHUNK_SIZE_BITS))
+	{
+		hdr.sec[GCALAB_GCA_IC].len = 0;
+	}
+	else if (hdr.sec[GCALAB_GCA_WINDOW].len == rowlen*(hdr.WSIZE))
+	{
+		window = (chunk *)(base + hdr.sec[GCALAB_GCA_WINDOW].offset);
+	}
+	*(GCA) = MapGCA(params,(state *)(base + hdr.sec[GCALAB_GCA_LUT].offset),window,map,maplen);
+	if (*(GCA) == NULL)
+	{
+		free(params);
+		munmap(map,maplen);
+		return OUT_OF_MEMORY;
+	}
+	if (window != NULL)
+	{
+		(*GCA)->t = hdr.t;
+	}
+	if (hdr.sec[GCALAB_GCA_IC].len == rowlen)
+	{
+		memcpy((void *)((*GCA)->ic),(void *)(base + hdr.sec[GCALAB_GCA_IC].offset),(size_t)rowlen);
+	}
+
+	if (hasmesh)
+	{
+		mesh *geom;
+		geom = CreateMesh(hdr.numVerts,hdr.dim,(hdr.numFaces > 0) ? hdr.numFaces : 1,hdr.maxVerts);
+		if (geom != NULL && geom->vList != NULL && geom->fList != NULL)
+		{
+			memcpy((void *)geom->vList->verts,(void *)(base + hdr.sec[GCALAB_GCA_VERTS].offset),(size_t)hdr.sec[GCALAB_GCA_VERTS].len);
+			memcpy((void *)geom->fList->faces,(void *)(base + hdr.sec[GCALAB_GCA_FACES].offset),(size_t)hdr.sec[GCALAB_GCA_FACES].len);
+			memcpy((void *)geom->fList->faceTypes,(void *)(base + hdr.sec[GCALAB_GCA_FACETYPES].offset),(size_t)hdr.sec[GCALAB_GCA_FACETYPES].len);
+			geom->vList->numVerts = hdr.numVerts;
+			geom->fList->numFaces = hdr.numFaces;
+			*(m) = geom;
+		}
+	}
+	return READ_SUCCESS;
+}
+
+/** @brief Maps a binary container file (see GCALab_fio_saveCABin()) into memory.
+ *
+ * @param filename the file to map.
+ * @param GCA set to the GCA (NULL on failure).
+ * @param m set to the mesh, if the file has one.
+ * @retVal READ_SUCCESS on completion.
+ * @retVal READ_FAILED if the file could not be mapped or is not a valid container.
+ * @retVal OUT_OF_MEMORY on allocation failure.
+ */
+char GCALab_fio_loadCABin(char *filename,GraphCellularAutomaton **GCA,mesh **m)
+{
+	int fd;
+	struct stat st;
+	char rc;
+
+	*(GCA) = NULL;
+	if ((fd = open(filename,O_RDONLY)) < 0)
+	{
+		return READ_FAILED;
+	}
+	rc = READ_FAILED;
+	if (fstat(fd,&st) == 0)
+	{
+		rc = GCALab_fio_mapCABin(fd,0,(size_t)st.st_size,GCA,m);
+	}
+	close(fd);
+	return rc;
+}
+
 /** @brief reads a *.gca file to memory.
+ *
+ * @details Binary containers (see GCALab_fio_saveCABin()) are mapped, anything else
+ * is read as the text format written by GCALab_fio_saveCA().
  *
  * @param filename *.gca file to import
  * @param GCA pointer to memory for storing the GCA data
  * @param m pointer to memory for storing CA topology/geometry.
+ * @retVal READ_SUCCESS on completion.
+ * @retVal READ_FAILED if a file could not be read, or a graph or rule table entry is out
+ * of range.
+ * @retVal OUT_OF_MEMORY on allocation failure.
  */
 char GCALab_fio_loadCA(char* filename, GraphCellularAutomaton **GCA, mesh **m)
 {
@@ -346,54 +1001,104 @@ char GCALab_fio_loadCA(char* filename, GraphCellularAutomaton **GCA, mesh **m)
 	char graphfile[255];
 	char lutfile[255];
 	char meshfile[255];
+	char magic[GCALAB_GCA_MAGIC_LEN];
 	CellularAutomatonParameters *params;	
-	int i,j;
+	unsigned int i,v;
 
+	*(GCA) = NULL;
 	if (!(fp = fopen(filename,"r")))
 	{
 		return READ_FAILED;
 	}
+	if (fread((void *)magic,GCALAB_GCA_MAGIC_LEN,1,fp) == 1 && !memcmp(magic,GCALAB_GCA_MAGIC,GCALAB_GCA_MAGIC_LEN))
+	{
+		fclose(fp);
+		return GCALab_fio_loadCABin(filename,GCA,m);
+	}
+	rewind(fp);
 
 	params = (CellularAutomatonParameters*)malloc(sizeof(CellularAutomatonParameters));
 
 	if (!params)
 	{
+		fclose(fp);
 		return OUT_OF_MEMORY;
 	}
 
-	fscanf(fp,"%u",&(params->N));
-	fscanf(fp,"%hhu\n",&(params->s));
-	fscanf(fp,"%hhu\n",&(params->k));
-	fscanf(fp,"%hhu\n",&(params->rule_type));
-	fscanf(fp,"%u\n",&(params->rule));
-	fscanf(fp,"%d\n",&(params->WSIZE));
-	fscanf(fp,"%s\n",lutfile);
-	fscanf(fp,"%s\n",graphfile);
-	if (!(fscanf(fp,"%s\n",meshfile) == 1))
+	if (fscanf(fp,"%u",&(params->N)) != 1 || fscanf(fp,"%hhu\n",&(params->s)) != 1
+		|| fscanf(fp,"%hhu\n",&(params->k)) != 1 || fscanf(fp,"%hhu\n",&(params->rule_type)) != 1
+		|| fscanf(fp,"%u\n",&(params->rule)) != 1 || fscanf(fp,"%u\n",&(params->WSIZE)) != 1
+		|| fscanf(fp,"%254s\n",lutfile) != 1 || fscanf(fp,"%254s\n",graphfile) != 1
+		|| params->N == 0 || params->s < 2 || params->k < 2 
+		|| (unsigned long long)(params->N)*(params->k-1) > UINT_MAX)
+	{
+		fclose(fp);
+		free(params);
+		return READ_FAILED;
+	}
+	if (!(fscanf(fp,"%254s\n",meshfile) == 1))
 	{
 		meshfile[0] = '\0';
 	}
 	fclose(fp);
 
-	params->graph = (unsigned int*)malloc((params->N)*(params->k-1)*sizeof(unsigned int));
+	params->graph = (unsigned int*)malloc((size_t)(params->N)*(params->k-1)*sizeof(unsigned int));
 	if (!(params->graph))
 	{
+		free(params);
 		return OUT_OF_MEMORY;
 	}
 
 	
 	if (!(fp = fopen(graphfile,"r")))
 	{
+		free(params->graph);
+		free(params);
 		return READ_FAILED;
 	}
 
+	/*as for binary containers (see GCALab_fio_validValues()), every entry is a cell or no neighbour*/
 	for (i=0;i<(params->N)*(params->k-1);i++)
 	{
-		fscanf(fp,"%u",params->graph + i);
+		if (fscanf(fp,"%u",params->graph + i) != 1 
+			|| (params->graph[i] >= params->N && params->graph[i] != 0xFFFFFFFF))
+		{
+			fclose(fp);
+			free(params->graph);
+			free(params);
+			return READ_FAILED;
+		}
 	}
 	fclose(fp);
 
 	*(GCA) = CreateGCA(params);
+	if (*(GCA) == NULL)
+	{
+		free(params->graph);
+		free(params);
+		return OUT_OF_MEMORY;
+	}
+
+	/*the saved table wins over the rule code, e.g., for hand edited tables*/
+	if ((fp = fopen(lutfile,"r")) != NULL)
+	{
+		unsigned int j;
+		while (fscanf(fp,"%u %u",&j,&v) == 2)
+		{
+			if (v >= params->s)
+			{
+				fclose(fp);
+				FreeGCA(*(GCA));
+				*(GCA) = NULL;
+				return READ_FAILED;
+			}
+			if (j < (*GCA)->LUT_size)
+			{
+				(*GCA)->ruleLUT[j] = (state)v;
+			}
+		}
+		fclose(fp);
+	}
 
 	if (meshfile[0] != '\0')
 	{
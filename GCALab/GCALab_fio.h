@@ -18,6 +18,7 @@
 #define __GCALAB_FIO_H
 
 #include <stdio.h>
+#include <sys/types.h>
 #include "GCA.h"
 #include "BitMapWriter.h"
 
@@ -46,11 +47,118 @@
 	#define CHUNK HEX8
 #endif
 
-/*for now this is it*/
+/*binary GCA container*/
+#define GCALAB_GCA_MAGIC "GCABIN01"
+#define GCALAB_GCA_MAGIC_LEN 8
+#define GCALAB_GCA_VERSION 1
+
+#ifndef GCALAB_GCA_ALIGN
+/*sections start on a multiple of this many bytes*/
+#define GCALAB_GCA_ALIGN 64
+#endif
+
+/*container sections*/
+#define GCALAB_GCA_LUT 			0
+#define GCALAB_GCA_GRAPH 		1
+#define GCALAB_GCA_IC 			2
+#define GCALAB_GCA_WINDOW 		3
+#define GCALAB_GCA_VERTS 		4
+#define GCALAB_GCA_FACES 		5
+#define GCALAB_GCA_FACETYPES 	6
+#define GCALAB_GCA_NUM_SECTIONS 7
+
+#ifndef GCALAB_NPY_ALIGN
+/*the data of .npy files starts on a multiple of this many bytes*/
+#define GCALAB_NPY_ALIGN 64
+#endif
+
+typedef struct GCALab_GCASection_struct GCALab_GCASection;
+typedef struct GCALab_GCAHeader_struct GCALab_GCAHeader;
+typedef struct GCALab_STPWriter_struct GCALab_STPWriter;
+typedef struct GCALab_NPYArray_struct GCALab_NPYArray;
+
+/*where a section is in the file, an absent section has len 0*/
+struct GCALab_GCASection_struct
+{
+	unsigned long long offset;
+	unsigned long long len;
+};
+
+/*Binary GCA container header
+ *
+ * The header is followed by the sections, each aligned to GCALAB_GCA_ALIGN bytes
+ * and in native byte order, so the file can be mapped and the graph and rule
+ * table used in place. The initial condition and window are only restored if
+ * chunkbits matches CHUNK_SIZE_BITS.
+ */
+struct GCALab_GCAHeader_struct
+{
+	char magic[GCALAB_GCA_MAGIC_LEN];
+	unsigned int version;
+	unsigned int chunkbits;
+	/*CA parameters and current time step*/
+	unsigned int N;
+	unsigned int WSIZE;
+	unsigned int rule;
+	unsigned int t;
+	unsigned char s;
+	unsigned char rule_type;
+	unsigned char k;
+	unsigned char pad;
+	unsigned int size;
+	/*mesh dimensions (if the mesh sections are present)*/
+	int numVerts;
+	int dim;
+	int numFaces;
+	int maxVerts;
+	GCALab_GCASection sec[GCALAB_GCA_NUM_SECTIONS];
+};
+
+/*A space-time pattern image being written
+ *
+ * The image is palettised with one colour per cell state, 1 bit per pixel for
+ * s = 2, 4 for s <= 16 and 8 otherwise, and written a row at a time straight from
+ * the packed configurations. Row 0 is the bottom of the image.
+ */
+struct GCALab_STPWriter_struct
+{
+	BMPFILE *bmp;
+	/*one row of pixels, with padding*/
+	uint8_t *row;
+	unsigned int N;
+	unsigned char log2s;
+};
+
+/*An exported array, as described in the JSON sidecar*/
+struct GCALab_NPYArray_struct
+{
+	char *file;
+	char *name;
+	unsigned int id;
+	unsigned int N;
+	unsigned char type;
+	unsigned char raw;
+	/*where the data starts in the file*/
+	unsigned long long offset;
+};
+
+/*colours of the cell states in images*/
+extern unsigned char cellCols[8][3];
+
+char GCALab_fio_openSTP(GCALab_STPWriter *stp,char *filename,unsigned int N,unsigned int s,unsigned int height);
+char GCALab_fio_writeSTPRow(GCALab_STPWriter *stp,unsigned int y,chunk *config);
+char GCALab_fio_closeSTP(GCALab_STPWriter *stp);
+
 char GCALab_fio_saveCA(char *filename,GraphCellularAutomaton *GCA,mesh *m);
+char GCALab_fio_saveCABin(char *filename,GraphCellularAutomaton *GCA,mesh *m);
+char GCALab_fio_writeCABin(FILE *fp,GraphCellularAutomaton *GCA,mesh *m,unsigned long long *len);
 
 char GCALab_fio_saveData(char* filename,char * name, void * data, int N,unsigned char type);
+char GCALab_fio_saveNPY(char *filename,void *data,unsigned int N,unsigned char type,unsigned char raw,unsigned long long *offset);
+char GCALab_fio_saveNPYMeta(char *filename,GCALab_NPYArray *arrays,unsigned int n);
 
 char GCALab_fio_loadCA(char* filenale, GraphCellularAutomaton **GCA, mesh **m);
+char GCALab_fio_loadCABin(char *filename,GraphCellularAutomaton **GCA,mesh **m);
+char GCALab_fio_mapCABin(int fd,off_t start,size_t len,GraphCellularAutomaton **GCA,mesh **m);
 
 #endif
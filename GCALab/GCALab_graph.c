@@ -0,0 +1,506 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_graph.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Edge list graph importer. Builds the topology of a GCA from a 
+ *              text or binary list of edges, for graphs that are not the face
+ *              adjacency of a mesh. The file is mapped and parsed by several
+ *              threads in three passes (size, degrees, neighbours), and the 
+ *              neighbour lists are sorted, so the graph does not depend on the
+ *              number of threads.
+ *
+ *              The graph is built in memory, with the edge lists it is built 
+ *              from (about 8 bytes per edge and 12 per cell on top of the graph),
+ *              and is only moved out of core once it is complete. So with -o an 
+ *              imported graph must still fit in memory, only the rows do not.
+ *
+ *==============================================================================
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "GCALab.h"
+
+/**
+ * @brief Gets the format of an edge list from its extension.
+ * @returns GCALAB_EDGES_BINARY for *.bin, GCALAB_EDGES_TEXT otherwise.
+ */
+unsigned char GCALab_EdgeFormat(char *filename)
+{
+	char *ext;
+	ext = strrchr(filename,'.');
+	return (ext != NULL && !strcmp(ext,".bin")) ? GCALAB_EDGES_BINARY : GCALAB_EDGES_TEXT;
+}
+
+/**
+ * @brief Reads the next edge of a text edge list.
+ *
+ * @param p The position in the file, moved past the edge.
+ * @param end The end of the piece being read.
+ * @param u Set to the first cell of the edge.
+ * @param v Set to the second cell of the edge.
+ *
+ * @returns 1 if an edge was read, 0 at the end of the piece and -1 on a line that
+ * does not start with two cell indices.
+ */
+static int GCALab_NextTextEdge(char **p,char *end,unsigned long long *u,unsigned long long *v)
+{
+	unsigned long long x[2];
+	char *c;
+	int n;
+
+	c = *p;
+	while (c < end)
+	{
+		if (*c == ' ' || *c == '\t' || *c == '\r' || *c == '\n')
+		{
+			c++;
+			continue;
+		}
+		if (*c == '#' || *c == '%')
+		{
+			while (c < end && *c != '\n')
+			{
+				c++;
+			}
+			continue;
+		}
+		for (n=0;n<2;n++)
+		{
+			while (c < end && (*c == ' ' || *c == '\t'))
+			{
+				c++;
+			}
+			if (c >= end || *c < '0' || *c > '9')
+			{
+				*p = c;
+				return -1;
+			}
+			/*0xFFFFFFFF marks a missing neighbour in the graph, so it is not a cell*/
+			for (x[n]=0;c < end && *c >= '0' && *c <= '9' && x[n] < 0xFFFFFFFFULL;c++)
+			{
+				x[n] = 10*x[n] + (unsigned long long)(*c - '0');
+			}
+			if (x[n] >= 0xFFFFFFFFULL)
+			{
+				*p = c;
+				return -1;
+			}
+		}
+		/*the rest of the line (e.g., a weight) is ignored*/
+		while (c < end && *c != '\n')
+		{
+			c++;
+		}
+		*p = c;
+		*u = x[0];
+		*v = x[1];
+		return 1;
+	}
+	*p = c;
+	return 0;
+}
+
+/**
+ * @brief Orders cell indices.
+ */
+static int GCALab_CompareCells(const void *a,const void *b)
+{
+	unsigned int x,y;
+	x = *(const unsigned int *)a;
+	y = *(const unsigned int *)b;
+	return (x > y) - (x < y);
+}
+
+/**
+ * @brief Sorts the neighbour lists of the cells of a worker and removes repeats.
+ * @details The number of distinct neighbours replaces the degree of each cell.
+ */
+static void GCALab_SortNeighbours(GCALab_EdgeWorker *w)
+{
+	GCALab_EdgeImport *imp;
+	unsigned int *list;
+	size_t i,j,n,d;
+
+	imp = w->imp;
+	for (i=w->start;i<w->end;i++)
+	{
+		list = imp->adj + imp->off[i];
+		n = (size_t)(imp->off[i+1] - imp->off[i]);
+		qsort((void *)list,n,sizeof(unsigned int),&GCALab_CompareCells);
+		for (j=0,d=0;j<n;j++)
+		{
+			if (d == 0 || list[j] != list[d-1])
+			{
+				list[d++] = list[j];
+			}
+		}
+		imp->deg[i] = (unsigned int)d;
+		if (d > w->maxdeg)
+		{
+			w->maxdeg = (unsigned int)d;
+		}
+	}
+}
+
+/**
+ * @brief Runs one pass of an import over the piece of a worker.
+ */
+static void *GCALab_EdgeWorkerMain(void *arg)
+{
+	GCALab_EdgeWorker *w;
+	GCALab_EdgeImport *imp;
+	unsigned long long u,v;
+	unsigned int *e;
+	char *p,*end;
+	int got;
+
+	w = (GCALab_EdgeWorker *)arg;
+	imp = w->imp;
+	if (w->pass == GCALAB_EDGES_SORT)
+	{
+		GCALab_SortNeighbours(w);
+		return NULL;
+	}
+	p = imp->buf + w->start;
+	end = imp->buf + w->end;
+	while (1)
+	{
+		if (imp->format == GCALAB_EDGES_BINARY)
+		{
+			if (p >= end)
+			{
+				break;
+			}
+			e = (unsigned int *)p;
+			u = (unsigned long long)e[0];
+			v = (unsigned long long)e[1];
+			p += 2*sizeof(unsigned int);
+			got = (e[0] == 0xFFFFFFFF || e[1] == 0xFFFFFFFF) ? -1 : 1;
+		}
+		else
+		{
+			got = GCALab_NextTextEdge(&p,end,&u,&v);
+		}
+		if (got <= 0)
+		{
+			w->rc = (got < 0) ? GCALAB_INVALID_OPTION : GCALAB_SUCCESS;
+			break;
+		}
+		/*a cell is always part of its own neighbourhood*/
+		if (u == v)
+		{
+			continue;
+		}
+		switch (w->pass)
+		{
+			case GCALAB_EDGES_SCAN:
+				w->maxid = (u > w->maxid) ? u : w->maxid;
+				w->maxid = (v > w->maxid) ? v : w->maxid;
+				w->nedges++;
+				break;
+			case GCALAB_EDGES_COUNT:
+				__sync_fetch_and_add(imp->deg + u,1);
+				__sync_fetch_and_add(imp->deg + v,1);
+				break;
+			case GCALAB_EDGES_FILL:
+				imp->adj[__sync_fetch_and_add(imp->off + u,1ULL)] = (unsigned int)v;
+				imp->adj[__sync_fetch_and_add(imp->off + v,1ULL)] = (unsigned int)u;
+				break;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * @brief Runs a pass of an import on every worker.
+ *
+ * @details The calling thread acts as worker 0, and runs the workers of any 
+ * threads that could not be started.
+ *
+ * @retval GCALAB_SUCCESS if every worker finished its piece.
+ * @retval GCALAB_INVALID_OPTION if a piece has a malformed edge.
+ */
+static char GCALab_RunEdgePass(GCALab_EdgeWorker *workers,unsigned int nthreads,unsigned int pass)
+{
+	unsigned int t,nstarted;
+
+	for (t=0;t<nthreads;t++)
+	{
+		workers[t].pass = pass;
+		workers[t].rc = GCALAB_SUCCESS;
+	}
+	for (nstarted=1;nstarted<nthreads;nstarted++)
+	{
+		if (pthread_create(&(workers[nstarted].thread),NULL,&GCALab_EdgeWorkerMain,(void *)(workers+nstarted)))
+		{
+			break;
+		}
+	}
+	GCALab_EdgeWorkerMain((void *)workers);
+	for (t=nstarted;t<nthreads;t++)
+	{
+		GCALab_EdgeWorkerMain((void *)(workers+t));
+	}
+	for (t=1;t<nstarted;t++)
+	{
+		pthread_join(workers[t].thread,NULL);
+	}
+	for (t=0;t<nthreads;t++)
+	{
+		if (workers[t].rc != GCALAB_SUCCESS)
+		{
+			return workers[t].rc;
+		}
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Where the piece of thread t of the file starts, at the start of a line
+ * (or edge).
+ */
+static size_t GCALab_EdgeSplit(GCALab_EdgeImport *imp,unsigned int t,unsigned int nthreads)
+{
+	size_t at;
+	if (t == 0 || t >= nthreads)
+	{
+		return (t == 0) ? 0 : imp->len;
+	}
+	if (imp->format == GCALAB_EDGES_BINARY)
+	{
+		return (size_t)(((unsigned long long)(imp->len/8))*t/nthreads)*8;
+	}
+	at = (size_t)(((unsigned long long)(imp->len))*t/nthreads);
+	while (at > 0 && at < imp->len && imp->buf[at-1] != '\n')
+	{
+		at++;
+	}
+	return at;
+}
+
+/**
+ * @brief Builds a graph from an edge list.
+ *
+ * @details Edges are undirected, self loops and repeated edges are dropped, and
+ * the cells are 0 to the largest index in the list. The neighbours of each cell 
+ * are in increasing order, padded with 0xFFFFFFFF up to the largest degree.
+ * The graph and the edge lists are all held in memory at the peak.
+ *
+ * @param filename The edge list, see GCALab_EdgeFormat().
+ * @param nthreads The number of threads to parse it with.
+ * @param graph Set to the graph, N x (k-1), the caller frees it.
+ * @param N Set to the number of cells.
+ * @param k Set to the neighbourhood size, the largest degree + 1.
+ *
+ * @retval GCALAB_SUCCESS if the graph was built.
+ * @retval GCALAB_INVALID_OPTION if the file could not be read, has a malformed 
+ * edge, no edges or a cell with more than 254 neighbours.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ */
+char GCALab_ImportEdges(char *filename,unsigned int nthreads,unsigned int **graph,unsigned int *N,unsigned char *k)
+{
+	GCALab_EdgeImport imp;
+	GCALab_EdgeWorker *workers;
+	struct stat st;
+	unsigned long long maxid,nedges;
+	unsigned int i,j,t,maxdeg;
+	unsigned int *g;
+	int fd;
+	char rc;
+
+	(*graph) = NULL;
+	nthreads = (nthreads == 0) ? 1 : nthreads;
+	memset((void *)&imp,0,sizeof(GCALab_EdgeImport));
+	imp.format = GCALab_EdgeFormat(filename);
+	if ((fd = open(filename,O_RDONLY)) < 0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	if (fstat(fd,&st) < 0 || st.st_size == 0 
+		|| (imp.format == GCALAB_EDGES_BINARY && st.st_size % (2*sizeof(unsigned int)) != 0))
+	{
+		close(fd);
+		return GCALAB_INVALID_OPTION;
+	}
+	imp.len = (size_t)st.st_size;
+	imp.buf = (char *)mmap(NULL,imp.len,PROT_READ,MAP_PRIVATE,fd,0);
+	close(fd);
+	if (imp.buf == (char *)MAP_FAILED)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	/*every pass reads the file front to back, so it is paged in and dropped as it goes*/
+	madvise((void *)(imp.buf),imp.len,MADV_SEQUENTIAL);
+	if (!(workers = (GCALab_EdgeWorker *)malloc(nthreads*sizeof(GCALab_EdgeWorker))))
+	{
+		munmap((void *)(imp.buf),imp.len);
+		return GCALAB_MEM_ERROR;
+	}
+	memset((void *)workers,0,nthreads*sizeof(GCALab_EdgeWorker));
+	for (t=0;t<nthreads;t++)
+	{
+		workers[t].imp = &imp;
+		workers[t].start = GCALab_EdgeSplit(&imp,t,nthreads);
+		workers[t].end = GCALab_EdgeSplit(&imp,t+1,nthreads);
+	}
+
+	/*size the graph*/
+	rc = GCALab_RunEdgePass(workers,nthreads,GCALAB_EDGES_SCAN);
+	maxid = 0;
+	nedges = 0;
+	for (t=0;t<nthreads;t++)
+	{
+		maxid = (workers[t].maxid > maxid) ? workers[t].maxid : maxid;
+		nedges += workers[t].nedges;
+	}
+	if (rc == GCALAB_SUCCESS && nedges == 0)
+	{
+		rc = GCALAB_INVALID_OPTION;
+	}
+	if (rc == GCALAB_SUCCESS)
+	{
+		imp.N = (unsigned int)(maxid + 1);
+		imp.deg = (unsigned int *)malloc((size_t)(imp.N)*sizeof(unsigned int));
+		imp.off = (unsigned long long *)malloc(((size_t)(imp.N)+1)*sizeof(unsigned long long));
+		imp.adj = (unsigned int *)malloc((size_t)(2*nedges)*sizeof(unsigned int));
+		if (imp.deg == NULL || imp.off == NULL || imp.adj == NULL)
+		{
+			rc = GCALAB_MEM_ERROR;
+		}
+	}
+
+	/*count the neighbours, then place them, each cell filling from where its list starts*/
+	if (rc == GCALAB_SUCCESS)
+	{
+		memset((void *)(imp.deg),0,(size_t)(imp.N)*sizeof(unsigned int));
+		rc = GCALab_RunEdgePass(workers,nthreads,GCALAB_EDGES_COUNT);
+	}
+	if (rc == GCALAB_SUCCESS)
+	{
+		imp.off[0] = 0;
+		for (i=0;i<imp.N;i++)
+		{
+			imp.off[i+1] = imp.off[i] + imp.deg[i];
+		}
+		rc = GCALab_RunEdgePass(workers,nthreads,GCALAB_EDGES_FILL);
+		/*each offset is now where the next list starts*/
+		for (i=imp.N;i>0;i--)
+		{
+			imp.off[i] = imp.off[i-1];
+		}
+		imp.off[0] = 0;
+	}
+	munmap((void *)(imp.buf),imp.len);
+
+	/*sort the lists, split over the cells*/
+	if (rc == GCALAB_SUCCESS)
+	{
+		for (t=0;t<nthreads;t++)
+		{
+			workers[t].start = (size_t)(((unsigned long long)(imp.N))*t/nthreads);
+			workers[t].end = (size_t)(((unsigned long long)(imp.N))*(t+1)/nthreads);
+		}
+		rc = GCALab_RunEdgePass(workers,nthreads,GCALAB_EDGES_SORT);
+	}
+	maxdeg = 0;
+	for (t=0;t<nthreads;t++)
+	{
+		maxdeg = (workers[t].maxdeg > maxdeg) ? workers[t].maxdeg : maxdeg;
+	}
+	free(workers);
+	if (rc == GCALAB_SUCCESS && maxdeg > 254)
+	{
+		rc = GCALAB_INVALID_OPTION;
+	}
+
+	/*the graph has a row of k-1 neighbours per cell*/
+	g = NULL;
+	if (rc == GCALAB_SUCCESS && !(g = (unsigned int *)malloc((size_t)(imp.N)*maxdeg*sizeof(unsigned int))))
+	{
+		rc = GCALAB_MEM_ERROR;
+	}
+	if (rc == GCALAB_SUCCESS)
+	{
+		for (i=0;i<imp.N;i++)
+		{
+			for (j=0;j<maxdeg;j++)
+			{
+				g[(size_t)i*maxdeg + j] = (j < imp.deg[i]) ? imp.adj[imp.off[i] + j] : 0xFFFFFFFF;
+			}
+		}
+		(*graph) = g;
+		(*N) = imp.N;
+		(*k) = (unsigned char)(maxdeg + 1);
+	}
+	free(imp.deg);
+	free(imp.off);
+	free(imp.adj);
+	return rc;
+}
+
+/**
+ * @brief Creates a Graph Cellular Automaton on the graph of an edge list, see 
+ * GCALab_ImportEdges().
+ *
+ * @param GCA Set to the GCA.
+ *
+ * @retval GCALAB_SUCCESS if the GCA was created.
+ * @retval GCALAB_INVALID_OPTION if the graph could not be imported, or its rule 
+ * table would have more than 2^GCALAB_EDGES_LUTBITS entries.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ */
+char GCALab_ImportGCA(char *filename,unsigned int nthreads,state s,unsigned char rule_type,unsigned int rule,unsigned int ws,GraphCellularAutomaton **GCA)
+{
+	CellularAutomatonParameters *params;
+	char rc;
+
+	(*GCA) = NULL;
+	if (!(params = (CellularAutomatonParameters *)malloc(sizeof(CellularAutomatonParameters))))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	rc = GCALab_ImportEdges(filename,nthreads,&(params->graph),&(params->N),&(params->k));
+	if (rc != GCALAB_SUCCESS)
+	{
+		free(params);
+		return rc;
+	}
+	/*the rule table has s^k entries, so a few high degree cells can make it too large*/
+	if (s < 2 || pow((double)s,(double)(params->k)) > (double)(1UL << GCALAB_EDGES_LUTBITS))
+	{
+		free(params->graph);
+		free(params);
+		return GCALAB_INVALID_OPTION;
+	}
+	params->WSIZE = (ws == 0) ? DEFAULT_WINDOW_SIZE : ws;
+	params->rule_type = rule_type;
+	params->rule = rule;
+	params->s = s;
+	if (!((*GCA) = CreateGCA(params)))
+	{
+		free(params->graph);
+		free(params);
+		return GCALAB_MEM_ERROR;
+	}
+	return GCALAB_SUCCESS;
+}
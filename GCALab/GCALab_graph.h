@@ -0,0 +1,99 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_graph.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Edge list graph importer definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_GRAPH_H
+#define __GCALAB_GRAPH_H
+
+#include <pthread.h>
+#include "GCA.h"
+
+/*edge list formats*/
+/*one edge per line, two cell indices separated by white space, lines starting
+ *with # or % are comments and anything after the two indices is ignored*/
+#define GCALAB_EDGES_TEXT 	0
+/*pairs of native unsigned 32 bit cell indices (*.bin)*/
+#define GCALAB_EDGES_BINARY 1
+
+#ifndef GCALAB_EDGES_LUTBITS
+/*largest rule table an imported graph may need, in log2 entries*/
+#define GCALAB_EDGES_LUTBITS 26
+#endif
+
+/*import passes, run by every thread over its share of the file or cells*/
+/*largest cell index and number of edges*/
+#define GCALAB_EDGES_SCAN 	0
+/*degree of every cell*/
+#define GCALAB_EDGES_COUNT 	1
+/*neighbour lists*/
+#define GCALAB_EDGES_FILL 	2
+/*sorted and duplicate free neighbour lists*/
+#define GCALAB_EDGES_SORT 	3
+
+typedef struct GCALab_EdgeImport_struct GCALab_EdgeImport;
+typedef struct GCALab_EdgeWorker_struct GCALab_EdgeWorker;
+
+/*An edge list being imported
+ *
+ * Edges are undirected, self loops and repeated edges are dropped. The file is
+ * read through a mapping, split into one piece per thread at line (or edge) 
+ * boundaries, and parsed once per pass. Neighbour lists are built in place (as 
+ * offsets into adj), so the graph is the same whatever the number of threads.
+ */
+struct GCALab_EdgeImport_struct
+{
+	char *buf;
+	size_t len;
+	unsigned char format;
+	/*number of cells, largest index + 1*/
+	unsigned int N;
+	/*degree of each cell, then the number of distinct neighbours*/
+	unsigned int *deg;
+	/*where the neighbours of each cell start in adj (N+1 of them), the next 
+	 *free slot while filling*/
+	unsigned long long *off;
+	unsigned int *adj;
+};
+
+/*A thread of an import, and what it found*/
+struct GCALab_EdgeWorker_struct
+{
+	GCALab_EdgeImport *imp;
+	/*the bytes of the file (or cells when sorting) of this thread*/
+	size_t start;
+	size_t end;
+	unsigned int pass;
+	unsigned long long maxid;
+	unsigned long long nedges;
+	unsigned int maxdeg;
+	char rc;
+	pthread_t thread;
+};
+
+unsigned char GCALab_EdgeFormat(char *filename);
+char GCALab_ImportEdges(char *filename,unsigned int nthreads,unsigned int **graph,unsigned int *N,unsigned char *k);
+char GCALab_ImportGCA(char *filename,unsigned int nthreads,state s,unsigned char rule_type,unsigned int rule,unsigned int ws,GraphCellularAutomaton **GCA);
+
+#endif
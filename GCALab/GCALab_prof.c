@@ -0,0 +1,197 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_prof.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Per-command profiling. Every command records its wall and CPU
+ *              time, the process peak memory, and the libGCA work counters
+ *              (steps, cell updates, NhElim sweeps, pre-images tested) of all
+ *              threads that worked on it.
+ *
+ *==============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include "GCALab.h"
+
+/*profile of the calling thread*/
+static pthread_key_t GCALab_ProfileKey;
+static pthread_once_t GCALab_ProfileOnce = PTHREAD_ONCE_INIT;
+
+static void GCALab_CreateProfileKey(void)
+{
+	pthread_key_create(&GCALab_ProfileKey,NULL);
+}
+
+/**
+ * @brief Makes prof the profile (and counters) of the calling thread.
+ */
+static void GCALab_SetProfile(GCALab_Profile *prof)
+{
+	pthread_once(&GCALab_ProfileOnce,&GCALab_CreateProfileKey);
+	pthread_setspecific(GCALab_ProfileKey,(void*)prof);
+	GCA_SetCounters((prof != NULL) ? &(prof->counters) : NULL);
+}
+
+/**
+ * @brief Nanoseconds between two times.
+ */
+static unsigned long long GCALab_ElapsedNs(struct timespec *t0,struct timespec *t1)
+{
+	return (unsigned long long)((t1->tv_sec - t0->tv_sec)*1000000000LL + (t1->tv_nsec - t0->tv_nsec));
+}
+
+/**
+ * @brief Initialises an empty profile log.
+ * @param log the log to initialise
+ */
+char GCALab_InitProfileLog(GCALab_ProfileLog *log)
+{
+	if (!(log->profs = (GCALab_Profile **)malloc(GCALAB_PROFILES_INIT_SIZE*sizeof(GCALab_Profile *))))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	log->num = 0;
+	log->cap = GCALAB_PROFILES_INIT_SIZE;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Appends a profile to a log, the log takes ownership of it.
+ */
+char GCALab_AddProfile(GCALab_ProfileLog *log,GCALab_Profile *prof)
+{
+	GCALab_Profile **profs;
+	if (log->num == log->cap)
+	{
+		if (!(profs = (GCALab_Profile **)realloc(log->profs,2*log->cap*sizeof(GCALab_Profile *))))
+		{
+			return GCALAB_MEM_ERROR;
+		}
+		log->profs = profs;
+		log->cap *= 2;
+	}
+	log->profs[log->num] = prof;
+	log->num++;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Frees a log and every profile in it.
+ */
+void GCALab_FreeProfileLog(GCALab_ProfileLog *log)
+{
+	unsigned int i;
+	for (i=0;i<log->num;i++)
+	{
+		free(log->profs[i]);
+	}
+	free(log->profs);
+	log->profs = NULL;
+	log->num = 0;
+	log->cap = 0;
+}
+
+/**
+ * @brief Starts profiling a command on the calling thread.
+ * @details The command fields (cmd_id, rule, ...) are left as they are.
+ * @param prof the profile to record into
+ */
+void GCALab_ProfileBegin(GCALab_Profile *prof)
+{
+	memset((void*)&(prof->counters),0,sizeof(GCA_Counters));
+	prof->wall = 0.0;
+	prof->cpu_ns = 0;
+	prof->maxrss = 0;
+	prof->parent = NULL;
+	prof->prev = NULL;
+	clock_gettime(CLOCK_MONOTONIC,&(prof->wall0));
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID,&(prof->cpu0));
+	GCALab_SetProfile(prof);
+}
+
+/**
+ * @brief Stops profiling a command, all its helper threads must have finished.
+ * @param prof the profile passed to GCALab_ProfileBegin()
+ */
+void GCALab_ProfileEnd(GCALab_Profile *prof)
+{
+	struct timespec t;
+	struct rusage ru;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID,&t);
+	prof->cpu_ns += GCALab_ElapsedNs(&(prof->cpu0),&t);
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	prof->wall = 1e-9*(double)GCALab_ElapsedNs(&(prof->wall0),&t);
+	if (getrusage(RUSAGE_SELF,&ru) == 0)
+	{
+		prof->maxrss = 1024ULL*(unsigned long long)ru.ru_maxrss;
+	}
+	GCALab_SetProfile(NULL);
+}
+
+/**
+ * @brief Gets the profile of the calling thread.
+ * @returns the profile, NULL if the thread is not profiling.
+ */
+GCALab_Profile *GCALab_CurrentProfile(void)
+{
+	pthread_once(&GCALab_ProfileOnce,&GCALab_CreateProfileKey);
+	return (GCALab_Profile *)pthread_getspecific(GCALab_ProfileKey);
+}
+
+/**
+ * @brief Starts counting the work of a helper thread of a command.
+ * @details Every thread working on a job, including the one that started it,
+ * counts into its own local profile so counters are never updated by two
+ * threads at once.
+ * @param local the helper thread's own profile
+ * @param parent the profile of the command (see GCALab_CurrentProfile()), can be NULL
+ */
+void GCALab_ProfileThreadBegin(GCALab_Profile *local,GCALab_Profile *parent)
+{
+	memset((void*)&(local->counters),0,sizeof(GCA_Counters));
+	local->cpu_ns = 0;
+	local->parent = parent;
+	local->prev = GCALab_CurrentProfile();
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID,&(local->cpu0));
+	GCALab_SetProfile(local);
+}
+
+/**
+ * @brief Merges the work of a helper thread into its command's profile.
+ * @param local the profile passed to GCALab_ProfileThreadBegin()
+ */
+void GCALab_ProfileThreadEnd(GCALab_Profile *local)
+{
+	struct timespec t;
+	if (local->parent != NULL)
+	{
+		GCA_AddCounters(&(local->parent->counters),&(local->counters));
+		/*the command's own thread is already timed by GCALab_ProfileEnd()*/
+		if (local->prev != local->parent)
+		{
+			clock_gettime(CLOCK_THREAD_CPUTIME_ID,&t);
+			__sync_fetch_and_add(&(local->parent->cpu_ns),GCALab_ElapsedNs(&(local->cpu0),&t));
+		}
+	}
+	GCALab_SetProfile(local->prev);
+}
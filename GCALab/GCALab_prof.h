@@ -0,0 +1,86 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_prof.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Per-command profiling definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_PROF_H
+#define __GCALAB_PROF_H
+
+#include <time.h>
+#include "GCA.h"
+
+#ifndef GCALAB_PROFILES_INIT_SIZE
+/*initial capacity of a workspace profile log*/
+#define GCALAB_PROFILES_INIT_SIZE 64
+#endif
+
+typedef struct GCALab_Profile_struct GCALab_Profile;
+typedef struct GCALab_ProfileLog_struct GCALab_ProfileLog;
+
+/*Profile of one executed command
+ *
+ * Helper threads of a command (e.g., sampler threads) count into a local
+ * profile which is merged into the command's profile when they finish.
+ */
+struct GCALab_Profile_struct
+{
+	unsigned int cmd_id;
+	unsigned int trgt_id;
+	/*rule and number of cells of the target when the command started (N = 0 if none)*/
+	unsigned char rule_type;
+	unsigned int rule;
+	unsigned int N;
+	/*index of the command's result, -1 if it has none*/
+	int res_id;
+	/*wall time (s) and CPU time of every thread that worked on the command (ns)*/
+	double wall;
+	unsigned long long cpu_ns;
+	/*peak resident set size of the process when the command finished (bytes)*/
+	unsigned long long maxrss;
+	GCA_Counters counters;
+	/*start times, and the profile to merge into and restore for helper threads*/
+	struct timespec wall0;
+	struct timespec cpu0;
+	GCALab_Profile *parent;
+	GCALab_Profile *prev;
+};
+
+/*profiles of the retired commands of a workspace, in queue order*/
+struct GCALab_ProfileLog_struct
+{
+	GCALab_Profile **profs;
+	unsigned int num;
+	unsigned int cap;
+};
+
+char GCALab_InitProfileLog(GCALab_ProfileLog *log);
+char GCALab_AddProfile(GCALab_ProfileLog *log,GCALab_Profile *prof);
+void GCALab_FreeProfileLog(GCALab_ProfileLog *log);
+void GCALab_ProfileBegin(GCALab_Profile *prof);
+void GCALab_ProfileEnd(GCALab_Profile *prof);
+GCALab_Profile *GCALab_CurrentProfile(void);
+void GCALab_ProfileThreadBegin(GCALab_Profile *local,GCALab_Profile *parent);
+void GCALab_ProfileThreadEnd(GCALab_Profile *local);
+
+#endif
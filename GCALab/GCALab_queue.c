@@ -0,0 +1,299 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_queue.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: The workspace command queue. Front-ends (and any other producers)
+ *              append commands without taking the workspace lock, while the
+ *              workspace scheduler consumes them in submission order. The queue
+ *              is a chain of fixed size segments so there is no limit on the
+ *              number of queued commands.
+ *
+ *==============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "GCALab.h"
+
+/**
+ * @brief Allocates an empty segment, every record knows its own location.
+ */
+static GCALab_QueueSegment *GCALab_NewSegment(void)
+{
+	GCALab_QueueSegment *seg;
+	unsigned int i;
+	if (!(seg = (GCALab_QueueSegment *)malloc(sizeof(GCALab_QueueSegment))))
+	{
+		return NULL;
+	}
+	memset((void*)seg,0,sizeof(GCALab_QueueSegment));
+	for (i=0;i<GCALAB_QUEUE_SEGMENT_SIZE;i++)
+	{
+		seg->cmds[i].seg = seg;
+		seg->cmds[i].slot = i;
+	}
+	return seg;
+}
+
+/**
+ * @brief Frees segments before the head once no producer can be using them.
+ * @details A producer only touches the segment it read from the tail, and it 
+ * registers itself before reading it. So the tail is read first: a producer that
+ * still holds a segment before it must have registered before the tail moved on,
+ * and is counted, while later producers only see the tail or what comes after.
+ */
+static void GCALab_ReclaimSegments(GCALab_CmdQueue *q)
+{
+	GCALab_QueueSegment *seg,*tail;
+	tail = q->tail;
+	__sync_synchronize();
+	if (q->producers != 0)
+	{
+		return;
+	}
+	while (q->oldest != q->head && q->oldest != tail)
+	{
+		seg = q->oldest;
+		q->oldest = seg->next;
+		free(seg);
+	}
+}
+
+/**
+ * @brief Initialises an empty command queue.
+ * @param q the queue to initialise
+ */
+char GCALab_InitQueue(GCALab_CmdQueue *q)
+{
+	if (!(q->head = GCALab_NewSegment()))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	q->tail = q->head;
+	q->oldest = q->head;
+	q->headslot = 0;
+	q->producers = 0;
+	q->pushed = 0;
+	q->retired = 0;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Copies command parameters into a single allocation.
+ * @details The pointer array is followed by the strings, each string is truncated
+ * to GCALAB_MAX_STRLEN characters (including the terminator).
+ * @param argv the parameters to copy
+ * @param argc the number of parameters
+ * @returns the copy, release it with free(), or NULL if out of memory.
+ */
+char **GCALab_ParamArena(char **argv,int argc)
+{
+	char **params;
+	char *str;
+	size_t len,size;
+	int i;
+
+	size = (argc > 0) ? argc*sizeof(char*) : sizeof(char*);
+	for (i=0;i<argc;i++)
+	{
+		len = strlen(argv[i]);
+		size += ((len < GCALAB_MAX_STRLEN) ? len : GCALAB_MAX_STRLEN-1) + 1;
+	}
+	if (!(params = (char **)malloc(size)))
+	{
+		return NULL;
+	}
+	str = (char *)(params + ((argc > 0) ? argc : 1));
+	for (i=0;i<argc;i++)
+	{
+		len = strlen(argv[i]);
+		len = (len < GCALAB_MAX_STRLEN) ? len : GCALAB_MAX_STRLEN-1;
+		memcpy(str,argv[i],len);
+		str[len] = '\0';
+		params[i] = str;
+		str += len + 1;
+	}
+	return params;
+}
+
+/**
+ * @brief Appends a command, safe to call from any number of threads at once.
+ * @details The queue takes ownership of params (see GCALab_ParamArena()).
+ * @param q the queue
+ * @param cmd_id the op-code of the command
+ * @param trgt_id the target GCA of the command
+ * @param params arguments to the command
+ * @param numparams the number of arguments
+ * @param notify called when the command is retired, can be NULL
+ * @param notify_arg passed to notify
+ */
+char GCALab_QueuePush(GCALab_CmdQueue *q,unsigned int cmd_id,unsigned int trgt_id,char **params,int numparams,
+	void (*notify)(void*,char,int),void *notify_arg)
+{
+	GCALab_QueueSegment *seg,*next;
+	GCALab_CmdRecord *cmd;
+	unsigned int slot;
+	char rc;
+
+	rc = GCALAB_MEM_ERROR;
+	__sync_fetch_and_add(&(q->producers),1);
+	while (1)
+	{
+		seg = q->tail;
+		slot = __sync_fetch_and_add(&(seg->reserved),1);
+		if (slot < GCALAB_QUEUE_SEGMENT_SIZE)
+		{
+			cmd = seg->cmds + slot;
+			cmd->cmd_id = cmd_id;
+			cmd->trgt_id = trgt_id;
+			cmd->params = params;
+			cmd->numparams = numparams;
+			cmd->state = GCALAB_CMD_QUEUED;
+			cmd->res = NULL;
+			cmd->prof = NULL;
+			cmd->cancel = 0;
+			cmd->stopped = 0;
+			cmd->done = 0;
+			cmd->total = 0;
+			cmd->snapshot = NULL;
+			/*until the operation has actually run*/
+			cmd->rc = GCALAB_INVALID_OPTION;
+			cmd->notify = notify;
+			cmd->notify_arg = notify_arg;
+			/*counted first so the length never goes below zero*/
+			__sync_fetch_and_add(&(q->pushed),1);
+			cmd->published = 1;
+			rc = GCALAB_SUCCESS;
+			break;
+		}
+		/*segment is full, link in a new one unless another producer already has*/
+		if (seg->next == NULL)
+		{
+			if (!(next = GCALab_NewSegment()))
+			{
+				break;
+			}
+			if (!__sync_bool_compare_and_swap(&(seg->next),NULL,next))
+			{
+				free(next);
+			}
+		}
+		__sync_bool_compare_and_swap(&(q->tail),seg,seg->next);
+	}
+	__sync_fetch_and_sub(&(q->producers),1);
+	return rc;
+}
+
+/**
+ * @brief Number of commands pushed but not yet popped.
+ */
+unsigned long long GCALab_QueueLength(GCALab_CmdQueue *q)
+{
+	return q->pushed - q->retired;
+}
+
+/**
+ * @brief Gets the oldest command in the queue.
+ * @returns the command, or NULL if nothing has been published.
+ */
+GCALab_CmdRecord *GCALab_QueueFirst(GCALab_CmdQueue *q)
+{
+	GCALab_CmdRecord *cmd;
+	if (q->headslot == GCALAB_QUEUE_SEGMENT_SIZE)
+	{
+		if (q->head->next == NULL)
+		{
+			return NULL;
+		}
+		q->head = q->head->next;
+		q->headslot = 0;
+		GCALab_ReclaimSegments(q);
+	}
+	cmd = q->head->cmds + q->headslot;
+	if (!cmd->published)
+	{
+		return NULL;
+	}
+	__sync_synchronize();
+	return cmd;
+}
+
+/**
+ * @brief Gets the command after cmd in the queue.
+ * @returns the command, or NULL if cmd is the last one published.
+ */
+GCALab_CmdRecord *GCALab_QueueNext(GCALab_CmdQueue *q,GCALab_CmdRecord *cmd)
+{
+	GCALab_QueueSegment *seg;
+	unsigned int slot;
+	seg = cmd->seg;
+	slot = cmd->slot + 1;
+	if (slot == GCALAB_QUEUE_SEGMENT_SIZE)
+	{
+		if ((seg = seg->next) == NULL)
+		{
+			return NULL;
+		}
+		slot = 0;
+	}
+	cmd = seg->cmds + slot;
+	if (!cmd->published)
+	{
+		return NULL;
+	}
+	__sync_synchronize();
+	return cmd;
+}
+
+/**
+ * @brief Removes the oldest command, its parameters must already be released.
+ */
+void GCALab_QueuePop(GCALab_CmdQueue *q)
+{
+	GCALab_CmdRecord *cmd;
+	if ((cmd = GCALab_QueueFirst(q)) == NULL)
+	{
+		return;
+	}
+	cmd->params = NULL;
+	cmd->numparams = 0;
+	cmd->res = NULL;
+	cmd->prof = NULL;
+	q->headslot++;
+	q->retired++;
+}
+
+/**
+ * @brief Frees every segment of a queue.
+ * @details The parameters, results and profiles of the records still queued must 
+ * already be released, and no producer may be using the queue.
+ */
+void GCALab_FreeQueue(GCALab_CmdQueue *q)
+{
+	GCALab_QueueSegment *seg;
+	while (q->oldest != NULL)
+	{
+		seg = q->oldest;
+		q->oldest = seg->next;
+		free(seg);
+	}
+	q->head = NULL;
+	q->tail = NULL;
+}
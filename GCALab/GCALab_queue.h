@@ -0,0 +1,118 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_queue.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Unbounded multiple producer single consumer command queue definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_QUEUE_H
+#define __GCALAB_QUEUE_H
+
+#ifndef GCALAB_QUEUE_SEGMENT_SIZE
+/*number of command records in one queue segment*/
+#define GCALAB_QUEUE_SEGMENT_SIZE 256
+#endif
+
+typedef struct GCALab_CmdRecord_struct GCALab_CmdRecord;
+typedef struct GCALab_QueueSegment_struct GCALab_QueueSegment;
+typedef struct GCALab_CmdQueue_struct GCALab_CmdQueue;
+
+/*a queued command
+ *
+ * params points into a single arena allocation holding both the pointer array
+ * and the strings, so one free() releases them.
+ */
+struct GCALab_CmdRecord_struct
+{
+	unsigned int cmd_id;
+	unsigned int trgt_id;
+	int numparams;
+	char **params;
+	/*GCALAB_CMD_* state, only used by the consumer*/
+	unsigned char state;
+	/*set by the producer once the record is filled in*/
+	volatile unsigned char published;
+	/*GCALAB_CMD_ABORT or GCALAB_CMD_PAUSE to ask a running command to stop, and
+	 * set once it has (see GCALab_CmdProgress())*/
+	volatile unsigned char cancel;
+	volatile unsigned char stopped;
+	/*progress of a running command, total is 0 if unknown*/
+	volatile unsigned long long done;
+	volatile unsigned long long total;
+	/*snapshot a paused read only command resumes on*/
+	struct GraphCellularAutomaton_struct *snapshot;
+	/*result, profile and return code of a finished command*/
+	struct GCALabOutput_struct *res;
+	struct GCALab_Profile_struct *prof;
+	char rc;
+	/*called when the command is retired with its return code and result id 
+	 * (-1 if none), can be NULL*/
+	void (*notify)(void *arg,char rc,int res_id);
+	void *notify_arg;
+	/*where the record lives*/
+	GCALab_QueueSegment *seg;
+	unsigned int slot;
+};
+
+/*a fixed block of records, segments are chained as the queue grows*/
+struct GCALab_QueueSegment_struct
+{
+	GCALab_CmdRecord cmds[GCALAB_QUEUE_SEGMENT_SIZE];
+	/*number of slots claimed by producers (may run past the segment size)*/
+	volatile unsigned int reserved;
+	GCALab_QueueSegment * volatile next;
+};
+
+/*A segmented MPSC queue
+ *
+ * Producers claim a slot with an atomic increment on the tail segment and link
+ * in a new segment when it is full, they never block. The consumer side (head,
+ * traversal, retiring) must be serialised by the caller, e.g., by the workspace
+ * lock. Retired segments are only freed once they are behind the tail and no
+ * producer that could have read them is inside GCALab_QueuePush(), so a producer
+ * never touches freed memory.
+ */
+struct GCALab_CmdQueue_struct
+{
+	/*producer side*/
+	GCALab_QueueSegment * volatile tail;
+	volatile unsigned int producers;
+	volatile unsigned long long pushed;
+	/*consumer side*/
+	GCALab_QueueSegment *head;
+	unsigned int headslot;
+	/*oldest segment not yet freed*/
+	GCALab_QueueSegment *oldest;
+	unsigned long long retired;
+};
+
+char GCALab_InitQueue(GCALab_CmdQueue *q);
+char **GCALab_ParamArena(char **argv,int argc);
+char GCALab_QueuePush(GCALab_CmdQueue *q,unsigned int cmd_id,unsigned int trgt_id,char **params,int numparams,
+	void (*notify)(void*,char,int),void *notify_arg);
+unsigned long long GCALab_QueueLength(GCALab_CmdQueue *q);
+GCALab_CmdRecord *GCALab_QueueFirst(GCALab_CmdQueue *q);
+GCALab_CmdRecord *GCALab_QueueNext(GCALab_CmdQueue *q,GCALab_CmdRecord *cmd);
+void GCALab_QueuePop(GCALab_CmdQueue *q);
+void GCALab_FreeQueue(GCALab_CmdQueue *q);
+
+#endif
@@ -0,0 +1,673 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_rec.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Space-time pattern recorder. A recorder attached to a GCA
+ *              appends every configuration the GCA goes through to a file,
+ *              so space-time patterns are not limited to the window. Rows are
+ *              stored as run-length encoded differences from the row before,
+ *              with a keyframe every so often so any time step can be read
+ *              back without decoding the whole recording.
+ *
+ *==============================================================================
+ */
+
+#include "GCALab.h"
+
+/*worst case encoded length of a row, a pair of counts per two chunks plus the chunks*/
+#define GCALAB_REC_MAXENC(size) ((size_t)(size)*(sizeof(chunk) + 2*sizeof(unsigned int)) + 2*sizeof(unsigned int))
+
+/**
+ * @brief Run-length encodes a row, or the row XOR prev if prev is not NULL.
+ *
+ * @details Single zero chunks are kept in the literals, so every run but the last
+ * starts with at least two zeros and the output is never longer than
+ * GCALAB_REC_MAXENC(size).
+ *
+ * @returns The encoded length in bytes.
+ */
+static unsigned int GCALab_RecEncode(chunk *row,chunk *prev,unsigned int size,unsigned char *enc)
+{
+	unsigned int i,j,z,l,len;
+	chunk c;
+
+	#define GCALAB_REC_X(a) ((prev != NULL) ? (row[(a)] ^ prev[(a)]) : row[(a)])
+	i = 0;
+	len = 0;
+	while (i < size)
+	{
+		for (z=0;i+z < size && GCALAB_REC_X(i+z) == 0;z++);
+		i += z;
+		for (l=0;i+l < size && (GCALAB_REC_X(i+l) != 0 || (i+l+1 < size && GCALAB_REC_X(i+l+1) != 0));l++);
+		memcpy((void *)(enc + len),(void *)&z,sizeof(unsigned int));
+		memcpy((void *)(enc + len + sizeof(unsigned int)),(void *)&l,sizeof(unsigned int));
+		len += 2*sizeof(unsigned int);
+		for (j=0;j<l;j++)
+		{
+			c = GCALAB_REC_X(i+j);
+			memcpy((void *)(enc + len),(void *)&c,sizeof(chunk));
+			len += sizeof(chunk);
+		}
+		i += l;
+	}
+	#undef GCALAB_REC_X
+	return len;
+}
+
+/**
+ * @brief Decodes a row, XORing it into row if delta is set.
+ * @retval GCALAB_SUCCESS if the encoded runs cover the row exactly.
+ * @retval GCALAB_INVALID_OPTION otherwise.
+ */
+static char GCALab_RecDecode(unsigned char *enc,unsigned int len,chunk *row,unsigned int size,unsigned char delta)
+{
+	unsigned int i,j,z,l,pos;
+	chunk c;
+
+	i = 0;
+	pos = 0;
+	while (i < size && pos + 2*sizeof(unsigned int) <= len)
+	{
+		memcpy((void *)&z,(void *)(enc + pos),sizeof(unsigned int));
+		memcpy((void *)&l,(void *)(enc + pos + sizeof(unsigned int)),sizeof(unsigned int));
+		pos += 2*sizeof(unsigned int);
+		if (z > size - i || l > size - i - z || (unsigned long long)l*sizeof(chunk) > len - pos)
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+		if (!delta)
+		{
+			memset((void *)(row + i),0,z*sizeof(chunk));
+		}
+		i += z;
+		for (j=0;j<l;j++,i++)
+		{
+			memcpy((void *)&c,(void *)(enc + pos),sizeof(chunk));
+			pos += sizeof(chunk);
+			row[i] = (delta) ? (row[i] ^ c) : c;
+		}
+	}
+	return (i == size && pos == len) ? GCALAB_SUCCESS : GCALAB_INVALID_OPTION;
+}
+
+/**
+ * @brief Writer thread of a recorder, appends the rows queued by GCALab_RecordStep().
+ */
+static void *GCALab_RecorderWriter(void *arg)
+{
+	GCALab_Recorder *rec;
+	GCALab_RecRow hdr;
+	chunk *row;
+	unsigned int slot,size;
+
+	rec = (GCALab_Recorder *)arg;
+	size = rec->hdr.size;
+	while (1)
+	{
+		pthread_mutex_lock(&(rec->lock));
+		while (rec->tail == rec->head && !(rec->closed))
+		{
+			pthread_cond_wait(&(rec->cond),&(rec->lock));
+		}
+		if (rec->tail == rec->head)
+		{
+			pthread_mutex_unlock(&(rec->lock));
+			break;
+		}
+		slot = (unsigned int)(rec->tail % GCALAB_REC_DEPTH);
+		hdr.t = rec->slot_t[slot];
+		pthread_mutex_unlock(&(rec->lock));
+
+		/*keyframes are also forced where the GCA was reset, so t is consecutive between them*/
+		row = rec->slots + (size_t)slot*size;
+		hdr.type = (rec->hdr.nrows % rec->hdr.keyint == 0 || hdr.t != rec->last_t + 1) ? GCALAB_REC_KEY : GCALAB_REC_DELTA;
+		hdr.len = GCALab_RecEncode(row,(hdr.type == GCALAB_REC_KEY) ? NULL : rec->prev,size,rec->enc);
+		hdr.pad = 0;
+		if (!(rec->error))
+		{
+			if (hdr.type == GCALAB_REC_KEY && rec->hdr.nkeys == rec->maxkeys)
+			{
+				GCALab_RecKey *keys;
+				if ((keys = (GCALab_RecKey *)realloc(rec->keys,2*(rec->maxkeys)*sizeof(GCALab_RecKey))) != NULL)
+				{
+					rec->keys = keys;
+					rec->maxkeys *= 2;
+				}
+				else
+				{
+					rec->error = 1;
+				}
+			}
+			if (fwrite((void *)&hdr,sizeof(GCALab_RecRow),1,rec->fp) != 1
+				|| (hdr.len > 0 && fwrite((void *)(rec->enc),hdr.len,1,rec->fp) != 1))
+			{
+				rec->error = 1;
+			}
+		}
+		if (!(rec->error))
+		{
+			if (hdr.type == GCALAB_REC_KEY)
+			{
+				rec->keys[rec->hdr.nkeys].row = rec->hdr.nrows;
+				rec->keys[rec->hdr.nkeys].offset = rec->offset;
+				rec->keys[rec->hdr.nkeys].t = hdr.t;
+				rec->keys[rec->hdr.nkeys].pad = 0;
+				rec->hdr.nkeys++;
+			}
+			rec->offset += sizeof(GCALab_RecRow) + hdr.len;
+			rec->hdr.nrows++;
+		}
+		memcpy((void *)(rec->prev),(void *)row,size*sizeof(chunk));
+		rec->last_t = hdr.t;
+
+		pthread_mutex_lock(&(rec->lock));
+		rec->tail++;
+		pthread_cond_broadcast(&(rec->cond));
+		pthread_mutex_unlock(&(rec->lock));
+	}
+	return NULL;
+}
+
+/**
+ * @brief Attaches a recorder to a GCA, the current configuration is the first row.
+ *
+ * @param rec Set to the recorder.
+ * @param filename The recording file to create.
+ * @param GCA The GCA to record.
+ * @param keyint Rows between keyframes (the default if 0).
+ *
+ * @retval GCALAB_SUCCESS if the recorder is running.
+ * @retval GCALAB_INVALID_OPTION if the file could not be created.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ * @retval GCALAB_THREAD_ERROR if the writer could not be started.
+ */
+char GCALab_OpenRecorder(GCALab_Recorder **rec,char *filename,GraphCellularAutomaton *GCA,unsigned int keyint)
+{
+	GCALab_Recorder *r;
+	unsigned int size;
+
+	(*rec) = NULL;
+	size = GCA->size;
+	if (!(r = (GCALab_Recorder *)malloc(sizeof(GCALab_Recorder))))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	memset((void *)r,0,sizeof(GCALab_Recorder));
+	r->slots = (chunk *)malloc((size_t)GCALAB_REC_DEPTH*size*sizeof(chunk));
+	r->prev = (chunk *)malloc(size*sizeof(chunk));
+	r->enc = (unsigned char *)malloc(GCALAB_REC_MAXENC(size));
+	r->maxkeys = 16;
+	r->keys = (GCALab_RecKey *)malloc((r->maxkeys)*sizeof(GCALab_RecKey));
+	r->filename = (char *)malloc(strlen(filename) + 1);
+	if (!(r->slots) || !(r->prev) || !(r->enc) || !(r->keys) || !(r->filename))
+	{
+		free(r->filename);
+		free(r->slots);
+		free(r->prev);
+		free(r->enc);
+		free(r->keys);
+		free(r);
+		return GCALAB_MEM_ERROR;
+	}
+
+	memcpy(r->hdr.magic,GCALAB_REC_MAGIC,GCALAB_REC_MAGIC_LEN);
+	r->hdr.version = GCALAB_REC_VERSION;
+	r->hdr.chunkbits = CHUNK_SIZE_BITS;
+	r->hdr.N = GCA->params->N;
+	r->hdr.s = GCA->params->s;
+	r->hdr.size = size;
+	r->hdr.keyint = (keyint > 0) ? keyint : GCALAB_REC_KEYINT;
+	strcpy(r->filename,filename);
+	r->offset = sizeof(GCALab_RecHeader);
+	if (!(r->fp = fopen(filename,"wb")) || fwrite((void *)&(r->hdr),sizeof(GCALab_RecHeader),1,r->fp) != 1)
+	{
+		if (r->fp)
+		{
+			fclose(r->fp);
+		}
+		free(r->filename);
+		free(r->slots);
+		free(r->prev);
+		free(r->enc);
+		free(r->keys);
+		free(r);
+		return GCALAB_INVALID_OPTION;
+	}
+
+	pthread_mutex_init(&(r->lock),NULL);
+	pthread_cond_init(&(r->cond),NULL);
+	if (pthread_create(&(r->writer),NULL,&GCALab_RecorderWriter,(void *)r))
+	{
+		fclose(r->fp);
+		pthread_mutex_destroy(&(r->lock));
+		pthread_cond_destroy(&(r->cond));
+		free(r->filename);
+		free(r->slots);
+		free(r->prev);
+		free(r->enc);
+		free(r->keys);
+		free(r);
+		return GCALAB_THREAD_ERROR;
+	}
+	(*rec) = r;
+	return GCALab_RecordStep(r,GCA);
+}
+
+/**
+ * @brief Queues the current configuration of a GCA for the writer.
+ *
+ * @details This only copies the row, unless the writer is GCALAB_REC_DEPTH rows
+ * behind, in which case it waits for a free slot.
+ *
+ * @retval GCALAB_SUCCESS if the row was queued.
+ * @retval GCALAB_INVALID_OPTION if the recorder is closed.
+ */
+char GCALab_RecordStep(GCALab_Recorder *rec,GraphCellularAutomaton *GCA)
+{
+	unsigned int slot;
+
+	pthread_mutex_lock(&(rec->lock));
+	while (rec->head - rec->tail == GCALAB_REC_DEPTH && !(rec->closed))
+	{
+		pthread_cond_wait(&(rec->cond),&(rec->lock));
+	}
+	if (rec->closed || GCA->size != rec->hdr.size)
+	{
+		pthread_mutex_unlock(&(rec->lock));
+		return GCALAB_INVALID_OPTION;
+	}
+	slot = (unsigned int)(rec->head % GCALAB_REC_DEPTH);
+	pthread_mutex_unlock(&(rec->lock));
+
+	/*the writer does not look at the slot until head moves past it*/
+	memcpy((void *)(rec->slots + (size_t)slot*(rec->hdr.size)),(void *)(GCA->config),(rec->hdr.size)*sizeof(chunk));
+
+	pthread_mutex_lock(&(rec->lock));
+	rec->slot_t[slot] = GCA->t;
+	rec->head++;
+	pthread_cond_broadcast(&(rec->cond));
+	pthread_mutex_unlock(&(rec->lock));
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Waits for the writer to append every queued row, so the file can be read.
+ * @retval GCALAB_SUCCESS if every row so far is in the file.
+ * @retval GCALAB_INVALID_OPTION if a write failed.
+ */
+char GCALab_FlushRecorder(GCALab_Recorder *rec)
+{
+	pthread_mutex_lock(&(rec->lock));
+	while (rec->tail != rec->head)
+	{
+		pthread_cond_wait(&(rec->cond),&(rec->lock));
+	}
+	pthread_mutex_unlock(&(rec->lock));
+	if (rec->fp == NULL || rec->error || fflush(rec->fp) != 0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Stops a recorder, the queued rows and the keyframe index are written and
+ * the file is closed.
+ *
+ * @details The recorder memory is kept, so this is safe while another thread may
+ * still record a step (e.g., at shut down), any later step is refused.
+ *
+ * @retval GCALAB_SUCCESS if the recording is complete.
+ * @retval GCALAB_INVALID_OPTION if a write failed.
+ */
+char GCALab_FinishRecorder(GCALab_Recorder *rec)
+{
+	char rc;
+
+	pthread_mutex_lock(&(rec->lock));
+	if (rec->closed)
+	{
+		pthread_mutex_unlock(&(rec->lock));
+		return GCALAB_SUCCESS;
+	}
+	rec->closed = 1;
+	pthread_cond_broadcast(&(rec->cond));
+	pthread_mutex_unlock(&(rec->lock));
+	pthread_join(rec->writer,NULL);
+
+	rc = (rec->error) ? GCALAB_INVALID_OPTION : GCALAB_SUCCESS;
+	rec->hdr.index = rec->offset;
+	if (rc == GCALAB_SUCCESS && (fwrite((void *)(rec->keys),sizeof(GCALab_RecKey),(size_t)(rec->hdr.nkeys),rec->fp) != rec->hdr.nkeys
+		|| fseek(rec->fp,0,SEEK_SET) != 0 || fwrite((void *)&(rec->hdr),sizeof(GCALab_RecHeader),1,rec->fp) != 1))
+	{
+		rc = GCALAB_INVALID_OPTION;
+	}
+	if (fclose(rec->fp) != 0)
+	{
+		rc = GCALAB_INVALID_OPTION;
+	}
+	rec->fp = NULL;
+	return rc;
+}
+
+/**
+ * @brief Stops a recorder (see GCALab_FinishRecorder()) and frees it.
+ */
+char GCALab_CloseRecorder(GCALab_Recorder *rec)
+{
+	char rc;
+	if (rec == NULL)
+	{
+		return GCALAB_SUCCESS;
+	}
+	rc = GCALab_FinishRecorder(rec);
+	pthread_mutex_destroy(&(rec->lock));
+	pthread_cond_destroy(&(rec->cond));
+	free(rec->filename);
+	free(rec->slots);
+	free(rec->prev);
+	free(rec->enc);
+	free(rec->keys);
+	free(rec);
+	return rc;
+}
+
+/**
+ * @brief Rebuilds the keyframe index of a recording that was not closed.
+ * @details Rows are read up to the first one that is cut short.
+ */
+static char GCALab_RecScan(GCALab_Recording *rec)
+{
+	GCALab_RecRow row;
+	unsigned long long pos,end,n,maxkeys;
+	GCALab_RecKey *keys;
+
+	if (fseek(rec->fp,0,SEEK_END) != 0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	end = (unsigned long long)ftell(rec->fp);
+	pos = sizeof(GCALab_RecHeader);
+	n = 0;
+	maxkeys = 0;
+	rec->hdr.nkeys = 0;
+	while (pos + sizeof(GCALab_RecRow) <= end && fseek(rec->fp,(long)pos,SEEK_SET) == 0
+		&& fread((void *)&row,sizeof(GCALab_RecRow),1,rec->fp) == 1
+		&& row.len <= end - pos - sizeof(GCALab_RecRow) && (row.type == GCALAB_REC_KEY || n > 0))
+	{
+		if (row.type == GCALAB_REC_KEY)
+		{
+			if (rec->hdr.nkeys == maxkeys)
+			{
+				maxkeys = (maxkeys > 0) ? 2*maxkeys : 16;
+				if (!(keys = (GCALab_RecKey *)realloc(rec->keys,maxkeys*sizeof(GCALab_RecKey))))
+				{
+					return GCALAB_MEM_ERROR;
+				}
+				rec->keys = keys;
+			}
+			rec->keys[rec->hdr.nkeys].row = n;
+			rec->keys[rec->hdr.nkeys].offset = pos;
+			rec->keys[rec->hdr.nkeys].t = row.t;
+			rec->hdr.nkeys++;
+		}
+		pos += sizeof(GCALab_RecRow) + row.len;
+		n++;
+	}
+	rec->hdr.nrows = n;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Opens a recording for reading.
+ *
+ * @details The recording may still be written to, only the rows in the file when
+ * it is opened can be read (see GCALab_FlushRecorder()).
+ *
+ * @retval GCALAB_SUCCESS if the recording was opened.
+ * @retval GCALAB_INVALID_OPTION if the file is missing or not a recording.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ */
+char GCALab_OpenRecording(GCALab_Recording **rec,char *filename)
+{
+	GCALab_Recording *r;
+	char rc;
+
+	(*rec) = NULL;
+	if (!(r = (GCALab_Recording *)malloc(sizeof(GCALab_Recording))))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	memset((void *)r,0,sizeof(GCALab_Recording));
+	if (!(r->fp = fopen(filename,"rb")))
+	{
+		free(r);
+		return GCALAB_INVALID_OPTION;
+	}
+	rc = GCALAB_INVALID_OPTION;
+	if (fread((void *)&(r->hdr),sizeof(GCALab_RecHeader),1,r->fp) == 1
+		&& !memcmp(r->hdr.magic,GCALAB_REC_MAGIC,GCALAB_REC_MAGIC_LEN) && r->hdr.version == GCALAB_REC_VERSION
+		&& r->hdr.chunkbits == CHUNK_SIZE_BITS && r->hdr.size > 0 && r->hdr.s >= 2)
+	{
+		rc = GCALAB_SUCCESS;
+		if (r->hdr.index == 0)
+		{
+			rc = GCALab_RecScan(r);
+		}
+		else if (!(r->keys = (GCALab_RecKey *)malloc((size_t)(r->hdr.nkeys + 1)*sizeof(GCALab_RecKey))))
+		{
+			rc = GCALAB_MEM_ERROR;
+		}
+		else if (fseek(r->fp,(long)(r->hdr.index),SEEK_SET) != 0
+			|| fread((void *)(r->keys),sizeof(GCALab_RecKey),(size_t)(r->hdr.nkeys),r->fp) != r->hdr.nkeys)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+	}
+	if (rc == GCALAB_SUCCESS)
+	{
+		r->row = (chunk *)malloc((r->hdr.size)*sizeof(chunk));
+		r->enc = (unsigned char *)malloc(GCALAB_REC_MAXENC(r->hdr.size));
+		if (!(r->row) || !(r->enc))
+		{
+			rc = GCALAB_MEM_ERROR;
+		}
+	}
+	if (rc != GCALAB_SUCCESS)
+	{
+		GCALab_CloseRecording(r);
+		return rc;
+	}
+	r->cur = r->hdr.nrows;
+	(*rec) = r;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Closes a recording opened by GCALab_OpenRecording().
+ */
+void GCALab_CloseRecording(GCALab_Recording *rec)
+{
+	if (rec == NULL)
+	{
+		return;
+	}
+	if (rec->fp)
+	{
+		fclose(rec->fp);
+	}
+	free(rec->keys);
+	free(rec->row);
+	free(rec->enc);
+	free(rec);
+}
+
+/**
+ * @brief Finds the row of time step t, followed by the rows of the next n-1 steps.
+ * @details If the GCA was reset while recording, the last such row is found.
+ * @retval GCALAB_SUCCESS if time steps t to t+n-1 were recorded in one piece.
+ * @retval GCALAB_INVALID_OPTION otherwise.
+ */
+char GCALab_FindRecordedSteps(GCALab_Recording *rec,unsigned int t,unsigned int n,unsigned long long *row)
+{
+	unsigned long long k,j,end,first,last;
+	if (n == 0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	for (k=rec->hdr.nkeys;k>0;k--)
+	{
+		end = (k < rec->hdr.nkeys) ? rec->keys[k].row : rec->hdr.nrows;
+		if (t < rec->keys[k-1].t || (unsigned long long)(t - rec->keys[k-1].t) >= end - rec->keys[k-1].row)
+		{
+			continue;
+		}
+		first = rec->keys[k-1].row + (t - rec->keys[k-1].t);
+		last = first + n - 1;
+		/*time carries on over periodic keyframes, but not over resets*/
+		for (j=k;j < rec->hdr.nkeys && rec->keys[j].row <= last;j++)
+		{
+			if (rec->keys[j].t - rec->keys[k-1].t != rec->keys[j].row - rec->keys[k-1].row)
+			{
+				break;
+			}
+		}
+		if (last < rec->hdr.nrows && (j == rec->hdr.nkeys || rec->keys[j].row > last))
+		{
+			*row = first;
+			return GCALAB_SUCCESS;
+		}
+	}
+	return GCALAB_INVALID_OPTION;
+}
+
+/**
+ * @brief Decodes a row of a recording.
+ *
+ * @details Decoding starts at the keyframe before the row, or carries on from the
+ * row last read if that is closer, so reading rows in order decodes each once.
+ *
+ * @param config Set to the configuration, valid until the next read.
+ * @retval GCALAB_SUCCESS if the row was read.
+ * @retval GCALAB_INVALID_OPTION if the row is not in the recording or is corrupt.
+ */
+char GCALab_ReadRecording(GCALab_Recording *rec,unsigned long long row,chunk **config)
+{
+	GCALab_RecRow hdr;
+	unsigned long long lo,hi,mid,r,pos;
+
+	if (row >= rec->hdr.nrows || rec->hdr.nkeys == 0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	/*the last keyframe at or before row*/
+	lo = 0;
+	hi = rec->hdr.nkeys;
+	while (hi - lo > 1)
+	{
+		mid = (lo + hi)/2;
+		if (rec->keys[mid].row <= row)
+		{
+			lo = mid;
+		}
+		else
+		{
+			hi = mid;
+		}
+	}
+	if (rec->cur < rec->hdr.nrows && rec->cur >= rec->keys[lo].row && rec->cur <= row)
+	{
+		r = rec->cur + 1;
+		pos = rec->next;
+	}
+	else
+	{
+		r = rec->keys[lo].row;
+		pos = rec->keys[lo].offset;
+	}
+	for (;r <= row;r++)
+	{
+		if (fseek(rec->fp,(long)pos,SEEK_SET) != 0 || fread((void *)&hdr,sizeof(GCALab_RecRow),1,rec->fp) != 1
+			|| hdr.len > GCALAB_REC_MAXENC(rec->hdr.size) || (r == rec->keys[lo].row && hdr.type != GCALAB_REC_KEY)
+			|| (hdr.len > 0 && fread((void *)(rec->enc),hdr.len,1,rec->fp) != 1)
+			|| GCALab_RecDecode(rec->enc,hdr.len,rec->row,rec->hdr.size,(hdr.type == GCALAB_REC_DELTA)) != GCALAB_SUCCESS)
+		{
+			rec->cur = rec->hdr.nrows;
+			return GCALAB_INVALID_OPTION;
+		}
+		pos += sizeof(GCALab_RecRow) + hdr.len;
+		rec->cur = r;
+		rec->cur_t = hdr.t;
+		rec->next = pos;
+	}
+	*config = rec->row;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Writes time steps t0 to t1 of a recording to a bitmap, with the same
+ * layout as the space-time pattern written by GCALab_fio_saveCA().
+ *
+ * @retval GCALAB_SUCCESS if the image was written.
+ * @retval GCALAB_INVALID_OPTION if the range was not recorded in one piece, or the
+ * image could not be written.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ */
+char GCALab_ExportRecording(GCALab_Recording *rec,unsigned int t0,unsigned int t1,char *filename)
+{
+	GCALab_STPWriter stp;
+	chunk *config;
+	unsigned long long row;
+	unsigned int j;
+	char rc;
+
+	if (t1 < t0 || GCALab_FindRecordedSteps(rec,t0,t1 - t0 + 1,&row) != GCALAB_SUCCESS)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	switch (GCALab_fio_openSTP(&stp,filename,rec->hdr.N,rec->hdr.s,t1 - t0 + 1))
+	{
+		case WRITE_SUCCESS:
+			break;
+		case OUT_OF_MEMORY:
+			return GCALAB_MEM_ERROR;
+		default:
+			return GCALAB_INVALID_OPTION;
+	}
+	rc = GCALAB_SUCCESS;
+	for (j=0;j<=t1 - t0 && rc == GCALAB_SUCCESS;j++)
+	{
+		rc = GCALab_ReadRecording(rec,row + j,&config);
+		if (rc == GCALAB_SUCCESS && rec->cur_t != t0 + j)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+		/*the last time step is the bottom row, as in the window*/
+		if (rc == GCALAB_SUCCESS && GCALab_fio_writeSTPRow(&stp,t1 - t0 - j,config) != WRITE_SUCCESS)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+	}
+	if (GCALab_fio_closeSTP(&stp) != WRITE_SUCCESS && rc == GCALAB_SUCCESS)
+	{
+		rc = GCALAB_INVALID_OPTION;
+	}
+	return rc;
+}
@@ -0,0 +1,157 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_rec.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Space-time pattern recorder definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_REC_H
+#define __GCALAB_REC_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include "GCA.h"
+
+/*identifies the recording file format*/
+#define GCALAB_REC_MAGIC "GCAREC01"
+#define GCALAB_REC_MAGIC_LEN 8
+#define GCALAB_REC_VERSION 1
+
+#ifndef GCALAB_REC_KEYINT
+/*default number of rows between keyframes*/
+#define GCALAB_REC_KEYINT 	256
+#endif
+
+#ifndef GCALAB_REC_DEPTH
+/*number of rows waiting for the writer before the simulation is held up*/
+#define GCALAB_REC_DEPTH 	64
+#endif
+
+/*kinds of row*/
+/*the row itself*/
+#define GCALAB_REC_KEY 		0
+/*the row XOR the one before it*/
+#define GCALAB_REC_DELTA 	1
+
+typedef struct GCALab_RecHeader_struct GCALab_RecHeader;
+typedef struct GCALab_RecRow_struct GCALab_RecRow;
+typedef struct GCALab_RecKey_struct GCALab_RecKey;
+typedef struct GCALab_Recorder_struct GCALab_Recorder;
+typedef struct GCALab_Recording_struct GCALab_Recording;
+
+/*Recording file format
+ *
+ * A header, then one GCALab_RecRow per recorded configuration followed by len
+ * bytes of run-length encoded chunks. Runs are pairs of chunk counts (zeros,
+ * literals) followed by the literals, until the row is covered. Keyframes encode
+ * the row, other rows the row XOR the previous one, which is mostly zeros. The
+ * keyframe index is written at the end once the recorder is closed, a file that
+ * was never closed is indexed by scanning the rows.
+ */
+struct GCALab_RecHeader_struct
+{
+	char magic[GCALAB_REC_MAGIC_LEN];
+	unsigned int version;
+	unsigned int chunkbits;
+	unsigned int N;
+	unsigned int s;
+	unsigned int size;
+	unsigned int keyint;
+	unsigned long long nrows;
+	unsigned long long nkeys;
+	/*offset of the keyframe index, 0 if the recorder was not closed*/
+	unsigned long long index;
+};
+
+struct GCALab_RecRow_struct
+{
+	unsigned int type;
+	unsigned int t;
+	unsigned int len;
+	unsigned int pad;
+};
+
+/*a keyframe index entry, row is the number of the row in the recording*/
+struct GCALab_RecKey_struct
+{
+	unsigned long long row;
+	unsigned long long offset;
+	unsigned int t;
+	unsigned int pad;
+};
+
+/*A recorder attached to a GCA
+ *
+ * The simulation copies each new configuration into a slot and moves on, a
+ * writer thread encodes and appends the slots in order.
+ */
+struct GCALab_Recorder_struct
+{
+	char *filename;
+	FILE *fp;
+	GCALab_RecHeader hdr;
+	GCALab_RecKey *keys;
+	unsigned long long maxkeys;
+	/*rows waiting for the writer, slots [tail,head) mod GCALAB_REC_DEPTH*/
+	chunk *slots;
+	unsigned int slot_t[GCALAB_REC_DEPTH];
+	unsigned long long head;
+	unsigned long long tail;
+	/*writer state*/
+	chunk *prev;
+	unsigned char *enc;
+	unsigned int last_t;
+	unsigned long long offset;
+	unsigned char closed;
+	unsigned char error;
+	pthread_t writer;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+/*A recording opened for reading*/
+struct GCALab_Recording_struct
+{
+	FILE *fp;
+	GCALab_RecHeader hdr;
+	GCALab_RecKey *keys;
+	/*the row last decoded, and where the one after it starts*/
+	chunk *row;
+	unsigned long long cur;
+	unsigned long long next;
+	unsigned int cur_t;
+	unsigned char *enc;
+};
+
+char GCALab_OpenRecorder(GCALab_Recorder **rec,char *filename,GraphCellularAutomaton *GCA,unsigned int keyint);
+char GCALab_RecordStep(GCALab_Recorder *rec,GraphCellularAutomaton *GCA);
+char GCALab_FlushRecorder(GCALab_Recorder *rec);
+char GCALab_FinishRecorder(GCALab_Recorder *rec);
+char GCALab_CloseRecorder(GCALab_Recorder *rec);
+
+char GCALab_OpenRecording(GCALab_Recording **rec,char *filename);
+void GCALab_CloseRecording(GCALab_Recording *rec);
+char GCALab_FindRecordedSteps(GCALab_Recording *rec,unsigned int t,unsigned int n,unsigned long long *row);
+char GCALab_ReadRecording(GCALab_Recording *rec,unsigned long long row,chunk **config);
+char GCALab_ExportRecording(GCALab_Recording *rec,unsigned int t0,unsigned int t1,char *filename);
+
+#endif
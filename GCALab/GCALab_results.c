@@ -0,0 +1,352 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_results.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Workspace results store. Keeps a growable index of results and
+ *              moves large payloads (pre-image sets, frequency tables, density
+ *              series, sweeps) out to an mmap'd scratch file so long runs
+ *              neither drop results nor hold every payload in RAM.
+ *
+ *==============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "GCALab.h"
+
+/*where spill files are created*/
+static char *GCALab_ScratchDir = NULL;
+
+/**
+ * @brief Sets the directory spill files are created in.
+ * @param dir the directory, NULL for $TMPDIR (or GCALAB_DEFAULT_SCRATCH)
+ */
+void GCALab_SetScratchDir(char *dir)
+{
+	GCALab_ScratchDir = dir;
+}
+
+/**
+ * @brief Size in bytes of one element of a result type.
+ * @param type one of the GCALab_fio.h type codes
+ */
+size_t GCALab_TypeSize(int type)
+{
+	switch(type)
+	{
+		case UINT8:
+		case SINT8:
+		case HEX8:
+			return 1;
+		case UINT16:
+		case SINT16:
+		case HEX16:
+			return 2;
+		case FLOAT64:
+		case UINT64:
+		case SINT64:
+		case HEX64:
+			return 8;
+		default:
+			return 4;
+	}
+}
+
+/**
+ * @brief Creates the spill file, it is unlinked straight away so it goes
+ * when GCALab exits.
+ */
+static char GCALab_OpenSpill(GCALab_ResultStore *rs)
+{
+	char *dir;
+	char *path;
+	dir = GCALab_ScratchDir;
+	if (dir == NULL)
+	{
+		dir = getenv("TMPDIR");
+	}
+	if (dir == NULL || dir[0] == '\0')
+	{
+		dir = GCALAB_DEFAULT_SCRATCH;
+	}
+	if (!(path = (char *)malloc(strlen(dir) + 32)))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	sprintf(path,"%s/gcalab-spill-XXXXXX",dir);
+	rs->fd = mkstemp(path);
+	if (rs->fd >= 0)
+	{
+		unlink(path);
+	}
+	free(path);
+	return (rs->fd >= 0) ? GCALAB_SUCCESS : GCALAB_FATAL_ERROR;
+}
+
+/**
+ * @brief Reserves size bytes in the spill file.
+ * @returns a pointer to the mapped space, or NULL if it could not be made.
+ */
+static void *GCALab_SpillAlloc(GCALab_ResultStore *rs,size_t size)
+{
+	GCALab_SpillMap *map;
+	size_t len,page;
+	void *base;
+
+	if (rs->fd < 0 && GCALab_OpenSpill(rs) != GCALAB_SUCCESS)
+	{
+		return NULL;
+	}
+	/*keep payloads 16 byte aligned*/
+	size = (size + 15) & ~((size_t)15);
+	if (rs->nummaps > 0)
+	{
+		map = rs->maps + rs->nummaps - 1;
+		if (map->len - map->used >= size)
+		{
+			base = (void *)(map->base + map->used);
+			map->used += size;
+			return base;
+		}
+	}
+
+	/*map a new region at the end of the file*/
+	if (rs->nummaps == rs->capmaps)
+	{
+		rs->capmaps = (rs->capmaps > 0) ? 2*rs->capmaps : 8;
+		if (!(map = (GCALab_SpillMap *)realloc(rs->maps,rs->capmaps*sizeof(GCALab_SpillMap))))
+		{
+			return NULL;
+		}
+		rs->maps = map;
+	}
+	page = (size_t)sysconf(_SC_PAGESIZE);
+	len = (size > GCALAB_SPILL_CHUNK) ? size : GCALAB_SPILL_CHUNK;
+	len = ((len + page - 1)/page)*page;
+	if (ftruncate(rs->fd,rs->filelen + (off_t)len) != 0)
+	{
+		return NULL;
+	}
+	base = mmap(NULL,len,PROT_READ | PROT_WRITE,MAP_SHARED,rs->fd,rs->filelen);
+	if (base == MAP_FAILED)
+	{
+		return NULL;
+	}
+	rs->filelen += (off_t)len;
+	map = rs->maps + rs->nummaps;
+	map->base = (char *)base;
+	map->len = len;
+	map->used = size;
+	rs->nummaps++;
+	return base;
+}
+
+/**
+ * @brief Initialises an empty results store.
+ * @param rs the store to initialise
+ */
+char GCALab_InitResults(GCALab_ResultStore *rs)
+{
+	memset((void *)(rs->blocks),0,GCALAB_RESULTS_BLOCKS*sizeof(GCALabOutput **));
+	if (!(rs->blocks[0] = (GCALabOutput **)malloc(GCALAB_RESULTS_INIT_SIZE*sizeof(GCALabOutput *))))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	rs->num = 0;
+	rs->cap = GCALAB_RESULTS_INIT_SIZE;
+	rs->fd = -1;
+	rs->filelen = 0;
+	rs->maps = NULL;
+	rs->nummaps = 0;
+	rs->capmaps = 0;
+	rs->inram = 0;
+	rs->spilled = 0;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Gets the index entry of a result, the block holding it must exist.
+ */
+static GCALabOutput **GCALab_ResultSlot(GCALab_ResultStore *rs,unsigned int res_id)
+{
+	unsigned int b,first,size;
+	first = 0;
+	size = GCALAB_RESULTS_INIT_SIZE;
+	for (b=0;res_id - first >= size;b++)
+	{
+		first += size;
+		size <<= 1;
+	}
+	return rs->blocks[b] + (res_id - first);
+}
+
+/**
+ * @brief Makes room in the index for one more result, by adding a block twice
+ * the size of the last.
+ */
+static char GCALab_GrowResults(GCALab_ResultStore *rs)
+{
+	unsigned int b,size;
+	if (rs->num == rs->cap)
+	{
+		for (b=0,size=GCALAB_RESULTS_INIT_SIZE;b < GCALAB_RESULTS_BLOCKS && rs->blocks[b] != NULL;b++)
+		{
+			size <<= 1;
+		}
+		if (b == GCALAB_RESULTS_BLOCKS || !(rs->blocks[b] = (GCALabOutput **)malloc(size*sizeof(GCALabOutput *))))
+		{
+			return GCALAB_MEM_ERROR;
+		}
+		rs->cap += size;
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Stores a result in the next entry of the index.
+ * @details The entry is written before the count, so readers that see the new 
+ * count see the result.
+ */
+static void GCALab_AppendResult(GCALab_ResultStore *rs,GCALabOutput *res)
+{
+	*GCALab_ResultSlot(rs,rs->num) = res;
+	__sync_synchronize();
+	rs->num++;
+}
+
+/**
+ * @brief Appends a result, spilling its payload if it is large.
+ * @details If the payload can not be spilled (e.g., the scratch directory is
+ * not writable) it is kept in memory.
+ * @param rs the store
+ * @param res the result, the store takes ownership of it
+ */
+char GCALab_AddResult(GCALab_ResultStore *rs,GCALabOutput *res)
+{
+	size_t size;
+	void *dst;
+
+	if (GCALab_GrowResults(rs) != GCALAB_SUCCESS)
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	size = (size_t)res->datalen*GCALab_TypeSize(res->type);
+	dst = NULL;
+	if (res->data != NULL && size >= GCALAB_SPILL_THRESHOLD)
+	{
+		dst = GCALab_SpillAlloc(rs,size);
+	}
+	if (dst != NULL)
+	{
+		memcpy(dst,res->data,size);
+		free(res->data);
+		res->data = dst;
+		rs->spilled += size;
+	}
+	else
+	{
+		rs->inram += size;
+	}
+	GCALab_AppendResult(rs,res);
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Appends a result whose payload is in a mapping that is never unmapped 
+ * (e.g., a restored snapshot, see GCALab_RestoreWS()).
+ * @details The payload is used in place, it is counted as spilled.
+ * @param rs the store
+ * @param res the result, the store takes ownership of it but not of its payload
+ */
+char GCALab_AddMappedResult(GCALab_ResultStore *rs,GCALabOutput *res)
+{
+	if (GCALab_GrowResults(rs) != GCALAB_SUCCESS)
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	rs->spilled += (size_t)res->datalen*GCALab_TypeSize(res->type);
+	GCALab_AppendResult(rs,res);
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Frees every result of a store, its index and its spill file.
+ * @details Payloads in memory are freed and the spill file is unmapped and closed.
+ * Payloads added with GCALab_AddMappedResult() are not the store's, the caller 
+ * must set their data to NULL first. No other thread may be using the store.
+ * @param rs the store
+ */
+void GCALab_FreeResults(GCALab_ResultStore *rs)
+{
+	GCALabOutput *res;
+	unsigned int i,j;
+	char *data;
+
+	for (i=0;i<rs->num;i++)
+	{
+		res = *GCALab_ResultSlot(rs,i);
+		data = (char *)(res->data);
+		for (j=0;j<rs->nummaps && data != NULL;j++)
+		{
+			if (data >= rs->maps[j].base && data < rs->maps[j].base + rs->maps[j].len)
+			{
+				data = NULL;
+			}
+		}
+		free(data);
+		free(res);
+	}
+	for (i=0;i<GCALAB_RESULTS_BLOCKS;i++)
+	{
+		free(rs->blocks[i]);
+		rs->blocks[i] = NULL;
+	}
+	for (j=0;j<rs->nummaps;j++)
+	{
+		munmap((void *)(rs->maps[j].base),rs->maps[j].len);
+	}
+	free(rs->maps);
+	if (rs->fd >= 0)
+	{
+		close(rs->fd);
+	}
+	rs->num = 0;
+	rs->cap = 0;
+	rs->fd = -1;
+	rs->maps = NULL;
+	rs->nummaps = 0;
+	rs->capmaps = 0;
+}
+
+/**
+ * @brief Gets a result by id, safe to call while another thread adds results.
+ * @returns the result, NULL if there is no such result.
+ */
+GCALabOutput *GCALab_GetResult(GCALab_ResultStore *rs,unsigned int res_id)
+{
+	if (res_id >= rs->num)
+	{
+		return NULL;
+	}
+	__sync_synchronize();
+	return *GCALab_ResultSlot(rs,res_id);
+}
@@ -0,0 +1,100 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_results.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Workspace results store definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_RESULTS_H
+#define __GCALAB_RESULTS_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#ifndef GCALAB_RESULTS_INIT_SIZE
+/*capacity of the first block of the result index*/
+#define GCALAB_RESULTS_INIT_SIZE 64
+#endif
+
+/*number of index blocks, block i holds GCALAB_RESULTS_INIT_SIZE*2^i results*/
+#define GCALAB_RESULTS_BLOCKS 26
+
+#ifndef GCALAB_SPILL_THRESHOLD
+/*payloads of at least this many bytes are moved to the spill file*/
+#define GCALAB_SPILL_THRESHOLD 65536
+#endif
+
+#ifndef GCALAB_SPILL_CHUNK
+/*the spill file is grown and mapped this many bytes at a time*/
+#define GCALAB_SPILL_CHUNK 67108864
+#endif
+
+#ifndef GCALAB_DEFAULT_SCRATCH
+#define GCALAB_DEFAULT_SCRATCH "/tmp"
+#endif
+
+typedef struct GCALab_SpillMap_struct GCALab_SpillMap;
+typedef struct GCALab_ResultStore_struct GCALab_ResultStore;
+
+/*a mapped region of the spill file*/
+struct GCALab_SpillMap_struct
+{
+	char *base;
+	size_t len;
+	size_t used;
+};
+
+/*The results of a workspace
+ *
+ * The index grows a block at a time so no result is ever dropped, and blocks are
+ * never moved, so results can be read without the workspace lock while another
+ * thread adds to the store. Large payloads are
+ * copied into a shared mapping of an (unlinked) file in the scratch directory,
+ * and the result's data pointer is redirected there, so the payload stays
+ * readable as ordinary memory but the kernel can write it back and reclaim
+ * the pages. Mappings are never moved, so data pointers stay valid.
+ */
+struct GCALab_ResultStore_struct
+{
+	struct GCALabOutput_struct **blocks[GCALAB_RESULTS_BLOCKS];
+	volatile unsigned int num;
+	unsigned int cap;
+	/*spill file, -1 until the first large payload*/
+	int fd;
+	off_t filelen;
+	GCALab_SpillMap *maps;
+	unsigned int nummaps;
+	unsigned int capmaps;
+	/*payload bytes held in memory and in the spill file*/
+	size_t inram;
+	size_t spilled;
+};
+
+void GCALab_SetScratchDir(char *dir);
+char GCALab_InitResults(GCALab_ResultStore *rs);
+char GCALab_AddResult(GCALab_ResultStore *rs,struct GCALabOutput_struct *res);
+char GCALab_AddMappedResult(GCALab_ResultStore *rs,struct GCALabOutput_struct *res);
+void GCALab_FreeResults(GCALab_ResultStore *rs);
+struct GCALabOutput_struct *GCALab_GetResult(GCALab_ResultStore *rs,unsigned int res_id);
+size_t GCALab_TypeSize(int type);
+
+#endif
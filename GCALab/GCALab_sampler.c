@@ -0,0 +1,891 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_sampler.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Multi-threaded Monte Carlo sampling engine. Samples are divided
+ *              into fixed sized blocks, threads claim blocks dynamically and the
+ *              block sums of each round are reduced in block order. Combined with
+ *              one random stream per sample this makes the result independent of
+ *              the number of threads, and of the number of processes a sharded
+ *              job is split over.
+ *
+ *==============================================================================
+ */
+
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include "GCALab.h"
+
+/*shared state of a sampler run*/
+typedef struct
+{
+	GCALab_Sampler *smp;
+	/*the blocks [first, nblocks) this run evaluates, all of them unless it is a shard*/
+	unsigned long long first;
+	unsigned long long nblocks;
+	/*next block to claim and the current round [round_start, round_end)*/
+	unsigned long long next;
+	unsigned long long round_start;
+	unsigned long long round_end;
+	/*per-block partial sums followed by (count,mean,M2) of each monitored estimate,
+	 * from block base on, a shard keeps all of its blocks for the part file*/
+	double *blocksums;
+	unsigned long long base;
+	unsigned int stride;
+	/*running (count,mean,M2) of each monitored estimate*/
+	double stats[3*GCALAB_SAMPLER_MAX_STATS];
+	/*z-score of the requested confidence level*/
+	double z;
+	unsigned char done;
+	pthread_mutex_t lock;
+	pthread_barrier_t barrier;
+	/*profile of the command running the job (can be NULL)*/
+	GCALab_Profile *prof;
+	/*progress callback of the command running the job (can be NULL)*/
+	GCA_Progress *progress;
+	unsigned char stop;
+	/*checkpoint signature and time of the last checkpoint*/
+	unsigned long long sig;
+	struct timespec ckpt_time;
+} GCALab_SamplerRun;
+
+/*checkpoint file header, followed by the sums and the monitored (count,mean,M2) triples*/
+typedef struct
+{
+	char magic[GCALAB_CKPT_MAGIC_LEN];
+	unsigned long long sig;
+	unsigned long long n;
+	/*number of blocks reduced*/
+	unsigned long long next;
+	unsigned int nvals;
+	unsigned int nstats;
+	unsigned int complete;
+	unsigned int pad;
+} GCALab_CkptHeader;
+
+/*per-thread state*/
+typedef struct
+{
+	GCALab_SamplerRun *run;
+	GraphCellularAutomaton *GCA;
+	void *scratch;
+	double *vals;
+	pthread_t thread;
+} GCALab_SamplerWorker;
+
+/**
+ * @brief Sets default sampler options.
+ *
+ * @param smp The sampler to initialise.
+ * @param GCA The prototype GCA.
+ * @param nvals Number of values computed per sample.
+ */
+void GCALab_InitSampler(GCALab_Sampler *smp,GraphCellularAutomaton *GCA,unsigned int nvals)
+{
+	smp->GCA = GCA;
+	smp->n = 1;
+	smp->nvals = nvals;
+	smp->nthreads = GCALAB_DEFAULT_THREADS;
+	smp->seed = GCALAB_DEFAULT_SEED;
+	smp->range = NULL;
+	smp->stride = 1;
+	smp->rotate = 0;
+	smp->init = NULL;
+	smp->sample = NULL;
+	smp->reduce = NULL;
+	smp->args = NULL;
+	smp->round = GCALAB_SAMPLER_ROUND;
+	smp->tol = 0.0;
+	smp->conf = GCALAB_DEFAULT_CONF;
+	smp->nstats = 0;
+	smp->ckpt = NULL;
+	smp->ckpt_tag = 0;
+	smp->shard = NULL;
+	smp->counts = NULL;
+	smp->ncounts = 0;
+	smp->sums = NULL;
+	smp->n_used = 0;
+	smp->stopped = 0;
+}
+
+/**
+ * @brief Samples explicit initial conditions from a range instead of noise.
+ *
+ * @param smp The sampler.
+ * @param range Two element array [start, end) of initial conditions.
+ * @param stride Increment between consecutive initial conditions.
+ *
+ * @retval GCALAB_INVALID_OPTION if the range is empty or the GCA is too large to enumerate.
+ */
+char GCALab_SetSamplerRange(GCALab_Sampler *smp,chunk *range,unsigned int stride)
+{
+	if (range[1] <= range[0] || stride == 0 || smp->GCA->size != 1)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	smp->range = range;
+	smp->stride = stride;
+	smp->n = ((unsigned long long)(range[1] - range[0]) + stride - 1)/stride;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Enables early stopping once the monitored estimates are precise enough.
+ *
+ * @param smp The sampler, smp->n becomes the maximum number of samples.
+ * @param tol Target confidence interval half-width.
+ * @param conf Confidence level, 0 < conf < 1.
+ *
+ * @retval GCALAB_INVALID_OPTION if tol or conf are out of range.
+ */
+char GCALab_SetSamplerTolerance(GCALab_Sampler *smp,double tol,double conf)
+{
+	if (tol <= 0.0 || conf <= 0.0 || conf >= 1.0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	smp->tol = tol;
+	smp->conf = conf;
+	/*smaller rounds so we can stop sooner*/
+	smp->round = GCALAB_SAMPLER_SEQ_ROUND;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Adds an estimate to track the mean and variance of.
+ *
+ * @param smp The sampler.
+ * @param val Index of the sample value to estimate the mean of.
+ * @param wgt Index of a 0/1 sample value selecting which samples count, -1 for all.
+ *
+ * @retval GCALAB_INVALID_OPTION if too many estimates are monitored.
+ */
+char GCALab_SamplerMonitor(GCALab_Sampler *smp,unsigned int val,int wgt)
+{
+	if (smp->nstats >= GCALAB_SAMPLER_MAX_STATS || val >= smp->nvals || wgt >= (int)smp->nvals)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	smp->stat_val[smp->nstats] = val;
+	smp->stat_wgt[smp->nstats] = wgt;
+	smp->nstats++;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Approximates the quantile function of the standard normal distribution.
+ *
+ * @details Rational approximation of Abramowitz and Stegun (26.2.23), absolute error
+ * is less than 4.5e-4 which is plenty for confidence intervals.
+ *
+ * @param p Probability, 0 < p < 1.
+ *
+ * @returns z such that P(Z < z) = p.
+ */
+double GCALab_NormalQuantile(double p)
+{
+	double q,t,z;
+	q = (p < 0.5) ? p : 1.0 - p;
+	t = sqrt(-2.0*log(q));
+	z = t - (2.515517 + 0.802853*t + 0.010328*t*t)/(1.0 + 1.432788*t + 0.189269*t*t + 0.001308*t*t*t);
+	return (p < 0.5) ? -z : z;
+}
+
+/**
+ * @brief Merges (count,mean,M2) of b into a (Chan et al. parallel variance).
+ */
+static void GCALab_MergeStats(double *a,double *b)
+{
+	double n,delta;
+	if (b[0] == 0)
+	{
+		return;
+	}
+	n = a[0] + b[0];
+	delta = b[1] - a[1];
+	a[1] += delta*b[0]/n;
+	a[2] += b[2] + delta*delta*a[0]*b[0]/n;
+	a[0] = n;
+}
+
+/**
+ * @brief Confidence interval half-width of a (count,mean,M2) triple.
+ */
+static double GCALab_StatsCI(double *a,double z)
+{
+	if (a[0] < 2)
+	{
+		return HUGE_VAL;
+	}
+	return z*sqrt(a[2]/((a[0]-1.0)*a[0]));
+}
+
+/**
+ * @brief Hashes everything that determines the sums of a job.
+ */
+static unsigned long long GCALab_SamplerSignature(GCALab_Sampler *smp)
+{
+	GraphCellularAutomaton *GCA;
+	unsigned long long h;
+	unsigned long long job[10];
+	double prec[2];
+	GCA = smp->GCA;
+	h = GCALab_HashTopology(GCA);
+	h = GCALab_Hash(h,(void*)GCA->ruleLUT,(GCA->LUT_size)*sizeof(state));
+	job[0] = smp->n;
+	job[1] = smp->nvals;
+	job[2] = smp->seed;
+	job[3] = (smp->range != NULL) ? (unsigned long long)smp->range[0] : 0;
+	job[4] = (smp->range != NULL) ? (unsigned long long)smp->range[1] : 0;
+	job[5] = (smp->range != NULL) ? smp->stride : 0;
+	job[6] = smp->rotate;
+	job[7] = smp->round;
+	job[8] = smp->nstats;
+	job[9] = smp->ckpt_tag;
+	h = GCALab_Hash(h,(void*)job,10*sizeof(unsigned long long));
+	prec[0] = smp->tol;
+	prec[1] = smp->conf;
+	h = GCALab_Hash(h,(void*)prec,2*sizeof(double));
+	h = GCALab_Hash(h,(void*)smp->stat_val,(smp->nstats)*sizeof(unsigned int));
+	return GCALab_Hash(h,(void*)smp->stat_wgt,(smp->nstats)*sizeof(int));
+}
+
+/**
+ * @brief Writes the reduced sums of a job to its checkpoint file.
+ *
+ * @details The checkpoint is written to a temporary file which then replaces the
+ * old one, so there is always a complete checkpoint on disk.
+ */
+static char GCALab_SaveCheckpoint(GCALab_SamplerRun *run)
+{
+	GCALab_Sampler *smp;
+	GCALab_CkptHeader hdr;
+	char *tmp;
+	int fd;
+	size_t len;
+	char rc;
+
+	smp = run->smp;
+	if (!(tmp = (char *)malloc(strlen(smp->ckpt) + 5)))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	sprintf(tmp,"%s.tmp",smp->ckpt);
+	memset((void*)&hdr,0,sizeof(GCALab_CkptHeader));
+	memcpy(hdr.magic,GCALAB_CKPT_MAGIC,GCALAB_CKPT_MAGIC_LEN);
+	hdr.sig = run->sig;
+	hdr.n = smp->n;
+	hdr.next = run->next;
+	hdr.nvals = smp->nvals;
+	hdr.nstats = smp->nstats;
+	hdr.complete = (run->done && !run->stop);
+
+	rc = GCALAB_INVALID_OPTION;
+	if ((fd = open(tmp,O_WRONLY | O_CREAT | O_TRUNC,0644)) >= 0)
+	{
+		len = (smp->nvals)*sizeof(double);
+		if (write(fd,(void*)&hdr,sizeof(GCALab_CkptHeader)) == sizeof(GCALab_CkptHeader)
+			&& write(fd,(void*)smp->sums,len) == (ssize_t)len
+			&& write(fd,(void*)run->stats,3*(smp->nstats)*sizeof(double)) == (ssize_t)(3*(smp->nstats)*sizeof(double))
+			&& fsync(fd) == 0)
+		{
+			rc = GCALAB_SUCCESS;
+		}
+		close(fd);
+		if (rc == GCALAB_SUCCESS && rename(tmp,smp->ckpt) != 0)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+	}
+	free(tmp);
+	clock_gettime(CLOCK_MONOTONIC,&(run->ckpt_time));
+	return rc;
+}
+
+/**
+ * @brief Restores the reduced sums of a job from its checkpoint file, if it has one.
+ *
+ * @retval GCALAB_SUCCESS if there is no checkpoint yet or it was restored.
+ * @retval GCALAB_INVALID_OPTION if the file is not a checkpoint of this job.
+ */
+static char GCALab_LoadCheckpoint(GCALab_SamplerRun *run)
+{
+	GCALab_Sampler *smp;
+	GCALab_CkptHeader hdr;
+	int fd;
+	size_t len;
+	char rc;
+
+	smp = run->smp;
+	if ((fd = open(smp->ckpt,O_RDONLY)) < 0)
+	{
+		return GCALAB_SUCCESS;
+	}
+	rc = GCALAB_INVALID_OPTION;
+	len = (smp->nvals)*sizeof(double);
+	if (read(fd,(void*)&hdr,sizeof(GCALab_CkptHeader)) == sizeof(GCALab_CkptHeader)
+		&& !memcmp(hdr.magic,GCALAB_CKPT_MAGIC,GCALAB_CKPT_MAGIC_LEN) && hdr.sig == run->sig 
+		&& hdr.n == smp->n && hdr.nvals == smp->nvals && hdr.nstats == smp->nstats && hdr.next <= run->nblocks
+		&& read(fd,(void*)smp->sums,len) == (ssize_t)len
+		&& read(fd,(void*)run->stats,3*(smp->nstats)*sizeof(double)) == (ssize_t)(3*(smp->nstats)*sizeof(double)))
+	{
+		/*rounds stay where they would have been had the job never stopped*/
+		run->next = hdr.next;
+		run->round_start = hdr.next;
+		run->base = hdr.next;
+		run->round_end = (hdr.next/smp->round + 1)*smp->round;
+		run->round_end = (run->round_end > run->nblocks) ? run->nblocks : run->round_end;
+		smp->n_used = (hdr.next*GCALAB_SAMPLER_BLOCK > smp->n) ? smp->n : hdr.next*GCALAB_SAMPLER_BLOCK;
+		run->done = (hdr.complete != 0);
+		rc = GCALAB_SUCCESS;
+	}
+	close(fd);
+	return rc;
+}
+
+/**
+ * @brief Writes the block sums and counts of a shard to its part file.
+ * @details A shard that was stopped writes the blocks it did, marked incomplete.
+ */
+static char GCALab_SaveShard(GCALab_SamplerRun *run,unsigned long long total)
+{
+	GCALab_Sampler *smp;
+	GCALab_ShardHeader hdr;
+	size_t len;
+
+	smp = run->smp;
+	GCALab_InitShardHeader(smp->shard,&hdr,GCALAB_SHARD_SAMPLER,run->sig,total);
+	hdr.end = run->next;
+	hdr.complete = (run->done && !run->stop);
+	/*counts follow the blocks, there is room for them at the end of blocksums*/
+	len = (size_t)(run->next - run->first)*(run->stride)*sizeof(double);
+	if (smp->ncounts > 0)
+	{
+		memcpy((void*)(((char *)run->blocksums) + len),(void*)smp->counts,(smp->ncounts)*sizeof(unsigned int));
+	}
+	hdr.len = len + (smp->ncounts)*sizeof(unsigned int);
+	return GCALab_WriteShard(smp->shard,&hdr,(void*)run->blocksums);
+}
+
+/**
+ * @brief Merges the part files of a sharded job.
+ *
+ * @details The blocks of every part are reduced in block order, as the rounds of 
+ * a single run would, so the sums and monitored estimates are the same. Counts
+ * are added to smp->counts.
+ */
+static char GCALab_MergeSampler(GCALab_Sampler *smp)
+{
+	GCALab_ShardHeader hdr;
+	double stats[3*GCALAB_SAMPLER_MAX_STATS];
+	double *data,*bsum,*bstat;
+	unsigned int *counts;
+	unsigned long long b,nb;
+	unsigned int i,v,k,stride;
+	double z;
+	char rc;
+
+	smp->sums = (double *)malloc((smp->nvals+1)*sizeof(double));
+	if (smp->sums == NULL)
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	memset(smp->sums,0,(smp->nvals+1)*sizeof(double));
+	memset((void*)stats,0,3*GCALAB_SAMPLER_MAX_STATS*sizeof(double));
+	stride = smp->nvals + 3*smp->nstats;
+	GCALab_InitShardHeader(smp->shard,&hdr,GCALAB_SHARD_SAMPLER,GCALab_SamplerSignature(smp),
+		(smp->n + GCALAB_SAMPLER_BLOCK - 1)/GCALAB_SAMPLER_BLOCK);
+	hdr.start = 0;
+
+	rc = GCALAB_SUCCESS;
+	for (i=0;i<smp->shard->count && rc == GCALAB_SUCCESS;i++)
+	{
+		rc = GCALab_ReadShard(smp->shard,i,&hdr,(void**)&data);
+		if (rc != GCALAB_SUCCESS)
+		{
+			break;
+		}
+		nb = hdr.end - hdr.start;
+		if (hdr.len != nb*stride*sizeof(double) + (smp->ncounts)*sizeof(unsigned int))
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+		else
+		{
+			for (b=0;b<nb;b++)
+			{
+				bsum = data + b*stride;
+				bstat = bsum + smp->nvals;
+				for (v=0;v<smp->nvals;v++)
+				{
+					smp->sums[v] += bsum[v];
+				}
+				for (k=0;k<smp->nstats;k++)
+				{
+					GCALab_MergeStats(stats + 3*k,bstat + 3*k);
+				}
+			}
+			counts = (unsigned int *)(data + nb*stride);
+			for (v=0;v<smp->ncounts;v++)
+			{
+				smp->counts[v] += counts[v];
+			}
+		}
+		free(data);
+		hdr.start = hdr.end;
+	}
+	if (rc != GCALAB_SUCCESS)
+	{
+		free(smp->sums);
+		smp->sums = NULL;
+		return rc;
+	}
+
+	smp->n_used = smp->n;
+	smp->stopped = 0;
+	z = GCALab_NormalQuantile(0.5 + 0.5*smp->conf);
+	for (k=0;k<smp->nstats;k++)
+	{
+		smp->stat_n[k] = (unsigned long long)stats[3*k];
+		smp->stat_mean[k] = stats[3*k+1];
+		smp->stat_ci[k] = GCALab_StatsCI(stats + 3*k,z);
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Passes the progress of a job to the command running it.
+ * @details The caller must hold the run lock.
+ */
+static void GCALab_SamplerReport(GCALab_SamplerRun *run,unsigned long long b)
+{
+	if (!run->stop && run->progress != NULL && run->progress->f != NULL)
+	{
+		unsigned long long total;
+		total = run->nblocks*GCALAB_SAMPLER_BLOCK;
+		total = (total > run->smp->n) ? run->smp->n : total;
+		run->stop = (*(run->progress->f))(run->progress->arg,(b - run->first)*GCALAB_SAMPLER_BLOCK,total - run->first*GCALAB_SAMPLER_BLOCK);
+	}
+}
+
+/**
+ * @brief Prepares the worker's GCA for sample i.
+ */
+static void GCALab_SamplerSetup(GCALab_Sampler *smp,GraphCellularAutomaton *GCA,unsigned long long i,GCA_RandStream *rs,unsigned char rotate)
+{
+	chunk ic;
+	/*clear the window so nothing carries over from the previous sample*/
+	ClearWindow(GCA);
+	SeedRandStream(rs,smp->seed,i);
+	GCA->rng = rs;
+	if (rotate)
+	{
+		unsigned int j,k_1,N;
+		N = GCA->params->N;
+		k_1 = GCA->params->k - 1;
+		/*always rotate from the original topology so sample i is reproducible*/
+		memcpy(GCA->params->graph,smp->GCA->params->graph,N*k_1*sizeof(unsigned int));
+		for (j=0;j<N;j++)
+		{
+			RotateNeighbourhood(GCA,j,(unsigned int)(RandStreamNext(rs)%k_1));
+		}
+	}
+
+	if (smp->range != NULL)
+	{
+		ic = smp->range[0] + (chunk)(i*smp->stride);
+		SetCAIC(GCA,&ic,EXPLICIT_IC_TYPE);
+	}
+	else
+	{
+		SetCAIC(GCA,NULL,NOISE_IC_TYPE);
+	}
+	ResetCA(GCA);
+}
+
+/**
+ * @brief Sampler thread, evaluates blocks until all rounds are complete.
+ */
+static void *GCALab_SamplerWorkerMain(void *params)
+{
+	GCALab_SamplerWorker *w;
+	GCALab_SamplerRun *run;
+	GCALab_Sampler *smp;
+	GCA_RandStream rs;
+	unsigned long long b,i,i_end;
+	unsigned int v,k;
+	double *bsum,*bstat;
+	GCALab_Profile prof;
+
+	w = (GCALab_SamplerWorker *)params;
+	run = w->run;
+	smp = run->smp;
+	GCALab_ProfileThreadBegin(&prof,run->prof);
+
+	while(1)
+	{
+		pthread_mutex_lock(&(run->lock));
+		b = run->next;
+		if (b < run->round_end)
+		{
+			GCALab_SamplerReport(run,b);
+		}
+		/*once stopped no more blocks are started, the round ends with those done*/
+		if (run->stop)
+		{
+			b = run->round_end;
+		}
+		else if (b < run->round_end)
+		{
+			run->next++;
+		}
+		pthread_mutex_unlock(&(run->lock));
+
+		if (b < run->round_end)
+		{
+			bsum = run->blocksums + (b - run->base)*run->stride;
+			bstat = bsum + smp->nvals;
+			for (v=0;v<run->stride;v++)
+			{
+				bsum[v] = 0;
+			}
+			i_end = (b+1)*GCALAB_SAMPLER_BLOCK;
+			i_end = (i_end > smp->n) ? smp->n : i_end;
+			for (i=b*GCALAB_SAMPLER_BLOCK;i<i_end;i++)
+			{
+				GCALab_SamplerSetup(smp,w->GCA,i,&rs,smp->rotate);
+				smp->sample(w->GCA,w->scratch,smp->args,w->vals);
+				for (v=0;v<smp->nvals;v++)
+				{
+					bsum[v] += w->vals[v];
+				}
+				/*Welford update of the monitored estimates*/
+				for (k=0;k<smp->nstats;k++)
+				{
+					if (smp->stat_wgt[k] < 0 || w->vals[smp->stat_wgt[k]] != 0)
+					{
+						double x,delta;
+						x = w->vals[smp->stat_val[k]];
+						bstat[3*k]++;
+						delta = x - bstat[3*k+1];
+						bstat[3*k+1] += delta/bstat[3*k];
+						bstat[3*k+2] += delta*(x - bstat[3*k+1]);
+					}
+				}
+			}
+			continue;
+		}
+
+		/*end of round, one thread reduces the blocks in order*/
+		if (pthread_barrier_wait(&(run->barrier)) == PTHREAD_BARRIER_SERIAL_THREAD)
+		{
+			unsigned char converged;
+			struct timespec now;
+			for (b=run->round_start;b<run->next;b++)
+			{
+				bsum = run->blocksums + (b - run->base)*run->stride;
+				bstat = bsum + smp->nvals;
+				for (v=0;v<smp->nvals;v++)
+				{
+					smp->sums[v] += bsum[v];
+				}
+				for (k=0;k<smp->nstats;k++)
+				{
+					GCALab_MergeStats(run->stats + 3*k,bstat + 3*k);
+				}
+			}
+			i_end = run->next*GCALAB_SAMPLER_BLOCK;
+			smp->n_used = ((i_end > smp->n) ? smp->n : i_end) - run->first*GCALAB_SAMPLER_BLOCK;
+			
+			/*stop if all monitored estimates are within tolerance*/
+			converged = (smp->tol > 0.0 && smp->nstats > 0);
+			for (k=0;k<smp->nstats && converged;k++)
+			{
+				converged = (GCALab_StatsCI(run->stats + 3*k,run->z) <= smp->tol);
+			}
+
+			if (run->round_end >= run->nblocks || converged || run->stop)
+			{
+				run->done = 1;
+			}
+			else
+			{
+				run->round_start = run->round_end;
+				run->base = (smp->shard != NULL) ? run->base : run->round_start;
+				run->round_end += smp->round;
+				run->round_end = (run->round_end > run->nblocks) ? run->nblocks : run->round_end;
+			}
+
+			/*a failed checkpoint is tried again next round rather than losing the job*/
+			clock_gettime(CLOCK_MONOTONIC,&now);
+			if (smp->ckpt != NULL && (run->done || now.tv_sec - run->ckpt_time.tv_sec >= GCALAB_CKPT_INTERVAL))
+			{
+				GCALab_SaveCheckpoint(run);
+			}
+		}
+		pthread_barrier_wait(&(run->barrier));
+		if (run->done)
+		{
+			break;
+		}
+	}
+	GCALab_ProfileThreadEnd(&prof);
+	return NULL;
+}
+
+/**
+ * @brief Runs a sampling job.
+ *
+ * @details smp->sums is allocated by this function and holds the sum of each sample
+ * value over the smp->n_used samples evaluated, it is the callers responsibility to 
+ * free it. smp->n_used is smp->n unless the job stopped early.
+ *
+ * @param smp The sampler, smp->GCA and smp->sample must be set.
+ *
+ * @retval GCALAB_SUCCESS if the job was completed.
+ * @retval GCALAB_MEM_ERROR if per-thread memory could not be allocated.
+ * @retval GCALAB_INVALID_OPTION if the job is not fully specified, or a part file 
+ * could not be written or is not of this job.
+ *
+ * @remark If fewer threads than requested can be created the job runs on those available.
+ */
+char GCALab_RunSampler(GCALab_Sampler *smp)
+{
+	GCALab_SamplerRun run;
+	GCALab_SamplerWorker *workers;
+	unsigned long long total,nkeep;
+	unsigned int t,nthreads;
+	char rc;
+
+	/*per-thread accumulators are not part of a checkpoint, shards can not stop early*/
+	if (smp->GCA == NULL || smp->sample == NULL || smp->n == 0 || (smp->ckpt != NULL && smp->reduce != NULL)
+		|| (smp->shard != NULL && (smp->tol > 0.0 || smp->ckpt != NULL)))
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	if (smp->shard != NULL && smp->shard->mode == GCALAB_SHARD_MERGE)
+	{
+		return GCALab_MergeSampler(smp);
+	}
+
+	smp->round = (smp->round == 0) ? GCALAB_SAMPLER_ROUND : smp->round;
+	run.smp = smp;
+	total = (smp->n + GCALAB_SAMPLER_BLOCK - 1)/GCALAB_SAMPLER_BLOCK;
+	GCALab_ShardRange(smp->shard,total,&(run.first),&(run.nblocks));
+	run.next = run.first;
+	run.round_start = run.first;
+	run.round_end = (run.nblocks - run.first < smp->round) ? run.nblocks : run.first + smp->round;
+	run.base = run.first;
+	run.stride = smp->nvals + 3*smp->nstats;
+	run.z = GCALab_NormalQuantile(0.5 + 0.5*smp->conf);
+	memset((void*)(run.stats),0,3*GCALAB_SAMPLER_MAX_STATS*sizeof(double));
+	/*a shard can be left with no blocks*/
+	run.done = (run.first >= run.nblocks);
+	run.prof = GCALab_CurrentProfile();
+	run.progress = GCA_GetProgress();
+	run.stop = 0;
+	smp->n_used = 0;
+	smp->stopped = 0;
+
+	/*no point having more threads than blocks*/
+	nthreads = (smp->nthreads == 0) ? 1 : smp->nthreads;
+	nthreads = (run.nblocks - run.first < nthreads) ? (unsigned int)(run.nblocks - run.first) : nthreads;
+
+	/*a shard keeps its block sums, followed by its counts, for the part file*/
+	nkeep = (smp->shard != NULL) ? run.nblocks - run.first : smp->round;
+	smp->sums = (double *)malloc((smp->nvals+1)*sizeof(double));
+	run.blocksums = (double *)malloc((nkeep*run.stride+smp->ncounts+1)*sizeof(double));
+	workers = (GCALab_SamplerWorker *)malloc((nthreads+1)*sizeof(GCALab_SamplerWorker));
+	if (smp->sums == NULL || run.blocksums == NULL || workers == NULL)
+	{
+		free(smp->sums);
+		free(run.blocksums);
+		free(workers);
+		smp->sums = NULL;
+		return GCALAB_MEM_ERROR;
+	}
+	memset(smp->sums,0,(smp->nvals+1)*sizeof(double));
+
+	/*carry on from the checkpoint, and make sure one can be written*/
+	rc = GCALAB_SUCCESS;
+	run.sig = (smp->ckpt != NULL || smp->shard != NULL) ? GCALab_SamplerSignature(smp) : 0;
+	if (smp->ckpt != NULL)
+	{
+		rc = GCALab_LoadCheckpoint(&run);
+		if (rc == GCALAB_SUCCESS)
+		{
+			rc = GCALab_SaveCheckpoint(&run);
+		}
+		if (rc != GCALAB_SUCCESS)
+		{
+			free(smp->sums);
+			free(run.blocksums);
+			free(workers);
+			smp->sums = NULL;
+			return rc;
+		}
+	}
+
+	/*each thread gets its own GCA, rotation also needs a private graph*/
+	for (t=0;t<nthreads;t++)
+	{
+		workers[t].run = &run;
+		workers[t].GCA = (smp->rotate) ? CopyGCA(smp->GCA) : CloneGCA(smp->GCA);
+		workers[t].vals = (double *)malloc((smp->nvals+1)*sizeof(double));
+		workers[t].scratch = (smp->init != NULL && workers[t].GCA != NULL) ? smp->init(workers[t].GCA,smp->args) : NULL;
+		if (workers[t].GCA == NULL || workers[t].vals == NULL || (smp->init != NULL && workers[t].scratch == NULL))
+		{
+			rc = GCALAB_MEM_ERROR;
+			nthreads = t+1;
+			break;
+		}
+	}
+
+	/*nothing left to do if the checkpoint is of the finished job*/
+	if (rc == GCALAB_SUCCESS && !run.done)
+	{
+		unsigned int nstarted;
+		/*samples are never cut short, the job only stops between blocks*/
+		GCA_SetProgress(NULL);
+		pthread_mutex_init(&(run.lock),NULL);
+		/*hold the lock so no thread reaches the barrier before it exists*/
+		pthread_mutex_lock(&(run.lock));
+		/*the calling thread acts as worker 0*/
+		for (nstarted=1;nstarted<nthreads;nstarted++)
+		{
+			if (pthread_create(&(workers[nstarted].thread),NULL,GCALab_SamplerWorkerMain,(void*)(workers+nstarted)))
+			{
+				/*just run with the threads we have*/
+				break;
+			}
+		}
+		pthread_barrier_init(&(run.barrier),NULL,nstarted);
+		pthread_mutex_unlock(&(run.lock));
+		GCALab_SamplerWorkerMain((void*)workers);
+		for (t=1;t<nstarted;t++)
+		{
+			pthread_join(workers[t].thread,NULL);
+		}
+		pthread_barrier_destroy(&(run.barrier));
+		pthread_mutex_destroy(&(run.lock));
+		GCA_SetProgress(run.progress);
+	}
+	smp->stopped = run.stop;
+
+	/*merge per-thread accumulators in thread order*/
+	for (t=0;t<nthreads;t++)
+	{
+		if (smp->reduce != NULL && workers[t].scratch != NULL)
+		{
+			smp->reduce(workers[t].scratch,smp->args);
+		}
+		free(workers[t].vals);
+		FreeGCA(workers[t].GCA);
+	}
+	free(workers);
+	
+	/*the part file gets the blocks and counts of the shard*/
+	if (rc == GCALAB_SUCCESS && smp->shard != NULL)
+	{
+		rc = GCALab_SaveShard(&run,total);
+	}
+	free(run.blocksums);
+
+	for (t=0;t<smp->nstats;t++)
+	{
+		smp->stat_n[t] = (unsigned long long)run.stats[3*t];
+		smp->stat_mean[t] = run.stats[3*t+1];
+		smp->stat_ci[t] = GCALab_StatsCI(run.stats + 3*t,run.z);
+	}
+
+	if (rc != GCALAB_SUCCESS)
+	{
+		free(smp->sums);
+		smp->sums = NULL;
+	}
+	return rc;
+}
+
+/**
+ * @brief Runs a sampling job in the calling thread on the given GCA.
+ *
+ * @details Used when the parallelism is elsewhere (e.g., a rule sweep). Samples are
+ * summed in the same blocks as GCALab_RunSampler() so the sums are identical.
+ * Rotation and early stopping are ignored.
+ *
+ * @param smp The sampler, smp->GCA is not used.
+ * @param GCA The GCA to evaluate the samples on, its configuration is overwritten.
+ * @param scratch Scratch memory for smp->sample (as returned by smp->init).
+ *
+ * @retval GCALAB_SUCCESS if the job was completed.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ */
+char GCALab_RunSamplerOn(GCALab_Sampler *smp,GraphCellularAutomaton *GCA,void *scratch)
+{
+	GCA_RandStream rs;
+	GCA_RandStream *rng;
+	unsigned long long i;
+	unsigned int v;
+	double *vals,*bsum;
+
+	if (smp->sample == NULL || smp->n == 0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	smp->sums = (double *)malloc((smp->nvals+1)*sizeof(double));
+	vals = (double *)malloc(2*(smp->nvals+1)*sizeof(double));
+	if (smp->sums == NULL || vals == NULL)
+	{
+		free(smp->sums);
+		free(vals);
+		smp->sums = NULL;
+		return GCALAB_MEM_ERROR;
+	}
+	memset(smp->sums,0,(smp->nvals+1)*sizeof(double));
+	bsum = vals + smp->nvals + 1;
+
+	rng = GCA->rng;
+	for (i=0;i<smp->n;i++)
+	{
+		if (i % GCALAB_SAMPLER_BLOCK == 0)
+		{
+			memset(bsum,0,(smp->nvals+1)*sizeof(double));
+		}
+		GCALab_SamplerSetup(smp,GCA,i,&rs,0);
+		smp->sample(GCA,scratch,smp->args,vals);
+		for (v=0;v<smp->nvals;v++)
+		{
+			bsum[v] += vals[v];
+		}
+		if ((i+1) % GCALAB_SAMPLER_BLOCK == 0 || i+1 == smp->n)
+		{
+			for (v=0;v<smp->nvals;v++)
+			{
+				smp->sums[v] += bsum[v];
+			}
+		}
+	}
+	GCA->rng = rng;
+	smp->n_used = smp->n;
+	free(vals);
+	return GCALAB_SUCCESS;
+}
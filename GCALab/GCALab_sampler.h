@@ -0,0 +1,173 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_sampler.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Multi-threaded Monte Carlo sampling engine definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_SAMPLER_H
+#define __GCALAB_SAMPLER_H
+
+#include <pthread.h>
+#include "GCA.h"
+#include "GCALab_shard.h"
+
+#ifndef GCALAB_SAMPLER_BLOCK
+/*number of samples accumulated into one partial sum*/
+#define GCALAB_SAMPLER_BLOCK 64
+#endif
+
+#ifndef GCALAB_SAMPLER_ROUND
+/*number of blocks evaluated between ordered reductions*/
+#define GCALAB_SAMPLER_ROUND 256
+#endif
+
+#ifndef GCALAB_SAMPLER_SEQ_ROUND
+/*blocks per round when stopping early, a stopping decision is made every round*/
+#define GCALAB_SAMPLER_SEQ_ROUND 16
+#endif
+
+#ifndef GCALAB_SAMPLER_MAX_STATS
+/*max number of monitored estimates*/
+#define GCALAB_SAMPLER_MAX_STATS 4
+#endif
+
+#ifndef GCALAB_SAMPLER_MAX_SAMPLES
+/*sample limit when stopping early and no limit is given*/
+#define GCALAB_SAMPLER_MAX_SAMPLES 1048576
+#endif
+
+#ifndef GCALAB_CKPT_INTERVAL
+/*min number of seconds between checkpoints of a running job*/
+#define GCALAB_CKPT_INTERVAL 60
+#endif
+
+/*identifies the checkpoint file format*/
+#define GCALAB_CKPT_MAGIC "GCACKPT1"
+#define GCALAB_CKPT_MAGIC_LEN 8
+
+#ifndef GCALAB_DEFAULT_CONF
+#define GCALAB_DEFAULT_CONF 0.95
+#endif
+
+#ifndef GCALAB_DEFAULT_THREADS
+#define GCALAB_DEFAULT_THREADS 1
+#endif
+
+#ifndef GCALAB_DEFAULT_SEED
+#define GCALAB_DEFAULT_SEED 0
+#endif
+
+typedef struct GCALab_Sampler_struct GCALab_Sampler;
+
+/*A Monte Carlo sampling job
+ *
+ * Sample i is evaluated on a per-thread clone of GCA with either the initial
+ * condition range[0] + i*stride (if range != NULL), or a noise initial condition
+ * drawn from random stream i of seed. Sample values are summed in fixed blocks
+ * and the blocks are reduced in index order, so sums are identical for any
+ * number of threads.
+ *
+ * Monitored estimates keep a running mean and variance (Welford within a block,
+ * merged in block order). If tol > 0 the job stops at the first round boundary
+ * where every monitored confidence interval half-width is within tol, since
+ * rounds are a fixed number of blocks the stopping point does not depend on the
+ * number of threads either.
+ *
+ * The job stops early if the progress callback of the calling thread asks it to
+ * (see GCA_SetProgress()), the sums then cover the blocks done. If a checkpoint 
+ * file is set, the sums are saved to it every GCALAB_CKPT_INTERVAL seconds, when
+ * the job stops and when it is complete. A job started with the checkpoint of the
+ * same job carries on from it and gives the same sums as if it was never stopped.
+ *
+ * If shard is set and running, only the shard's range of blocks is evaluated and
+ * its block sums and counts are written to the part file. If it is merging, the
+ * blocks of every part are reduced in block order instead of being evaluated, 
+ * which gives the sums of a single run.
+ */
+struct GCALab_Sampler_struct
+{
+	/*the prototype GCA, it is never modified*/
+	GraphCellularAutomaton *GCA;
+	/*number of samples*/
+	unsigned long long n;
+	/*number of values produced per sample*/
+	unsigned int nvals;
+	/*number of worker threads*/
+	unsigned int nthreads;
+	/*user seed for noise initial conditions*/
+	unsigned long long seed;
+	/*initial condition range, NULL for noise initial conditions*/
+	chunk *range;
+	unsigned int stride;
+	/*if set neighbourhoods are randomly rotated for every sample*/
+	unsigned char rotate;
+	/*allocates per-thread scratch memory (can be NULL)*/
+	void *(*init)(GraphCellularAutomaton *GCA,void *args);
+	/*evaluates one sample on GCA, writing nvals values*/
+	void (*sample)(GraphCellularAutomaton *GCA,void *scratch,void *args,double *vals);
+	/*merges and frees per-thread scratch, called in thread order (can be NULL)*/
+	void (*reduce)(void *scratch,void *args);
+	/*read-only arguments passed to the callbacks*/
+	void *args;
+	/*blocks evaluated between ordered reductions*/
+	unsigned int round;
+	/*confidence interval half-width to stop at (0 runs all n samples)*/
+	double tol;
+	/*confidence level of the interval*/
+	double conf;
+	/*monitored estimates: mean of value stat_val over samples where value 
+	 * stat_wgt is non-zero (stat_wgt < 0 for all samples)*/
+	unsigned int nstats;
+	unsigned int stat_val[GCALAB_SAMPLER_MAX_STATS];
+	int stat_wgt[GCALAB_SAMPLER_MAX_STATS];
+	/*checkpoint file (NULL for none), only for jobs without a reduce callback*/
+	char *ckpt;
+	/*identifies what the sample callback computes (e.g., a hash of args) in the checkpoint*/
+	unsigned long long ckpt_tag;
+	/*part files of a sharded job (NULL if not sharded), not with tol or ckpt*/
+	GCALab_Shard *shard;
+	/*integer accumulators the reduce callback sums into (e.g., state counts), shards
+	 * write them and a merge adds them up*/
+	unsigned int *counts;
+	unsigned int ncounts;
+	/*output: sum of each value over all samples*/
+	double *sums;
+	/*output: number of samples actually evaluated*/
+	unsigned long long n_used;
+	/*output: set if the job was stopped by the progress callback*/
+	unsigned char stopped;
+	/*output: monitored estimates, their CI half-widths and sample counts*/
+	double stat_mean[GCALAB_SAMPLER_MAX_STATS];
+	double stat_ci[GCALAB_SAMPLER_MAX_STATS];
+	unsigned long long stat_n[GCALAB_SAMPLER_MAX_STATS];
+};
+
+void GCALab_InitSampler(GCALab_Sampler *smp,GraphCellularAutomaton *GCA,unsigned int nvals);
+char GCALab_SetSamplerRange(GCALab_Sampler *smp,chunk *range,unsigned int stride);
+char GCALab_SetSamplerTolerance(GCALab_Sampler *smp,double tol,double conf);
+char GCALab_SamplerMonitor(GCALab_Sampler *smp,unsigned int val,int wgt);
+char GCALab_RunSampler(GCALab_Sampler *smp);
+char GCALab_RunSamplerOn(GCALab_Sampler *smp,GraphCellularAutomaton *GCA,void *scratch);
+double GCALab_NormalQuantile(double p);
+
+#endif
@@ -0,0 +1,281 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_sched.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: A global pool of worker threads shared by all workspaces. 
+ *              Workspaces push commands here once they are ready to run (i.e., 
+ *              all ordering constraints are met), so the pool never needs to know
+ *              about workspace ordering. Workers run tasks from their own deque 
+ *              first and steal from other workers when it is empty.
+ *
+ *==============================================================================
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "GCALab.h"
+
+/*the worker pool*/
+static GCALab_SchedWorker *GCALab_Workers;
+static unsigned int GCALab_numWorkers;
+/*called to run each task*/
+static void (*GCALab_RunTask)(GCALab_Task *task);
+/*idle workers sleep on cond until there are pending tasks*/
+static pthread_mutex_t GCALab_PoolLock;
+static pthread_cond_t GCALab_PoolCond;
+static unsigned int GCALab_Pending;
+/*workers tasks are pushed to when not pushed by a worker*/
+static unsigned int GCALab_NextWorker;
+/*worker id of the current thread (stored as id + 1)*/
+static pthread_key_t GCALab_WorkerKey;
+static struct timespec GCALab_SchedStart;
+
+/**
+ * @brief Seconds elapsed since a reference time.
+ */
+static double GCALab_Elapsed(struct timespec *ref)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (double)(now.tv_sec - ref->tv_sec) + 1e-9*(double)(now.tv_nsec - ref->tv_nsec);
+}
+
+/**
+ * @brief Takes a task from the bottom (own == 1) or top (own == 0) of a worker's deque.
+ *
+ * @retval 1 if a task was taken.
+ */
+static unsigned char GCALab_DequeTake(GCALab_SchedWorker *w,GCALab_Task *task,unsigned char own)
+{
+	unsigned char taken;
+	pthread_mutex_lock(&(w->lock));
+	taken = (w->count > 0);
+	if (taken)
+	{
+		if (own)
+		{
+			*task = w->tasks[(w->head + w->count - 1)%(w->cap)];
+		}
+		else
+		{
+			*task = w->tasks[w->head];
+			w->head = (w->head + 1)%(w->cap);
+		}
+		w->count--;
+	}
+	pthread_mutex_unlock(&(w->lock));
+	return taken;
+}
+
+/**
+ * @brief Main loop of a scheduler worker.
+ */
+static void *GCALab_SchedWorkerMain(void *params)
+{
+	GCALab_SchedWorker *w;
+	GCALab_Task task;
+	struct timespec t0;
+	unsigned int id,i;
+	unsigned char stolen,found;
+
+	id = (unsigned int)(unsigned long long)params;
+	w = GCALab_Workers + id;
+	pthread_setspecific(GCALab_WorkerKey,(void*)(unsigned long long)(id + 1));
+	while (1)
+	{
+		/*own deque first, then try every other worker once*/
+		stolen = 0;
+		found = GCALab_DequeTake(w,&task,1);
+		for (i=1;i<GCALab_numWorkers && !found;i++)
+		{
+			found = GCALab_DequeTake(GCALab_Workers + (id + i)%GCALab_numWorkers,&task,0);
+			stolen = found;
+		}
+
+		pthread_mutex_lock(&GCALab_PoolLock);
+		if (!found)
+		{
+			/*nothing anywhere, sleep until something is pushed*/
+			while (GCALab_Pending == 0)
+			{
+				pthread_cond_wait(&GCALab_PoolCond,&GCALab_PoolLock);
+			}
+			pthread_mutex_unlock(&GCALab_PoolLock);
+			continue;
+		}
+		GCALab_Pending--;
+		pthread_mutex_unlock(&GCALab_PoolLock);
+
+		clock_gettime(CLOCK_MONOTONIC,&t0);
+		(*GCALab_RunTask)(&task);
+		pthread_mutex_lock(&(w->lock));
+		w->executed++;
+		w->stolen += stolen;
+		w->busy += GCALab_Elapsed(&t0);
+		pthread_mutex_unlock(&(w->lock));
+	}
+	return NULL;
+}
+
+/**
+ * @brief Starts the worker pool.
+ *
+ * @param numworkers The number of workers (the number of online processors if 0).
+ * @param run Called by a worker to run each task.
+ *
+ * @retval GCALAB_SUCCESS if all workers were started.
+ */
+char GCALab_StartScheduler(unsigned int numworkers,void (*run)(GCALab_Task *task))
+{
+	unsigned int i;
+	if (numworkers == 0)
+	{
+		long nprocs;
+		nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+		numworkers = (nprocs > 0) ? (unsigned int)nprocs : 1;
+	}
+	GCALab_Workers = (GCALab_SchedWorker *)malloc(numworkers*sizeof(GCALab_SchedWorker));
+	if (GCALab_Workers == NULL)
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	memset((void*)GCALab_Workers,0,numworkers*sizeof(GCALab_SchedWorker));
+	for (i=0;i<numworkers;i++)
+	{
+		GCALab_Workers[i].cap = GCALAB_DEQUE_INIT_SIZE;
+		GCALab_Workers[i].tasks = (GCALab_Task *)malloc(GCALAB_DEQUE_INIT_SIZE*sizeof(GCALab_Task));
+		if (GCALab_Workers[i].tasks == NULL)
+		{
+			return GCALAB_MEM_ERROR;
+		}
+		pthread_mutex_init(&(GCALab_Workers[i].lock),NULL);
+	}
+	GCALab_numWorkers = numworkers;
+	GCALab_RunTask = run;
+	GCALab_Pending = 0;
+	GCALab_NextWorker = 0;
+	pthread_mutex_init(&GCALab_PoolLock,NULL);
+	pthread_cond_init(&GCALab_PoolCond,NULL);
+	pthread_key_create(&GCALab_WorkerKey,NULL);
+	clock_gettime(CLOCK_MONOTONIC,&GCALab_SchedStart);
+	for (i=0;i<numworkers;i++)
+	{
+		if (pthread_create(&(GCALab_Workers[i].thread),NULL,GCALab_SchedWorkerMain,(void*)(unsigned long long)i))
+		{
+			return GCALAB_THREAD_ERROR;
+		}
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Returns the id of the calling worker, -1 if not called by a worker.
+ */
+int GCALab_CurrentWorker(void)
+{
+	return ((int)(unsigned long long)pthread_getspecific(GCALab_WorkerKey)) - 1;
+}
+
+/**
+ * @brief Returns the number of workers in the pool.
+ */
+unsigned int GCALab_NumWorkers(void)
+{
+	return GCALab_numWorkers;
+}
+
+/**
+ * @brief Pushes a ready task.
+ *
+ * @details A worker pushes onto its own deque, so follow-on work stays local unless
+ * another worker is idle. Other threads push round-robin.
+ *
+ * @param task The task.
+ *
+ * @retval GCALAB_SUCCESS if the task was queued.
+ * @retval GCALAB_MEM_ERROR if the deque could not grow.
+ */
+char GCALab_SchedulerPush(GCALab_Task *task)
+{
+	GCALab_SchedWorker *w;
+	int id;
+	id = GCALab_CurrentWorker();
+	if (id < 0)
+	{
+		pthread_mutex_lock(&GCALab_PoolLock);
+		id = (int)GCALab_NextWorker;
+		GCALab_NextWorker = (GCALab_NextWorker + 1)%GCALab_numWorkers;
+		pthread_mutex_unlock(&GCALab_PoolLock);
+	}
+	w = GCALab_Workers + id;
+
+	pthread_mutex_lock(&(w->lock));
+	if (w->count == w->cap)
+	{
+		GCALab_Task *tasks;
+		unsigned int i;
+		tasks = (GCALab_Task *)malloc(2*(w->cap)*sizeof(GCALab_Task));
+		if (tasks == NULL)
+		{
+			pthread_mutex_unlock(&(w->lock));
+			return GCALAB_MEM_ERROR;
+		}
+		for (i=0;i<w->count;i++)
+		{
+			tasks[i] = w->tasks[(w->head + i)%(w->cap)];
+		}
+		free(w->tasks);
+		w->tasks = tasks;
+		w->head = 0;
+		w->cap *= 2;
+	}
+	w->tasks[(w->head + w->count)%(w->cap)] = *task;
+	w->count++;
+	pthread_mutex_unlock(&(w->lock));
+
+	pthread_mutex_lock(&GCALab_PoolLock);
+	GCALab_Pending++;
+	pthread_cond_signal(&GCALab_PoolCond);
+	pthread_mutex_unlock(&GCALab_PoolLock);
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Prints per-worker utilisation and steal counts.
+ */
+void GCALab_PrintSchedulerStats(FILE *fp)
+{
+	unsigned int i;
+	double elapsed;
+	elapsed = GCALab_Elapsed(&GCALab_SchedStart);
+	fprintf(fp,"Workers: %u, uptime: %.3f s\n",GCALab_numWorkers,elapsed);
+	fprintf(fp,"Worker\tExecuted\tStolen\tQueued\tBusy (s)\tUtilisation\n");
+	fprintf(fp,"-------------------------------------------------------------\n");
+	for (i=0;i<GCALab_numWorkers;i++)
+	{
+		GCALab_SchedWorker *w;
+		w = GCALab_Workers + i;
+		pthread_mutex_lock(&(w->lock));
+		fprintf(fp,"%u\t%llu\t\t%llu\t%u\t%.3f\t\t%.1f%%\n",i,w->executed,w->stolen,w->count,
+			w->busy,(elapsed > 0.0) ? 100.0*(w->busy)/elapsed : 0.0);
+		pthread_mutex_unlock(&(w->lock));
+	}
+}
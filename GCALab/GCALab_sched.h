@@ -0,0 +1,76 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_sched.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Work-stealing scheduler definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_SCHED_H
+#define __GCALAB_SCHED_H
+
+#include <stdio.h>
+#include <pthread.h>
+#include <time.h>
+#include "GCALab_queue.h"
+
+#ifndef GCALAB_DEQUE_INIT_SIZE
+/*initial capacity of a worker's task deque*/
+#define GCALAB_DEQUE_INIT_SIZE 64
+#endif
+
+typedef struct GCALab_Task_struct GCALab_Task;
+typedef struct GCALab_SchedWorker_struct GCALab_SchedWorker;
+
+/*a ready command and the workspace it belongs to*/
+struct GCALab_Task_struct
+{
+	unsigned char ws_id;
+	GCALab_CmdRecord *cmd;
+};
+
+/*A scheduler worker
+ *
+ * Each worker owns a deque of ready tasks. It pushes and pops tasks at the bottom
+ * of its own deque, while idle workers steal from the top of other deques. 
+ * Statistics are only updated by the owner while holding lock.
+ */
+struct GCALab_SchedWorker_struct
+{
+	pthread_t thread;
+	pthread_mutex_t lock;
+	GCALab_Task *tasks;
+	unsigned int cap;
+	unsigned int head;
+	unsigned int count;
+	/*number of tasks run, of those how many were stolen, and time spent running them*/
+	unsigned long long executed;
+	unsigned long long stolen;
+	double busy;
+};
+
+char GCALab_StartScheduler(unsigned int numworkers,void (*run)(GCALab_Task *task));
+char GCALab_SchedulerPush(GCALab_Task *task);
+int GCALab_CurrentWorker(void);
+unsigned int GCALab_NumWorkers(void);
+void GCALab_PrintSchedulerStats(FILE *fp);
+
+#endif
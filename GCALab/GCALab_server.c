@@ -0,0 +1,512 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_server.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Job server. GCALab listens on a UNIX domain socket and runs
+ *              the commands of any number of clients against the same
+ *              workspaces, so GCAs (and their meshes and topologies) stay
+ *              loaded between jobs. Results are sent back to the client
+ *              that queued the operation as soon as it is done.
+ *
+ *==============================================================================
+ */
+
+/*for SO_PEERCRED*/
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "GCALab.h"
+
+/*defined in GCALab.c*/
+extern unsigned int cur_ws;
+
+/*an operation queued by a client*/
+typedef struct GCALab_ServerJob_struct
+{
+	GCALab_Session *s;
+	unsigned int seq;
+	unsigned char ws_id;
+} GCALab_ServerJob;
+
+/*commands other than operations use the global current workspace, so they 
+ * run one at a time*/
+static pthread_mutex_t GCALab_ServerLock = PTHREAD_MUTEX_INITIALIZER;
+/*socket to remove when the server is stopped*/
+static char *GCALab_SocketPath = NULL;
+
+/**
+ * @brief Removes the socket and exits when the server is stopped by a signal.
+ */
+static void GCALab_ServerStop(int sig)
+{
+	if (GCALab_SocketPath != NULL)
+	{
+		unlink(GCALab_SocketPath);
+	}
+	_exit(0);
+}
+
+/**
+ * @brief Appends output for the client, the session takes ownership of buf.
+ */
+static void GCALab_SessionPush(GCALab_Session *s,char *buf,size_t len)
+{
+	GCALab_ServerMsg *msg;
+	if (!(msg = (GCALab_ServerMsg *)malloc(sizeof(GCALab_ServerMsg))))
+	{
+		free(buf);
+		return;
+	}
+	msg->buf = buf;
+	msg->len = len;
+	msg->next = NULL;
+	pthread_mutex_lock(&(s->lock));
+	if (s->tail != NULL)
+	{
+		s->tail->next = msg;
+	}
+	else
+	{
+		s->head = msg;
+	}
+	s->tail = msg;
+	pthread_cond_broadcast(&(s->cond));
+	pthread_mutex_unlock(&(s->lock));
+}
+
+/**
+ * @brief Appends a formatted line for the client.
+ */
+static void GCALab_SessionPrintf(GCALab_Session *s,const char *fmt,...)
+{
+	va_list args;
+	char *buf;
+	int len;
+	if (!(buf = (char *)malloc(GCALAB_MAX_STRLEN)))
+	{
+		return;
+	}
+	va_start(args,fmt);
+	len = vsnprintf(buf,GCALAB_MAX_STRLEN,fmt,args);
+	va_end(args);
+	if (len >= GCALAB_MAX_STRLEN)
+	{
+		len = GCALAB_MAX_STRLEN - 1;
+	}
+	GCALab_SessionPush(s,buf,(size_t)len);
+}
+
+/**
+ * @brief Writer thread of a session, sends output in order until the session closes.
+ * @details Once the client has gone away output is dropped.
+ */
+static void *GCALab_SessionWriter(void *arg)
+{
+	GCALab_Session *s;
+	GCALab_ServerMsg *msg;
+	size_t sent;
+	ssize_t n;
+	unsigned char lost;
+	s = (GCALab_Session *)arg;
+	lost = 0;
+	while (1)
+	{
+		pthread_mutex_lock(&(s->lock));
+		while (s->head == NULL && !(s->closing))
+		{
+			pthread_cond_wait(&(s->cond),&(s->lock));
+		}
+		msg = s->head;
+		if (msg != NULL)
+		{
+			s->head = msg->next;
+			if (s->head == NULL)
+			{
+				s->tail = NULL;
+			}
+		}
+		pthread_mutex_unlock(&(s->lock));
+		if (msg == NULL)
+		{
+			break;
+		}
+		for (sent=0;!lost && sent<msg->len;sent += (size_t)n)
+		{
+			n = write(s->fd,msg->buf + sent,msg->len - sent);
+			if (n < 0 && errno == EINTR)
+			{
+				n = 0;
+			}
+			else if (n <= 0)
+			{
+				lost = 1;
+			}
+		}
+		free(msg->buf);
+		free(msg);
+	}
+	return NULL;
+}
+
+/**
+ * @brief Sends the result of a finished operation to the client that queued it.
+ * @details Called with the lock of the operation's workspace held (see
+ * GCALab_QueueCommandNotify()).
+ */
+static void GCALab_ServerNotify(void *arg,char rc,int res_id)
+{
+	GCALab_ServerJob *job;
+	GCALab_Session *s;
+	FILE *fp;
+	char *buf;
+	size_t len;
+	job = (GCALab_ServerJob *)arg;
+	s = job->s;
+	buf = NULL;
+	len = 0;
+	if ((fp = open_memstream(&buf,&len)) != NULL)
+	{
+		fprintf(fp,"@done %u %d %d\n",job->seq,(int)rc,res_id);
+		if (res_id >= 0)
+		{
+			GCALab_FPrintResults(fp,job->ws_id,(unsigned int)res_id);
+		}
+		fclose(fp);
+		GCALab_SessionPush(s,buf,len);
+	}
+	free(job);
+	pthread_mutex_lock(&(s->lock));
+	s->pending--;
+	pthread_cond_broadcast(&(s->cond));
+	pthread_mutex_unlock(&(s->lock));
+}
+
+/**
+ * @brief Splits a line into words.
+ * @returns the words, each in its own allocation as GCALab_Process_Command()
+ * expects, or NULL if out of memory.
+ */
+static char **GCALab_ServerTokenise(char *line,int *argc)
+{
+	char **argv;
+	char *word;
+	int n,len;
+	n = 0;
+	for (word=line;*word != '\0';word++)
+	{
+		if (!isspace((unsigned char)*word) && (word == line || isspace((unsigned char)word[-1])))
+		{
+			n++;
+		}
+	}
+	if (!(argv = (char **)malloc(((n > 0) ? n : 1)*sizeof(char *))))
+	{
+		return NULL;
+	}
+	*argc = 0;
+	for (word=strtok(line," \t\r\n");word != NULL;word=strtok(NULL," \t\r\n"))
+	{
+		len = strlen(word);
+		if (!(argv[*argc] = (char *)malloc(len+1)))
+		{
+			break;
+		}
+		memcpy(argv[*argc],word,len+1);
+		(*argc)++;
+	}
+	return argv;
+}
+
+/**
+ * @brief Runs a command that is not an operation, sending its output and return code.
+ * @details The command runs with the client's current workspace, and any
+ * change to it (e.g., new-work, ch-work) is kept for the client. Its output is
+ * collected through GCALab_SetOutput(), so output of other threads is not sent.
+ */
+static void GCALab_ServerCommand(GCALab_Session *s,int argc,char **argv)
+{
+	FILE *fp;
+	char *buf;
+	size_t len;
+	int i;
+	char rc;
+
+	buf = NULL;
+	len = 0;
+	if (!(fp = open_memstream(&buf,&len)))
+	{
+		for (i=0;i<argc;i++)
+		{
+			free(argv[i]);
+		}
+		free(argv);
+		GCALab_SessionPrintf(s,"@ok %d\n",(int)GCALAB_MEM_ERROR);
+		return;
+	}
+	GCALab_SetOutput(fp);
+	pthread_mutex_lock(&GCALab_ServerLock);
+	cur_ws = s->ws;
+	rc = GCALab_Process_Command(argc,argv);
+	s->ws = cur_ws;
+	pthread_mutex_unlock(&GCALab_ServerLock);
+	GCALab_SetOutput(NULL);
+	fclose(fp);
+	if (len > 0)
+	{
+		GCALab_SessionPush(s,buf,len);
+	}
+	else
+	{
+		free(buf);
+	}
+	GCALab_SessionPrintf(s,"@ok %d\n",(int)rc);
+}
+
+/**
+ * @brief Queues an operation for the client, its result is sent when it is done.
+ */
+static void GCALab_ServerOperation(GCALab_Session *s,unsigned int cmd_code,int argc,char **argv)
+{
+	GCALab_ServerJob *job;
+	char rc;
+
+	if (argc < 2)
+	{
+		GCALab_SessionPrintf(s,"@ok %d\n",(int)GCALAB_INVALID_OPTION);
+		return;
+	}
+	if ((rc = GCALab_ValidWSId(s->ws)) < 0)
+	{
+		GCALab_SessionPrintf(s,"@ok %d\n",(int)rc);
+		return;
+	}
+	if (!(job = (GCALab_ServerJob *)malloc(sizeof(GCALab_ServerJob))))
+	{
+		GCALab_SessionPrintf(s,"@ok %d\n",(int)GCALAB_MEM_ERROR);
+		return;
+	}
+	job->s = s;
+	job->ws_id = (unsigned char)s->ws;
+	/*the operation may be done before GCALab_QueueCommandNotify() returns*/
+	pthread_mutex_lock(&(s->lock));
+	job->seq = s->seq;
+	s->seq++;
+	s->pending++;
+	pthread_mutex_unlock(&(s->lock));
+	GCALab_SessionPrintf(s,"@queued %u\n",job->seq);
+	rc = GCALab_QueueCommandNotify(job->ws_id,cmd_code,(unsigned int)atoi(argv[1]),argv+2,argc-2,
+		&GCALab_ServerNotify,(void *)job);
+	if (rc != GCALAB_SUCCESS)
+	{
+		GCALab_ServerNotify((void *)job,rc,-1);
+	}
+}
+
+/**
+ * @brief Reader thread of a session, runs the client's commands until it
+ * closes its end or sends quit, then waits for its operations and cleans up.
+ */
+static void *GCALab_SessionReader(void *arg)
+{
+	GCALab_Session *s;
+	FILE *in;
+	char line[GCALAB_SERVER_LINE];
+	char **argv;
+	unsigned int cmd_code;
+	int argc,i,k,c;
+
+	s = (GCALab_Session *)arg;
+	pthread_create(&(s->writer),NULL,&GCALab_SessionWriter,(void *)s);
+	in = fdopen(dup(s->fd),"r");
+	while (in != NULL && fgets(line,GCALAB_SERVER_LINE,in) != NULL)
+	{
+		/*a line too long for the buffer is dropped whole, with a single error*/
+		if (strchr(line,'\n') == NULL && !feof(in))
+		{
+			while ((c = fgetc(in)) != EOF && c != '\n');
+			GCALab_SessionPrintf(s,"@ok %d\n",(int)GCALAB_INVALID_OPTION);
+			continue;
+		}
+		if (!(argv = GCALab_ServerTokenise(line,&argc)))
+		{
+			break;
+		}
+		if (argc == 0 || argv[0][0] == '#')
+		{
+			for (i=0;i<argc;i++)
+			{
+				free(argv[i]);
+			}
+			free(argv);
+			continue;
+		}
+		if (!strcmp(argv[0],"quit"))
+		{
+			for (i=0;i<argc;i++)
+			{
+				free(argv[i]);
+			}
+			free(argv);
+			break;
+		}
+		/*operations are queued on the client's workspace, the q-cmd prefix is optional*/
+		k = (!strcmp(argv[0],"q-cmd") && argc > 1) ? 1 : 0;
+		cmd_code = GCALab_GetCommandCode(argv[k]);
+		if (cmd_code != GCALAB_NOP || !strcmp(argv[k],"nop"))
+		{
+			GCALab_ServerOperation(s,cmd_code,argc-k,argv+k);
+			for (i=0;i<argc;i++)
+			{
+				free(argv[i]);
+			}
+			free(argv);
+		}
+		else
+		{
+			GCALab_ServerCommand(s,argc,argv);
+		}
+	}
+	if (in != NULL)
+	{
+		fclose(in);
+	}
+
+	pthread_mutex_lock(&(s->lock));
+	while (s->pending > 0)
+	{
+		pthread_cond_wait(&(s->cond),&(s->lock));
+	}
+	pthread_mutex_unlock(&(s->lock));
+	GCALab_SessionPrintf(s,"@bye\n");
+	pthread_mutex_lock(&(s->lock));
+	s->closing = 1;
+	pthread_cond_broadcast(&(s->cond));
+	pthread_mutex_unlock(&(s->lock));
+	pthread_join(s->writer,NULL);
+	close(s->fd);
+	pthread_mutex_destroy(&(s->lock));
+	pthread_cond_destroy(&(s->cond));
+	free(s);
+	return NULL;
+}
+
+/**
+ * @brief Tests if a client runs as the same user as the server.
+ */
+static unsigned char GCALab_ServerPeerOK(int fd)
+{
+	struct ucred cred;
+	socklen_t len;
+	len = sizeof(cred);
+	if (getsockopt(fd,SOL_SOCKET,SO_PEERCRED,(void *)&cred,&len) < 0 || len != sizeof(cred))
+	{
+		return 0;
+	}
+	return (cred.uid == geteuid());
+}
+
+/**
+ * @brief Listens on a UNIX domain socket and serves clients until stopped.
+ * @details Any existing socket at path is replaced. Only the owner may connect,
+ * the socket is created without access for others and clients running as
+ * another user are refused. Clients share the workspaces, each starts on 
+ * workspace 0 (see GCALab_Session).
+ * @param path the socket path
+ * @returns 1 if the server could not be started (it does not return otherwise).
+ */
+int GCALab_RunServer(char *path)
+{
+	struct sockaddr_un addr;
+	GCALab_Session *s;
+	pthread_t thread;
+	pthread_attr_t attr;
+	mode_t mask;
+	int fd,client,rc;
+
+	if (path == NULL || strlen(path) >= sizeof(addr.sun_path))
+	{
+		fprintf(stderr,"Invalid socket path.\n");
+		return 1;
+	}
+	if ((fd = socket(AF_UNIX,SOCK_STREAM,0)) < 0)
+	{
+		perror("socket");
+		return 1;
+	}
+	memset((void *)&addr,0,sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path,path);
+	unlink(path);
+	mask = umask(077);
+	rc = bind(fd,(struct sockaddr *)&addr,sizeof(addr));
+	umask(mask);
+	if (rc < 0 || listen(fd,GCALAB_SERVER_BACKLOG) < 0)
+	{
+		perror(path);
+		close(fd);
+		return 1;
+	}
+	GCALab_SocketPath = path;
+	signal(SIGPIPE,SIG_IGN);
+	signal(SIGINT,&GCALab_ServerStop);
+	signal(SIGTERM,&GCALab_ServerStop);
+	fprintf(stdout,"Listening on %s\n",path);
+	fflush(stdout);
+
+	pthread_attr_init(&attr);
+	pthread_attr_setdetachstate(&attr,PTHREAD_CREATE_DETACHED);
+	while (1)
+	{
+		if ((client = accept(fd,NULL,NULL)) < 0)
+		{
+			continue;
+		}
+		if (!GCALab_ServerPeerOK(client))
+		{
+			close(client);
+			continue;
+		}
+		if (!(s = (GCALab_Session *)calloc(1,sizeof(GCALab_Session))))
+		{
+			close(client);
+			continue;
+		}
+		s->fd = client;
+		s->ws = 0;
+		pthread_mutex_init(&(s->lock),NULL);
+		pthread_cond_init(&(s->cond),NULL);
+		if (pthread_create(&thread,&attr,&GCALab_SessionReader,(void *)s) != 0)
+		{
+			close(client);
+			pthread_mutex_destroy(&(s->lock));
+			pthread_cond_destroy(&(s->cond));
+			free(s);
+		}
+	}
+	return 0;
+}
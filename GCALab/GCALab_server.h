@@ -0,0 +1,94 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_server.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Job server definitions, shared with the client
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_SERVER_H
+#define __GCALAB_SERVER_H
+
+#include <stddef.h>
+#include <pthread.h>
+
+/*Protocol
+ *
+ * Clients send commands in the GCALab command language, one per line. The
+ * server answers with the output of the commands, and lines starting with
+ * GCALAB_SERVER_TAG:
+ *    @ok rc                    a command finished with return code rc
+ *    @queued seq               an operation was queued as the client's seq-th
+ *    @done seq rc res_id       operation seq finished, its result follows
+ *                              (res_id is -1 if it has none)
+ *    @bye                      all operations of the client are done
+ * Once the client closes its end (or sends quit) the server finishes the
+ * queued operations of the client, sends @bye and closes the connection.
+ */
+#define GCALAB_SERVER_TAG 		'@'
+
+#ifndef GCALAB_SERVER_BACKLOG
+/*number of connections waiting to be accepted*/
+#define GCALAB_SERVER_BACKLOG 	64
+#endif
+
+#ifndef GCALAB_SERVER_LINE
+/*max length of a command line*/
+#define GCALAB_SERVER_LINE 		4096
+#endif
+
+typedef struct GCALab_ServerMsg_struct GCALab_ServerMsg;
+typedef struct GCALab_Session_struct GCALab_Session;
+
+/*output waiting to be sent to a client*/
+struct GCALab_ServerMsg_struct
+{
+	char *buf;
+	size_t len;
+	GCALab_ServerMsg *next;
+};
+
+/*A client connection
+ *
+ * A reader thread runs the client's commands and a writer thread sends the
+ * output in order, so a client that is slow to read never holds up the
+ * workspaces its operations run on.
+ */
+struct GCALab_Session_struct
+{
+	int fd;
+	/*the client's current workspace*/
+	unsigned int ws;
+	/*number of operations queued, and of those not yet done*/
+	unsigned int seq;
+	unsigned int pending;
+	/*output not yet sent, the reader is done once closing is set*/
+	GCALab_ServerMsg *head;
+	GCALab_ServerMsg *tail;
+	unsigned char closing;
+	pthread_t writer;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+};
+
+int GCALab_RunServer(char *path);
+
+#endif
@@ -0,0 +1,280 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_shard.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Sharded jobs. Running the same script as --shard i/n in n
+ *              processes splits every operation given a -part file into n
+ *              contiguous pieces of work, each written to its own part file.
+ *              Running the script again with --merge reads the parts back in
+ *              order and reduces them exactly as a single process would have.
+ *
+ *==============================================================================
+ */
+
+#include "GCALab.h"
+
+/*the mode of this process, set from the command line*/
+static unsigned char GCALab_ShardMode = GCALAB_SHARD_NONE;
+static unsigned int GCALab_ShardIndex = 0;
+static unsigned int GCALab_ShardCount = 1;
+
+/**
+ * @brief Sets the shard mode of the process.
+ *
+ * @param mode GCALAB_SHARD_NONE, GCALAB_SHARD_RUN or GCALAB_SHARD_MERGE.
+ * @param index The shard this process runs (GCALAB_SHARD_RUN only).
+ * @param count The number of shards (GCALAB_SHARD_RUN only).
+ */
+void GCALab_SetShardMode(unsigned char mode,unsigned int index,unsigned int count)
+{
+	GCALab_ShardMode = mode;
+	GCALab_ShardIndex = index;
+	GCALab_ShardCount = count;
+}
+
+/**
+ * @brief Parses a shard specification of the form i/n.
+ *
+ * @retval GCALAB_SUCCESS if spec is valid, i.e., 0 <= i < n.
+ * @retval GCALAB_INVALID_OPTION otherwise.
+ */
+char GCALab_ParseShard(char *spec,unsigned int *index,unsigned int *count)
+{
+	char *end;
+	unsigned long i,n;
+	if (spec == NULL)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	i = strtoul(spec,&end,10);
+	if (end == spec || *end != '/')
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	spec = end + 1;
+	n = strtoul(spec,&end,10);
+	if (end == spec || *end != '\0' || n == 0 || i >= n)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	*index = (unsigned int)i;
+	*count = (unsigned int)n;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Opens the part files of an operation for the shard mode of the process.
+ *
+ * @details When merging, the number of shards is taken from the first section
+ * of base.0.
+ *
+ * @param shard Set to the open part files, or NULL if the process is not sharded.
+ * @param base The -part file name of the operation (can be NULL).
+ *
+ * @retval GCALAB_SUCCESS if the files are open, or there are none to open.
+ * @retval GCALAB_INVALID_OPTION if a part file could not be opened.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ */
+char GCALab_OpenShard(GCALab_Shard **shard,char *base)
+{
+	GCALab_Shard *sh;
+	GCALab_ShardHeader hdr;
+	char *name;
+	unsigned int i;
+	char rc;
+
+	(*shard) = NULL;
+	if (base == NULL || GCALab_ShardMode == GCALAB_SHARD_NONE)
+	{
+		return GCALAB_SUCCESS;
+	}
+	sh = (GCALab_Shard *)malloc(sizeof(GCALab_Shard));
+	name = (char *)malloc(strlen(base) + 16);
+	if (sh == NULL || name == NULL)
+	{
+		free(sh);
+		free(name);
+		return GCALAB_MEM_ERROR;
+	}
+	sh->mode = GCALab_ShardMode;
+	sh->index = GCALab_ShardIndex;
+	sh->count = GCALab_ShardCount;
+	sh->fp = NULL;
+	sh->nfp = 0;
+
+	rc = GCALAB_SUCCESS;
+	if (sh->mode == GCALAB_SHARD_MERGE)
+	{
+		FILE *fp;
+		rc = GCALAB_INVALID_OPTION;
+		sprintf(name,"%s.0",base);
+		if ((fp = fopen(name,"rb")) != NULL)
+		{
+			if (fread((void *)&hdr,sizeof(GCALab_ShardHeader),1,fp) == 1
+				&& !memcmp(hdr.magic,GCALAB_SHARD_MAGIC,GCALAB_SHARD_MAGIC_LEN) && hdr.count > 0)
+			{
+				sh->count = hdr.count;
+				rc = GCALAB_SUCCESS;
+			}
+			fclose(fp);
+		}
+	}
+
+	/*a merge needs every part, a shard only its own*/
+	if (rc == GCALAB_SUCCESS)
+	{
+		unsigned int nfp;
+		nfp = (sh->mode == GCALAB_SHARD_MERGE) ? sh->count : 1;
+		sh->fp = (FILE **)malloc(nfp*sizeof(FILE *));
+		if (sh->fp == NULL)
+		{
+			rc = GCALAB_MEM_ERROR;
+		}
+		for (i=0;i<nfp && rc == GCALAB_SUCCESS;i++)
+		{
+			sprintf(name,"%s.%u",base,(sh->mode == GCALAB_SHARD_MERGE) ? i : sh->index);
+			sh->fp[i] = fopen(name,(sh->mode == GCALAB_SHARD_MERGE) ? "rb" : "wb");
+			if (sh->fp[i] == NULL)
+			{
+				rc = GCALAB_INVALID_OPTION;
+				break;
+			}
+			sh->nfp++;
+		}
+	}
+	free(name);
+	if (rc != GCALAB_SUCCESS)
+	{
+		GCALab_CloseShard(sh);
+		return rc;
+	}
+	(*shard) = sh;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Closes the part files of an operation.
+ * @param shard The part files (can be NULL).
+ */
+void GCALab_CloseShard(GCALab_Shard *shard)
+{
+	unsigned int i;
+	if (shard == NULL)
+	{
+		return;
+	}
+	for (i=0;i<shard->nfp;i++)
+	{
+		fclose(shard->fp[i]);
+	}
+	free(shard->fp);
+	free(shard);
+}
+
+/**
+ * @brief The work units [start,end) a process does of a job of total units.
+ * @details This is all of them unless the process runs a shard.
+ */
+void GCALab_ShardRange(GCALab_Shard *shard,unsigned long long total,unsigned long long *start,unsigned long long *end)
+{
+	if (shard == NULL || shard->mode != GCALAB_SHARD_RUN)
+	{
+		*start = 0;
+		*end = total;
+		return;
+	}
+	*start = (total*shard->index)/shard->count;
+	*end = (total*(shard->index + 1))/shard->count;
+}
+
+/**
+ * @brief Initialises the header of a section of the given job.
+ * @details The range is that of the shard, and the section is complete with no data.
+ */
+void GCALab_InitShardHeader(GCALab_Shard *shard,GCALab_ShardHeader *hdr,unsigned int kind,unsigned long long sig,unsigned long long total)
+{
+	memset((void*)hdr,0,sizeof(GCALab_ShardHeader));
+	memcpy(hdr->magic,GCALAB_SHARD_MAGIC,GCALAB_SHARD_MAGIC_LEN);
+	hdr->sig = sig;
+	hdr->kind = kind;
+	hdr->index = shard->index;
+	hdr->count = shard->count;
+	hdr->complete = 1;
+	hdr->total = total;
+	GCALab_ShardRange(shard,total,&(hdr->start),&(hdr->end));
+}
+
+/**
+ * @brief Appends a section to the part file of a shard.
+ *
+ * @param hdr The section header, hdr->len bytes of data follow it.
+ * @param data The data.
+ */
+char GCALab_WriteShard(GCALab_Shard *shard,GCALab_ShardHeader *hdr,void *data)
+{
+	if (fwrite((void *)hdr,sizeof(GCALab_ShardHeader),1,shard->fp[0]) != 1
+		|| (hdr->len > 0 && fwrite(data,(size_t)(hdr->len),1,shard->fp[0]) != 1)
+		|| fflush(shard->fp[0]) != 0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Reads the next section of part i.
+ *
+ * @details The section must be a complete one of the same job, and start where
+ * part i-1 ended. The data is allocated by this function, it is the callers
+ * responsibility to free it.
+ *
+ * @param hdr On entry the expected sig, kind, total and start, on return the
+ * header of the section.
+ * @param data Set to the data of the section.
+ *
+ * @retval GCALAB_SUCCESS if the section was read.
+ * @retval GCALAB_INVALID_OPTION if the part is missing, short or of another job.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ */
+char GCALab_ReadShard(GCALab_Shard *shard,unsigned int i,GCALab_ShardHeader *hdr,void **data)
+{
+	GCALab_ShardHeader sec;
+	(*data) = NULL;
+	if (i >= shard->nfp || fread((void *)&sec,sizeof(GCALab_ShardHeader),1,shard->fp[i]) != 1
+		|| memcmp(sec.magic,GCALAB_SHARD_MAGIC,GCALAB_SHARD_MAGIC_LEN) || sec.sig != hdr->sig
+		|| sec.kind != hdr->kind || sec.total != hdr->total || sec.index != i || sec.count != shard->count
+		|| !sec.complete || sec.start != hdr->start || sec.end < sec.start || sec.end > sec.total
+		|| (i + 1 == shard->count && sec.end != sec.total))
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	if (!((*data) = malloc((size_t)(sec.len) + 1)))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	if (sec.len > 0 && fread(*data,(size_t)(sec.len),1,shard->fp[i]) != 1)
+	{
+		free(*data);
+		(*data) = NULL;
+		return GCALAB_INVALID_OPTION;
+	}
+	memcpy((void *)hdr,(void *)&sec,sizeof(GCALab_ShardHeader));
+	return GCALAB_SUCCESS;
+}
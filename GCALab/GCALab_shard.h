@@ -0,0 +1,99 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_shard.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Sharded job definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_SHARD_H
+#define __GCALAB_SHARD_H
+
+#include <stdio.h>
+
+/*identifies the shard file format*/
+#define GCALAB_SHARD_MAGIC "GCASHRD1"
+#define GCALAB_SHARD_MAGIC_LEN 8
+
+/*process wide shard modes*/
+/*-part files are ignored, jobs run in full*/
+#define GCALAB_SHARD_NONE 	0
+/*jobs run their share of the work and write it to the -part file*/
+#define GCALAB_SHARD_RUN 	1
+/*jobs read the work of all shards from the -part files instead of running*/
+#define GCALAB_SHARD_MERGE 	2
+
+/*kinds of shard file section*/
+#define GCALAB_SHARD_SAMPLER 	0
+#define GCALAB_SHARD_SWEEP 		1
+
+typedef struct GCALab_Shard_struct GCALab_Shard;
+typedef struct GCALab_ShardHeader_struct GCALab_ShardHeader;
+
+/*The -part files of one operation
+ *
+ * Shard i of n writes base.i, a merge reads base.0 to base.(n-1). An operation
+ * running several jobs writes (and reads) one section per job, in order.
+ */
+struct GCALab_Shard_struct
+{
+	unsigned char mode;
+	/*the shard this process runs and the number of shards*/
+	unsigned int index;
+	unsigned int count;
+	/*one file when running a shard, count files when merging*/
+	FILE **fp;
+	unsigned int nfp;
+};
+
+/*A shard file section header, followed by len bytes of data
+ *
+ * A job is split into total work units (sampler blocks or sweep rule classes)
+ * and shard i does the units [total*i/n, total*(i+1)/n), so the shards of a job
+ * cover it in order.
+ */
+struct GCALab_ShardHeader_struct
+{
+	char magic[GCALAB_SHARD_MAGIC_LEN];
+	/*identifies the job, see GCALab_SamplerSignature()*/
+	unsigned long long sig;
+	unsigned int kind;
+	unsigned int index;
+	unsigned int count;
+	/*cleared if the shard was stopped before its units were done*/
+	unsigned int complete;
+	unsigned long long start;
+	unsigned long long end;
+	unsigned long long total;
+	/*bytes of data that follow*/
+	unsigned long long len;
+};
+
+void GCALab_SetShardMode(unsigned char mode,unsigned int index,unsigned int count);
+char GCALab_ParseShard(char *spec,unsigned int *index,unsigned int *count);
+char GCALab_OpenShard(GCALab_Shard **shard,char *base);
+void GCALab_CloseShard(GCALab_Shard *shard);
+void GCALab_ShardRange(GCALab_Shard *shard,unsigned long long total,unsigned long long *start,unsigned long long *end);
+void GCALab_InitShardHeader(GCALab_Shard *shard,GCALab_ShardHeader *hdr,unsigned int kind,unsigned long long sig,unsigned long long total);
+char GCALab_WriteShard(GCALab_Shard *shard,GCALab_ShardHeader *hdr,void *data);
+char GCALab_ReadShard(GCALab_Shard *shard,unsigned int i,GCALab_ShardHeader *hdr,void **data);
+
+#endif
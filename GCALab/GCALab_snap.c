@@ -0,0 +1,882 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_snap.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Workspace snapshots. A snapshot holds the GCAs (with their time,
+ *              initial condition and window), meshes, results and command queue
+ *              of a workspace. It is written by a forked child, which works on a
+ *              copy-on-write image of the process taken while no command was
+ *              modifying the workspace, so the workspace carries on processing 
+ *              while the file is written. Restoring maps the GCAs and the large
+ *              results in place.
+ *
+ *==============================================================================
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "GCALab.h"
+
+extern GCALab_WS **GCALab_Global;
+extern unsigned int GCALab_numWS;
+extern GCALab_Op GCALab_Ops[];
+
+typedef struct GCALab_SnapWriter_struct GCALab_SnapWriter;
+typedef struct GCALab_SnapJob_struct GCALab_SnapJob;
+
+/*a snapshot being written*/
+struct GCALab_SnapWriter_struct
+{
+	FILE *fp;
+	unsigned long long offset;
+	GCALab_SnapEntry *entries;
+	unsigned long long nentries;
+	unsigned long long cap;
+};
+
+/*a snapshot child waited on by a background thread*/
+struct GCALab_SnapJob_struct
+{
+	pid_t pid;
+	char *filename;
+	unsigned char ws_id;
+	/*set if writers are held back until the child is done*/
+	unsigned char hold;
+};
+
+/*snapshots still being written*/
+static unsigned int GCALab_SnapPending = 0;
+static pthread_mutex_t GCALab_SnapLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t GCALab_SnapCond = PTHREAD_COND_INITIALIZER;
+
+/**
+ * @brief Pads the snapshot with zeros to a multiple of align.
+ */
+static char GCALab_SnapPad(GCALab_SnapWriter *w,unsigned long long align)
+{
+	static const char zeros[GCALAB_SNAP_ALIGN] = {0};
+	unsigned long long pad;
+	pad = (align - w->offset % align) % align;
+	if (pad > 0 && fwrite((void *)zeros,(size_t)pad,1,w->fp) != 1)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	w->offset += pad;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Appends an entry to the index of the snapshot.
+ */
+static char GCALab_SnapEntryAdd(GCALab_SnapWriter *w,unsigned int kind,unsigned int id,unsigned long long offset)
+{
+	GCALab_SnapEntry *entries;
+	if (w->nentries == w->cap)
+	{
+		w->cap = (w->cap > 0) ? 2*w->cap : 64;
+		if (!(entries = (GCALab_SnapEntry *)realloc(w->entries,w->cap*sizeof(GCALab_SnapEntry))))
+		{
+			return GCALAB_MEM_ERROR;
+		}
+		w->entries = entries;
+	}
+	w->entries[w->nentries].kind = kind;
+	w->entries[w->nentries].id = id;
+	w->entries[w->nentries].offset = offset;
+	w->entries[w->nentries].len = w->offset - offset;
+	w->nentries++;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Writes a GCA (and its mesh) to the snapshot as a binary container.
+ */
+static char GCALab_SnapGCA(GCALab_SnapWriter *w,unsigned int kind,unsigned int id,GraphCellularAutomaton *GCA,mesh *m)
+{
+	unsigned long long start,len;
+	if (GCALab_SnapPad(w,GCALAB_SNAP_ALIGN) != GCALAB_SUCCESS)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	start = w->offset;
+	if (GCALab_fio_writeCABin(w->fp,GCA,m,&len) != WRITE_SUCCESS)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	w->offset += len;
+	return GCALab_SnapEntryAdd(w,kind,id,start);
+}
+
+/**
+ * @brief Writes a result to the snapshot.
+ */
+static char GCALab_SnapResultAdd(GCALab_SnapWriter *w,unsigned int id,GCALabOutput *res)
+{
+	GCALab_SnapResult sr;
+	unsigned long long start,size;
+	if (GCALab_SnapPad(w,GCALAB_GCA_ALIGN) != GCALAB_SUCCESS)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	start = w->offset;
+	memset((void *)&sr,0,sizeof(GCALab_SnapResult));
+	sr.type = res->type;
+	sr.datalen = (res->data != NULL) ? res->datalen : 0;
+	strncpy(sr.id,res->id,GCALAB_SNAP_IDLEN-1);
+	/*the payload is aligned, so it can be used in place*/
+	sr.data = start + sizeof(GCALab_SnapResult);
+	sr.data += (GCALAB_GCA_ALIGN - sr.data % GCALAB_GCA_ALIGN) % GCALAB_GCA_ALIGN;
+	size = (unsigned long long)(sr.datalen)*GCALab_TypeSize(sr.type);
+	if (fwrite((void *)&sr,sizeof(GCALab_SnapResult),1,w->fp) != 1)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	w->offset += sizeof(GCALab_SnapResult);
+	if (GCALab_SnapPad(w,GCALAB_GCA_ALIGN) != GCALAB_SUCCESS 
+		|| (size > 0 && fwrite(res->data,(size_t)size,1,w->fp) != 1))
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	w->offset += size;
+	return GCALab_SnapEntryAdd(w,GCALAB_SNAP_RESULT,id,start);
+}
+
+/**
+ * @brief Writes a queued command to the snapshot.
+ * @param res the result of the command if it finished, -1 if none.
+ */
+static char GCALab_SnapCmdAdd(GCALab_SnapWriter *w,unsigned int id,GCALab_CmdRecord *cmd,int res)
+{
+	GCALab_SnapCmd sc;
+	unsigned long long start;
+	unsigned int cmd_id;
+	int i;
+	if (GCALab_SnapPad(w,GCALAB_GCA_ALIGN) != GCALAB_SUCCESS)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	start = w->offset;
+	/*a command that was asked to abort is as good as deleted*/
+	cmd_id = (cmd->cancel == GCALAB_CMD_ABORT && cmd->state != GCALAB_CMD_DONE) ? GCALAB_NOP : cmd->cmd_id;
+	memset((void *)&sc,0,sizeof(GCALab_SnapCmd));
+	sc.trgt_id = cmd->trgt_id;
+	sc.numparams = (cmd_id == cmd->cmd_id && cmd->params != NULL) ? cmd->numparams : 0;
+	sc.done = (cmd->state == GCALAB_CMD_DONE);
+	sc.rc = cmd->rc;
+	sc.res = res;
+	sc.len = strlen(GCALab_Ops[cmd_id].id) + 1;
+	for (i=0;i<sc.numparams;i++)
+	{
+		sc.len += strlen(cmd->params[i]) + 1;
+	}
+	if (fwrite((void *)&sc,sizeof(GCALab_SnapCmd),1,w->fp) != 1
+		|| fwrite((void *)GCALab_Ops[cmd_id].id,strlen(GCALab_Ops[cmd_id].id) + 1,1,w->fp) != 1)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	for (i=0;i<sc.numparams;i++)
+	{
+		if (fwrite((void *)cmd->params[i],strlen(cmd->params[i]) + 1,1,w->fp) != 1)
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+	}
+	w->offset += sizeof(GCALab_SnapCmd) + sc.len;
+	return GCALab_SnapEntryAdd(w,GCALAB_SNAP_CMD,id,start);
+}
+
+/**
+ * @brief Writes a snapshot of a workspace, called in the snapshot child.
+ * @details The file is written under a temporary name and renamed once it is 
+ * complete, so filename is never left half written.
+ */
+static char GCALab_WriteSnapshot(unsigned char ws_id,char *filename)
+{
+	GCALab_SnapWriter w;
+	GCALab_SnapHeader hdr;
+	GCALab_CmdRecord *cmd;
+	GCALab_WS *ws;
+	char *tmp;
+	unsigned int i,numres;
+	int res;
+	char rc;
+
+	ws = WS(ws_id);
+	if (!(tmp = (char *)malloc(strlen(filename) + 32)))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	sprintf(tmp,"%s.%d.tmp",filename,(int)getpid());
+	if (!(w.fp = fopen(tmp,"wb")))
+	{
+		free(tmp);
+		return GCALAB_INVALID_OPTION;
+	}
+	w.offset = 0;
+	w.entries = NULL;
+	w.nentries = 0;
+	w.cap = 0;
+	memset((void *)&hdr,0,sizeof(GCALab_SnapHeader));
+	memcpy(hdr.magic,GCALAB_SNAP_MAGIC,GCALAB_SNAP_MAGIC_LEN);
+	hdr.version = GCALAB_SNAP_VERSION;
+	hdr.chunkbits = CHUNK_SIZE_BITS;
+	hdr.numGCA = (unsigned int)ws->numGCA;
+	hdr.maxGCA = (unsigned int)ws->maxGCA;
+	hdr.maxrunning = ws->maxrunning;
+	hdr.paused = (ws->state == GCALAB_WS_STATE_PAUSED);
+	hdr.numres = ws->results.num;
+
+	/*the header is written again at the end*/
+	rc = GCALAB_INVALID_OPTION;
+	if (fwrite((void *)&hdr,sizeof(GCALab_SnapHeader),1,w.fp) == 1)
+	{
+		w.offset = sizeof(GCALab_SnapHeader);
+		rc = GCALAB_SUCCESS;
+	}
+	for (i=0;i<hdr.numGCA && rc == GCALAB_SUCCESS;i++)
+	{
+		if (ws->GCAList[i] != NULL)
+		{
+			rc = GCALab_SnapGCA(&w,GCALAB_SNAP_GCA,i,ws->GCAList[i],ws->GCAGeometry[i]);
+		}
+	}
+	for (i=0;i<hdr.numres && rc == GCALAB_SUCCESS;i++)
+	{
+		rc = GCALab_SnapResultAdd(&w,i,GCALab_GetResult(&(ws->results),i));
+	}
+	numres = hdr.numres;
+	cmd = GCALab_QueueFirst(&(ws->queue));
+	for (i=0;cmd != NULL && rc == GCALAB_SUCCESS;i++,cmd = GCALab_QueueNext(&(ws->queue),cmd))
+	{
+		res = -1;
+		if (cmd->state == GCALAB_CMD_DONE && cmd->res != NULL)
+		{
+			res = (int)numres;
+			rc = GCALab_SnapResultAdd(&w,numres++,cmd->res);
+		}
+		/*running and paused readers carry on with the view they started with*/
+		if (rc == GCALAB_SUCCESS && cmd->state != GCALAB_CMD_DONE && cmd->snapshot != NULL)
+		{
+			rc = GCALab_SnapGCA(&w,GCALAB_SNAP_VIEW,i,cmd->snapshot,NULL);
+		}
+		if (rc == GCALAB_SUCCESS)
+		{
+			rc = GCALab_SnapCmdAdd(&w,i,cmd,res);
+		}
+	}
+	hdr.numcmds = i;
+
+	/*the index makes the snapshot complete*/
+	if (rc == GCALAB_SUCCESS && (rc = GCALab_SnapPad(&w,GCALAB_GCA_ALIGN)) == GCALAB_SUCCESS)
+	{
+		hdr.index = w.offset;
+		hdr.nentries = w.nentries;
+		if ((w.nentries > 0 && fwrite((void *)w.entries,(size_t)(w.nentries)*sizeof(GCALab_SnapEntry),1,w.fp) != 1)
+			|| fseeko(w.fp,0,SEEK_SET) != 0 || fwrite((void *)&hdr,sizeof(GCALab_SnapHeader),1,w.fp) != 1)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+	}
+	if (fclose(w.fp) != 0)
+	{
+		rc = GCALAB_INVALID_OPTION;
+	}
+	if (rc != GCALAB_SUCCESS || rename(tmp,filename) != 0)
+	{
+		unlink(tmp);
+		rc = GCALAB_INVALID_OPTION;
+	}
+	free(w.entries);
+	free(tmp);
+	return rc;
+}
+
+/**
+ * @brief Tests if a command that modifies the workspace has been started.
+ * @details The caller must hold the workspace lock.
+ */
+static unsigned char GCALab_SnapWritersRunning(unsigned char ws_id)
+{
+	GCALab_CmdRecord *cmd;
+	GCALab_CmdQueue *q;
+	q = &(WS(ws_id)->queue);
+	for (cmd = GCALab_QueueFirst(q);cmd != NULL;cmd = GCALab_QueueNext(q,cmd))
+	{
+		if ((cmd->state == GCALAB_CMD_RUNNING || cmd->state == GCALAB_CMD_DISPATCHED)
+			&& (GCALab_Ops[cmd->cmd_id].flags & (GCALAB_OP_WRITE | GCALAB_OP_EXCLUSIVE)))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Tests if a workspace has a GCA kept out of core.
+ * @details The caller must hold the workspace lock.
+ */
+static unsigned char GCALab_SnapOutOfCore(unsigned char ws_id)
+{
+	int i;
+	for (i=0;i<WS(ws_id)->numGCA;i++)
+	{
+		if (WS(ws_id)->GCAList[i] != NULL && (WS(ws_id)->GCAList[i]->shared & GCA_OUT_OF_CORE))
+		{
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Lets the writers held back by a snapshot start again.
+ * @details The caller must hold the workspace lock.
+ */
+static void GCALab_SnapRelease(unsigned char ws_id)
+{
+	WS(ws_id)->holdwriters--;
+	GCALab_Schedule(ws_id);
+	GCALab_SignalWS(ws_id);
+}
+
+/**
+ * @brief Waits for a snapshot child.
+ * @returns GCALAB_SUCCESS if the snapshot was written.
+ */
+static char GCALab_SnapReap(GCALab_SnapJob *job)
+{
+	int status;
+	char rc;
+	while (waitpid(job->pid,&status,0) < 0)
+	{
+		if (errno != EINTR)
+		{
+			status = -1;
+			break;
+		}
+	}
+	rc = (status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0) ? GCALAB_SUCCESS : GCALAB_INVALID_OPTION;
+	if (job->hold)
+	{
+		GCALab_LockWS(job->ws_id);
+		GCALab_SnapRelease(job->ws_id);
+		GCALab_UnLockWS(job->ws_id);
+	}
+	pthread_mutex_lock(&GCALab_SnapLock);
+	GCALab_SnapPending--;
+	pthread_cond_broadcast(&GCALab_SnapCond);
+	pthread_mutex_unlock(&GCALab_SnapLock);
+	return rc;
+}
+
+/**
+ * @brief Background thread reaping a snapshot child.
+ */
+static void *GCALab_SnapReaper(void *arg)
+{
+	GCALab_SnapJob *job;
+	job = (GCALab_SnapJob *)arg;
+	if (GCALab_SnapReap(job) != GCALAB_SUCCESS)
+	{
+		fprintf(stderr,"snapshot %s could not be written\n",job->filename);
+	}
+	free(job);
+	return NULL;
+}
+
+/**
+ * @brief Writes a snapshot of a workspace.
+ *
+ * @details New commands that modify the workspace are held back until those
+ * already running have finished, the process then forks and the child writes
+ * the snapshot from its copy of the workspace, so read only commands never stop
+ * and the rest only wait for the fork. The rows of out-of-core GCAs are shared
+ * with the child rather than copied, so if there are any the rest wait until the
+ * snapshot is written. Recorders are not part of a snapshot.
+ *
+ * @param ws_id the workspace.
+ * @param filename the snapshot file.
+ * @param wait if set, returns once the snapshot is written, otherwise it is
+ * waited for in the background (see GCALab_WaitSnapshots()).
+ *
+ * @retval GCALAB_SUCCESS if the snapshot was (or is being) written.
+ * @retval GCALAB_INVALID_OPTION if the snapshot could not be written.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ */
+char GCALab_SnapshotWS(unsigned char ws_id,char *filename,unsigned char wait)
+{
+	GCALab_SnapJob *job;
+	pthread_t reaper;
+	pthread_attr_t attr;
+	pid_t pid;
+	char rc;
+
+	if (!(job = (GCALab_SnapJob *)malloc(sizeof(GCALab_SnapJob) + strlen(filename) + 1)))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	job->filename = (char *)(job + 1);
+	strcpy(job->filename,filename);
+	job->ws_id = ws_id;
+
+	GCALab_LockWS(ws_id);
+	WS(ws_id)->holdwriters++;
+	while (GCALab_SnapWritersRunning(ws_id))
+	{
+		GCALab_WaitWS(ws_id);
+	}
+	pthread_mutex_lock(&GCALab_SnapLock);
+	GCALab_SnapPending++;
+	pthread_mutex_unlock(&GCALab_SnapLock);
+	pid = fork();
+	if (pid == 0)
+	{
+		/*the child only has this thread, and leaves without running exit handlers*/
+		_exit((GCALab_WriteSnapshot(ws_id,filename) == GCALAB_SUCCESS) ? 0 : 1);
+	}
+	job->hold = (pid > 0 && GCALab_SnapOutOfCore(ws_id));
+	if (!(job->hold))
+	{
+		GCALab_SnapRelease(ws_id);
+	}
+	GCALab_UnLockWS(ws_id);
+
+	if (pid < 0)
+	{
+		pthread_mutex_lock(&GCALab_SnapLock);
+		GCALab_SnapPending--;
+		pthread_cond_broadcast(&GCALab_SnapCond);
+		pthread_mutex_unlock(&GCALab_SnapLock);
+		free(job);
+		return GCALAB_INVALID_OPTION;
+	}
+	job->pid = pid;
+	if (!wait)
+	{
+		pthread_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr,PTHREAD_CREATE_DETACHED);
+		wait = (pthread_create(&reaper,&attr,&GCALab_SnapReaper,(void *)job) != 0);
+		pthread_attr_destroy(&attr);
+		if (!wait)
+		{
+			return GCALAB_SUCCESS;
+		}
+	}
+	rc = GCALab_SnapReap(job);
+	free(job);
+	return rc;
+}
+
+/**
+ * @brief Waits for every snapshot being written in the background.
+ */
+void GCALab_WaitSnapshots(void)
+{
+	pthread_mutex_lock(&GCALab_SnapLock);
+	while (GCALab_SnapPending > 0)
+	{
+		pthread_cond_wait(&GCALab_SnapCond,&GCALab_SnapLock);
+	}
+	pthread_mutex_unlock(&GCALab_SnapLock);
+}
+
+/**
+ * @brief Reads exactly len bytes at offset.
+ */
+static char GCALab_SnapRead(int fd,void *buf,size_t len,unsigned long long offset)
+{
+	ssize_t n;
+	while (len > 0)
+	{
+		n = pread(fd,buf,len,(off_t)offset);
+		if (n < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (n <= 0)
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+		buf = (void *)((char *)buf + n);
+		len -= (size_t)n;
+		offset += (unsigned long long)n;
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Reads a result from a snapshot.
+ * @details Large payloads point into map if there is one, others are read.
+ * @param mapped set if the payload is in map.
+ */
+static char GCALab_SnapLoadResult(int fd,GCALab_SnapEntry *e,size_t filelen,char *map,GCALabOutput **res,unsigned char *mapped)
+{
+	GCALab_SnapResult sr;
+	unsigned long long size;
+
+	*res = NULL;
+	*mapped = 0;
+	if (e->len < sizeof(GCALab_SnapResult) || GCALab_SnapRead(fd,(void *)&sr,sizeof(GCALab_SnapResult),e->offset) != GCALAB_SUCCESS)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	size = (unsigned long long)(sr.datalen)*GCALab_TypeSize(sr.type);
+	if (sr.data < e->offset || sr.data > (unsigned long long)filelen || size > (unsigned long long)filelen - sr.data)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	if (!((*res) = (GCALabOutput *)malloc(sizeof(GCALabOutput))))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	(*res)->type = sr.type;
+	(*res)->datalen = sr.datalen;
+	sr.id[GCALAB_SNAP_IDLEN-1] = '\0';
+	strncpy((*res)->id,sr.id,GCALAB_MAX_STRLEN-1);
+	(*res)->id[GCALAB_MAX_STRLEN-1] = '\0';
+	(*res)->data = NULL;
+	if (size >= GCALAB_SPILL_THRESHOLD && map != NULL)
+	{
+		(*res)->data = (void *)(map + sr.data);
+		*mapped = 1;
+	}
+	else if (size > 0)
+	{
+		if (!((*res)->data = malloc((size_t)size)) || GCALab_SnapRead(fd,(*res)->data,(size_t)size,sr.data) != GCALAB_SUCCESS)
+		{
+			free((*res)->data);
+			free(*res);
+			*res = NULL;
+			return GCALAB_INVALID_OPTION;
+		}
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Queues a command from a snapshot.
+ * @details The caller must hold the workspace lock.
+ * @param cmd set to the queue record of the command.
+ */
+static char GCALab_SnapLoadCmd(int fd,GCALab_SnapEntry *e,unsigned char ws_id,GCALab_SnapCmd *sc,GCALab_CmdRecord **cmd)
+{
+	char *buf,*str,*end;
+	char **params;
+	char **arena;
+	unsigned int cmd_id;
+	int i;
+	char rc;
+
+	if (e->len < sizeof(GCALab_SnapCmd) || GCALab_SnapRead(fd,(void *)sc,sizeof(GCALab_SnapCmd),e->offset) != GCALAB_SUCCESS
+		|| sc->len == 0 || sc->numparams < 0 || sizeof(GCALab_SnapCmd) + (unsigned long long)(sc->len) > e->len)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	buf = (char *)malloc(sc->len + 1);
+	params = (char **)malloc((sc->numparams + 1)*sizeof(char *));
+	if (buf == NULL || params == NULL)
+	{
+		free(buf);
+		free(params);
+		return GCALAB_MEM_ERROR;
+	}
+	rc = GCALab_SnapRead(fd,(void *)buf,sc->len,e->offset + sizeof(GCALab_SnapCmd));
+	buf[sc->len] = '\0';
+	end = buf + sc->len;
+	str = buf + strlen(buf) + 1;
+	for (i=0;i<sc->numparams && rc == GCALAB_SUCCESS;i++)
+	{
+		if (str >= end)
+		{
+			rc = GCALAB_INVALID_OPTION;
+			break;
+		}
+		params[i] = str;
+		str += strlen(str) + 1;
+	}
+	/*operations are stored by name, unknown ones become a nop*/
+	cmd_id = GCALab_GetCommandCode(buf);
+	arena = NULL;
+	if (rc == GCALAB_SUCCESS && !(arena = GCALab_ParamArena(params,sc->numparams)))
+	{
+		rc = GCALAB_MEM_ERROR;
+	}
+	if (rc == GCALAB_SUCCESS && (rc = GCALab_QueuePush(&(WS(ws_id)->queue),cmd_id,sc->trgt_id,arena,sc->numparams,NULL,NULL)) != GCALAB_SUCCESS)
+	{
+		free(arena);
+	}
+	free(buf);
+	free(params);
+	if (rc == GCALAB_SUCCESS)
+	{
+		*cmd = (*cmd == NULL) ? GCALab_QueueFirst(&(WS(ws_id)->queue)) : GCALab_QueueNext(&(WS(ws_id)->queue),*cmd);
+	}
+	return rc;
+}
+
+/**
+ * @brief Restores a snapshot (see GCALab_SnapshotWS()) into a new workspace.
+ *
+ * @details GCAs and the large results are mapped from the file rather than read,
+ * changes to them never reach the file. Finished commands are retired with their
+ * results, the others are queued again, read only ones on the view they started 
+ * with. Processing starts straight away unless the workspace was paused. If the 
+ * restore fails part way the new workspace is freed again.
+ *
+ * @param filename the snapshot file.
+ * @param ws_id set to the new workspace.
+ *
+ * @retval GCALAB_SUCCESS if the workspace was restored.
+ * @retval GCALAB_INVALID_OPTION if the file is not a complete snapshot.
+ * @retval GCALAB_INVALID_WS_ERROR if there is no room for another workspace.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ */
+char GCALab_RestoreWS(char *filename,unsigned char *ws_id)
+{
+	GCALab_SnapHeader hdr;
+	GCALab_SnapEntry *entries,*e;
+	GCALab_SnapCmd sc;
+	GCALab_CmdRecord *cmd;
+	GCALabOutput **pending;
+	GCALabOutput *res;
+	GraphCellularAutomaton *GCA;
+	GCALab_WS *ws;
+	struct stat st;
+	mesh *m;
+	char *map;
+	size_t filelen;
+	unsigned long long i,npending;
+	unsigned int id;
+	unsigned char mapped;
+	int fd;
+	char rc;
+
+	/*a snapshot being written to this file is only there once it is renamed*/
+	GCALab_WaitSnapshots();
+	if ((fd = open(filename,O_RDONLY)) < 0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	entries = NULL;
+	rc = GCALAB_INVALID_OPTION;
+	if (fstat(fd,&st) == 0 && GCALab_SnapRead(fd,(void *)&hdr,sizeof(GCALab_SnapHeader),0) == GCALAB_SUCCESS
+		&& !memcmp(hdr.magic,GCALAB_SNAP_MAGIC,GCALAB_SNAP_MAGIC_LEN) && hdr.version == GCALAB_SNAP_VERSION
+		&& hdr.chunkbits == CHUNK_SIZE_BITS && hdr.numGCA <= hdr.maxGCA && hdr.index > 0 
+		&& hdr.index <= (unsigned long long)st.st_size 
+		&& hdr.nentries <= ((unsigned long long)st.st_size - hdr.index)/sizeof(GCALab_SnapEntry))
+	{
+		rc = GCALAB_MEM_ERROR;
+		if ((entries = (GCALab_SnapEntry *)malloc((size_t)(hdr.nentries + 1)*sizeof(GCALab_SnapEntry))) != NULL)
+		{
+			rc = GCALab_SnapRead(fd,(void *)entries,(size_t)(hdr.nentries)*sizeof(GCALab_SnapEntry),hdr.index);
+		}
+	}
+	filelen = (size_t)st.st_size;
+	for (i=0;i<hdr.nentries && rc == GCALAB_SUCCESS;i++)
+	{
+		if (entries[i].offset > (unsigned long long)filelen || entries[i].len > (unsigned long long)filelen - entries[i].offset)
+		{
+			rc = GCALAB_INVALID_OPTION;
+		}
+	}
+	if (rc == GCALAB_SUCCESS)
+	{
+		rc = GCALab_NewWorkSpace((int)hdr.maxGCA,(int)hdr.maxrunning);
+	}
+	if (rc != GCALAB_SUCCESS)
+	{
+		free(entries);
+		close(fd);
+		return rc;
+	}
+	*ws_id = (unsigned char)(GCALab_numWS - 1);
+	ws = WS(*ws_id);
+
+	/*large results are used in place, the mapping lasts as long as the workspace*/
+	map = NULL;
+	npending = 0;
+	for (i=0;i<hdr.nentries;i++)
+	{
+		if (entries[i].kind == GCALAB_SNAP_RESULT)
+		{
+			npending += (entries[i].id >= hdr.numres);
+			if (map == NULL && entries[i].len >= GCALAB_SPILL_THRESHOLD)
+			{
+				map = (char *)mmap(NULL,filelen,PROT_READ,MAP_PRIVATE,fd,0);
+				map = (map == (char *)MAP_FAILED) ? NULL : map;
+			}
+		}
+	}
+	if (!(pending = (GCALabOutput **)calloc((size_t)npending + 1,sizeof(GCALabOutput *))))
+	{
+		npending = 0;
+		rc = GCALAB_MEM_ERROR;
+	}
+
+	GCALab_LockWS(*ws_id);
+	for (id=0;id<hdr.maxGCA;id++)
+	{
+		ws->GCAList[id] = NULL;
+		ws->GCAGeometry[id] = NULL;
+		ws->GCARecorder[id] = NULL;
+	}
+	ws->numGCA = (int)hdr.numGCA;
+	cmd = NULL;
+	GCA = NULL;
+	for (i=0;i<hdr.nentries && rc == GCALAB_SUCCESS;i++)
+	{
+		e = entries + i;
+		switch (e->kind)
+		{
+			case GCALAB_SNAP_GCA:
+				m = NULL;
+				rc = GCALAB_INVALID_OPTION;
+				if (e->id < hdr.numGCA && ws->GCAList[e->id] == NULL
+					&& GCALab_fio_mapCABin(fd,(off_t)(e->offset),(size_t)(e->len),&(ws->GCAList[e->id]),&m) == READ_SUCCESS)
+				{
+					ws->GCAGeometry[e->id] = m;
+					rc = GCALAB_SUCCESS;
+				}
+				break;
+			case GCALAB_SNAP_VIEW:
+				/*the view goes with the next command*/
+				m = NULL;
+				FreeGCA(GCA);
+				GCA = NULL;
+				if (GCALab_fio_mapCABin(fd,(off_t)(e->offset),(size_t)(e->len),&GCA,&m) != READ_SUCCESS)
+				{
+					rc = GCALAB_INVALID_OPTION;
+				}
+				break;
+			case GCALAB_SNAP_RESULT:
+				rc = GCALab_SnapLoadResult(fd,e,filelen,map,&res,&mapped);
+				if (rc != GCALAB_SUCCESS)
+				{
+					break;
+				}
+				if (e->id < hdr.numres && e->id == ws->results.num)
+				{
+					rc = (mapped) ? GCALab_AddMappedResult(&(ws->results),res) : GCALab_AddResult(&(ws->results),res);
+				}
+				else if (e->id >= hdr.numres && e->id - hdr.numres < npending && pending[e->id - hdr.numres] == NULL)
+				{
+					pending[e->id - hdr.numres] = res;
+				}
+				else
+				{
+					rc = GCALAB_INVALID_OPTION;
+				}
+				if (rc != GCALAB_SUCCESS)
+				{
+					if (!mapped)
+					{
+						free(res->data);
+					}
+					free(res);
+				}
+				break;
+			case GCALAB_SNAP_CMD:
+				rc = GCALab_SnapLoadCmd(fd,e,*ws_id,&sc,&cmd);
+				if (rc != GCALAB_SUCCESS)
+				{
+					break;
+				}
+				cmd->snapshot = GCA;
+				GCA = NULL;
+				if (sc.done)
+				{
+					free(cmd->params);
+					cmd->params = NULL;
+					cmd->numparams = 0;
+					cmd->rc = (char)(sc.rc);
+					cmd->state = GCALAB_CMD_DONE;
+					if (sc.res >= (int)(hdr.numres) && (unsigned long long)(sc.res - (int)(hdr.numres)) < npending)
+					{
+						cmd->res = pending[sc.res - hdr.numres];
+						pending[sc.res - hdr.numres] = NULL;
+					}
+					FreeGCA(cmd->snapshot);
+					cmd->snapshot = NULL;
+				}
+				break;
+			default:
+				rc = GCALAB_INVALID_OPTION;
+				break;
+		}
+	}
+	FreeGCA(GCA);
+	/*results no command claimed*/
+	for (i=0;i<npending;i++)
+	{
+		if (pending[i] != NULL)
+		{
+			if (map == NULL || (char *)(pending[i]->data) < map || (char *)(pending[i]->data) >= map + filelen)
+			{
+				free(pending[i]->data);
+			}
+			free(pending[i]);
+		}
+	}
+	free(pending);
+	free(entries);
+	close(fd);
+
+	/*a partly restored workspace is dropped, the payloads in the mapping are not its own*/
+	if (rc != GCALAB_SUCCESS)
+	{
+		for (id=0;id<ws->results.num;id++)
+		{
+			res = GCALab_GetResult(&(ws->results),id);
+			if (map != NULL && (char *)(res->data) >= map && (char *)(res->data) < map + filelen)
+			{
+				res->data = NULL;
+			}
+		}
+		for (cmd = GCALab_QueueFirst(&(ws->queue));cmd != NULL;cmd = GCALab_QueueNext(&(ws->queue),cmd))
+		{
+			if (map != NULL && cmd->res != NULL && (char *)(cmd->res->data) >= map && (char *)(cmd->res->data) < map + filelen)
+			{
+				cmd->res->data = NULL;
+			}
+		}
+		GCALab_UnLockWS(*ws_id);
+		GCALab_DropWorkSpace();
+		if (map != NULL)
+		{
+			munmap((void *)map,filelen);
+		}
+		return rc;
+	}
+
+	/*finished commands are retired in order, the rest run as before*/
+	GCALab_RetireCommands(*ws_id);
+	if (hdr.paused)
+	{
+		ws->state = GCALAB_WS_STATE_PAUSED;
+	}
+	GCALab_Schedule(*ws_id);
+	GCALab_SignalWS(*ws_id);
+	GCALab_UnLockWS(*ws_id);
+	return rc;
+}
@@ -0,0 +1,117 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_snap.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Workspace snapshot definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_SNAP_H
+#define __GCALAB_SNAP_H
+
+/*identifies the snapshot file format*/
+#define GCALAB_SNAP_MAGIC "GCASNAP1"
+#define GCALAB_SNAP_MAGIC_LEN 8
+#define GCALAB_SNAP_VERSION 1
+
+/*length of a result id in the file*/
+#define GCALAB_SNAP_IDLEN 128
+
+#ifndef GCALAB_SNAP_ALIGN
+/*GCA containers start on this boundary, so they can be mapped in place*/
+#define GCALAB_SNAP_ALIGN 4096
+#endif
+
+/*kinds of snapshot entry*/
+/*a GCA container (see GCALab_fio_writeCABin()), id is the GCA slot*/
+#define GCALAB_SNAP_GCA 	0
+/*a GCALab_SnapResult followed by the payload, id is the result*/
+#define GCALAB_SNAP_RESULT 	1
+/*a GCALab_SnapCmd followed by the strings, id is the position in the queue*/
+#define GCALAB_SNAP_CMD 	2
+/*the GCA container a read only command works on, id is the command*/
+#define GCALAB_SNAP_VIEW 	3
+
+typedef struct GCALab_SnapHeader_struct GCALab_SnapHeader;
+typedef struct GCALab_SnapEntry_struct GCALab_SnapEntry;
+typedef struct GCALab_SnapResult_struct GCALab_SnapResult;
+typedef struct GCALab_SnapCmd_struct GCALab_SnapCmd;
+
+/*Snapshot file format
+ *
+ * A header, then the entries in the order they are restored: the GCAs, the 
+ * results, then the command queue. Results of commands that finished but were 
+ * not yet retired are numbered after the results of the workspace and written 
+ * just before their command, as is the view of a running or paused read only
+ * command. The entry index is written at the end, a file without one was not
+ * finished.
+ */
+struct GCALab_SnapHeader_struct
+{
+	char magic[GCALAB_SNAP_MAGIC_LEN];
+	unsigned int version;
+	unsigned int chunkbits;
+	unsigned int numGCA;
+	unsigned int maxGCA;
+	unsigned int maxrunning;
+	unsigned int paused;
+	unsigned int numres;
+	unsigned int numcmds;
+	unsigned long long nentries;
+	/*offset of the entry index, 0 if the snapshot was not finished*/
+	unsigned long long index;
+};
+
+struct GCALab_SnapEntry_struct
+{
+	unsigned int kind;
+	unsigned int id;
+	unsigned long long offset;
+	unsigned long long len;
+};
+
+struct GCALab_SnapResult_struct
+{
+	int type;
+	unsigned int datalen;
+	char id[GCALAB_SNAP_IDLEN];
+	/*offset of the payload*/
+	unsigned long long data;
+};
+
+/*a queued command, followed by len bytes holding the operation name and then
+ * the parameters, each terminated*/
+struct GCALab_SnapCmd_struct
+{
+	unsigned int trgt_id;
+	int numparams;
+	/*set if the command finished, with its return code and result (-1 if none)*/
+	unsigned int done;
+	int rc;
+	int res;
+	unsigned int len;
+};
+
+char GCALab_SnapshotWS(unsigned char ws_id,char *filename,unsigned char wait);
+char GCALab_RestoreWS(char *filename,unsigned char *ws_id);
+void GCALab_WaitSnapshots(void);
+
+#endif
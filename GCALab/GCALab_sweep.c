@@ -0,0 +1,740 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_sweep.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Rule-space sweeps. The topology of a template GCA is built once
+ *              and shared by all workers, which claim rules dynamically and
+ *              only swap the rule look-up table between rules. Rows are written
+ *              out in rule order as soon as all earlier rules are complete.
+ *              Equivalent rules are grouped into classes before the sweep starts
+ *              and workers claim whole classes.
+ *
+ *==============================================================================
+ */
+
+#include <math.h>
+#include <limits.h>
+#include "GCALab.h"
+
+/*names used on the command line and in output headers*/
+static const char *GCALab_MeasureNames[GCALAB_NUM_MEASURES] = {"lambda","Z","S","W","G","C","T"};
+
+/*shared state of a sweep*/
+typedef struct
+{
+	GCALab_Sweep *sw;
+	unsigned int nrules;
+	/*rule classes, members of class c are members[class_start[c]..class_start[c+1]-1]
+	 * in rule order, classes are numbered in order of their first member*/
+	unsigned int nclasses;
+	unsigned int *class_start;
+	unsigned int *members;
+	/*hash of each class' canonical rule table, 0 if the rules are invalid*/
+	unsigned long long *class_hash;
+	unsigned char reflect;
+	unsigned long long topo;
+	/*classes [first, end) are evaluated, all of them unless the sweep is a shard*/
+	unsigned int first;
+	unsigned int end;
+	/*next class to claim and next row to write*/
+	unsigned int next;
+	unsigned int next_write;
+	/*set to 1 once a row is done, 2 if it belongs to another shard*/
+	unsigned char *done;
+	pthread_mutex_t lock;
+	/*profile of the command running the sweep (can be NULL)*/
+	GCALab_Profile *prof;
+	/*progress callback of the command running the sweep (can be NULL)*/
+	GCA_Progress *progress;
+	unsigned char stop;
+} GCALab_SweepRun;
+
+/**
+ * @brief Sets default sweep options.
+ *
+ * @param sw The sweep to initialise.
+ * @param GCA The template GCA.
+ */
+void GCALab_InitSweep(GCALab_Sweep *sw,GraphCellularAutomaton *GCA)
+{
+	sw->GCA = GCA;
+	sw->rule_type = GCA->params->rule_type;
+	sw->rule0 = GCA->params->rule;
+	sw->rule1 = GCA->params->rule;
+	sw->nmeasures = 0;
+	sw->n = GCALAB_SWEEP_DEFAULT_SAMPLES;
+	sw->seed = GCALAB_DEFAULT_SEED;
+	sw->T = GCALAB_SWEEP_DEFAULT_T;
+	sw->maxT = DEFAULT_WINDOW_SIZE;
+	sw->nthreads = GCALAB_DEFAULT_THREADS;
+	sw->canon = 1;
+	sw->cache = NULL;
+	sw->fp = NULL;
+	sw->shard = NULL;
+	sw->rows = NULL;
+	sw->nclasses = 0;
+}
+
+/**
+ * @brief Returns the name of a measure.
+ */
+const char *GCALab_MeasureName(unsigned int measure)
+{
+	return (measure < GCALAB_NUM_MEASURES) ? GCALab_MeasureNames[measure] : "?";
+}
+
+/**
+ * @brief Parses a comma separated list of measures (e.g., "lambda,Z,S,G").
+ *
+ * @param sw The sweep.
+ * @param list The measure list, it is modified by the tokeniser.
+ *
+ * @retval GCALAB_INVALID_OPTION if a measure is unknown or there are too many.
+ */
+char GCALab_ParseMeasures(GCALab_Sweep *sw,char *list)
+{
+	char *tok,*save;
+	unsigned int m;
+	sw->nmeasures = 0;
+	for (tok = strtok_r(list,",",&save);tok != NULL;tok = strtok_r(NULL,",",&save))
+	{
+		for (m=0;m<GCALAB_NUM_MEASURES;m++)
+		{
+			if (!strcmp(tok,GCALab_MeasureNames[m]))
+			{
+				break;
+			}
+		}
+		if (m == GCALAB_NUM_MEASURES || sw->nmeasures == GCALAB_SWEEP_MAX_MEASURES)
+		{
+			return GCALAB_INVALID_OPTION;
+		}
+		sw->measures[sw->nmeasures++] = m;
+	}
+	return (sw->nmeasures > 0) ? GCALAB_SUCCESS : GCALAB_INVALID_OPTION;
+}
+
+/**
+ * @brief Computes a single measure for the current rule of GCA.
+ */
+static float GCALab_SweepMeasure(GCALab_Sweep *sw,GraphCellularAutomaton *GCA,void *scratch,unsigned int measure)
+{
+	GCALab_Sampler smp;
+	GCALab_SampleArgs args;
+	float est;
+
+	switch(measure)
+	{
+		case GCALAB_MEASURE_LAMBDA:
+			return lambda_param(GCA);
+		case GCALAB_MEASURE_Z:
+			return Z_param(GCA);
+	}
+
+	args.goe_only = 0;
+	args.freqs = NULL;
+	args.nfreqs = 0;
+	GCALab_InitSampler(&smp,GCA,1);
+	smp.n = sw->n;
+	smp.seed = sw->seed;
+	smp.args = (void*)&args;
+	switch(measure)
+	{
+		case GCALAB_MEASURE_S:
+		case GCALAB_MEASURE_W:
+			args.op = GCALAB_ENTROPY;
+			args.T = sw->T;
+			args.type = (measure == GCALAB_MEASURE_S) ? GCALAB_SHANNON_ENTROPY : GCALAB_WORD_ENTROPY;
+			smp.sample = &GCALab_Sample_Entropy;
+			break;
+		case GCALAB_MEASURE_G:
+			args.op = GCALAB_PARAM;
+			args.T = sw->maxT;
+			args.type = GCALAB_G_PARAM;
+			smp.sample = &GCALab_Sample_Param;
+			break;
+		case GCALAB_MEASURE_C:
+		case GCALAB_MEASURE_T:
+			args.op = GCALAB_PARAM;
+			args.T = sw->maxT;
+			args.type = (measure == GCALAB_MEASURE_C) ? GCALAB_C_PARAM : GCALAB_T_PARAM;
+			smp.nvals = 2;
+			smp.sample = &GCALab_Sample_Param;
+			break;
+	}
+
+	if (GCALab_RunSamplerOn(&smp,GCA,scratch) != GCALAB_SUCCESS)
+	{
+		return NAN;
+	}
+	if (smp.nvals == 2)
+	{
+		est = (smp.sums[1] > 0) ? (float)(smp.sums[0]/smp.sums[1]) : 0.0;
+	}
+	else
+	{
+		est = (float)(smp.sums[0]/((double)smp.n_used));
+	}
+	free(smp.sums);
+	return est;
+}
+
+/**
+ * @brief Tests if a measure takes the same value for all rules in a class.
+ */
+static unsigned char GCALab_ClassInvariant(unsigned int measure)
+{
+	return (measure != GCALAB_MEASURE_LAMBDA && measure != GCALAB_MEASURE_Z);
+}
+
+/**
+ * @brief Computes a class invariant measure for the rule table of GCA, using the cache if set.
+ */
+static float GCALab_SweepClassMeasure(GCALab_SweepRun *run,GraphCellularAutomaton *GCA,void *scratch,unsigned long long rule,unsigned int measure)
+{
+	GCALab_Sweep *sw;
+	GCALab_CacheRecord rec;
+	unsigned long long p[3];
+	sw = run->sw;
+	if (sw->cache == NULL)
+	{
+		return GCALab_SweepMeasure(sw,GCA,scratch,measure);
+	}
+	/*only the options this measure depends on are part of the key*/
+	p[0] = (unsigned long long)sw->n;
+	p[1] = sw->seed;
+	switch(measure)
+	{
+		case GCALAB_MEASURE_S:
+		case GCALAB_MEASURE_W:
+			p[2] = (unsigned long long)sw->T;
+			break;
+		case GCALAB_MEASURE_C:
+		case GCALAB_MEASURE_T:
+			p[2] = (unsigned long long)sw->maxT;
+			break;
+		default:
+			p[2] = 0;
+			break;
+	}
+	rec.topo = run->topo;
+	rec.rule = rule;
+	rec.params = GCALab_Hash(GCALAB_HASH_INIT,(void*)p,3*sizeof(unsigned long long));
+	rec.measure = measure;
+	if (GCALab_CacheLookup(sw->cache,&rec))
+	{
+		return rec.value;
+	}
+	rec.value = GCALab_SweepMeasure(sw,GCA,scratch,measure);
+	GCALab_CacheStore(sw->cache,&rec);
+	return rec.value;
+}
+
+/**
+ * @brief Writes row r of a sweep to its output file, if it has one.
+ */
+static void GCALab_SweepWriteRow(GCALab_Sweep *sw,unsigned int r)
+{
+	double *row;
+	unsigned int m;
+	if (sw->fp == NULL)
+	{
+		return;
+	}
+	row = sw->rows + r*(sw->nmeasures + 1);
+	fprintf(sw->fp,"%u",sw->rule0 + r);
+	for (m=0;m<sw->nmeasures;m++)
+	{
+		fprintf(sw->fp,",%g",row[m+1]);
+	}
+	fprintf(sw->fp,"\n");
+}
+
+/**
+ * @brief Hashes everything that determines the rows of a sweep.
+ */
+static unsigned long long GCALab_SweepSignature(GCALab_SweepRun *run)
+{
+	GCALab_Sweep *sw;
+	unsigned long long job[9];
+	sw = run->sw;
+	job[0] = sw->rule_type;
+	job[1] = sw->rule0;
+	job[2] = sw->rule1;
+	job[3] = sw->n;
+	job[4] = sw->seed;
+	job[5] = sw->T;
+	job[6] = sw->maxT;
+	job[7] = sw->canon;
+	job[8] = run->nclasses;
+	return GCALab_Hash(GCALab_Hash(run->topo,(void*)job,9*sizeof(unsigned long long)),
+		(void*)sw->measures,(sw->nmeasures)*sizeof(unsigned int));
+}
+
+/**
+ * @brief Number of rules in the classes [c0,c1).
+ */
+static unsigned int GCALab_SweepNumRules(GCALab_SweepRun *run,unsigned long long c0,unsigned long long c1)
+{
+	return run->class_start[c1] - run->class_start[c0];
+}
+
+/**
+ * @brief Writes the rows of the classes of a shard to its part file, in class order.
+ * @details A shard that was stopped writes the classes it did, marked incomplete.
+ */
+static char GCALab_SaveSweepShard(GCALab_SweepRun *run)
+{
+	GCALab_Sweep *sw;
+	GCALab_ShardHeader hdr;
+	double *buf;
+	unsigned int i,ncols,nrows;
+	char rc;
+
+	sw = run->sw;
+	ncols = sw->nmeasures + 1;
+	GCALab_InitShardHeader(sw->shard,&hdr,GCALAB_SHARD_SWEEP,GCALab_SweepSignature(run),run->nclasses);
+	hdr.end = run->next;
+	hdr.complete = !run->stop;
+	nrows = GCALab_SweepNumRules(run,hdr.start,hdr.end);
+	hdr.len = nrows*ncols*sizeof(double);
+	if (!(buf = (double *)malloc((nrows*ncols + 1)*sizeof(double))))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	for (i=0;i<nrows;i++)
+	{
+		memcpy((void*)(buf + i*ncols),(void*)(sw->rows + (run->members[run->class_start[hdr.start] + i])*ncols),ncols*sizeof(double));
+	}
+	rc = GCALab_WriteShard(sw->shard,&hdr,(void*)buf);
+	free(buf);
+	return rc;
+}
+
+/**
+ * @brief Reads the rows of a sweep from the part files of its shards.
+ */
+static char GCALab_MergeSweep(GCALab_SweepRun *run)
+{
+	GCALab_Sweep *sw;
+	GCALab_ShardHeader hdr;
+	double *buf;
+	unsigned int i,j,ncols,nrows;
+	char rc;
+
+	sw = run->sw;
+	ncols = sw->nmeasures + 1;
+	GCALab_InitShardHeader(sw->shard,&hdr,GCALAB_SHARD_SWEEP,GCALab_SweepSignature(run),run->nclasses);
+	hdr.start = 0;
+	rc = GCALAB_SUCCESS;
+	for (i=0;i<sw->shard->count;i++)
+	{
+		rc = GCALab_ReadShard(sw->shard,i,&hdr,(void**)&buf);
+		if (rc != GCALAB_SUCCESS)
+		{
+			return rc;
+		}
+		nrows = GCALab_SweepNumRules(run,hdr.start,hdr.end);
+		if (hdr.len != nrows*ncols*sizeof(double))
+		{
+			free(buf);
+			return GCALAB_INVALID_OPTION;
+		}
+		for (j=0;j<nrows;j++)
+		{
+			memcpy((void*)(sw->rows + (run->members[run->class_start[hdr.start] + j])*ncols),(void*)(buf + j*ncols),ncols*sizeof(double));
+		}
+		free(buf);
+		hdr.start = hdr.end;
+	}
+	for (j=0;j<run->nrules;j++)
+	{
+		GCALab_SweepWriteRow(sw,j);
+	}
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Sweep thread, evaluates rule classes until there are none left.
+ */
+static void *GCALab_SweepWorkerMain(void *params)
+{
+	GCALab_SweepRun *run;
+	GCALab_Sweep *sw;
+	GraphCellularAutomaton *GCA;
+	GCALab_SampleArgs args;
+	void *scratch;
+	state *canon;
+	unsigned int c,i,r,m,ncols;
+	double *row;
+	float vals[GCALAB_SWEEP_MAX_MEASURES];
+	GCALab_Profile prof;
+
+	run = (GCALab_SweepRun *)params;
+	sw = run->sw;
+	GCALab_ProfileThreadBegin(&prof,run->prof);
+	ncols = sw->nmeasures + 1;
+
+	/*the graph is shared, only the window and rule table are per thread*/
+	GCA = CloneGCA(sw->GCA);
+	args.op = GCALAB_ENTROPY;
+	args.T = sw->T;
+	scratch = (GCA != NULL) ? GCALab_Sample_InitScratch(GCA,(void*)&args) : NULL;
+	canon = (GCA != NULL) ? (state *)malloc((GCA->LUT_size)*sizeof(state)) : NULL;
+
+	while(1)
+	{
+		pthread_mutex_lock(&(run->lock));
+		c = run->next;
+		if (c < run->end && !run->stop && run->progress != NULL && run->progress->f != NULL)
+		{
+			run->stop = (*(run->progress->f))(run->progress->arg,c - run->first,run->end - run->first);
+		}
+		if (c < run->end && !run->stop)
+		{
+			run->next++;
+		}
+		pthread_mutex_unlock(&(run->lock));
+		/*a stopped sweep picks up the finished classes from its cache when restarted*/
+		if (c >= run->end || run->stop)
+		{
+			break;
+		}
+
+		/*class invariant measures are evaluated once, on the canonical rule*/
+		r = run->members[run->class_start[c]];
+		if (scratch == NULL || canon == NULL || run->class_hash[c] == 0 || !SetCARule(GCA,sw->rule_type,sw->rule0 + r))
+		{
+			for (m=0;m<sw->nmeasures;m++)
+			{
+				vals[m] = NAN;
+			}
+		}
+		else
+		{
+			if (sw->canon)
+			{
+				CanonicalRuleLUT(GCA,GCA->ruleLUT,canon,run->reflect);
+				memcpy((void*)GCA->ruleLUT,(void*)canon,(GCA->LUT_size)*sizeof(state));
+			}
+			for (m=0;m<sw->nmeasures;m++)
+			{
+				if (GCALab_ClassInvariant(sw->measures[m]))
+				{
+					vals[m] = GCALab_SweepClassMeasure(run,GCA,scratch,run->class_hash[c],sw->measures[m]);
+				}
+			}
+		}
+
+		for (i=run->class_start[c];i<run->class_start[c+1];i++)
+		{
+			r = run->members[i];
+			row = sw->rows + r*ncols;
+			row[0] = (double)(sw->rule0 + r);
+			for (m=0;m<sw->nmeasures;m++)
+			{
+				if (GCALab_ClassInvariant(sw->measures[m]) || run->class_hash[c] == 0 || scratch == NULL)
+				{
+					row[m+1] = vals[m];
+				}
+				else
+				{
+					/*lambda and Z depend on the labelling of the states*/
+					row[m+1] = (SetCARule(GCA,sw->rule_type,sw->rule0 + r)) ? GCALab_SweepMeasure(sw,GCA,scratch,sw->measures[m]) : NAN;
+				}
+			}
+		}
+
+		/*stream out every row that is now complete in rule order*/
+		pthread_mutex_lock(&(run->lock));
+		for (i=run->class_start[c];i<run->class_start[c+1];i++)
+		{
+			run->done[run->members[i]] = 1;
+		}
+		while (run->next_write < run->nrules && run->done[run->next_write])
+		{
+			if (run->done[run->next_write] == 1)
+			{
+				GCALab_SweepWriteRow(sw,run->next_write);
+			}
+			run->next_write++;
+		}
+		if (sw->fp != NULL)
+		{
+			fflush(sw->fp);
+		}
+		pthread_mutex_unlock(&(run->lock));
+	}
+
+	if (scratch != NULL)
+	{
+		GCALab_Sample_Reduce(scratch,NULL);
+	}
+	free(canon);
+	FreeGCA(GCA);
+	GCALab_ProfileThreadEnd(&prof);
+	return NULL;
+}
+
+/**
+ * @brief Groups the rules of a sweep into equivalence classes.
+ *
+ * @details Rules are equivalent if their canonical rule tables are equal (compared 
+ * by hash). Invalid rules are each put in a class of their own with hash 0.
+ */
+static char GCALab_SweepClasses(GCALab_SweepRun *run)
+{
+	GCALab_Sweep *sw;
+	GraphCellularAutomaton *GCA;
+	state *canon;
+	unsigned long long h;
+	unsigned int *class_of,*slots,*count;
+	unsigned long long size;
+	unsigned int r,c,i;
+	char rc;
+
+	sw = run->sw;
+	for (size=1;size < 2ULL*run->nrules;size <<= 1);
+	if (size > 2ULL*GCALAB_SWEEP_MAX_RULES)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	GCA = CloneGCA(sw->GCA);
+	canon = (GCA != NULL) ? (state *)malloc((GCA->LUT_size)*sizeof(state)) : NULL;
+	class_of = (unsigned int *)malloc((run->nrules)*sizeof(unsigned int));
+	slots = (unsigned int *)malloc(size*sizeof(unsigned int));
+	run->class_hash = (unsigned long long *)malloc((run->nrules)*sizeof(unsigned long long));
+	run->class_start = (unsigned int *)malloc((run->nrules + 1)*sizeof(unsigned int));
+	run->members = (unsigned int *)malloc((run->nrules)*sizeof(unsigned int));
+	rc = GCALAB_SUCCESS;
+	if (canon == NULL || class_of == NULL || slots == NULL || run->class_hash == NULL 
+		|| run->class_start == NULL || run->members == NULL)
+	{
+		rc = GCALAB_MEM_ERROR;
+		goto cleanup;
+	}
+	/*slots hold class + 1, 0 is empty*/
+	memset(slots,0,size*sizeof(unsigned int));
+	memset(run->class_start,0,(run->nrules + 1)*sizeof(unsigned int));
+
+	run->nclasses = 0;
+	for (r=0;r<run->nrules;r++)
+	{
+		if (!SetCARule(GCA,sw->rule_type,sw->rule0 + r))
+		{
+			run->class_hash[run->nclasses] = 0;
+			class_of[r] = run->nclasses++;
+			continue;
+		}
+		if (sw->canon)
+		{
+			CanonicalRuleLUT(GCA,GCA->ruleLUT,canon,run->reflect);
+		}
+		else
+		{
+			memcpy((void*)canon,(void*)GCA->ruleLUT,(GCA->LUT_size)*sizeof(state));
+		}
+		h = GCALab_Hash(GCALAB_HASH_INIT,(void*)canon,(GCA->LUT_size)*sizeof(state));
+		h = (h) ? h : 1;
+		for (i=(unsigned int)((h ^ (h >> 32)) & (size-1));slots[i] && run->class_hash[slots[i]-1] != h;i = (unsigned int)((i+1) & (size-1)));
+		if (!slots[i])
+		{
+			run->class_hash[run->nclasses] = h;
+			slots[i] = ++(run->nclasses);
+		}
+		class_of[r] = slots[i] - 1;
+	}
+
+	/*counting sort of the rules by class, stable so members stay in rule order*/
+	for (r=0;r<run->nrules;r++)
+	{
+		run->class_start[class_of[r]+1]++;
+	}
+	for (c=0;c<run->nclasses;c++)
+	{
+		run->class_start[c+1] += run->class_start[c];
+	}
+	count = slots;
+	memcpy(count,run->class_start,(run->nclasses)*sizeof(unsigned int));
+	for (r=0;r<run->nrules;r++)
+	{
+		run->members[count[class_of[r]]++] = r;
+	}
+
+cleanup:
+	free(canon);
+	free(class_of);
+	free(slots);
+	FreeGCA(GCA);
+	return rc;
+}
+
+/**
+ * @brief Runs a rule-space sweep.
+ *
+ * @details sw->rows is allocated by this function and holds (rule1 - rule0 + 1) rows
+ * of (nmeasures + 1) values, it is the callers responsibility to free it. If sw->fp is
+ * set a header and every row are written to it as comma separated columns.
+ *
+ * @param sw The sweep.
+ *
+ * @retval GCALAB_SUCCESS if all rules were evaluated (invalid rules give NaN rows).
+ * @retval GCALAB_SUCCESS also if the sweep was stopped by the progress callback (see 
+ * GCA_SetProgress()), rows of the rules not done are then undefined.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ * @retval GCALAB_INVALID_OPTION if the sweep is not fully specified, has more than
+ * UINT_MAX values or GCALAB_SWEEP_MAX_RULES rules, or a part file could not be written or is not of this sweep.
+ */
+char GCALab_RunSweep(GCALab_Sweep *sw)
+{
+	GCALab_SweepRun run;
+	pthread_t *threads;
+	unsigned int t,m,nthreads,nstarted;
+	unsigned long long c,c0,c1;
+	char rc;
+
+	if (sw->GCA == NULL || sw->nmeasures == 0 || sw->rule1 < sw->rule0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	/*the rows are a single result, so their number of values must fit its length*/
+	if (((unsigned long long)(sw->rule1 - sw->rule0) + 1)*(sw->nmeasures + 1) > UINT_MAX
+		|| (unsigned long long)(sw->rule1 - sw->rule0) + 1 > GCALAB_SWEEP_MAX_RULES)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+
+	run.sw = sw;
+	run.prof = GCALab_CurrentProfile();
+	run.progress = GCA_GetProgress();
+	run.stop = 0;
+	run.nrules = sw->rule1 - sw->rule0 + 1;
+	run.next_write = 0;
+	/*reflection is only a symmetry of the dynamics on a ring*/
+	run.reflect = IsRingTopology(sw->GCA);
+	run.topo = GCALab_HashTopology(sw->GCA);
+	run.class_hash = NULL;
+	run.class_start = NULL;
+	run.members = NULL;
+	rc = GCALab_SweepClasses(&run);
+	if (rc <= 0)
+	{
+		free(run.class_hash);
+		free(run.class_start);
+		free(run.members);
+		return rc;
+	}
+	sw->nclasses = run.nclasses;
+	GCALab_ShardRange(sw->shard,run.nclasses,&c0,&c1);
+	run.first = (unsigned int)c0;
+	run.end = (unsigned int)c1;
+	run.next = run.first;
+	nthreads = (sw->nthreads == 0) ? 1 : sw->nthreads;
+	nthreads = (run.end - run.first < nthreads) ? run.end - run.first : nthreads;
+
+	sw->rows = (double *)malloc(run.nrules*(sw->nmeasures+1)*sizeof(double));
+	run.done = (unsigned char *)malloc(run.nrules*sizeof(unsigned char));
+	threads = (pthread_t *)malloc((nthreads+1)*sizeof(pthread_t));
+	if (sw->rows == NULL || run.done == NULL || threads == NULL)
+	{
+		free(sw->rows);
+		free(run.done);
+		free(threads);
+		free(run.class_hash);
+		free(run.class_start);
+		free(run.members);
+		sw->rows = NULL;
+		return GCALAB_MEM_ERROR;
+	}
+	memset(run.done,0,run.nrules*sizeof(unsigned char));
+
+	/*the rows of classes another shard does are NaN*/
+	for (c=0;c<run.nclasses;c++)
+	{
+		if (c >= c0 && c < c1)
+		{
+			continue;
+		}
+		for (t=run.class_start[c];t<run.class_start[c+1];t++)
+		{
+			double *row;
+			row = sw->rows + (run.members[t])*(sw->nmeasures+1);
+			row[0] = (double)(sw->rule0 + run.members[t]);
+			for (m=0;m<sw->nmeasures;m++)
+			{
+				row[m+1] = NAN;
+			}
+			run.done[run.members[t]] = 2;
+		}
+	}
+
+	if (sw->fp != NULL)
+	{
+		fprintf(sw->fp,"rule");
+		for (m=0;m<sw->nmeasures;m++)
+		{
+			fprintf(sw->fp,",%s",GCALab_MeasureName(sw->measures[m]));
+		}
+		fprintf(sw->fp,"\n");
+	}
+
+	rc = GCALAB_SUCCESS;
+	if (sw->shard != NULL && sw->shard->mode == GCALAB_SHARD_MERGE)
+	{
+		rc = GCALab_MergeSweep(&run);
+	}
+	else
+	{
+		pthread_mutex_init(&(run.lock),NULL);
+		/*measures are never cut short, the sweep only stops between classes*/
+		GCA_SetProgress(NULL);
+		/*the calling thread acts as worker 0*/
+		for (nstarted=1;nstarted<nthreads;nstarted++)
+		{
+			if (pthread_create(threads + nstarted,NULL,GCALab_SweepWorkerMain,(void*)&run))
+			{
+				break;
+			}
+		}
+		GCALab_SweepWorkerMain((void*)&run);
+		for (t=1;t<nstarted;t++)
+		{
+			pthread_join(threads[t],NULL);
+		}
+		pthread_mutex_destroy(&(run.lock));
+		GCA_SetProgress(run.progress);
+		if (sw->shard != NULL)
+		{
+			rc = GCALab_SaveSweepShard(&run);
+		}
+	}
+
+	free(run.done);
+	free(run.class_hash);
+	free(run.class_start);
+	free(run.members);
+	free(threads);
+	if (rc != GCALAB_SUCCESS)
+	{
+		free(sw->rows);
+		sw->rows = NULL;
+	}
+	return rc;
+}
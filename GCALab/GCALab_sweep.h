@@ -0,0 +1,118 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_sweep.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Rule-space sweep definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_SWEEP_H
+#define __GCALAB_SWEEP_H
+
+#include <stdio.h>
+#include "GCA.h"
+#include "GCALab_cache.h"
+#include "GCALab_shard.h"
+
+#ifndef GCALAB_SWEEP_MAX_MEASURES
+#define GCALAB_SWEEP_MAX_MEASURES 8
+#endif
+
+/*bounds the class hash table of a sweep, which has twice as many slots as rules*/
+#ifndef GCALAB_SWEEP_MAX_RULES
+#define GCALAB_SWEEP_MAX_RULES (1U << 30)
+#endif
+
+#ifndef GCALAB_SWEEP_DEFAULT_SAMPLES
+#define GCALAB_SWEEP_DEFAULT_SAMPLES 100
+#endif
+
+#ifndef GCALAB_SWEEP_DEFAULT_T
+#define GCALAB_SWEEP_DEFAULT_T 100
+#endif
+
+/*measure codes*/
+#define GCALAB_MEASURE_LAMBDA 	0
+#define GCALAB_MEASURE_Z 		1
+#define GCALAB_MEASURE_S 		2
+#define GCALAB_MEASURE_W 		3
+#define GCALAB_MEASURE_G 		4
+#define GCALAB_MEASURE_C 		5
+#define GCALAB_MEASURE_T 		6
+#define GCALAB_NUM_MEASURES 	7
+
+typedef struct GCALab_Sweep_struct GCALab_Sweep;
+
+/*A rule-space sweep
+ *
+ * Every rule in [rule0,rule1] is evaluated on the topology, window size and number 
+ * of states of GCA. Worker threads each clone GCA once and only rebuild the rule 
+ * table between rules. Sampled measures use the same seed for every rule, so all 
+ * rules see the same initial conditions.
+ *
+ * If canon is set rules are grouped into equivalence classes (see CanonicalRuleLUT())
+ * and the measures that are invariant within a class (S, W, G, C and T) are only 
+ * computed once per class, on the canonical rule. If a cache is given, results are
+ * looked up there first and stored there otherwise.
+ *
+ * If shard is set and running, only the shard's range of rule classes is evaluated
+ * and its rows are written to the part file (the other rows are NaN). If it is
+ * merging, the rows are read from the parts instead of being evaluated.
+ */
+struct GCALab_Sweep_struct
+{
+	/*the template GCA, it is never modified*/
+	GraphCellularAutomaton *GCA;
+	/*rule range (inclusive)*/
+	unsigned char rule_type;
+	unsigned int rule0;
+	unsigned int rule1;
+	/*measures to compute for each rule*/
+	unsigned int nmeasures;
+	unsigned int measures[GCALAB_SWEEP_MAX_MEASURES];
+	/*samples per sampled measure*/
+	unsigned int n;
+	unsigned long long seed;
+	/*entropy time steps and max time for cycle search*/
+	unsigned int T;
+	unsigned int maxT;
+	unsigned int nthreads;
+	/*group rules into equivalence classes*/
+	unsigned char canon;
+	/*persistent result cache (can be NULL)*/
+	GCALab_Cache *cache;
+	/*rows are streamed here in rule order (can be NULL)*/
+	FILE *fp;
+	/*part files of a sharded sweep (NULL if not sharded)*/
+	GCALab_Shard *shard;
+	/*output: one row per rule, the rule code followed by each measure (double, 
+	 * so every rule code is exact)*/
+	double *rows;
+	/*output: number of rule classes evaluated*/
+	unsigned int nclasses;
+};
+
+void GCALab_InitSweep(GCALab_Sweep *sw,GraphCellularAutomaton *GCA);
+char GCALab_ParseMeasures(GCALab_Sweep *sw,char *list);
+const char *GCALab_MeasureName(unsigned int measure);
+char GCALab_RunSweep(GCALab_Sweep *sw);
+
+#endif
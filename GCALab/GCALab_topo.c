@@ -0,0 +1,393 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_topo.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Persistent topology cache. Building the graph of a large mesh
+ *              (and subdividing a generated one) is quadratic in the number of
+ *              faces, so with a cache directory both are done once and later
+ *              gca commands, in this or any other process, map the graph back 
+ *              in. Files are written under a temporary name and renamed, so 
+ *              processes sharing a directory never see a partial file.
+ *
+ *              Out-of-core GCAs. With an out-of-core directory, new GCAs keep 
+ *              their window rows (and any graph not already mapped from the 
+ *              cache) in a file there instead of in memory, see OutOfCoreGCA().
+ *              A GCA is moved once it is created, so its graph must first be
+ *              built in memory.
+ *
+ *==============================================================================
+ */
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "GCALab.h"
+
+/*the cache directory, NULL if topologies are not cached*/
+static char *GCALab_TopoDir = NULL;
+/*makes temporary file names unique within the process*/
+static unsigned int GCALab_TopoSeq = 0;
+/*the out-of-core directory, NULL if GCAs are kept in memory*/
+static char *GCALab_OutOfCoreDir = NULL;
+
+/**
+ * @brief Sets the topology cache directory.
+ * @param dir The directory (must exist), or NULL to disable the cache.
+ */
+void GCALab_SetTopologyCache(char *dir)
+{
+	GCALab_TopoDir = dir;
+}
+
+/**
+ * @brief Hashes the faces of a mesh, the only part of it a graph depends on.
+ */
+unsigned long long GCALab_HashFaces(mesh *m,unsigned char nh_type)
+{
+	unsigned long long h;
+	unsigned int hdr[4];
+	hdr[0] = GCALAB_TOPO_VERSION;
+	hdr[1] = (unsigned int)nh_type;
+	hdr[2] = (unsigned int)m->fList->numFaces;
+	hdr[3] = (unsigned int)m->fList->maxVerts;
+	h = GCALab_Hash(GCALAB_HASH_INIT,(void*)hdr,4*sizeof(unsigned int));
+	return GCALab_Hash(h,(void*)m->fList->faces,(size_t)(m->fList->numFaces)*(m->fList->maxVerts)*sizeof(int));
+}
+
+/**
+ * @brief Makes the name of a cache file, and a temporary name to write it under.
+ * @returns The name, the caller frees it, or NULL if there is no memory.
+ */
+static char *GCALab_TopoFile(char *name,char **tmp)
+{
+	char *file;
+	size_t len;
+	len = strlen(GCALab_TopoDir) + strlen(name) + 2;
+	if (!(file = (char *)malloc(2*len + 48)))
+	{
+		return NULL;
+	}
+	sprintf(file,"%s/%s",GCALab_TopoDir,name);
+	if (tmp != NULL)
+	{
+		*tmp = file + len;
+		sprintf(*tmp,"%s.%d.%u.tmp",file,(int)getpid(),__sync_fetch_and_add(&GCALab_TopoSeq,1));
+	}
+	return file;
+}
+
+/**
+ * @brief Moves a finished temporary file into place.
+ */
+static void GCALab_TopoCommit(char *tmp,char *file,unsigned char ok)
+{
+	if (!ok || rename(tmp,file) != 0)
+	{
+		unlink(tmp);
+	}
+}
+
+/**
+ * @brief Maps the graph of a mesh from the cache.
+ *
+ * @details The mapping is private and writable, since the graph is modified by
+ * RotateNeighbourhood().
+ *
+ * @param params Set to the cached N, k and graph on a hit.
+ * @param map Set to the mapping, the graph points into it.
+ * @param maplen Set to the length of the mapping.
+ *
+ * @retval GCALAB_SUCCESS on a hit.
+ * @retval GCALAB_INVALID_OPTION on a miss.
+ */
+static char GCALab_LoadTopology(mesh *m,unsigned char nh_type,unsigned long long key,CellularAutomatonParameters *params,void **map,size_t *maplen)
+{
+	GCALab_TopoHeader hdr;
+	struct stat st;
+	char name[64];
+	char *file;
+	void *base;
+	int fd;
+
+	sprintf(name,"topo-%016llx-%u.gcg",key,(unsigned int)nh_type);
+	if (!(file = GCALab_TopoFile(name,NULL)))
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	fd = open(file,O_RDONLY);
+	free(file);
+	if (fd < 0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	/*the header must describe this mesh and the file hold the whole graph*/
+	if (fstat(fd,&st) < 0 || read(fd,(void *)&hdr,sizeof(GCALab_TopoHeader)) != sizeof(GCALab_TopoHeader)
+		|| memcmp(hdr.magic,GCALAB_TOPO_MAGIC,GCALAB_TOPO_MAGIC_LEN) || hdr.version != GCALAB_TOPO_VERSION
+		|| hdr.key != key || hdr.nh_type != nh_type || hdr.numFaces != (unsigned int)m->fList->numFaces
+		|| hdr.maxVerts != (unsigned int)m->fList->maxVerts || hdr.N != hdr.numFaces || hdr.k < 2 
+		|| (unsigned long long)st.st_size != GCALAB_TOPO_DATA + (unsigned long long)(hdr.N)*(hdr.k-1)*sizeof(unsigned int))
+	{
+		close(fd);
+		return GCALAB_INVALID_OPTION;
+	}
+	base = mmap(NULL,(size_t)st.st_size,PROT_READ | PROT_WRITE,MAP_PRIVATE,fd,0);
+	close(fd);
+	if (base == MAP_FAILED)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	params->N = hdr.N;
+	params->k = (unsigned char)hdr.k;
+	params->graph = (unsigned int *)((char *)base + GCALAB_TOPO_DATA);
+	*map = base;
+	*maplen = (size_t)st.st_size;
+	return GCALAB_SUCCESS;
+}
+
+/**
+ * @brief Writes the graph of a mesh to the cache, errors are ignored.
+ */
+static void GCALab_StoreTopology(mesh *m,unsigned char nh_type,unsigned long long key,CellularAutomatonParameters *params)
+{
+	GCALab_TopoHeader hdr;
+	char pad[GCALAB_TOPO_DATA];
+	char name[64];
+	char *file,*tmp;
+	FILE *fp;
+	unsigned char ok;
+
+	sprintf(name,"topo-%016llx-%u.gcg",key,(unsigned int)nh_type);
+	if (!(file = GCALab_TopoFile(name,&tmp)))
+	{
+		return;
+	}
+	memset((void *)&hdr,0,sizeof(GCALab_TopoHeader));
+	memcpy(hdr.magic,GCALAB_TOPO_MAGIC,GCALAB_TOPO_MAGIC_LEN);
+	hdr.version = GCALAB_TOPO_VERSION;
+	hdr.nh_type = nh_type;
+	hdr.key = key;
+	hdr.numFaces = (unsigned int)m->fList->numFaces;
+	hdr.maxVerts = (unsigned int)m->fList->maxVerts;
+	hdr.N = params->N;
+	hdr.k = params->k;
+	memset((void *)pad,0,GCALAB_TOPO_DATA);
+	memcpy((void *)pad,(void *)&hdr,sizeof(GCALab_TopoHeader));
+	if ((fp = fopen(tmp,"wb")) != NULL)
+	{
+		ok = (fwrite((void *)pad,GCALAB_TOPO_DATA,1,fp) == 1 
+			&& fwrite((void *)(params->graph),(size_t)(params->N)*(params->k-1)*sizeof(unsigned int),1,fp) == 1);
+		ok = (fclose(fp) == 0) && ok;
+		GCALab_TopoCommit(tmp,file,ok);
+	}
+	free(file);
+}
+
+/**
+ * @brief Creates a sphere, torus or double torus mesh of at least numFaces faces,
+ * see CreateMeshTopology().
+ *
+ * @details With a cache directory the mesh is read from (or saved to) a binary 
+ * PLY file, which holds the vertices exactly, so the mesh is the same either way.
+ *
+ * @returns The mesh, NULL on error.
+ */
+mesh *GCALab_CreateMeshTopology(int numFaces,int genus)
+{
+	mesh *m;
+	char name[64];
+	char *file,*tmp;
+
+	if (GCALab_TopoDir == NULL)
+	{
+		return CreateMeshTopology(numFaces,genus);
+	}
+	sprintf(name,"mesh-%d-%d.ply",genus,numFaces);
+	if (!(file = GCALab_TopoFile(name,&tmp)))
+	{
+		return CreateMeshTopology(numFaces,genus);
+	}
+	if (access(file,R_OK) == 0 && ReadPLY(file,&m) > 0)
+	{
+		free(file);
+		return m;
+	}
+	if ((m = CreateMeshTopology(numFaces,genus)) != NULL)
+	{
+		GCALab_TopoCommit(tmp,file,WritePLY(tmp,m) > 0);
+	}
+	free(file);
+	return m;
+}
+
+/**
+ * @brief Creates a Graph Cellular Automaton on the topology of a mesh, see 
+ * CreateCAParams() and CreateGCA().
+ *
+ * @details With a cache directory, the graph is mapped from the cache if this 
+ * mesh has been seen before and stored in it otherwise. A mapped graph is
+ * released with the GCA.
+ *
+ * @returns The GCA, NULL on error.
+ */
+GraphCellularAutomaton *GCALab_CreateGCA(unsigned char nh_type,mesh *m,state s,unsigned char rule_type,unsigned int rule,unsigned int ws)
+{
+	CellularAutomatonParameters *params;
+	GraphCellularAutomaton *GCA;
+	unsigned long long key;
+	void *map;
+	size_t maplen;
+
+	map = NULL;
+	maplen = 0;
+	if (GCALab_TopoDir == NULL)
+	{
+		params = CreateCAParams(nh_type,m,s,rule_type,rule,ws);
+	}
+	else
+	{
+		key = GCALab_HashFaces(m,nh_type);
+		if (!(params = (CellularAutomatonParameters *)malloc(sizeof(CellularAutomatonParameters))))
+		{
+			return NULL;
+		}
+		if (GCALab_LoadTopology(m,nh_type,key,params,&map,&maplen) == GCALAB_SUCCESS)
+		{
+			params->WSIZE = (ws == 0) ? DEFAULT_WINDOW_SIZE : ws;
+			params->rule_type = rule_type;
+			params->rule = rule;
+			params->s = s;
+		}
+		else
+		{
+			free(params);
+			if ((params = CreateCAParams(nh_type,m,s,rule_type,rule,ws)) != NULL)
+			{
+				GCALab_StoreTopology(m,nh_type,key,params);
+			}
+		}
+	}
+	if (params == NULL)
+	{
+		return NULL;
+	}
+	if (!(GCA = CreateGCA(params)))
+	{
+		if (map != NULL)
+		{
+			munmap(map,maplen);
+		}
+		else
+		{
+			free(params->graph);
+		}
+		free(params);
+		return NULL;
+	}
+	/*the mapping now belongs to the GCA*/
+	if (map != NULL)
+	{
+		GCA->shared |= GCA_SHARED_GRAPH | GCA_MAPPED;
+		GCA->map = map;
+		GCA->maplen = maplen;
+	}
+	return GCA;
+}
+
+/**
+ * @brief Sets the out-of-core directory.
+ * @param dir The directory (must exist), or NULL to keep GCAs in memory.
+ */
+void GCALab_SetOutOfCore(char *dir)
+{
+	GCALab_OutOfCoreDir = dir;
+}
+
+/**
+ * @brief The window size to create a GCA with.
+ * @details Out-of-core GCAs default to GCALAB_OOC_WSIZE rows, as every row is 
+ * the size of a configuration.
+ * Read only operations still use the default window (see GCALab_ReadWindowSize()).
+ * @param ws The window size asked for, 0 for the default.
+ */
+unsigned int GCALab_WindowSize(unsigned int ws)
+{
+	if (ws == 0 && GCALab_OutOfCoreDir != NULL)
+	{
+		return GCALAB_OOC_WSIZE;
+	}
+	return ws;
+}
+
+/**
+ * @brief The window size read only operations evolve a GCA with.
+ * @details Out-of-core GCAs with the default GCALAB_OOC_WSIZE rows are read with 
+ * the in-memory default window instead, so that measures that depend on the window
+ * (e.g., attractor cycle lengths) are the same as for a GCA kept in memory.
+ * @param GCA The GCA.
+ */
+unsigned int GCALab_ReadWindowSize(GraphCellularAutomaton *GCA)
+{
+	if ((GCA->shared & GCA_OUT_OF_CORE) && GCA->params->WSIZE == GCALAB_OOC_WSIZE)
+	{
+		return DEFAULT_WINDOW_SIZE;
+	}
+	return GCA->params->WSIZE;
+}
+
+/**
+ * @brief Moves a new GCA out of core if there is an out-of-core directory.
+ *
+ * @details The rows go to a file in the directory that is unlinked straight 
+ * away, so it is released with the GCA, or by the system if the process dies.
+ *
+ * @retval GCALAB_SUCCESS if the GCA was moved, or there is no directory.
+ * @retval GCALAB_INVALID_OPTION if the file could not be created or mapped.
+ * @retval GCALAB_MEM_ERROR if memory could not be allocated.
+ */
+char GCALab_OutOfCore(GraphCellularAutomaton *GCA)
+{
+	char *file;
+	int fd;
+	unsigned char ok;
+
+	if (GCALab_OutOfCoreDir == NULL)
+	{
+		return GCALAB_SUCCESS;
+	}
+	if (!(file = (char *)malloc(strlen(GCALab_OutOfCoreDir) + 48)))
+	{
+		return GCALAB_MEM_ERROR;
+	}
+	sprintf(file,"%s/ooc-%d-%u.gcr",GCALab_OutOfCoreDir,(int)getpid(),__sync_fetch_and_add(&GCALab_TopoSeq,1));
+	fd = open(file,O_RDWR | O_CREAT | O_EXCL,0600);
+	if (fd >= 0)
+	{
+		unlink(file);
+	}
+	free(file);
+	if (fd < 0)
+	{
+		return GCALAB_INVALID_OPTION;
+	}
+	ok = OutOfCoreGCA(GCA,fd);
+	close(fd);
+	return (ok) ? GCALAB_SUCCESS : GCALAB_INVALID_OPTION;
+}
@@ -0,0 +1,78 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: GCALab_topo.h
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Persistent topology cache and out-of-core GCA definitions
+ *
+ *==============================================================================
+ */
+
+#ifndef __GCALAB_TOPO_H
+#define __GCALAB_TOPO_H
+
+#include "mesh.h"
+#include "GCA.h"
+
+/*identifies the topology file format*/
+#define GCALAB_TOPO_MAGIC "GCATOPO1"
+#define GCALAB_TOPO_MAGIC_LEN 8
+#define GCALAB_TOPO_VERSION 1
+
+/*the graph starts this many bytes into the file*/
+#define GCALAB_TOPO_DATA 64
+
+#ifndef GCALAB_OOC_WSIZE
+/*default window size of an out-of-core GCA*/
+#define GCALAB_OOC_WSIZE 2
+#endif
+
+typedef struct GCALab_TopoHeader_struct GCALab_TopoHeader;
+
+/*Topology file header
+ *
+ * A cache directory holds one file per (mesh faces, neighbourhood type), named 
+ * after the key, with the graph in native byte order after the header so a hit
+ * is a single mapping. Generated meshes are kept alongside as binary PLY files.
+ */
+struct GCALab_TopoHeader_struct
+{
+	char magic[GCALAB_TOPO_MAGIC_LEN];
+	unsigned int version;
+	unsigned int nh_type;
+	/*hash of the faces of the mesh, see GCALab_HashFaces()*/
+	unsigned long long key;
+	/*the mesh the graph was built from*/
+	unsigned int numFaces;
+	unsigned int maxVerts;
+	/*the graph, N x (k-1)*/
+	unsigned int N;
+	unsigned int k;
+};
+
+void GCALab_SetTopologyCache(char *dir);
+unsigned long long GCALab_HashFaces(mesh *m,unsigned char nh_type);
+mesh *GCALab_CreateMeshTopology(int numFaces,int genus);
+GraphCellularAutomaton *GCALab_CreateGCA(unsigned char nh_type,mesh *m,state s,unsigned char rule_type,unsigned int rule,unsigned int ws);
+void GCALab_SetOutOfCore(char *dir);
+unsigned int GCALab_WindowSize(unsigned int ws);
+unsigned int GCALab_ReadWindowSize(GraphCellularAutomaton *GCA);
+char GCALab_OutOfCore(GraphCellularAutomaton *GCA);
+
+#endif
@@ -0,0 +1,868 @@
+/* GCALab: An analysis tool for Graph Cellular Automata
+ * Copyright (C) 2012  David J. Warne
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* File: test.c
+ *
+ * Date Created: 19/10/2026
+ * Last Modified: 19/10/2026
+ *
+ * Description: Self checks of the GCALab modules (run with -check). Files are
+ *              written to the current directory and removed afterwards.
+ *
+ *==============================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "GCALab.h"
+
+extern GCALab_WS **GCALab_Global;
+extern unsigned int GCALab_numWS;
+
+/* runParamSampler(): samples all parameters of GCA with nthreads threads,
+ * from noise initial conditions, from range if it is not NULL, or until the
+ * estimate of G is within tol if tol > 0. The part files of shard are used if
+ * it is not NULL*/
+char runParamSampler(GCALab_Sampler *smp,GraphCellularAutomaton *GCA,GCALab_SampleArgs *args,
+	unsigned int nthreads,chunk *range,double tol,GCALab_Shard *shard)
+{
+	char rc;
+	args->op = GCALAB_PARAM;
+	args->T = 40;
+	args->type = GCALAB_ALL_PARAM;
+	args->goe_only = 0;
+	args->freqs = NULL;
+	args->nfreqs = 0;
+	GCALab_InitSampler(smp,GCA,5);
+	smp->nthreads = nthreads;
+	smp->seed = 7;
+	smp->sample = &GCALab_Sample_Param;
+	smp->args = (void*)args;
+	smp->n = 3000;
+	smp->shard = shard;
+	rc = GCALAB_SUCCESS;
+	if (range != NULL)
+	{
+		rc = GCALab_SetSamplerRange(smp,range,3);
+	}
+	if (rc == GCALAB_SUCCESS && tol > 0.0)
+	{
+		rc = GCALab_SetSamplerTolerance(smp,tol,0.95);
+		GCALab_SamplerMonitor(smp,0,-1);
+	}
+	return (rc == GCALAB_SUCCESS) ? GCALab_RunSampler(smp) : rc;
+}
+
+/* checkSampler(): the sums of a sampling job, and where it stops early, must
+ * not depend on the number of threads*/
+int checkSampler(void)
+{
+	unsigned int threads[3] = {1,3,8};
+	unsigned int c,j,fails;
+	double ref[5];
+	unsigned long long ref_n;
+	chunk range[2];
+	GraphCellularAutomaton *ECA;
+	GCALab_Sampler smp;
+	GCALab_SampleArgs args;
+
+	fails = 0;
+	ECA = CreateECA(12,3,110,64);
+	range[0] = 5;
+	range[1] = 0xFFF;
+	ref_n = 0;
+	for (c=0;c<3;c++)
+	{
+		for (j=0;j<3;j++)
+		{
+			if (runParamSampler(&smp,ECA,&args,threads[j],(c == 1) ? range : NULL,(c == 2) ? 0.03 : 0.0,NULL) != GCALAB_SUCCESS)
+			{
+				printf("RunSampler: case %u with %u threads failed\n",c,threads[j]);
+				fails++;
+				continue;
+			}
+			if (j == 0)
+			{
+				memcpy((void*)ref,(void*)smp.sums,5*sizeof(double));
+				ref_n = smp.n_used;
+			}
+			else if (memcmp((void*)ref,(void*)smp.sums,5*sizeof(double)) || smp.n_used != ref_n)
+			{
+				printf("RunSampler: case %u with %u threads, %llu samples G=%f (%llu samples G=%f)\n",
+					c,threads[j],smp.n_used,smp.sums[0],ref_n,ref[0]);
+				fails++;
+			}
+			free(smp.sums);
+		}
+	}
+	FreeGCA(ECA);
+	return fails;
+}
+
+/* runShardSweep(): runs a sweep of the ECA rules in the process shard mode, 
+ * writing or merging the part files of base*/
+char runShardSweep(GCALab_Sweep *sw,GraphCellularAutomaton *GCA,char *base)
+{
+	/*the list is split in place*/
+	char measures[] = "lambda,Z,S,G,C";
+	char rc;
+	GCALab_InitSweep(sw,GCA);
+	sw->rule_type = CODE_RULE_TYPE;
+	sw->rule0 = 0;
+	sw->rule1 = 255;
+	sw->n = 50;
+	sw->T = 20;
+	sw->maxT = 40;
+	sw->nthreads = 2;
+	rc = GCALab_ParseMeasures(sw,measures);
+	if (rc == GCALAB_SUCCESS)
+	{
+		rc = GCALab_OpenShard(&(sw->shard),base);
+	}
+	if (rc == GCALAB_SUCCESS)
+	{
+		rc = GCALab_RunSweep(sw);
+		GCALab_CloseShard(sw->shard);
+	}
+	return rc;
+}
+
+/* checkShards(): merging the parts of a sampling job or a sweep run as three 
+ * shards must give the sums and rows of a single run*/
+int checkShards(void)
+{
+	unsigned int i,fails;
+	double ref[5];
+	double *rows;
+	char name[32];
+	GraphCellularAutomaton *ECA;
+	GCALab_Shard *shard;
+	GCALab_Sampler smp;
+	GCALab_SampleArgs args;
+	GCALab_Sweep sw;
+
+	fails = 0;
+	ECA = CreateECA(12,3,110,64);
+	GCALab_SetShardMode(GCALAB_SHARD_NONE,0,1);
+	rows = NULL;
+	if (runParamSampler(&smp,ECA,&args,2,NULL,0.0,NULL) != GCALAB_SUCCESS 
+		|| runShardSweep(&sw,ECA,NULL) != GCALAB_SUCCESS)
+	{
+		printf("checkShards: single run failed\n");
+		FreeGCA(ECA);
+		return 1;
+	}
+	memcpy((void*)ref,(void*)smp.sums,5*sizeof(double));
+	free(smp.sums);
+	rows = sw.rows;
+
+	for (i=0;i<=3;i++)
+	{
+		/*the three shards, then the merge*/
+		GCALab_SetShardMode((i < 3) ? GCALAB_SHARD_RUN : GCALAB_SHARD_MERGE,(i < 3) ? i : 0,3);
+		if (GCALab_OpenShard(&shard,"check_sampler.part") != GCALAB_SUCCESS
+			|| runParamSampler(&smp,ECA,&args,2,NULL,0.0,shard) != GCALAB_SUCCESS)
+		{
+			printf("RunSampler: shard %u of 3 failed\n",i);
+			fails++;
+		}
+		else
+		{
+			if (i == 3 && memcmp((void*)ref,(void*)smp.sums,5*sizeof(double)))
+			{
+				printf("RunSampler: merged G=%f (G=%f)\n",smp.sums[0],ref[0]);
+				fails++;
+			}
+			free(smp.sums);
+		}
+		GCALab_CloseShard(shard);
+		if (runShardSweep(&sw,ECA,"check_sweep.part") != GCALAB_SUCCESS)
+		{
+			printf("RunSweep: shard %u of 3 failed\n",i);
+			fails++;
+			continue;
+		}
+		if (i == 3 && memcmp((void*)rows,(void*)sw.rows,256*(sw.nmeasures + 1)*sizeof(double)))
+		{
+			printf("RunSweep: merged rows differ\n");
+			fails++;
+		}
+		free(sw.rows);
+	}
+	GCALab_SetShardMode(GCALAB_SHARD_NONE,0,1);
+	for (i=0;i<3;i++)
+	{
+		sprintf(name,"check_sampler.part.%u",i);
+		remove(name);
+		sprintf(name,"check_sweep.part.%u",i);
+		remove(name);
+	}
+	free(rows);
+	FreeGCA(ECA);
+	return fails;
+}
+
+#define CHECK_PRODUCERS 4
+#define CHECK_CONSUMERS 2
+#define CHECK_PUSHES 5000
+
+/*a queue shared by the producer and consumer threads of checkQueue()*/
+typedef struct
+{
+	GCALab_CmdQueue q;
+	/*serialises the consumers, as the workspace lock does*/
+	pthread_mutex_t lock;
+	/*number of commands of each producer popped so far*/
+	unsigned int next[CHECK_PRODUCERS];
+	unsigned int popped;
+	unsigned int fails;
+	unsigned int id[CHECK_PRODUCERS];
+} CheckQueue;
+CheckQueue checkq;
+
+/* queueProducer(): pushes CHECK_PUSHES commands tagged with the producer and a 
+ * sequence number*/
+void *queueProducer(void *arg)
+{
+	unsigned int p,i;
+	char str[32];
+	char *argv[1];
+	char **params;
+	p = *((unsigned int *)arg);
+	argv[0] = str;
+	for (i=0;i<CHECK_PUSHES;i++)
+	{
+		sprintf(str,"%u.%u",p,i);
+		params = GCALab_ParamArena(argv,1);
+		if (params == NULL || GCALab_QueuePush(&(checkq.q),p,i,params,1,NULL,NULL) != GCALAB_SUCCESS)
+		{
+			free(params);
+			__sync_fetch_and_add(&(checkq.fails),1);
+		}
+	}
+	return NULL;
+}
+
+/* queueConsumer(): pops commands until all have been popped, every producer's
+ * commands must come out in the order they were pushed*/
+void *queueConsumer(void *arg)
+{
+	GCALab_CmdRecord *cmd;
+	char str[32];
+	unsigned char done;
+	done = 0;
+	while (!done)
+	{
+		pthread_mutex_lock(&(checkq.lock));
+		if ((cmd = GCALab_QueueFirst(&(checkq.q))) != NULL)
+		{
+			sprintf(str,"%u.%u",cmd->cmd_id,cmd->trgt_id);
+			if (cmd->cmd_id >= CHECK_PRODUCERS || cmd->trgt_id != checkq.next[cmd->cmd_id] 
+				|| cmd->numparams != 1 || strcmp(cmd->params[0],str))
+			{
+				printf("QueueFirst: got %u.%u\n",cmd->cmd_id,cmd->trgt_id);
+				checkq.fails++;
+			}
+			else
+			{
+				checkq.next[cmd->cmd_id]++;
+			}
+			free(cmd->params);
+			GCALab_QueuePop(&(checkq.q));
+			checkq.popped++;
+		}
+		done = (checkq.popped == CHECK_PRODUCERS*CHECK_PUSHES || checkq.fails > 0);
+		pthread_mutex_unlock(&(checkq.lock));
+	}
+	return NULL;
+}
+
+/* checkQueue(): producers and consumers use the queue at once, over many 
+ * segments, no command may be lost, duplicated or reordered*/
+int checkQueue(void)
+{
+	pthread_t threads[CHECK_PRODUCERS + CHECK_CONSUMERS];
+	unsigned int i;
+	GCALab_CmdRecord *cmd;
+
+	memset((void*)&checkq,0,sizeof(CheckQueue));
+	if (GCALab_InitQueue(&(checkq.q)) != GCALAB_SUCCESS)
+	{
+		printf("InitQueue: failed\n");
+		return 1;
+	}
+	pthread_mutex_init(&(checkq.lock),NULL);
+	for (i=0;i<CHECK_CONSUMERS;i++)
+	{
+		pthread_create(threads + CHECK_PRODUCERS + i,NULL,&queueConsumer,NULL);
+	}
+	for (i=0;i<CHECK_PRODUCERS;i++)
+	{
+		checkq.id[i] = i;
+		pthread_create(threads + i,NULL,&queueProducer,(void *)(checkq.id + i));
+	}
+	for (i=0;i<CHECK_PRODUCERS + CHECK_CONSUMERS;i++)
+	{
+		pthread_join(threads[i],NULL);
+	}
+	if (checkq.fails == 0 && GCALab_QueueLength(&(checkq.q)) != 0)
+	{
+		printf("QueueLength: %llu left\n",GCALab_QueueLength(&(checkq.q)));
+		checkq.fails++;
+	}
+	/*a failed check may leave commands behind*/
+	while ((cmd = GCALab_QueueFirst(&(checkq.q))) != NULL)
+	{
+		free(cmd->params);
+		GCALab_QueuePop(&(checkq.q));
+	}
+	GCALab_FreeQueue(&(checkq.q));
+	pthread_mutex_destroy(&(checkq.lock));
+	return checkq.fails;
+}
+
+/* newResult(): a result of n floats, value i is i + seed*/
+GCALabOutput *newResult(unsigned int n,unsigned int seed)
+{
+	GCALabOutput *res;
+	float *data;
+	unsigned int i;
+	res = (GCALabOutput *)malloc(sizeof(GCALabOutput));
+	data = (float *)malloc(n*sizeof(float));
+	if (res == NULL || data == NULL)
+	{
+		free(res);
+		free(data);
+		return NULL;
+	}
+	for (i=0;i<n;i++)
+	{
+		data[i] = (float)(i + seed);
+	}
+	res->type = FLOAT32;
+	sprintf(res->id,"(%u):check",seed);
+	res->datalen = n;
+	res->data = (void *)data;
+	return res;
+}
+
+/* checkResults(): results added to a store, small ones kept in memory and large
+ * ones spilled to the scratch file over several index blocks, must read back 
+ * as they were added*/
+int checkResults(void)
+{
+	GCALab_ResultStore rs;
+	GCALabOutput *res;
+	size_t large,spilled;
+	unsigned int i,j,n,fails;
+	float *data;
+
+	if (GCALab_InitResults(&rs) != GCALAB_SUCCESS)
+	{
+		printf("InitResults: failed\n");
+		return 1;
+	}
+	fails = 0;
+	large = GCALAB_SPILL_THRESHOLD/sizeof(float) + 100;
+	spilled = 0;
+	for (i=0;i<5*GCALAB_RESULTS_INIT_SIZE;i++)
+	{
+		n = (i % 3 == 0) ? (unsigned int)large : 10 + i;
+		if ((res = newResult(n,i)) == NULL || GCALab_AddResult(&rs,res) != GCALAB_SUCCESS)
+		{
+			printf("AddResult: result %u failed\n",i);
+			fails++;
+			break;
+		}
+		spilled += (i % 3 == 0) ? n*sizeof(float) : 0;
+	}
+	if (rs.num != i || rs.spilled != spilled)
+	{
+		printf("AddResult: %u results %lu bytes spilled (%u results %lu bytes)\n",rs.num,
+			(unsigned long)rs.spilled,i,(unsigned long)spilled);
+		fails++;
+	}
+	for (i=0;i<rs.num;i++)
+	{
+		res = GCALab_GetResult(&rs,i);
+		n = (i % 3 == 0) ? (unsigned int)large : 10 + i;
+		data = (float *)(res->data);
+		for (j=0;j<n && res->datalen == n && data[j] == (float)(j + i);j++);
+		if (j < n)
+		{
+			printf("GetResult: result %u differs at %u\n",i,j);
+			fails++;
+		}
+	}
+	if (GCALab_GetResult(&rs,rs.num) != NULL)
+	{
+		printf("GetResult: result %u should not exist\n",rs.num);
+		fails++;
+	}
+	GCALab_FreeResults(&rs);
+	return fails;
+}
+
+/* tetraMesh(): a tetrahedron with outward facing triangles*/
+mesh *tetraMesh(void)
+{
+	float verts[12] = {0,0,0, 1,0,0, 0,1,0, 0,0,1};
+	int faces[12] = {0,2,1, 0,1,3, 0,3,2, 1,2,3};
+	unsigned int i;
+	mesh *m;
+	if ((m = CreateMesh(4,3,4,3)) == NULL)
+	{
+		return NULL;
+	}
+	for (i=0;i<4;i++)
+	{
+		InsertVertex(m->vList,verts + 3*i);
+		InsertFace(m->fList,faces + 3*i,3);
+	}
+	return m;
+}
+
+/* sameGCA(): tests two GCAs have the same parameters, graph, rule table, initial
+ * condition, time step and window*/
+int sameGCA(GraphCellularAutomaton *a,GraphCellularAutomaton *b)
+{
+	unsigned int i,t,tn;
+	if (a->params->N != b->params->N || a->params->s != b->params->s || a->params->k != b->params->k 
+		|| a->params->rule != b->params->rule || a->params->rule_type != b->params->rule_type
+		|| a->params->WSIZE != b->params->WSIZE || a->LUT_size != b->LUT_size || a->size != b->size || a->t != b->t
+		|| memcmp((void*)(a->params->graph),(void*)(b->params->graph),(a->params->N)*(a->params->k - 1)*sizeof(unsigned int))
+		|| memcmp((void*)(a->ruleLUT),(void*)(b->ruleLUT),(a->LUT_size)*sizeof(state))
+		|| memcmp((void*)(a->ic),(void*)(b->ic),(a->size)*sizeof(chunk)))
+	{
+		return 0;
+	}
+	tn = (a->t < a->params->WSIZE) ? a->t : a->params->WSIZE - 1;
+	for (t=0;t<=tn;t++)
+	{
+		for (i=0;i<a->params->N;i++)
+		{
+			if (GetCellStatePacked(a,i,t) != GetCellStatePacked(b,i,t))
+			{
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/* sameMesh(): tests two meshes have the same vertices and faces*/
+int sameMesh(mesh *a,mesh *b)
+{
+	return (a != NULL && b != NULL && a->vList->numVerts == b->vList->numVerts && a->vList->dim == b->vList->dim
+		&& a->fList->numFaces == b->fList->numFaces && a->fList->maxVerts == b->fList->maxVerts
+		&& !memcmp((void*)(a->vList->verts),(void*)(b->vList->verts),(a->vList->numVerts)*(a->vList->dim)*sizeof(float))
+		&& !memcmp((void*)(a->fList->faces),(void*)(b->fList->faces),(a->fList->numFaces)*(a->fList->maxVerts)*sizeof(int))
+		&& !memcmp((void*)(a->fList->faceTypes),(void*)(b->fList->faceTypes),(a->fList->numFaces)*sizeof(unsigned char)));
+}
+
+/* checkContainer(): a GCA part way through its evolution and its mesh must load 
+ * back from a binary container as they were saved, and a container with a rule
+ * table entry out of range must be rejected*/
+int checkContainer(void)
+{
+	unsigned int t,fails;
+	state bad;
+	FILE *fp;
+	GCALab_GCAHeader hdr;
+	GraphCellularAutomaton *ECA,*GCA;
+	mesh *m,*m2;
+
+	fails = 0;
+	ECA = CreateECA(40,3,110,32);
+	m = tetraMesh();
+	SetCAIC(ECA,NULL,NOISE_IC_TYPE);
+	ResetCA(ECA);
+	for (t=0;t<50;t++)
+	{
+		CANextStep(ECA);
+	}
+	GCA = NULL;
+	m2 = NULL;
+	if (m == NULL || GCALab_fio_saveCABin("check_container.gca",ECA,m) != WRITE_SUCCESS
+		|| GCALab_fio_loadCA("check_container.gca",&GCA,&m2) != READ_SUCCESS)
+	{
+		printf("saveCABin: container could not be written or read\n");
+		fails++;
+	}
+	else if (!sameGCA(ECA,GCA) || !sameMesh(m,m2))
+	{
+		printf("loadCA: container differs from the saved GCA\n");
+		fails++;
+	}
+	FreeGCA(GCA);
+	FreeMesh(m2);
+	GCA = NULL;
+	m2 = NULL;
+
+	/*the first rule table entry becomes the number of states*/
+	bad = ECA->params->s;
+	if ((fp = fopen("check_container.gca","r+b")) == NULL || fread((void*)&hdr,sizeof(GCALab_GCAHeader),1,fp) != 1
+		|| fseek(fp,(long)(hdr.sec[GCALAB_GCA_LUT].offset),SEEK_SET) || fwrite((void*)&bad,sizeof(state),1,fp) != 1)
+	{
+		printf("checkContainer: could not corrupt the container\n");
+		fails++;
+	}
+	else
+	{
+		fclose(fp);
+		fp = NULL;
+		if (GCALab_fio_loadCA("check_container.gca",&GCA,&m2) == READ_SUCCESS || GCA != NULL)
+		{
+			printf("loadCA: corrupt rule table accepted\n");
+			fails++;
+		}
+	}
+	if (fp != NULL)
+	{
+		fclose(fp);
+	}
+	remove("check_container.gca");
+	FreeGCA(GCA);
+	FreeMesh(m2);
+	FreeMesh(m);
+	FreeGCA(ECA);
+	return fails;
+}
+
+/* readFile(): reads a whole file, release it with free()*/
+char *readFile(char *filename,size_t *len)
+{
+	FILE *fp;
+	char *buf;
+	long n;
+	buf = NULL;
+	if ((fp = fopen(filename,"rb")) == NULL)
+	{
+		return NULL;
+	}
+	if (!fseek(fp,0,SEEK_END) && (n = ftell(fp)) >= 0 && !fseek(fp,0,SEEK_SET)
+		&& (buf = (char *)malloc((size_t)n + 1)) != NULL)
+	{
+		*len = fread((void*)buf,1,(size_t)n,fp);
+		buf[*len] = '\0';
+	}
+	fclose(fp);
+	return buf;
+}
+
+/* checkNPY(): arrays exported as .npy must have a numpy 1.0 header describing
+ * their type and shape with the data aligned after it, raw files must hold the
+ * data only, and the JSON description must give where the data is*/
+int checkNPY(void)
+{
+	unsigned char types[5] = {FLOAT32,FLOAT64,UINT8,SINT32,HEX16};
+	char *dtypes[5] = {"f4","f8","u1","i4","u2"};
+	unsigned int sizes[5] = {4,8,1,4,2};
+	unsigned int N = 1001;
+	unsigned int c,i,one,fails;
+	unsigned long long offset,hlen;
+	unsigned char *data;
+	char *buf;
+	char hdr[96];
+	size_t n,len;
+	GCALab_NPYArray arrays[2];
+
+	fails = 0;
+	one = 1;
+	data = (unsigned char *)malloc(N*8);
+	for (i=0;i<N*8;i++)
+	{
+		data[i] = (unsigned char)(i*37);
+	}
+	for (c=0;c<5;c++)
+	{
+		n = (size_t)N*sizes[c];
+		buf = NULL;
+		if (GCALab_fio_saveNPY("check_npy.npy",(void*)data,N,types[c],0,&offset) != WRITE_SUCCESS
+			|| (buf = readFile("check_npy.npy",&len)) == NULL || len < 10)
+		{
+			printf("saveNPY: %s could not be written\n",dtypes[c]);
+			fails++;
+			free(buf);
+			continue;
+		}
+		hlen = (unsigned char)buf[8] | ((unsigned long long)(unsigned char)buf[9] << 8);
+		sprintf(hdr,"{'descr': '%c%s', 'fortran_order': False, 'shape': (%u,), }",
+			(sizes[c] == 1) ? '|' : ((*(unsigned char *)&one) ? '<' : '>'),dtypes[c],N);
+		if (memcmp(buf,"\x93NUMPY\x01\x00",8) || offset != 10 + hlen || offset % GCALAB_NPY_ALIGN != 0 
+			|| len != offset + n || strncmp(buf + 10,hdr,strlen(hdr)) || buf[offset-1] != '\n'
+			|| memcmp(buf + offset,(void*)data,n))
+		{
+			printf("saveNPY: %s file is not as expected\n",dtypes[c]);
+			fails++;
+		}
+		free(buf);
+		buf = NULL;
+		if (GCALab_fio_saveNPY("check_npy.raw",(void*)data,N,types[c],1,&offset) != WRITE_SUCCESS
+			|| (buf = readFile("check_npy.raw",&len)) == NULL || offset != 0 || len != n || memcmp(buf,(void*)data,n))
+		{
+			printf("saveNPY: %s raw file is not as expected\n",dtypes[c]);
+			fails++;
+		}
+		free(buf);
+	}
+
+	arrays[0].file = "./check_npy.npy";
+	arrays[0].name = "a\"b";
+	arrays[0].id = 3;
+	arrays[0].N = N;
+	arrays[0].type = HEX16;
+	arrays[0].raw = 0;
+	arrays[0].offset = 128;
+	arrays[1] = arrays[0];
+	arrays[1].name = "c";
+	arrays[1].id = 4;
+	buf = NULL;
+	if (GCALab_fio_saveNPYMeta("check_npy.json",arrays,2) != WRITE_SUCCESS || (buf = readFile("check_npy.json",&len)) == NULL
+		|| !strstr(buf,"\"format\": \"npy\"") || !strstr(buf,"{\"id\": 3, \"name\": \"a\\\"b\", \"type\": \"HEX16\"")
+		|| !strstr(buf,"\"shape\": [1001], \"file\": \"check_npy.npy\", \"offset\": 128}") || !strstr(buf,"{\"id\": 4, \"name\": \"c\""))
+	{
+		printf("saveNPYMeta: description is not as expected\n");
+		fails++;
+	}
+	free(buf);
+	remove("check_npy.npy");
+	remove("check_npy.raw");
+	remove("check_npy.json");
+	free(data);
+	return fails;
+}
+
+/* testChecks(): runs the self checks, returns non-zero if any fail*/
+/* checkSnapshot(): a workspace with GCAs, a small and a spilled result must 
+ * restore from a snapshot as it was, and a snapshot with an entry of unknown 
+ * kind must be rejected without leaving a workspace behind*/
+int checkSnapshot(void)
+{
+	GCALab_SnapHeader hdr;
+	GCALab_SnapEntry ent;
+	GCALab_WS *ws,*ws2;
+	GCALabOutput *a,*b;
+	GraphCellularAutomaton *ECA;
+	unsigned char ws_id,ws2_id,bad_id;
+	unsigned int t,i,numWS,fails;
+	size_t len;
+	char *buf;
+	FILE *fp;
+
+	if (GCALab_NewWorkSpace(4,1) != GCALAB_SUCCESS)
+	{
+		printf("NewWorkSpace: failed\n");
+		return 1;
+	}
+	fails = 0;
+	ws_id = (unsigned char)(GCALab_numWS - 1);
+	ws = WS(ws_id);
+	ECA = CreateECA(40,3,110,32);
+	SetCAIC(ECA,NULL,NOISE_IC_TYPE);
+	ResetCA(ECA);
+	for (t=0;t<50;t++)
+	{
+		CANextStep(ECA);
+	}
+	GCALab_LockWS(ws_id);
+	ws->GCAList[0] = ECA;
+	ws->GCAGeometry[0] = tetraMesh();
+	ws->GCARecorder[0] = NULL;
+	ws->GCAList[1] = CreateECA(12,3,30,16);
+	ws->GCAGeometry[1] = NULL;
+	ws->GCARecorder[1] = NULL;
+	ws->numGCA = 2;
+	if (GCALab_AddResult(&(ws->results),newResult(10,1)) != GCALAB_SUCCESS
+		|| GCALab_AddResult(&(ws->results),newResult(GCALAB_SPILL_THRESHOLD/sizeof(float) + 100,2)) != GCALAB_SUCCESS)
+	{
+		printf("AddResult: failed\n");
+		fails++;
+	}
+	GCALab_UnLockWS(ws_id);
+
+	if (GCALab_SnapshotWS(ws_id,"check_snapshot.snap",1) != GCALAB_SUCCESS
+		|| GCALab_RestoreWS("check_snapshot.snap",&ws2_id) != GCALAB_SUCCESS)
+	{
+		printf("SnapshotWS: snapshot could not be written or restored\n");
+		remove("check_snapshot.snap");
+		return fails + 1;
+	}
+	ws2 = WS(ws2_id);
+	GCALab_LockWS(ws2_id);
+	if (ws2->numGCA != ws->numGCA || ws2->maxGCA != ws->maxGCA || ws2->results.num != ws->results.num)
+	{
+		printf("RestoreWS: %d GCAs %u results (%d GCAs %u results)\n",ws2->numGCA,ws2->results.num,
+			ws->numGCA,ws->results.num);
+		fails++;
+	}
+	else
+	{
+		if (!sameGCA(ws->GCAList[0],ws2->GCAList[0]) || !sameGCA(ws->GCAList[1],ws2->GCAList[1])
+			|| !sameMesh(ws->GCAGeometry[0],ws2->GCAGeometry[0]) || ws2->GCAGeometry[1] != NULL)
+		{
+			printf("RestoreWS: GCAs differ from the snapshot\n");
+			fails++;
+		}
+		for (i=0;i<ws->results.num;i++)
+		{
+			a = GCALab_GetResult(&(ws->results),i);
+			b = GCALab_GetResult(&(ws2->results),i);
+			if (a->type != b->type || a->datalen != b->datalen || strcmp(a->id,b->id)
+				|| memcmp(a->data,b->data,(a->datalen)*sizeof(float)))
+			{
+				printf("RestoreWS: result %u differs from the snapshot\n",i);
+				fails++;
+			}
+		}
+	}
+	GCALab_UnLockWS(ws2_id);
+
+	/*the last index entry becomes a kind that does not exist*/
+	numWS = GCALab_numWS;
+	if ((buf = readFile("check_snapshot.snap",&len)) == NULL || (fp = fopen("check_snapshot_bad.snap","wb")) == NULL)
+	{
+		printf("checkSnapshot: could not copy the snapshot\n");
+		free(buf);
+		fails++;
+	}
+	else
+	{
+		memcpy((void*)&hdr,(void*)buf,sizeof(GCALab_SnapHeader));
+		memcpy((void*)&ent,(void*)(buf + hdr.index + (hdr.nentries - 1)*sizeof(GCALab_SnapEntry)),sizeof(GCALab_SnapEntry));
+		ent.kind = 99;
+		memcpy((void*)(buf + hdr.index + (hdr.nentries - 1)*sizeof(GCALab_SnapEntry)),(void*)&ent,sizeof(GCALab_SnapEntry));
+		fwrite((void*)buf,1,len,fp);
+		fclose(fp);
+		free(buf);
+		if (GCALab_RestoreWS("check_snapshot_bad.snap",&bad_id) == GCALAB_SUCCESS || GCALab_numWS != numWS)
+		{
+			printf("RestoreWS: corrupt snapshot accepted or its workspace kept\n");
+			fails++;
+		}
+	}
+	remove("check_snapshot_bad.snap");
+	remove("check_snapshot.snap");
+	return fails;
+}
+
+/* writeFile(): writes len bytes to a file*/
+int writeFile(char *filename,void *buf,size_t len)
+{
+	FILE *fp;
+	size_t n;
+	if ((fp = fopen(filename,"wb")) == NULL)
+	{
+		return 0;
+	}
+	n = fwrite(buf,1,len,fp);
+	fclose(fp);
+	return (n == len);
+}
+
+/* checkEdges(): a text edge list with comments, repeated edges, a self loop and
+ * no final newline, and the same edges in binary, must give the same graph with
+ * any number of threads, and a malformed edge must be rejected*/
+int checkEdges(void)
+{
+	char text[] = "# a small graph\n% with comments\n0 1\n1 0\n1 2 7.5\n2 3\n3 3\n0 3\n0 1\n4\t2\n5 0";
+	unsigned int edges[18] = {0,1, 1,0, 1,2, 2,3, 3,3, 0,3, 0,1, 4,2, 5,0};
+	unsigned int expect[18] = {1,3,5, 0,2,0xFFFFFFFF, 1,3,4, 0,2,0xFFFFFFFF, 2,0xFFFFFFFF,0xFFFFFFFF, 0,0xFFFFFFFF,0xFFFFFFFF};
+	char *files[2] = {"check_edges.txt","check_edges.bin"};
+	unsigned int nthreads[3] = {1,2,4};
+	unsigned int *graph;
+	unsigned int i,j,N,fails;
+	unsigned char k;
+
+	fails = 0;
+	if (!writeFile(files[0],(void*)text,strlen(text)) || !writeFile(files[1],(void*)edges,sizeof(edges)))
+	{
+		printf("checkEdges: could not write the edge lists\n");
+		remove(files[0]);
+		return 1;
+	}
+	for (i=0;i<2;i++)
+	{
+		for (j=0;j<3;j++)
+		{
+			graph = NULL;
+			if (GCALab_ImportEdges(files[i],nthreads[j],&graph,&N,&k) != GCALAB_SUCCESS)
+			{
+				printf("ImportEdges: %s with %u threads failed\n",files[i],nthreads[j]);
+				fails++;
+			}
+			else if (N != 6 || k != 4 || memcmp((void*)graph,(void*)expect,sizeof(expect)))
+			{
+				printf("ImportEdges: %s with %u threads gives N = %u k = %u or a different graph\n",
+					files[i],nthreads[j],N,(unsigned int)k);
+				fails++;
+			}
+			free(graph);
+		}
+	}
+
+	strcpy(text,"0 1\n1 x\n2 3\n");
+	graph = NULL;
+	if (!writeFile(files[0],(void*)text,strlen(text)))
+	{
+		printf("checkEdges: could not write the edge list\n");
+		fails++;
+	}
+	else if (GCALab_ImportEdges(files[0],1,&graph,&N,&k) == GCALAB_SUCCESS || graph != NULL)
+	{
+		printf("ImportEdges: malformed edge accepted\n");
+		fails++;
+	}
+	free(graph);
+	remove(files[0]);
+	remove(files[1]);
+	return fails;
+}
+
+int testChecks(void)
+{
+	unsigned int fails;
+	fails = checkSampler();
+	fails += checkShards();
+	fails += checkQueue();
+	fails += checkResults();
+	fails += checkContainer();
+	fails += checkNPY();
+	fails += checkSnapshot();
+	fails += checkEdges();
+	printf("GCALab checks: %s\n",(fails == 0) ? "passed" : "FAILED");
+	return (fails != 0);
+}
+
+int main(int argc, char **argv)
+{
+	char *args[4] = {"Test","-i","-w","4"};
+	GCALab_CL_Options *opts;
+
+	if (argc == 2 && !strcmp(argv[1],"-check"))
+	{
+		if (GCALab_Init(4,args,&opts) != GCALAB_SUCCESS)
+		{
+			printf("GCALab_Init: failed\n");
+			return 1;
+		}
+		free(opts);
+		return testChecks();
+	}
+	printf("usage: %s -check\n",argv[0]);
+	return 1;
+}
@@ -1,5 +1,6 @@
 
 
+#include <string.h>
 #include"BitMapFile.h"
 
 BMPFILE* CreateBMPFILE(char* fileName)
@@ -23,6 +24,10 @@ BMPFILE* CreateBMPFILE(char* fileName)
 		bmpfile->fileName = (char*)malloc(i);
 		for (j=0;j<i;j++)
 			bmpfile->fileName[j] = fileName[j]; 
+		bmpfile->bmpFileHeader = NULL;
+		bmpfile->bmpInfoHeader = NULL;
+		bmpfile->bmpPalette = NULL;
+		bmpfile->imageData = NULL;
 		return bmpfile;
 	}
 }
@@ -57,6 +62,7 @@ BMPFILE* CreateBMPFILE_FromImage(char* fileName,BMPImage* image)
 		
 		bmpfile->bmpFileHeader = (BMPFILEHEADER*)malloc(sizeof(BMPFILEHEADER));
 		bmpfile->bmpInfoHeader = (BMPINFOHEADER*)malloc(sizeof(BMPINFOHEADER));
+		bmpfile->bmpPalette = NULL;
 
 		/*now fille the headers*/
 		bmpfile->bmpFileHeader->type[0] = 'B';
@@ -98,6 +104,77 @@ BMPFILE* CreateBMPFILE_FromImage(char* fileName,BMPImage* image)
 	}
 }
 
+/* Creates a palettised bitmap of colorDepth 1, 4 or 8 bits per pixel, the image
+ * data is not held in memory but written a row at a time with BMP_WriteRow().
+ * The palette is copied.
+ */
+BMPFILE* CreateBMPFILE_Indexed(char* fileName,uint32_t width,uint32_t height,uint16_t colorDepth,PALETTE* palette)
+{
+	BMPFILE* bmpfile;
+	unsigned long int fhSize, ihSize, pSize;
+	if (colorDepth != 1 && colorDepth != 4 && colorDepth != 8)
+	{
+		return NULL;
+	}
+	if (palette->size <= 0 || palette->size > (1 << colorDepth))
+	{
+		return NULL;
+	}
+	bmpfile = CreateBMPFILE(fileName);
+	if (!bmpfile)
+	{
+		return NULL;
+	}
+	fhSize = 14;
+	ihSize = 40;
+	pSize = 4*(palette->size);
+	
+	/*Allocate memory for headers and palette*/
+	bmpfile->bmpFileHeader = (BMPFILEHEADER*)malloc(sizeof(BMPFILEHEADER));
+	bmpfile->bmpInfoHeader = (BMPINFOHEADER*)malloc(sizeof(BMPINFOHEADER));
+	bmpfile->bmpPalette = (PALETTE*)malloc(sizeof(PALETTE));
+	if (!(bmpfile->bmpFileHeader) || !(bmpfile->bmpInfoHeader) || !(bmpfile->bmpPalette))
+	{
+		DestroyBMPFILE(bmpfile);
+		return NULL;
+	}
+	bmpfile->bmpPalette->size = palette->size;
+	bmpfile->bmpPalette->colours = (uint32_t*)malloc(pSize);
+	if (!(bmpfile->bmpPalette->colours))
+	{
+		DestroyBMPFILE(bmpfile);
+		return NULL;
+	}
+	memcpy((void*)(bmpfile->bmpPalette->colours),(void*)(palette->colours),pSize);
+	
+	/*now fill the headers*/
+	bmpfile->bmpFileHeader->type[0] = 'B';
+	bmpfile->bmpFileHeader->type[1] = 'M';
+	bmpfile->bmpFileHeader->reserved1 = 0x1337;
+	bmpfile->bmpFileHeader->reserved2 = 0xC0DE;
+	bmpfile->bmpFileHeader->offset = fhSize + ihSize + pSize;
+	
+	bmpfile->bmpInfoHeader->size = ihSize;
+	bmpfile->bmpInfoHeader->width = width;
+	bmpfile->bmpInfoHeader->height = height;
+	bmpfile->bmpInfoHeader->planes = (uint16_t)1;
+	bmpfile->bmpInfoHeader->colorDepth = colorDepth;
+	bmpfile->bmpInfoHeader->compression = (uint32_t)BI_RGB;
+	bmpfile->bmpInfoHeader->imageSize = BMP_RowSize(bmpfile)*height;
+	bmpfile->bmpInfoHeader->hRes = (uint32_t)2835;
+	bmpfile->bmpInfoHeader->wRes = (uint32_t)2835;
+	bmpfile->bmpInfoHeader->paletteSize = (uint32_t)(palette->size);
+	bmpfile->bmpInfoHeader->numImportantColours = (uint32_t)0;
+	bmpfile->bmpFileHeader->fileSize = bmpfile->bmpFileHeader->offset + bmpfile->bmpInfoHeader->imageSize;
+	return bmpfile;
+}
+
+/* The number of bytes in a row of pixel data, rows are padded to 4 bytes*/
+uint32_t BMP_RowSize(BMPFILE* bmp_fp)
+{
+	return (((bmp_fp->bmpInfoHeader->width)*(bmp_fp->bmpInfoHeader->colorDepth) + 31)/32)*4;
+}
+
 ERROR BMP_OpenBitMap(BMPFILE* bmp_fp, char* option)
 {
 	/*Open bmp file handle*/
@@ -128,6 +205,11 @@ ERROR DestroyBMPFILE(BMPFILE* bmp_fp)
 	free(bmp_fp->bmpFileHeader);
 	free(bmp_fp->bmpInfoHeader);
 	free(bmp_fp->imageData);
+	if (bmp_fp->bmpPalette)
+	{
+		free(bmp_fp->bmpPalette->colours);
+		free(bmp_fp->bmpPalette);
+	}
 	free(bmp_fp);
 	return NO_ERRORS;
 }
@@ -15,6 +15,8 @@
 
 BMPFILE* CreateBMPFILE(char*);
 BMPFILE* CreateBMPFILE_FromImage(char*,BMPImage*);
+BMPFILE* CreateBMPFILE_Indexed(char*,uint32_t,uint32_t,uint16_t,PALETTE*);
+uint32_t BMP_RowSize(BMPFILE*);
 ERROR DestroyBMPFILE(BMPFILE*);
 ERROR BMP_OpenBitMap(BMPFILE*,char*);
 ERROR BMP_CloseBitMap(BMPFILE*);
@@ -30,7 +30,7 @@ ERROR BMP_ReadHeaders(BMPFILE* bmp_fp)
 	{
 		return FILE_READ_ERROR;
 	}
-	if(!(fread((void*)&(bmp_fp->bmpFileHeader->offset),2,1,bmp_fp->bmpfile_fp)==1))
+	if(!(fread((void*)&(bmp_fp->bmpFileHeader->offset),4,1,bmp_fp->bmpfile_fp)==1))
 	{
 		return FILE_READ_ERROR;
 	}
@@ -86,6 +86,34 @@ ERROR BMP_ReadHeaders(BMPFILE* bmp_fp)
 
 ERROR BMP_ReadColourPalette(BMPFILE* bmp_fp)
 {
+	uint32_t n;
+	/*only images of 8 bits per pixel or less have a palette*/
+	if (bmp_fp->bmpInfoHeader->colorDepth > 8)
+	{
+		return NO_ERRORS;
+	}
+	n = bmp_fp->bmpInfoHeader->paletteSize;
+	if (n == 0 || n > (1u << bmp_fp->bmpInfoHeader->colorDepth))
+	{
+		n = 1u << bmp_fp->bmpInfoHeader->colorDepth;
+	}
+	bmp_fp->bmpPalette = (PALETTE*)malloc(sizeof(PALETTE));
+	if (!(bmp_fp->bmpPalette))
+	{
+		return MEMORY_ERROR;
+	}
+	bmp_fp->bmpPalette->size = (int)n;
+	bmp_fp->bmpPalette->colours = (uint32_t*)calloc(n,sizeof(uint32_t));
+	if (!(bmp_fp->bmpPalette->colours))
+	{
+		return MEMORY_ERROR;
+	}
+	/*the palette follows the info header*/
+	fseek(bmp_fp->bmpfile_fp,14 + bmp_fp->bmpInfoHeader->size,SEEK_SET);
+	if (!(fread((void*)(bmp_fp->bmpPalette->colours),4*n,1,bmp_fp->bmpfile_fp)==1))
+	{
+		return FILE_READ_ERROR;
+	}
 	return NO_ERRORS;
 }
 
@@ -111,6 +139,11 @@ BMPImage ReadBMP(char* fileName)
 	BMPFILE* bmpfile = CreateBMPFILE(fileName);
 	BMP_OpenBitMap(bmpfile,"rb");
 	BMP_ReadHeaders(bmpfile);
+	BMP_ReadColourPalette(bmpfile);
+	if (bmpfile->bmpInfoHeader->imageSize == 0)
+	{
+		bmpfile->bmpInfoHeader->imageSize = BMP_RowSize(bmpfile)*(bmpfile->bmpInfoHeader->height);
+	}
 	
 	BMP_ReadImageData(bmpfile);
 	
@@ -127,6 +160,29 @@ BMPImage ReadBMP(char* fileName)
 	bmpImage.width = width;
 	bmpImage.height = height;
 	
+	/*palettised rows are padded, pixels are packed from the high bits*/
+	if (bmpfile->bmpPalette)
+	{
+		uint32_t depth,stride,idx,colour;
+		depth = bmpfile->bmpInfoHeader->colorDepth;
+		stride = BMP_RowSize(bmpfile);
+		for (row=0;row<height;row++)
+		{
+			for (col=0;col<width;col++)
+			{
+				i = row*stride + (col*depth)/8;
+				idx = (bmpfile->imageData[i] >> (8 - depth - (col*depth)%8)) & ((1 << depth) - 1);
+				colour = (idx < (uint32_t)(bmpfile->bmpPalette->size)) ? bmpfile->bmpPalette->colours[idx] : 0;
+				bmpImage.RGB[row][col*3] = (unsigned char)(colour >> 16);
+				bmpImage.RGB[row][col*3+1] = (unsigned char)(colour >> 8);
+				bmpImage.RGB[row][col*3+2] = (unsigned char)colour;
+			}
+		}
+		BMP_CloseBitMap(bmpfile);
+		DestroyBMPFILE(bmpfile);
+		return bmpImage;
+	}
+	
 	/*copy data*/
 	for (row=0;row<height;row++)
 	{
@@ -79,6 +79,15 @@ ERROR BMP_WriteHeaders(BMPFILE* bmpfile)
 
 ERROR BMP_WriteColourPalette(BMPFILE* bmpfile)
 {
+	/*entries are stored B,G,R,0 i.e., 0x00RRGGBB little endian*/
+	if (!(bmpfile->bmpPalette))
+	{
+		return NO_ERRORS;
+	}
+	if (!(fwrite((void*)(bmpfile->bmpPalette->colours),4*(bmpfile->bmpPalette->size),1,bmpfile->bmpfile_fp)==1))
+	{
+		return FILE_WRITE_ERROR;
+	}
 	return NO_ERRORS;
 }
 
@@ -93,6 +102,26 @@ ERROR BMP_WriteImageData(BMPFILE* bmpfile)
  
 
 
+/* Writes one row of pixel data, BMP_RowSize() bytes including the padding. Rows 
+ * are numbered bottom to top and can be written in any order.
+ */
+ERROR BMP_WriteRow(BMPFILE* bmpfile,uint32_t row,uint8_t* data)
+{
+	long pos;
+	uint32_t rowSize;
+	rowSize = BMP_RowSize(bmpfile);
+	pos = (long)(bmpfile->bmpFileHeader->offset) + (long)row*(long)rowSize;
+	if (ftell(bmpfile->bmpfile_fp) != pos && fseek(bmpfile->bmpfile_fp,pos,SEEK_SET))
+	{
+		return FILE_WRITE_ERROR;
+	}
+	if (!(fwrite((void*)data,rowSize,1,bmpfile->bmpfile_fp)==1))
+	{
+		return FILE_WRITE_ERROR;
+	}
+	return NO_ERRORS;
+}
+
 ERROR WriteBMP(char* fileName,BMPImage* image)
 {
 	ERROR error;
@@ -16,6 +16,7 @@
 ERROR BMP_WriteHeaders(BMPFILE*);
 ERROR BMP_WriteColourPalette(BMPFILE*);
 ERROR BMP_WriteImageData(BMPFILE*);
+ERROR BMP_WriteRow(BMPFILE*,uint32_t,uint8_t*);
 
 /*higher level writer user friendly*/
 ERROR WriteBMP(char*,BMPImage*);
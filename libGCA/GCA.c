@@ -101,6 +101,51 @@
  *                                  were being included multi[le times)
  *                             iv. fix bug in GetNeighbourhood_config when handling variable 
  *                                 neighbourhood sizes.
+ *       v 0.20 (19/10/2026) - i. Added AttTransLength(), a memoised single pass over a range of
+ *                                configurations for both attractor and transient lengths.
+ *                                AttLength() and TransLength() use it for ranges.
+ *
+ *       v 0.21 (19/10/2026) - i. Added per thread work counters, GCA_SetCounters(), 
+ *                                GCA_GetCounters() and GCA_AddCounters().
+ *
+ *       v 0.22 (19/10/2026) - i. Added per thread progress callbacks, GCA_SetProgress(),
+ *                                GCA_GetProgress() and GCA_ReportProgress(). AttLength(), 
+ *                                TransLength(), AttTransLength(), G_density(), SumCAImages()
+ *                                and GetFlags() report progress and can be stopped early.
+ *
+ *       v 0.23 (19/10/2026) - i. Added MapGCA(), a GCA whose graph and rule table are borrowed
+ *                                from a file mapping it releases when freed.
+ *
+ *       v 0.24 (19/10/2026) - i. Added CompressWindow(), long windows can keep older rows as
+ *                                XOR deltas with periodic keyframes. 
+ *                             ii. IsAttCyc() now returns the full cycle length.
+ *
+ *       v 0.25 (19/10/2026) - i. Added OutOfCoreGCA(), the rows (and graph) of a GCA can be
+ *                                moved to a shared file mapping. CANextStep() updates such
+ *                                a GCA in blocks with access hints.
+ *
+ *       v 0.26 (19/10/2026) - i. Fixed GetNeighbourhood_config() and its external version
+ *                                reading past the neighbours of cells with fewer than 
+ *                                (k-1)/2 of them, and the external version ignoring
+ *                                missing neighbours altogether.
+ *
+ *       v 0.27 (19/10/2026) - i. Added CloneGCAWindow(), for evolving a GCA with a short
+ *                                window on a wider one.
+ *                             ii. CloneGCA() frees a partial clone when it fails.
+ *                             iii. BuildRuleLUT() fails on an unknown rule type.
+ *                             iv. SetCAIC() clears the bits beyond the last cell for every
+ *                                 IC type, not only noise, so a compressed window finds
+ *                                 the same cycles as a dense one.
+ *                             v. AttTransLength() could stop early at a configuration whose
+ *                                cycle ran back through the current path, as it added their
+ *                                lengths, so it now keeps the larger of the two.
+ *                             vi. The AttTransLength() memo table is sized in size_t and
+ *                                 fails rather than wrapping when it can not grow.
+ *                             vii. IsRingTopology() rejects an even k, where reflection would
+ *                                  move the cell out of the middle of its neighbourhood.
+ *                             viii. A compressed window row whose delta can not be allocated
+ *                                   is kept whole in a spare row, or else it and older rows
+ *                                   are marked lost, instead of reading back as the newer row.
  *
  * Description: Implementation of Graph Cellular Automata Libarary
  *
@@ -137,8 +182,19 @@
  * =============================================================================
  */
 
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include "GCA.h"
 
+/*counters of the calling thread (see GCA_SetCounters())*/
+static pthread_key_t GCA_CountersKey;
+static pthread_once_t GCA_CountersOnce = PTHREAD_ONCE_INIT;
+
+/*progress callback of the calling thread (see GCA_SetProgress())*/
+static pthread_key_t GCA_ProgressKey;
+static pthread_once_t GCA_ProgressOnce = PTHREAD_ONCE_INIT;
+
 /** 
  * @brief Creates a topology array from a mesh. 
  * @details If mesh is NULL then a regular 1-dimensional genus-1 topology of \a N cells 
@@ -384,6 +440,13 @@ GraphCellularAutomaton *CreateGCA(CellularAutomatonParameters *params)
 	
 	GCA->log2s = 0;
 	GCA->params = params;
+	GCA->rng = NULL;
+	GCA->shared = 0;
+	GCA->map = NULL;
+	GCA->maplen = 0;
+	GCA->rowmap = NULL;
+	GCA->rowmaplen = 0;
+	GCA->win = NULL;
 	/* calculate the number of bits per symbol (needed alot later)*/
 	{ 
 		register state s; s = params->s;
@@ -418,24 +481,57 @@ GraphCellularAutomaton *CreateGCA(CellularAutomatonParameters *params)
 		return NULL;
 	}
 	/*create the rule table*/
-	switch(params->rule_type)
+	GCA->LUT_size = pow(params->s,params->k);
+	GCA->ruleLUT = (state *)malloc((GCA->LUT_size)*sizeof(state));
+	if (!(GCA->ruleLUT))
+	{
+		return NULL;
+	}
+	if (!BuildRuleLUT(GCA,GCA->ruleLUT,params->rule_type,params->rule))
+	{
+		/*the caller still owns params*/
+		for (i=0;i<(params->WSIZE);i++)
+		{
+			free(GCA->st_pattern[i]);
+		}
+		free(GCA->st_pattern);
+		free(GCA->ic);
+		free(GCA->ruleLUT);
+		free(GCA);
+		return NULL;
+	}
+	
+	return GCA;
+}
+
+/**
+ * @brief Builds the state transition look-up table for a rule.
+ *
+ * @details Only the number of states, neighbourhood size and the rule are used, so 
+ * the same GCA can be re-used to build the tables of many rules.
+ *
+ * @param GCA A Graph Cellular Automaton (defines \a s and \a k).
+ * @param LUT Memory for the table, of size \a GCA->LUT_size.
+ * @param rule_type The type of rule that the rule code represents.
+ * @param rule The rule code.
+ *
+ * @retval 1 The table was built.
+ * @retval 0 The rule is not valid for this GCA.
+ */
+unsigned char BuildRuleLUT(GraphCellularAutomaton *GCA,state *LUT,unsigned char rule_type,unsigned int rule)
+{
+	unsigned int i,j;
+	switch(rule_type)
 	{
 		case THRESH_RULE_TYPE: /*for now based on a single state*/
 		{	
 			state ref;
 			unsigned char thresh;
-			GCA->LUT_size = pow(params->s,params->k);
-			GCA->ruleLUT = (state *)malloc((GCA->LUT_size)*sizeof(state));
-			
-			if (!(GCA->ruleLUT))
-			{
-				return NULL;
-			}
 			/* here the rule is composed of 4 states-- three states <,=,>, the state of
 			 * interest, then a 8-bit integer representing the threshold
 			 */ 
-			ref = (state)((GCA->params->rule >> 3*(GCA->log2s)) & ((0x1 << (GCA->log2s)) - 1));
-			thresh = (unsigned char)((GCA->params->rule >> 4*(GCA->log2s)) & 0xFF); 
+			ref = (state)((rule >> 3*(GCA->log2s)) & ((0x1 << (GCA->log2s)) - 1));
+			thresh = (unsigned char)((rule >> 4*(GCA->log2s)) & 0xFF); 
 			for (i=0;i<GCA->LUT_size;i++)
 			{
 				register unsigned char sum;
@@ -460,25 +556,17 @@ GraphCellularAutomaton *CreateGCA(CellularAutomatonParameters *params)
 				{
 					ii = 2;
 				}
-				GCA->ruleLUT[i] = (state)((GCA->params->rule >> ii*(GCA->log2s)) & ((0x1 << (GCA->log2s)) - 1));
+				LUT[i] = (state)((rule >> ii*(GCA->log2s)) & ((0x1 << (GCA->log2s)) - 1));
 			}
 		}
 			break;
 		case COUNT_RULE_TYPE:
 		{
 			state ref;
-			GCA->LUT_size = pow(params->s,params->k);
-			GCA->ruleLUT = (state *)malloc((GCA->LUT_size)*sizeof(state));
-		
-			if (!(GCA->ruleLUT))
-			{
-				return NULL;
-			}
-			
 			/* here the rule is composed of k+1 states-- the state of interest, 
 			 * follow by k state changes for each count.
 			 */ 
-			ref = (state)(GCA->params->rule & ((0x1 << (GCA->log2s)) - 1));
+			ref = (state)(rule & ((0x1 << (GCA->log2s)) - 1));
 			for (i=0;i<GCA->LUT_size;i++)
 			{
 				register unsigned char sum;
@@ -499,23 +587,15 @@ GraphCellularAutomaton *CreateGCA(CellularAutomatonParameters *params)
 					}
 				}
 				
-				GCA->ruleLUT[i] = (state)((GCA->params->rule >> (ii+1)*(GCA->log2s)) & ((0x1 << (GCA->log2s)) - 1));
+				LUT[i] = (state)((rule >> (ii+1)*(GCA->log2s)) & ((0x1 << (GCA->log2s)) - 1));
 			}
 		}
 			break;
 		case CODE_RULE_TYPE:/*rule is the Wolfram rule code*/
-			GCA->LUT_size = pow(params->s,params->k);
-			GCA->ruleLUT = (state *)malloc((GCA->LUT_size)*sizeof(state));
-
-			if (!(GCA->ruleLUT))
-			{
-				return NULL;
-			}
-			
 			for (i=0;i<GCA->LUT_size;i++)
 			{
-				GCA->ruleLUT[i] = params->rule >> i*(GCA->log2s);		
-				GCA->ruleLUT[i] &= ((0x1 << (GCA->log2s)) - 1); 
+				LUT[i] = rule >> i*(GCA->log2s);		
+				LUT[i] &= ((0x1 << (GCA->log2s)) - 1); 
 			}
 			break;
 		case LIFE_RULE_TYPE: /*Based on Carter Bay's paper*/
@@ -523,22 +603,14 @@ GraphCellularAutomaton *CreateGCA(CellularAutomatonParameters *params)
 			unsigned int E_l,E_h,F_l,F_h;
 			unsigned int pop,q,r;
 			unsigned int C;
-			GCA->LUT_size = pow(params->s,params->k);
-			GCA->ruleLUT = (state*)malloc((GCA->LUT_size)*sizeof(state));
-
-			if (!(GCA->LUT_size))
-			{
-				return NULL;
-			}
-
 			/*for a life rule we assume only binary CA*/
 			if (GCA->params->s != 2)
 			{
-				return NULL;
+				return 0;
 			}
 
-			r = params->rule % 10;
-			q = params->rule / 10;
+			r = rule % 10;
+			q = rule / 10;
 			F_h = r;
 			r = q % 10;
 			q = q / 10;
@@ -559,109 +631,1295 @@ GraphCellularAutomaton *CreateGCA(CellularAutomatonParameters *params)
 					pop += (i >> j) & 0x1;
 				}
 				pop -= C;
-				GCA->ruleLUT[i] = (((C==1) && ((pop >= E_l) && (pop <= E_h))) || ((C==0) && ((pop >= F_l) && (pop <= F_h))));
+				LUT[i] = (((C==1) && ((pop >= E_l) && (pop <= E_h))) || ((C==0) && ((pop >= F_l) && (pop <= F_h))));
 			}
 		}
 			break;
+		default:
+			return 0;
 	}
 	
-	return GCA;
+	return 1;
 }
 
 /**
- * @brief Creates copy of the given Graph Cellular Automaton.
+ * @brief Changes the rule of a Graph Cellular Automaton.
  *
- * @param GCA The Graph Cellular Automaton to copy.
+ * @details If the parameters or LUT of \a GCA are borrowed (see CloneGCA()), private
+ * copies are made first, the graph is always left shared. This allows a clone to
+ * sweep through rule space without touching the GCA it was cloned from.
  *
- * @returns A GCA identical to the given one.
- * @retval NULL Failed to make a copy of \a GCA.
+ * @param GCA A Graph Cellular Automaton.
+ * @param rule_type The type of rule that the rule code represents.
+ * @param rule The rule code.
+ *
+ * @retval 1 The rule was changed.
+ * @retval 0 Out of memory or the rule is invalid.
  */
-GraphCellularAutomaton *CopyGCA(GraphCellularAutomaton *GCA)
+unsigned char SetCARule(GraphCellularAutomaton *GCA,unsigned char rule_type,unsigned int rule)
 {
-	GraphCellularAutomaton *GCA_cp;
-	int i,j;
-	/*easy case... :) */
-	if (GCA == NULL)
+	if (GCA->shared & GCA_SHARED_PARAMS)
 	{
-		return NULL;
+		CellularAutomatonParameters *params;
+		params = (CellularAutomatonParameters *)malloc(sizeof(CellularAutomatonParameters));
+		if (!params)
+		{
+			return 0;
+		}
+		memcpy((void*)params,(void*)(GCA->params),sizeof(CellularAutomatonParameters));
+		GCA->params = params;
+		GCA->shared &= ~GCA_SHARED_PARAMS;
 	}
-	
-	GCA_cp = (GraphCellularAutomaton *)malloc(sizeof(GraphCellularAutomaton));
-	if (!GCA_cp)
+	if (GCA->shared & GCA_SHARED_LUT)
 	{
-		return NULL;
+		state *LUT;
+		LUT = (state *)malloc((GCA->LUT_size)*sizeof(state));
+		if (!LUT)
+		{
+			return 0;
+		}
+		GCA->ruleLUT = LUT;
+		GCA->shared &= ~GCA_SHARED_LUT;
 	}
-	
-	GCA_cp->params = (CellularAutomatonParameters *)malloc(sizeof(CellularAutomatonParameters));
-	if (!(GCA_cp->params))
+	GCA->params->rule_type = rule_type;
+	GCA->params->rule = rule;
+	return BuildRuleLUT(GCA,GCA->ruleLUT,rule_type,rule);
+}
+
+/**
+ * @brief Tests if the topology is a ring (i.e., that of an ECA).
+ *
+ * @details On a ring the neighbourhood of cell \a i is \a i-r,...,\a i+r in order, so
+ * reflecting the neighbourhood is a symmetry of the topology.
+ *
+ * @param GCA A Graph Cellular Automaton.
+ *
+ * @retval 1 The topology is a ring.
+ * @retval 0 Otherwise.
+ */
+unsigned char IsRingTopology(GraphCellularAutomaton *GCA)
+{
+	unsigned int i,j,N,k_1,r;
+	unsigned int *U_i;
+	N = GCA->params->N;
+	k_1 = GCA->params->k - 1;
+	/*the cell must sit in the middle of its neighbourhood, so the reflection keeps it there*/
+	if (k_1 == 0 || k_1 % 2 != 0)
 	{
-		return NULL;
+		return 0;
+	}
+	r = k_1/2;
+	/*U_i[0..r-1] and U_i[r..k_1-1] cover every neighbour*/
+	for (i=0;i<N;i++)
+	{
+		U_i = GCA->params->graph + i*k_1;
+		for (j=0;j<r;j++)
+		{
+			if (U_i[j] != (i + j - r + N)%N || U_i[j+r] != (i + j + 1)%N)
+			{
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/**
+ * @brief Applies a state permutation and (optionally) a neighbourhood reflection 
+ * to a rule table.
+ */
+static void TransformRuleLUT(GraphCellularAutomaton *GCA,state *LUT,state *out,state *perm,unsigned char reflect)
+{
+	unsigned int n,n_out,p,k,log2s;
+	state mask;
+	k = GCA->params->k;
+	log2s = GCA->log2s;
+	mask = (state)((0x1 << log2s) - 1);
+	for (n=0;n<GCA->LUT_size;n++)
+	{
+		n_out = 0;
+		for (p=0;p<k;p++)
+		{
+			register state d;
+			d = perm[(n >> p*log2s) & mask];
+			n_out |= ((unsigned int)d) << ((reflect) ? (k-1-p) : p)*log2s;
+		}
+		out[n_out] = perm[LUT[n]];
 	}
+}
+
+/**
+ * @brief Computes the canonical representative of a rule's equivalence class.
+ *
+ * @details Rules related by a permutation of the states (e.g., the complement for 
+ * binary CA), and by reflection of the neighbourhood if \a reflect is set, have 
+ * equivalent dynamics. The canonical rule is the lexicographically smallest table in 
+ * the class, so two rules are equivalent iff their canonical tables are equal. All 
+ * state permutations are tried for up to MAX_CANONICAL_STATES states, beyond that
+ * only the reversal of the state order.
+ *
+ * @param GCA A Graph Cellular Automaton.
+ * @param LUT The rule table to canonicalise.
+ * @param canon Output table, of size \a GCA->LUT_size.
+ * @param reflect Non-zero to also consider reflection (only valid on a ring, see IsRingTopology()).
+ *
+ * @retval 1 The canonical table was computed.
+ * @retval 0 Out of memory, or the state encoding is not supported (\a canon = \a LUT).
+ */
+unsigned char CanonicalRuleLUT(GraphCellularAutomaton *GCA,state *LUT,state *canon,unsigned char reflect)
+{
+	state *tmp;
+	state perm[256];
+	unsigned int c[256];
+	unsigned int s,i,r;
 	
-	/*copy parameters*/
-	GCA_cp->params->N = GCA->params->N;
-	GCA_cp->params->WSIZE = GCA->params->WSIZE;
-	GCA_cp->params->rule = GCA->params->rule;
-	GCA_cp->params->s = GCA->params->s;
-	GCA_cp->params->rule_type = GCA->params->rule_type;
-	GCA_cp->params->k = GCA->params->k;
-	GCA_cp->params->graph = (unsigned int *)malloc((GCA->params->N)*(GCA->params->k-1)*sizeof(unsigned int));
-	if (!(GCA_cp->params->graph))
+	s = (unsigned int)GCA->params->s;
+	memcpy((void*)canon,(void*)LUT,(GCA->LUT_size)*sizeof(state));
+	/*tables are indexed by log2s bits per state, other state counts are not packed densely*/
+	if ((0x1u << GCA->log2s) != s)
 	{
-		return NULL;
+		return 0;
 	}
-	for (i=0;i<(GCA->params->N)*(GCA->params->k-1);i++)
+	tmp = (state *)malloc((GCA->LUT_size)*sizeof(state));
+	if (!tmp)
 	{
-		GCA_cp->params->graph[i] = GCA->params->graph[i];
+		return 0;
+	}
+
+	for (i=0;i<s;i++)
+	{
+		perm[i] = (state)i;
+		c[i] = 0;
 	}
 	
-	/*copy the CA now*/
-	GCA_cp->log2s = GCA->log2s;
-	GCA_cp->LUT_size = GCA->LUT_size;
-	GCA_cp->size = GCA->size;
-	GCA_cp->t = GCA->t;
-	GCA_cp->ruleLUT = (state*)malloc((GCA->LUT_size)*sizeof(state));
-	if (!(GCA_cp->ruleLUT))
+	if (s <= MAX_CANONICAL_STATES)
 	{
-		return NULL;
+		/*Heap's algorithm over all permutations of the states*/
+		i = 0;
+		while (1)
+		{
+			for (r=0;r<=(unsigned int)(reflect != 0);r++)
+			{
+				TransformRuleLUT(GCA,LUT,tmp,perm,(unsigned char)r);
+				if (memcmp((void*)tmp,(void*)canon,(GCA->LUT_size)*sizeof(state)) < 0)
+				{
+					memcpy((void*)canon,(void*)tmp,(GCA->LUT_size)*sizeof(state));
+				}
+			}
+			while (i < s && c[i] >= i)
+			{
+				c[i] = 0;
+				i++;
+			}
+			if (i >= s)
+			{
+				break;
+			}
+			{
+				register state t;
+				r = (i % 2) ? c[i] : 0;
+				t = perm[r];
+				perm[r] = perm[i];
+				perm[i] = t;
+			}
+			c[i]++;
+			i = 0;
+		}
 	}
-	for (i=0;i<GCA->LUT_size;i++)
+	else
 	{
-		GCA_cp->ruleLUT[i] = GCA->ruleLUT[i];
+		/*identity and reversed state order only*/
+		for (i=0;i<2;i++)
+		{
+			for (r=0;r<=(unsigned int)(reflect != 0);r++)
+			{
+				TransformRuleLUT(GCA,LUT,tmp,perm,(unsigned char)r);
+				if (memcmp((void*)tmp,(void*)canon,(GCA->LUT_size)*sizeof(state)) < 0)
+				{
+					memcpy((void*)canon,(void*)tmp,(GCA->LUT_size)*sizeof(state));
+				}
+			}
+			for (r=0;r<s;r++)
+			{
+				perm[r] = (state)(s-1-r);
+			}
+		}
 	}
-	GCA_cp->st_pattern = (chunk**)malloc((GCA->params->WSIZE)*sizeof(chunk*));
-	if (!(GCA_cp->st_pattern))
+	free(tmp);
+	return 1;
+}
+
+/**
+ * @brief Hashes a row of the window.
+ */
+static unsigned long long GCA_HashRow(chunk *row,unsigned int size)
+{
+	unsigned long long h;
+	unsigned int i;
+	h = 0x9E3779B97F4A7C15ULL ^ (unsigned long long)size;
+	for (i=0;i<size;i++)
 	{
-		return NULL;
+		h = (h ^ (unsigned long long)row[i])*0xFF51AFD7ED558CCDULL;
+		h ^= h >> 32;
 	}
-	for (i=0;i<GCA->params->WSIZE;i++)
+	return h;
+}
+
+/**
+ * @brief Makes room for \a n chunks (and indices if \a sparse) in a compressed row.
+ * @returns 1 on success, 0 if memory could not be allocated.
+ */
+static unsigned char GCA_ReserveWindowRow(GCA_WindowRow *r,unsigned int n,unsigned char sparse)
+{
+	if (n > r->cap)
 	{
-		GCA_cp->st_pattern[i] = (chunk*)malloc((GCA->size)*sizeof(chunk));
-		if (!(GCA_cp->st_pattern[i]))
+		chunk *data;
+		if (!(data = (chunk *)realloc(r->data,n*sizeof(chunk))))
 		{
-			return NULL;
+			return 0;
 		}
+		r->data = data;
+		r->cap = n;
 	}
-	for (i=0;i<GCA->params->WSIZE;i++)
+	if (sparse && n > r->icap)
 	{
-		for(j=0;j<GCA->size;j++)
+		unsigned int *idx;
+		if (!(idx = (unsigned int *)realloc(r->idx,n*sizeof(unsigned int))))
 		{
-			GCA_cp->st_pattern[i][j] = GCA->st_pattern[i][j];
+			return 0;
 		}
+		r->idx = idx;
+		r->icap = n;
 	}
-	GCA_cp->config = GCA_cp->st_pattern[0];
+	return 1;
+}
 
-	GCA_cp->ic = (chunk*)malloc((GCA->size)*sizeof(chunk));
-	if(!(GCA_cp->ic))
+/**
+ * @brief Pushes the row leaving the dense part of the window into the ring.
+ *
+ * @param row The row leaving the dense rows.
+ * @param newer The row one step newer than \a row.
+ *
+ * @remark If the row or its delta can not be allocated it is stored whole in the
+ * spare row. If that is gone too, the row and every older one are marked lost 
+ * (see GCA_Window), so the window only acts shorter and never reads back wrong rows.
+ */
+static void GCA_PushWindowRow(GraphCellularAutomaton *GCA,chunk *row,chunk *newer)
+{
+	GCA_Window *w;
+	GCA_WindowRow *r;
+	unsigned int i,n,size;
+
+	w = GCA->win;
+	size = GCA->size;
+	if (w->spare == NULL)
+	{
+		w->spare = (chunk *)malloc(size*sizeof(chunk));
+	}
+	r = w->rows + (w->pushed % w->nrows);
+	r->hash = GCA_HashRow(row,size);
+	r->n = 0;
+	r->type = GCA_WINDOW_SPARSE;
+	if (w->pushed % w->keyint == 0)
+	{
+		if (GCA_ReserveWindowRow(r,size,0))
+		{
+			memcpy((void*)(r->data),(void*)row,size*sizeof(chunk));
+			r->n = size;
+			r->type = GCA_WINDOW_KEY;
+		}
+	}
+	else
+	{
+		for (n=0,i=0;i<size;i++)
+		{
+			n += (row[i] != newer[i]);
+		}
+		/*an index costs about as much as a chunk, so dense deltas are stored whole*/
+		if (n > size/2)
+		{
+			if (GCA_ReserveWindowRow(r,size,0))
+			{
+				for (i=0;i<size;i++)
+				{
+					r->data[i] = row[i] ^ newer[i];
+				}
+				r->n = size;
+				r->type = GCA_WINDOW_XOR;
+			}
+		}
+		else if (GCA_ReserveWindowRow(r,n,1))
+		{
+			for (n=0,i=0;i<size;i++)
+			{
+				if (row[i] != newer[i])
+				{
+					r->idx[n] = i;
+					r->data[n++] = row[i] ^ newer[i];
+				}
+			}
+			r->n = n;
+		}
+	}
+	if (r->n == 0 && r->type == GCA_WINDOW_SPARSE && memcmp((void*)row,(void*)newer,size*sizeof(chunk)))
+	{
+		/*out of memory, an empty delta would read back as newer*/
+		if (w->spare != NULL)
+		{
+			free(r->data);
+			r->data = w->spare;
+			r->cap = size;
+			w->spare = NULL;
+			memcpy((void*)(r->data),(void*)row,size*sizeof(chunk));
+			r->n = size;
+			r->type = GCA_WINDOW_KEY;
+		}
+		else
+		{
+			w->lost = w->pushed + 1;
+		}
+	}
+	w->pushed++;
+}
+
+/**
+ * @brief Applies the delta of a compressed row to the next newer row.
+ */
+static void GCA_ApplyWindowRow(GCA_WindowRow *r,chunk *row,unsigned int size)
+{
+	unsigned int i;
+	switch (r->type)
+	{
+		case GCA_WINDOW_KEY:
+			memcpy((void*)row,(void*)(r->data),size*sizeof(chunk));
+			break;
+		case GCA_WINDOW_XOR:
+			for (i=0;i<size;i++)
+			{
+				row[i] ^= r->data[i];
+			}
+			break;
+		default:
+			for (i=0;i<r->n;i++)
+			{
+				row[r->idx[i]] ^= r->data[i];
+			}
+			break;
+	}
+}
+
+/**
+ * @brief Releases a compressed window.
+ */
+static void GCA_FreeWindow(GCA_Window *w)
+{
+	unsigned int i;
+	if (w == NULL)
+	{
+		return;
+	}
+	if (w->rows != NULL)
+	{
+		for (i=0;i<w->nrows;i++)
+		{
+			free(w->rows[i].data);
+			free(w->rows[i].idx);
+		}
+	}
+	for (i=0;i<GCA_WINDOW_CACHE;i++)
+	{
+		free(w->cache[i]);
+	}
+	free(w->rows);
+	free(w->zero);
+	free(w->spare);
+	free(w);
+}
+
+/**
+ * @brief Allocates an empty compressed window for rows of \a size chunks.
+ * @retval NULL if memory could not be allocated.
+ */
+static GCA_Window *GCA_AllocWindow(unsigned int nrows,unsigned int keyint,unsigned int size)
+{
+	GCA_Window *w;
+	unsigned int i;
+	if (!(w = (GCA_Window *)calloc(1,sizeof(GCA_Window))))
+	{
+		return NULL;
+	}
+	w->nrows = nrows;
+	w->keyint = (keyint > 0) ? keyint : GCA_WINDOW_KEYINT;
+	w->rows = (GCA_WindowRow *)calloc(nrows,sizeof(GCA_WindowRow));
+	w->zero = (chunk *)calloc(size,sizeof(chunk));
+	w->spare = (chunk *)malloc(size*sizeof(chunk));
+	if (!(w->rows) || !(w->zero) || !(w->spare))
+	{
+		GCA_FreeWindow(w);
+		return NULL;
+	}
+	for (i=0;i<GCA_WINDOW_CACHE;i++)
+	{
+		if (!(w->cache[i] = (chunk *)malloc(size*sizeof(chunk))))
+		{
+			GCA_FreeWindow(w);
+			return NULL;
+		}
+		w->cache_id[i] = ~0ULL;
+	}
+	w->zero_hash = GCA_HashRow(w->zero,size);
+	return w;
+}
+
+/**
+ * @brief Copies a compressed window, the copy has an empty cache.
+ * @retval NULL if memory could not be allocated.
+ */
+static GCA_Window *GCA_CopyWindow(GCA_Window *w,unsigned int size)
+{
+	GCA_Window *cp;
+	GCA_WindowRow *r;
+	unsigned int i;
+	if (!(cp = GCA_AllocWindow(w->nrows,w->keyint,size)))
+	{
+		return NULL;
+	}
+	cp->pushed = w->pushed;
+	cp->lost = w->lost;
+	for (i=0;i<w->nrows;i++)
+	{
+		r = cp->rows + i;
+		if (!GCA_ReserveWindowRow(r,w->rows[i].n,w->rows[i].type == GCA_WINDOW_SPARSE))
+		{
+			GCA_FreeWindow(cp);
+			return NULL;
+		}
+		r->hash = w->rows[i].hash;
+		r->n = w->rows[i].n;
+		r->type = w->rows[i].type;
+		if (r->n > 0)
+		{
+			memcpy((void*)(r->data),(void*)(w->rows[i].data),(r->n)*sizeof(chunk));
+			if (r->type == GCA_WINDOW_SPARSE)
+			{
+				memcpy((void*)(r->idx),(void*)(w->rows[i].idx),(r->n)*sizeof(unsigned int));
+			}
+		}
+	}
+	return cp;
+}
+
+/**
+ * @brief The hash of the row of age \a t (\a t >= GCA_WINDOW_DENSE) of a compressed window.
+ */
+static unsigned long long GCA_WindowRowHash(GraphCellularAutomaton *GCA,unsigned int t)
+{
+	GCA_Window *w;
+	unsigned long long a;
+	w = GCA->win;
+	a = t - GCA_WINDOW_DENSE;
+	if (a >= w->pushed || w->pushed - 1 - a < w->lost)
+	{
+		return w->zero_hash;
+	}
+	return w->rows[(w->pushed - 1 - a) % w->nrows].hash;
+}
+
+/**
+ * @brief Compresses the window of a Graph Cellular Automaton.
+ *
+ * @details Only the GCA_WINDOW_DENSE most recent rows stay in \a st_pattern, the
+ * others become sparse XOR deltas against the next newer row, with a keyframe 
+ * every \a keyint rows (see GCA_Window). For the long windows needed to detect long
+ * attractor cycles this takes a fraction of the memory, at the cost of rebuilding 
+ * older rows when they are read, see GetWindowRow().
+ *
+ * @param GCA The Graph Cellular Automaton.
+ * @param keyint Number of compressed rows between keyframes, 0 for GCA_WINDOW_KEYINT.
+ *
+ * @returns 1 if the window is compressed, 0 if it was left dense (out of memory, or 
+ * a window of no more than GCA_WINDOW_DENSE rows).
+ */
+unsigned char CompressWindow(GraphCellularAutomaton *GCA,unsigned int keyint)
+{
+	chunk *dense[GCA_WINDOW_DENSE];
+	unsigned int i,WSIZE;
+
+	if (GCA->win != NULL)
+	{
+		return 1;
+	}
+	WSIZE = GCA->params->WSIZE;
+	if (WSIZE <= GCA_WINDOW_DENSE)
+	{
+		return 0;
+	}
+	if (!(GCA->win = GCA_AllocWindow(WSIZE - GCA_WINDOW_DENSE,keyint,GCA->size)))
+	{
+		return 0;
+	}
+	/*borrowed rows are released with the mapping, the dense ones need private copies*/
+	for (i=0;i<GCA_WINDOW_DENSE;i++)
+	{
+		dense[i] = GCA->st_pattern[i];
+		if ((GCA->shared & GCA_SHARED_WINDOW) && !(dense[i] = (chunk *)malloc((GCA->size)*sizeof(chunk))))
+		{
+			while (i > 0)
+			{
+				free(dense[--i]);
+			}
+			GCA_FreeWindow(GCA->win);
+			GCA->win = NULL;
+			return 0;
+		}
+	}
+	/*oldest first, as CANextStep() would have pushed them, each row is released once pushed*/
+	for (i=WSIZE-1;i>=GCA_WINDOW_DENSE;i--)
+	{
+		GCA_PushWindowRow(GCA,GCA->st_pattern[i],GCA->st_pattern[i-1]);
+		if (!(GCA->shared & GCA_SHARED_WINDOW))
+		{
+			free(GCA->st_pattern[i]);
+		}
+		GCA->st_pattern[i] = NULL;
+	}
+	for (i=0;i<GCA_WINDOW_DENSE;i++)
+	{
+		if (dense[i] != GCA->st_pattern[i])
+		{
+			memcpy((void*)(dense[i]),(void*)(GCA->st_pattern[i]),(GCA->size)*sizeof(chunk));
+		}
+		GCA->st_pattern[i] = dense[i];
+	}
+	GCA->shared &= ~GCA_SHARED_WINDOW;
+	GCA->config = GCA->st_pattern[0];
+	return 1;
+}
+
+/**
+ * @brief Sets every row of the window to zeros.
+ *
+ * @param GCA The Graph Cellular Automaton.
+ */
+void ClearWindow(GraphCellularAutomaton *GCA)
+{
+	unsigned int i,ndense;
+	ndense = (GCA->win != NULL) ? GCA_WINDOW_DENSE : GCA->params->WSIZE;
+	for (i=0;i<ndense;i++)
+	{
+		memset((void*)(GCA->st_pattern[i]),0,(GCA->size)*sizeof(chunk));
+	}
+	if (GCA->win != NULL)
+	{
+		GCA->win->pushed = 0;
+		GCA->win->lost = 0;
+		for (i=0;i<GCA_WINDOW_CACHE;i++)
+		{
+			GCA->win->cache_id[i] = ~0ULL;
+		}
+	}
+}
+
+/**
+ * @brief Gets the row of the window at time step \a t.
+ *
+ * @details As for GetCellStatePacked(), \a t = 0 is the current configuration. For
+ * a compressed window older rows are rebuilt into a small cache, so the pointer is
+ * only valid until GCA_WINDOW_CACHE further rows are read or the GCA is evolved.
+ *
+ * @param GCA The Graph Cellular Automaton.
+ * @param t The time step of interest, 0 <= \a t < <em>GCA->param->WSIZE</em>.
+ *
+ * @returns The row, it must be treated as read-only.
+ *
+ * @warning Reading a compressed window modifies its cache, so it is not thread safe.
+ */
+chunk *GetWindowRow(GraphCellularAutomaton *GCA,unsigned int t)
+{
+	GCA_Window *w;
+	chunk *row;
+	unsigned long long a,id,m;
+	unsigned int i,slot,size;
+
+	w = GCA->win;
+	if (w == NULL || t < GCA_WINDOW_DENSE)
+	{
+		return GCA->st_pattern[t];
+	}
+	a = t - GCA_WINDOW_DENSE;
+	if (a >= w->pushed || a >= w->nrows || w->pushed - 1 - a < w->lost)
+	{
+		return w->zero;
+	}
+	id = w->pushed - 1 - a;
+	for (i=0;i<GCA_WINDOW_CACHE;i++)
+	{
+		if (w->cache_id[i] == id)
+		{
+			return w->cache[i];
+		}
+	}
+
+	size = GCA->size;
+	slot = w->next;
+	w->next = (w->next + 1) % GCA_WINDOW_CACHE;
+	row = w->cache[slot];
+	w->cache_id[slot] = ~0ULL;
+	/*find the newest row at or before age a that is cached or a keyframe, rebuild from there*/
+	for (m=a+1;m>0;m--)
+	{
+		for (i=0;i<GCA_WINDOW_CACHE && w->cache_id[i] != w->pushed - m;i++);
+		if (i < GCA_WINDOW_CACHE)
+		{
+			memcpy((void*)row,(void*)(w->cache[i]),size*sizeof(chunk));
+			break;
+		}
+		if (w->rows[(w->pushed - m) % w->nrows].type == GCA_WINDOW_KEY)
+		{
+			memcpy((void*)row,(void*)(w->rows[(w->pushed - m) % w->nrows].data),size*sizeof(chunk));
+			break;
+		}
+	}
+	/*none, so start from the oldest dense row*/
+	if (m == 0)
+	{
+		memcpy((void*)row,(void*)(GCA->st_pattern[GCA_WINDOW_DENSE-1]),size*sizeof(chunk));
+	}
+	/*row is now the row of age m-1, apply the deltas of ages m to a*/
+	for (;m<=a;m++)
+	{
+		GCA_ApplyWindowRow(w->rows + ((w->pushed - 1 - m) % w->nrows),row,size);
+	}
+	w->cache_id[slot] = id;
+	return row;
+}
+
+/**
+ * @brief Creates copy of the given Graph Cellular Automaton.
+ *
+ * @param GCA The Graph Cellular Automaton to copy.
+ *
+ * @returns A GCA identical to the given one.
+ * @retval NULL Failed to make a copy of \a GCA.
+ */
+GraphCellularAutomaton *CopyGCA(GraphCellularAutomaton *GCA)
+{
+	GraphCellularAutomaton *GCA_cp;
+	int i,j,ndense;
+	/*easy case... :) */
+	if (GCA == NULL)
+	{
+		return NULL;
+	}
+	
+	GCA_cp = (GraphCellularAutomaton *)malloc(sizeof(GraphCellularAutomaton));
+	if (!GCA_cp)
+	{
+		return NULL;
+	}
+	
+	GCA_cp->params = (CellularAutomatonParameters *)malloc(sizeof(CellularAutomatonParameters));
+	if (!(GCA_cp->params))
+	{
+		return NULL;
+	}
+	
+	/*copy parameters*/
+	GCA_cp->params->N = GCA->params->N;
+	GCA_cp->params->WSIZE = GCA->params->WSIZE;
+	GCA_cp->params->rule = GCA->params->rule;
+	GCA_cp->params->s = GCA->params->s;
+	GCA_cp->params->rule_type = GCA->params->rule_type;
+	GCA_cp->params->k = GCA->params->k;
+	GCA_cp->params->graph = (unsigned int *)malloc((GCA->params->N)*(GCA->params->k-1)*sizeof(unsigned int));
+	if (!(GCA_cp->params->graph))
+	{
+		return NULL;
+	}
+	for (i=0;i<(GCA->params->N)*(GCA->params->k-1);i++)
+	{
+		GCA_cp->params->graph[i] = GCA->params->graph[i];
+	}
+	
+	/*copy the CA now*/
+	GCA_cp->log2s = GCA->log2s;
+	GCA_cp->LUT_size = GCA->LUT_size;
+	GCA_cp->size = GCA->size;
+	GCA_cp->t = GCA->t;
+	GCA_cp->ruleLUT = (state*)malloc((GCA->LUT_size)*sizeof(state));
+	if (!(GCA_cp->ruleLUT))
+	{
+		return NULL;
+	}
+	for (i=0;i<GCA->LUT_size;i++)
+	{
+		GCA_cp->ruleLUT[i] = GCA->ruleLUT[i];
+	}
+	GCA_cp->st_pattern = (chunk**)malloc((GCA->params->WSIZE)*sizeof(chunk*));
+	if (!(GCA_cp->st_pattern))
+	{
+		return NULL;
+	}
+	/*a compressed window only has its most recent rows dense*/
+	ndense = (GCA->win != NULL) ? GCA_WINDOW_DENSE : GCA->params->WSIZE;
+	for (i=0;i<GCA->params->WSIZE;i++)
+	{
+		GCA_cp->st_pattern[i] = NULL;
+	}
+	for (i=0;i<ndense;i++)
+	{
+		GCA_cp->st_pattern[i] = (chunk*)malloc((GCA->size)*sizeof(chunk));
+		if (!(GCA_cp->st_pattern[i]))
+		{
+			return NULL;
+		}
+	}
+	for (i=0;i<ndense;i++)
+	{
+		for(j=0;j<GCA->size;j++)
+		{
+			GCA_cp->st_pattern[i][j] = GCA->st_pattern[i][j];
+		}
+	}
+	GCA_cp->config = GCA_cp->st_pattern[0];
+
+	GCA_cp->ic = (chunk*)malloc((GCA->size)*sizeof(chunk));
+	if(!(GCA_cp->ic))
+	{
+		return NULL;
+	}
+	for (i=0;i<GCA->size;i++)
+	{
+		GCA_cp->ic[i] = GCA->ic[i];
+	}
+	GCA_cp->rng = NULL;
+	GCA_cp->shared = 0;
+	GCA_cp->map = NULL;
+	GCA_cp->maplen = 0;
+	GCA_cp->rowmap = NULL;
+	GCA_cp->rowmaplen = 0;
+	GCA_cp->win = NULL;
+	if (GCA->win != NULL && !(GCA_cp->win = GCA_CopyWindow(GCA->win,GCA->size)))
+	{
+		return NULL;
+	}
+
+	return GCA_cp;
+}
+
+/**
+ * @brief Creates a light-weight clone of the given Graph Cellular Automaton.
+ *
+ * @details Unlike CopyGCA() the clone shares the parameters (including the graph) and 
+ * the rule look-up table of \a GCA, only the time-space pattern and initial condition
+ * memory is private. This makes it cheap to give each thread its own GCA to evolve.
+ *
+ * @param GCA The Graph Cellular Automaton to clone.
+ *
+ * @returns A GCA with the same rule, topology and current configuration as \a GCA.
+ * @retval NULL Failed to make a clone of \a GCA.
+ *
+ * @warning The graph and LUT must be treated as read-only while any clone exists.
+ */
+GraphCellularAutomaton *CloneGCA(GraphCellularAutomaton *GCA)
+{
+	GraphCellularAutomaton *GCA_cl;
+	unsigned int i,ndense;
+
+	if (GCA == NULL)
+	{
+		return NULL;
+	}
+
+	GCA_cl = (GraphCellularAutomaton *)malloc(sizeof(GraphCellularAutomaton));
+	if (!GCA_cl)
+	{
+		return NULL;
+	}
+	
+	/*borrow everything that is read-only during evolution*/
+	GCA_cl->params = GCA->params;
+	GCA_cl->ruleLUT = GCA->ruleLUT;
+	GCA_cl->log2s = GCA->log2s;
+	GCA_cl->LUT_size = GCA->LUT_size;
+	GCA_cl->size = GCA->size;
+	GCA_cl->t = GCA->t;
+	GCA_cl->rng = NULL;
+	GCA_cl->shared = GCA_SHARED_PARAMS | GCA_SHARED_LUT | GCA_SHARED_GRAPH;
+	GCA_cl->map = NULL;
+	GCA_cl->maplen = 0;
+	GCA_cl->rowmap = NULL;
+	GCA_cl->rowmaplen = 0;
+	GCA_cl->win = NULL;
+	
+	/*rows not yet allocated are NULL, so a failed clone can be freed as it is*/
+	GCA_cl->ic = NULL;
+	GCA_cl->st_pattern = (chunk**)calloc(GCA->params->WSIZE,sizeof(chunk*));
+	if (!(GCA_cl->st_pattern))
+	{
+		free(GCA_cl);
+		return NULL;
+	}
+	ndense = (GCA->win != NULL) ? GCA_WINDOW_DENSE : GCA->params->WSIZE;
+	for (i=0;i<ndense;i++)
+	{
+		GCA_cl->st_pattern[i] = (chunk*)malloc((GCA->size)*sizeof(chunk));
+		if (!(GCA_cl->st_pattern[i]))
+		{
+			FreeGCA(GCA_cl);
+			return NULL;
+		}
+		memcpy((void*)(GCA_cl->st_pattern[i]),(void*)(GCA->st_pattern[i]),(GCA->size)*sizeof(chunk));
+	}
+	GCA_cl->config = GCA_cl->st_pattern[0];
+	if (GCA->win != NULL && !(GCA_cl->win = GCA_CopyWindow(GCA->win,GCA->size)))
+	{
+		FreeGCA(GCA_cl);
+		return NULL;
+	}
+
+	GCA_cl->ic = (chunk*)malloc((GCA->size)*sizeof(chunk));
+	if (!(GCA_cl->ic))
+	{
+		FreeGCA(GCA_cl);
+		return NULL;
+	}
+	memcpy((void*)(GCA_cl->ic),(void*)(GCA->ic),(GCA->size)*sizeof(chunk));
+
+	return GCA_cl;
+}
+
+/**
+ * @brief Creates a clone of the given Graph Cellular Automaton with a wider window.
+ *
+ * @details As CloneGCA(), but the clone has its own parameters with a window of \a ws
+ * rows in memory. This lets a GCA with a short window (e.g., one kept out of core)
+ * be evolved with the window measures such as IsAttCyc() depend on. The rows \a GCA
+ * does not have are zero, so the time of the clone is limited to the rows it has.
+ *
+ * @param GCA The Graph Cellular Automaton to clone.
+ * @param ws The window size of the clone, if it is not larger than that of \a GCA
+ * (or the window is compressed) this is the same as CloneGCA().
+ *
+ * @returns A GCA with the same rule, topology and current configuration as \a GCA.
+ * @retval NULL Failed to make a clone of \a GCA.
+ *
+ * @warning The graph and LUT must be treated as read-only while any clone exists.
+ */
+GraphCellularAutomaton *CloneGCAWindow(GraphCellularAutomaton *GCA,unsigned int ws)
+{
+	GraphCellularAutomaton *GCA_cl;
+	unsigned int i,WSIZE;
+
+	if (GCA == NULL || GCA->win != NULL || ws <= GCA->params->WSIZE)
+	{
+		return CloneGCA(GCA);
+	}
+	WSIZE = GCA->params->WSIZE;
+
+	GCA_cl = (GraphCellularAutomaton *)malloc(sizeof(GraphCellularAutomaton));
+	if (!GCA_cl)
+	{
+		return NULL;
+	}
+	GCA_cl->params = (CellularAutomatonParameters *)malloc(sizeof(CellularAutomatonParameters));
+	GCA_cl->st_pattern = (chunk**)calloc(ws,sizeof(chunk*));
+	GCA_cl->ic = (chunk*)malloc((GCA->size)*sizeof(chunk));
+	if (!(GCA_cl->params) || !(GCA_cl->st_pattern) || !(GCA_cl->ic))
+	{
+		free(GCA_cl->params);
+		free(GCA_cl->st_pattern);
+		free(GCA_cl->ic);
+		free(GCA_cl);
+		return NULL;
+	}
+	memcpy((void*)(GCA_cl->params),(void*)(GCA->params),sizeof(CellularAutomatonParameters));
+	GCA_cl->params->WSIZE = ws;
+	GCA_cl->ruleLUT = GCA->ruleLUT;
+	GCA_cl->log2s = GCA->log2s;
+	GCA_cl->LUT_size = GCA->LUT_size;
+	GCA_cl->size = GCA->size;
+	GCA_cl->t = (GCA->t < WSIZE) ? GCA->t : WSIZE - 1;
+	GCA_cl->rng = NULL;
+	GCA_cl->shared = GCA_SHARED_LUT | GCA_SHARED_GRAPH;
+	GCA_cl->map = NULL;
+	GCA_cl->maplen = 0;
+	GCA_cl->rowmap = NULL;
+	GCA_cl->rowmaplen = 0;
+	GCA_cl->win = NULL;
+
+	for (i=0;i<ws;i++)
+	{
+		GCA_cl->st_pattern[i] = (chunk*)calloc(GCA->size,sizeof(chunk));
+		if (!(GCA_cl->st_pattern[i]))
+		{
+			FreeGCA(GCA_cl);
+			return NULL;
+		}
+		if (i < WSIZE)
+		{
+			memcpy((void*)(GCA_cl->st_pattern[i]),(void*)(GCA->st_pattern[i]),(GCA->size)*sizeof(chunk));
+		}
+	}
+	GCA_cl->config = GCA_cl->st_pattern[0];
+	memcpy((void*)(GCA_cl->ic),(void*)(GCA->ic),(GCA->size)*sizeof(chunk));
+
+	return GCA_cl;
+}
+
+/**
+ * @brief Creates a Graph Cellular Automaton on a graph and rule table in a file mapping.
+ *
+ * @details Nothing is copied, \a params->graph, \a LUT and \a window point into
+ * \a map. They are flagged as borrowed, so SetCARule() builds a private rule table,
+ * but the GCA owns the mapping and unmaps it when freed. The initial condition is
+ * private and zero.
+ *
+ * @param params Parameters defining CA dynamics and topology, the GCA takes ownership.
+ * @param LUT The rule look-up table, of size s^k.
+ * @param window The WSIZE rows of the window, one after the other, or NULL for a
+ * private window of zeros.
+ * @param map The file mapping.
+ * @param maplen The length of the file mapping.
+ *
+ * @returns A GCA ready for simulation.
+ * @retval NULL Failed to create the GCA, the mapping is still the callers.
+ *
+ * @warning The mapping must be writable (e.g., private copy-on-write) if the graph 
+ * is ever modified (see RotateNeighbourhood()).
+ */
+GraphCellularAutomaton *MapGCA(CellularAutomatonParameters *params,state *LUT,chunk *window,void *map,size_t maplen)
+{
+	GraphCellularAutomaton *GCA;
+	unsigned int i;
+
+	if (!(GCA = (GraphCellularAutomaton *)malloc(sizeof(GraphCellularAutomaton))))
+	{
+		return NULL;
+	}
+	GCA->log2s = 0;
+	GCA->params = params;
+	GCA->rng = NULL;
+	GCA->ruleLUT = LUT;
+	GCA->win = NULL;
+	GCA->t = 0;
+	{ 
+		register state s; s = params->s;
+		while (s >>= 1) GCA->log2s++;
+	}
+	GCA->size = ceil((float)(((params->N)*(GCA->log2s))) / (float)CHUNK_SIZE_BITS);
+	GCA->LUT_size = pow(params->s,params->k);
+	
+	GCA->st_pattern = (chunk **)malloc((params->WSIZE)*sizeof(chunk *));
+	GCA->ic = (chunk *)malloc((GCA->size)*sizeof(chunk));
+	if (!(GCA->st_pattern) || !(GCA->ic))
+	{
+		free(GCA->st_pattern);
+		free(GCA->ic);
+		free(GCA);
+		return NULL;
+	}
+	memset((void*)(GCA->ic),0,(GCA->size)*sizeof(chunk));
+	/*only the mapping itself is owned, it is released with the GCA*/
+	GCA->shared = GCA_SHARED_LUT | GCA_SHARED_GRAPH | GCA_MAPPED;
+	for (i=0;i<(params->WSIZE);i++)
+	{
+		/*evolving the GCA only rotates the rows, so they can stay in the mapping*/
+		if (window != NULL)
+		{
+			GCA->st_pattern[i] = window + i*(GCA->size);
+			continue;
+		}
+		GCA->st_pattern[i] = (chunk *)malloc((GCA->size)*sizeof(chunk));
+		if (!(GCA->st_pattern[i]))
+		{
+			while (i > 0)
+			{
+				free(GCA->st_pattern[--i]);
+			}
+			free(GCA->st_pattern);
+			free(GCA->ic);
+			free(GCA);
+			return NULL;
+		}
+		memset((void*)(GCA->st_pattern[i]),0,(GCA->size)*sizeof(chunk));
+	}
+	if (window != NULL)
+	{
+		GCA->shared |= GCA_SHARED_WINDOW;
+	}
+	GCA->config = GCA->st_pattern[0];
+	GCA->map = map;
+	GCA->maplen = maplen;
+	GCA->rowmap = NULL;
+	GCA->rowmaplen = 0;
+	return GCA;
+}
+
+/**
+ * @brief Releases all memory held by a Graph Cellular Automaton.
+ *
+ * @details For a GCA created by CloneGCA() only the private memory is released,
+ * anything flagged in \a GCA->shared remains owned by the original.
+ *
+ * @param GCA The Graph Cellular Automaton to free.
+ */
+void FreeGCA(GraphCellularAutomaton *GCA)
+{
+	unsigned int i;
+
+	if (GCA == NULL)
+	{
+		return;
+	}
+
+	for (i=0;i<GCA->params->WSIZE && !(GCA->shared & GCA_SHARED_WINDOW);i++)
+	{
+		free(GCA->st_pattern[i]);
+	}
+	free(GCA->st_pattern);
+	GCA_FreeWindow(GCA->win);
+	if (!(GCA->shared & GCA_OUT_OF_CORE))
+	{
+		free(GCA->ic);
+	}
+	if (!(GCA->shared & GCA_SHARED_LUT))
+	{
+		free(GCA->ruleLUT);
+	}
+	if (!(GCA->shared & GCA_SHARED_GRAPH))
+	{
+		free(GCA->params->graph);
+	}
+	if (!(GCA->shared & GCA_SHARED_PARAMS))
+	{
+		free(GCA->params);
+	}
+	if (GCA->shared & GCA_MAPPED)
+	{
+		munmap(GCA->map,GCA->maplen);
+	}
+	if (GCA->shared & GCA_OUT_OF_CORE)
+	{
+		munmap(GCA->rowmap,GCA->rowmaplen);
+	}
+	free(GCA);
+}
+
+/**
+ * @brief Gives the kernel an access hint for a range of a file mapping, the range
+ * is widened to whole pages and errors are ignored.
+ */
+static void GCA_Advise(void *addr,size_t len,int advice)
+{
+	size_t pagesize;
+	char *lo,*hi;
+	pagesize = (size_t)sysconf(_SC_PAGESIZE);
+	lo = (char *)((size_t)addr & ~(pagesize-1));
+	hi = (char *)(((size_t)addr + len + pagesize-1) & ~(pagesize-1));
+	madvise((void *)lo,(size_t)(hi - lo),advice);
+}
+
+/**
+ * @brief Moves the window rows and initial condition of a GCA into a file.
+ *
+ * @details The file is resized and mapped shared, so the rows are paged to and 
+ * from it rather than held in memory. A graph that is not already in a file 
+ * mapping (see MapGCA()) is moved after the rows. From then on CANextStep()
+ * updates the cells in blocks of GCA_OOC_BLOCK with access hints, see 
+ * GCA_UpdateOutOfCore(). With a window of 2 rows only the graph and two 
+ * configurations are touched per step, so the GCA can be much larger than memory
+ * as long as its graph is mapped from a file in the first place.
+ *
+ * @param GCA The Graph Cellular Automaton, not a clone or a compressed window.
+ * @param fd A file open for reading and writing, its contents are replaced. It 
+ * can be closed (or unlinked) once this returns, the mapping is released with 
+ * the GCA.
+ *
+ * @returns 1 if the rows were moved, 0 if the GCA was left as it was.
+ */
+unsigned char OutOfCoreGCA(GraphCellularAutomaton *GCA,int fd)
+{
+	size_t rowlen,rowslen,graphlen,pagesize;
+	unsigned char movegraph;
+	unsigned int i;
+	char *base;
+
+	if (GCA->win != NULL || (GCA->shared & (GCA_SHARED_PARAMS | GCA_OUT_OF_CORE)))
+	{
+		return 0;
+	}
+	pagesize = (size_t)sysconf(_SC_PAGESIZE);
+	rowlen = (GCA->size)*sizeof(chunk);
+	rowslen = (((GCA->params->WSIZE)+1)*rowlen + pagesize-1) & ~(pagesize-1);
+	/*a borrowed graph is already in a mapping, a private one follows the rows*/
+	movegraph = !(GCA->shared & GCA_SHARED_GRAPH);
+	graphlen = (movegraph) ? (size_t)(GCA->params->N)*(GCA->params->k-1)*sizeof(unsigned int) : 0;
+	if (ftruncate(fd,(off_t)(rowslen + graphlen)) < 0)
+	{
+		return 0;
+	}
+	base = (char *)mmap(NULL,rowslen + graphlen,PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+	if (base == (char *)MAP_FAILED)
+	{
+		return 0;
+	}
+	memcpy((void *)base,(void *)(GCA->ic),rowlen);
+	free(GCA->ic);
+	GCA->ic = (chunk *)base;
+	for (i=0;i<(GCA->params->WSIZE);i++)
 	{
-		return NULL;
+		memcpy((void *)(base + (i+1)*rowlen),(void *)(GCA->st_pattern[i]),rowlen);
+		if (!(GCA->shared & GCA_SHARED_WINDOW))
+		{
+			free(GCA->st_pattern[i]);
+		}
+		GCA->st_pattern[i] = (chunk *)(base + (i+1)*rowlen);
 	}
-	for (i=0;i<GCA->size;i++)
+	GCA->config = GCA->st_pattern[0];
+	if (movegraph)
 	{
-		GCA_cp->ic[i] = GCA->ic[i];
+		memcpy((void *)(base + rowslen),(void *)(GCA->params->graph),graphlen);
+		free(GCA->params->graph);
+		GCA->params->graph = (unsigned int *)(base + rowslen);
 	}
+	/*the graph is read front to back once per step*/
+	GCA_Advise((void *)(GCA->params->graph),(size_t)(GCA->params->N)*(GCA->params->k-1)*sizeof(unsigned int),MADV_SEQUENTIAL);
+	GCA->shared |= GCA_SHARED_GRAPH | GCA_SHARED_WINDOW | GCA_OUT_OF_CORE;
+	GCA->rowmap = (void *)base;
+	GCA->rowmaplen = rowslen + graphlen;
+	return 1;
+}
 
-	return GCA_cp;
+static void GCA_CreateCountersKey(void)
+{
+	pthread_key_create(&GCA_CountersKey,NULL);
+}
+
+/**
+ * @brief Sets the work counters of the calling thread.
+ *
+ * @param c The counters to accumulate into, NULL stops counting.
+ */
+void GCA_SetCounters(GCA_Counters *c)
+{
+	pthread_once(&GCA_CountersOnce,&GCA_CreateCountersKey);
+	pthread_setspecific(GCA_CountersKey,(void*)c);
+}
+
+/**
+ * @brief Gets the work counters of the calling thread.
+ *
+ * @returns The counters, NULL if the thread is not counting.
+ */
+GCA_Counters *GCA_GetCounters(void)
+{
+	pthread_once(&GCA_CountersOnce,&GCA_CreateCountersKey);
+	return (GCA_Counters *)pthread_getspecific(GCA_CountersKey);
+}
+
+/**
+ * @brief Atomically adds one set of counters to another.
+ *
+ * @details Used to merge the counters of helper threads into those of the 
+ * thread that started them.
+ *
+ * @param dst The counters to add to.
+ * @param src The counters to add.
+ */
+void GCA_AddCounters(GCA_Counters *dst,GCA_Counters *src)
+{
+	__sync_fetch_and_add(&(dst->steps),src->steps);
+	__sync_fetch_and_add(&(dst->cellupdates),src->cellupdates);
+	__sync_fetch_and_add(&(dst->nhelim),src->nhelim);
+	__sync_fetch_and_add(&(dst->preimages),src->preimages);
+}
+
+static void GCA_CreateProgressKey(void)
+{
+	pthread_key_create(&GCA_ProgressKey,NULL);
+}
+
+/**
+ * @brief Sets the progress callback of the calling thread.
+ *
+ * @param p The callback, NULL for none.
+ */
+void GCA_SetProgress(GCA_Progress *p)
+{
+	pthread_once(&GCA_ProgressOnce,&GCA_CreateProgressKey);
+	pthread_setspecific(GCA_ProgressKey,(void*)p);
+}
+
+/**
+ * @brief Gets the progress callback of the calling thread.
+ *
+ * @returns The callback, NULL if there is none.
+ */
+GCA_Progress *GCA_GetProgress(void)
+{
+	pthread_once(&GCA_ProgressOnce,&GCA_CreateProgressKey);
+	return (GCA_Progress *)pthread_getspecific(GCA_ProgressKey);
+}
+
+/**
+ * @brief Reports progress to the callback of the calling thread.
+ *
+ * @param done Number of iterations done.
+ * @param total Total number of iterations, 0 if unknown.
+ *
+ * @retval 1 The operation should stop.
+ * @retval 0 Otherwise (or if there is no callback).
+ */
+unsigned char GCA_ReportProgress(unsigned long long done,unsigned long long total)
+{
+	GCA_Progress *p;
+	p = GCA_GetProgress();
+	return (p != NULL && p->f != NULL) ? (*(p->f))(p->arg,done,total) : 0;
+}
+
+/**
+ * @brief Initialises a counter-based random stream.
+ *
+ * @details Distinct (\a seed, \a stream) pairs give statistically independent
+ * streams, this allows each Monte Carlo sample to draw from its own stream so results
+ * do not depend on how samples are distributed over threads.
+ *
+ * @param rs The stream to initialise.
+ * @param seed The user seed.
+ * @param stream The stream id (e.g., the sample index).
+ */
+void SeedRandStream(GCA_RandStream *rs,unsigned long long seed,unsigned long long stream)
+{
+	unsigned long long z;
+	/*SplitMix64 finaliser applied to the seed and then the stream id*/
+	z = seed + 0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+	z ^= (z >> 31);
+	z ^= stream*0xD1B54A32D192ED03ULL;
+	z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+	rs->key = z ^ (z >> 31);
+	rs->ctr = 0;
+}
+
+/**
+ * @brief Draws the next value from a counter-based random stream.
+ *
+ * @param rs The random stream.
+ *
+ * @returns A uniformly distributed 64-bit value.
+ */
+unsigned long long RandStreamNext(GCA_RandStream *rs)
+{
+	unsigned long long z;
+	/*output is a bijective mix of key + counter, no hidden state*/
+	rs->ctr++;
+	z = rs->key + rs->ctr*0x9E3779B97F4A7C15ULL;
+	z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
 }
 
 /**
@@ -700,9 +1958,19 @@ void SetCAIC(GraphCellularAutomaton *GCA,chunk *ic,unsigned char type)
 				}
 				break;
 			case NOISE_IC_TYPE:
-				for (i=0;i<GCA->size;i++)
+				if (GCA->rng != NULL)
+				{
+					for (i=0;i<GCA->size;i++)
+					{
+						GCA->config[i] = (chunk)RandStreamNext(GCA->rng);
+					}
+				}
+				else
 				{
-					GCA->config[i] = rand();
+					for (i=0;i<GCA->size;i++)
+					{
+						GCA->config[i] = rand();
+					}
 				}
 				break;
 			case STRIPE_IC_TYPE:
@@ -720,6 +1988,15 @@ void SetCAIC(GraphCellularAutomaton *GCA,chunk *ic,unsigned char type)
 				break;
 		}
 	}
+	/*bits beyond the last cell must stay clear, IsAttCyc() compares whole chunks*/
+	{
+		unsigned int nbits;
+		nbits = (GCA->params->N % (CHUNK_SIZE_BITS/GCA->log2s))*GCA->log2s;
+		if (nbits)
+		{
+			GCA->config[GCA->size-1] &= (((chunk)0x1) << nbits) - 1;
+		}
+	}
 	/*store a copy of the initial condition for restart*/
 	for (i=0;i<GCA->size;i++)
 	{
@@ -759,12 +2036,14 @@ void ResetCA(GraphCellularAutomaton *GCA)
 state GetCellStatePacked(GraphCellularAutomaton *GCA, unsigned int i,unsigned int t)
 {
 	register unsigned int log2s,p,r,q;
+	chunk *row;
 	log2s = GCA->log2s;
 	p = CHUNK_SIZE_BITS/log2s;
 	r = (i%p)*log2s;
 	q = i/p;
+	row = (GCA->win == NULL || t < GCA_WINDOW_DENSE) ? GCA->st_pattern[t] : GetWindowRow(GCA,t);
 	/* what the crap? gotta love bit twiddling*/
-	return (GCA->st_pattern[t][q] >> r) & ((0x1 << log2s) - 1);
+	return (row[q] >> r) & ((0x1 << log2s) - 1);
 }
 
 /**
@@ -925,11 +2204,11 @@ unsigned int GetNeighbourhood_config_external(GraphCellularAutomaton * GCA,chunk
 			break;
 		}
 	}
-	k_local = GCA->params->k-1;
+	k_local = j;
 	nhood = 0;
 	nhood |= GetCellStatePacked_external(GCA,config,i) << GCA->log2s*((GCA->params->k-1)/2);
 		
-	for (j=0;j<(GCA->params->k-1)/2;j++)
+	for (j=0;j<(GCA->params->k-1)/2 && j<k_local;j++)
 	{
 		nhood |= GetCellStatePacked_external(GCA,config,U_i[j]) << GCA->log2s*j;
 		
@@ -971,7 +2250,7 @@ unsigned int GetNeighbourhood_config(GraphCellularAutomaton * GCA,unsigned int i
 	nhood = 0;
 	nhood |= GetCellStatePacked(GCA,i,t) << GCA->log2s*((GCA->params->k-1)/2);
 		
-	for (j=0;j<(GCA->params->k-1)/2;j++)
+	for (j=0;j<(GCA->params->k-1)/2 && j<k_local;j++)
 	{
 		nhood |= GetCellStatePacked(GCA,U_i[j],t) << GCA->log2s*j;
 		
@@ -1002,6 +2281,45 @@ void CASimTSteps(GraphCellularAutomaton *GCA,unsigned int t)
 	while(CANextStep(GCA) != t);
 }
 
+/**
+ * @brief Updates the cells of an out-of-core GCA, see OutOfCoreGCA().
+ *
+ * @details Cells are updated in blocks of GCA_OOC_BLOCK in graph order, so the 
+ * graph, by far the largest part of the GCA, is streamed front to back. While a 
+ * block is updated the graph of the next one is requested, and once it is done 
+ * its graph is deactivated, so under memory pressure the kernel drops graph 
+ * pages before those of the previous row, which is read at random.
+ *
+ * @param GCA The Graph Cellular Automaton, with its window already rotated.
+ */
+static void GCA_UpdateOutOfCore(GraphCellularAutomaton *GCA)
+{
+	unsigned int i,b,end,N,nb;
+	size_t stride;
+
+	N = GCA->params->N;
+	stride = (size_t)(GCA->params->k-1);
+	GCA_Advise((void *)(GCA->st_pattern[1]),(GCA->size)*sizeof(chunk),MADV_WILLNEED);
+	for (b=0;b<N;b=end)
+	{
+		end = (N - b > GCA_OOC_BLOCK) ? b + GCA_OOC_BLOCK : N;
+		if (end < N)
+		{
+			nb = (N - end > GCA_OOC_BLOCK) ? GCA_OOC_BLOCK : N - end;
+			GCA_Advise((void *)(GCA->params->graph + end*stride),nb*stride*sizeof(unsigned int),MADV_WILLNEED);
+		}
+		for (i=b;i<end;i++)
+		{
+			register unsigned int nhood;
+			nhood = GetNeighbourhood_config(GCA,i,1);
+			SetCellStatePacked(GCA,i,GCA->ruleLUT[nhood]);
+		}
+#ifdef MADV_COLD
+		GCA_Advise((void *)(GCA->params->graph + b*stride),(end - b)*stride*sizeof(unsigned int),MADV_COLD);
+#endif
+	}
+}
+
 /**
  * @brief Evolves the Cellular Automaton 1 timestep.
  *
@@ -1013,11 +2331,17 @@ unsigned int CANextStep(GraphCellularAutomaton *GCA)
 {
 	unsigned int i,j,N,k,WSIZE;
 	chunk *next_config;
+	GCA_Counters *c;
 
 	N = GCA->params->N;
 	k = GCA->params->k;
 	WSIZE = GCA->params->WSIZE;
-	/*update the window*/
+	/*update the window, a compressed one only rotates its dense rows*/
+	if (GCA->win != NULL)
+	{
+		WSIZE = GCA_WINDOW_DENSE;
+		GCA_PushWindowRow(GCA,GCA->st_pattern[WSIZE-1],GCA->st_pattern[WSIZE-2]);
+	}
 	next_config = GCA->st_pattern[WSIZE-1];
 	
 	//GCA->st_pattern[1] = GCA->st_pattern[0];
@@ -1029,13 +2353,25 @@ unsigned int CANextStep(GraphCellularAutomaton *GCA)
 	GCA->st_pattern[0] = next_config;
 	GCA->config = GCA->st_pattern[0];
 	
-	for (i=0;i<N;i++)
+	if (GCA->shared & GCA_OUT_OF_CORE)
+	{
+		GCA_UpdateOutOfCore(GCA);
+	}
+	else
 	{
-		register unsigned int nhood;
-		nhood = GetNeighbourhood_config(GCA,i,1);
-		SetCellStatePacked(GCA,i,GCA->ruleLUT[nhood]);
+		for (i=0;i<N;i++)
+		{
+			register unsigned int nhood;
+			nhood = GetNeighbourhood_config(GCA,i,1);
+			SetCellStatePacked(GCA,i,GCA->ruleLUT[nhood]);
+		}
 	}
 	GCA->t++;
+	if ((c = GCA_GetCounters()) != NULL)
+	{
+		c->steps++;
+		c->cellupdates += N;
+	}
 	
 	return GCA->t;
 }
@@ -1070,6 +2406,27 @@ chunk* CASimToAttCyc(GraphCellularAutomaton *GCA,unsigned int t)
 	return cycle;
 }
 
+/**
+ * @brief Simulates the CA until an attractor cycle is detected.
+ *
+ * @details On return \a GCA->t holds the number of steps that were taken, which for a
+ * detected cycle is the transient length plus the cycle length.
+ *
+ * @param GCA A Graph Cellular Automaton.
+ * @param t Max time step, abort if a cycle is not reached before this step.
+ *
+ * @returns The length of the attractor cycle, 0 if none was found within \a t steps.
+ */
+unsigned int CASimToAttLength(GraphCellularAutomaton *GCA,unsigned int t)
+{
+	unsigned int length;
+	while(!(length = IsAttCyc(GCA)) && GCA->t < t) 
+	{
+		CANextStep(GCA);
+	}
+	return length;
+}
+
 /**
  * @brief Detects if the CA has entered an attractor cycle.
  *
@@ -1078,9 +2435,10 @@ chunk* CASimToAttCyc(GraphCellularAutomaton *GCA,unsigned int t)
  * @returns Returns the length of the cycle if an attractor cycle has begun, 
  * 0 otherwise. 
  */
-unsigned char IsAttCyc(GraphCellularAutomaton *GCA)
+unsigned int IsAttCyc(GraphCellularAutomaton *GCA)
 {
 	unsigned int WSIZE,nbytes,t,tn;
+	unsigned long long h;
 	WSIZE = GCA->params->WSIZE;
 	nbytes = (GCA->size)*sizeof(chunk);
 	if (GCA->t < WSIZE)
@@ -1091,10 +2449,21 @@ unsigned char IsAttCyc(GraphCellularAutomaton *GCA)
 	{
 		tn = WSIZE - 1;
 	}
+	/*lost rows of a compressed window can not be part of a cycle*/
+	if (GCA->win != NULL && GCA->win->lost > 0 && tn >= GCA_WINDOW_DENSE + (GCA->win->pushed - GCA->win->lost))
+	{
+		tn = GCA_WINDOW_DENSE - 1 + (unsigned int)(GCA->win->pushed - GCA->win->lost);
+	}
+	h = (GCA->win != NULL) ? GCA_HashRow(GCA->config,GCA->size) : 0;
 	for (t=tn;t>0;t--)
 	{
+		/*compressed rows are only rebuilt if their hash matches*/
+		if (GCA->win != NULL && t >= GCA_WINDOW_DENSE && GCA_WindowRowHash(GCA,t) != h)
+		{
+			continue;
+		}
 		/*if we have seen this configuation before, then we have entered an attractor cycle */
-		if (!memcmp((void*)(GCA->config),(void*)(GCA->st_pattern[t]),nbytes)){
+		if (!memcmp((void*)(GCA->config),(void*)(GetWindowRow(GCA,t)),nbytes)){
 			/*woah!? dejavu... was it the same cat?*/
 			return t;
 		}
@@ -1253,7 +2622,12 @@ unsigned char NhElim(GraphCellularAutomaton *GCA,unsigned char *flags,state *the
 	unsigned int *U_i,*U_j;
 	unsigned int state_mask,mask_nh;
     unsigned int theta_size;
+	GCA_Counters *c;
 
+	if ((c = GCA_GetCounters()) != NULL)
+	{
+		c->nhelim++;
+	}
 	k2 = (GCA->params->k-1)/2;
     r = GCA->log2s*k2;
 	
@@ -1417,11 +2791,12 @@ unsigned char NhElim(GraphCellularAutomaton *GCA,unsigned char *flags,state *the
  * @returns An array such that <em>flags(i,j) = 0 =></em> neighbourhood \a i cannot 
  * occur for cell \a j in any pre-image.
  *
- * @remark This function implements the EDEN-DET algorithm.
+ * @remark This function implements the EDEN-DET algorithm. If it is stopped by the 
+ * progress callback (see GCA_SetProgress()) some impossible neighbourhoods may still be flagged.
  */
 unsigned char* GetFlags(GraphCellularAutomaton* GCA)
 {
-	unsigned char exit,iter,*flags,*tmp_flags;
+	unsigned char exit,iter,stop,*flags,*tmp_flags;
 	state *theta_i,*theta_j;
 	unsigned int i,j,k,ii,jj;
 	unsigned int sum,prev_sum;
@@ -1500,11 +2875,17 @@ unsigned char* GetFlags(GraphCellularAutomaton* GCA)
 		{
 			unsigned char invalid;
 			invalid = 0;
+			stop = 0;
 			memcpy(tmp_flags,flags,(GCA->params->N)*(GCA->LUT_size)*sizeof(unsigned char));
 				
 			/*for each possible n-hood, run a single test iteration*/
 			for (i=0;i<(GCA->params->N);i++)
 			{
+				/*stopping early only leaves extra flags set, no possible n-hood is lost*/
+				if ((stop = GCA_ReportProgress(0,0)))
+				{
+					break;
+				}
 				for (j=0;j<GCA->LUT_size;j++)
 				{
 					if( tmp_flags[i*(GCA->LUT_size)+j] != 0)
@@ -1545,7 +2926,7 @@ unsigned char* GetFlags(GraphCellularAutomaton* GCA)
 				}
 			}
 			/*if we get here and we are still valid then we exit*/
-			exit = !invalid;
+			exit = !invalid || stop;
 		}
 	}
 	free(theta_i);
@@ -1597,6 +2978,11 @@ unsigned char isValid(GraphCellularAutomaton *GCA,chunk *config,unsigned char *f
 {
 	int i;
 	unsigned int nhood;
+	GCA_Counters *c;
+	if ((c = GCA_GetCounters()) != NULL)
+	{
+		c->preimages++;
+	}
 	for (i=0;i<GCA->params->N;i++)
 	{
 		nhood = GetNeighbourhood_config_external(GCA,config,i);
@@ -2016,6 +3402,8 @@ float WordEntropy(GraphCellularAutomaton *GCA,unsigned int T, float *pm,float* l
  * lower and upper range.
  *
  * @returns A pointer to an \a N x \a s array, this is equal to the \a counts array.
+ *
+ * @remark If stopped by the progress callback the counts only cover the pre-images done.
  */
 unsigned int *SumCAImages(GraphCellularAutomaton *GCA,unsigned int *counts,chunk *preImages,unsigned int n)
 {
@@ -2034,6 +3422,10 @@ unsigned int *SumCAImages(GraphCellularAutomaton *GCA,unsigned int *counts,chunk
 		/*for each pre-image*/
 		for (p=0;p<n;p++)
 		{
+			if (p % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(p,n))
+			{
+				break;
+			}
 			/*fix the initial condition*/
 			SetCAIC(GCA,preImages+p*(GCA->size),EXPLICIT_IC_TYPE);
 			ResetCA(GCA);
@@ -2067,6 +3459,11 @@ unsigned int *SumCAImages(GraphCellularAutomaton *GCA,unsigned int *counts,chunk
 		/*need to count by two's to avoid rotational symmetry*/	
 		for (p=preImages[0];p<preImages[1];p+=2)
 		{
+			if (((p - preImages[0])/2) % GCA_PROGRESS_INTERVAL == 0 
+				&& GCA_ReportProgress((p - preImages[0])/2,(preImages[1] - preImages[0] + 1)/2))
+			{
+				break;
+			}
 			/*fix the initial condition*/
 			SetCAIC(GCA,&p,0);
 			ResetCA(GCA);
@@ -2394,6 +3791,8 @@ float Z_param(GraphCellularAutomaton *GCA)
  * @param n If \a ics == \a NULL then this is the number of random samples to use, else it is is the number of configurations in \a ics.
  * 
  * @returns The density of Garden of eden configurations.
+ *
+ * @remark If stopped by the progress callback the density is over the configurations done.
  */
 float G_density(GraphCellularAutomaton *GCA,chunk* ics,unsigned int n)
 {
@@ -2406,6 +3805,10 @@ float G_density(GraphCellularAutomaton *GCA,chunk* ics,unsigned int n)
 		{
 			for (i=0;i<n;i++)
 			{
+				if (i % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(i,n))
+				{
+					break;
+				}
 				/*fix the initial condition*/
 				SetCAIC(GCA,ics+i*(GCA->size),EXPLICIT_IC_TYPE);
 				ResetCA(GCA);
@@ -2417,6 +3820,10 @@ float G_density(GraphCellularAutomaton *GCA,chunk* ics,unsigned int n)
 		{
 			for (i=0;i<n;i++)
 			{
+				if (i % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(i,n))
+				{
+					break;
+				}
 				/*fix the initial condition*/
 				SetCAIC(GCA,NULL,NOISE_IC_TYPE);
 				ResetCA(GCA);
@@ -2424,19 +3831,23 @@ float G_density(GraphCellularAutomaton *GCA,chunk* ics,unsigned int n)
 				G += IsGOE(GCA);
 			}
 		}
-		return ((float)G)/((float)n);
+		return (i > 0) ? ((float)G)/((float)i) : 0.0;
 	}
 	else
 	{
 		for (i=ics[0];i<ics[1];i++)
 		{
+			if ((i - ics[0]) % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(i - ics[0],ics[1] - ics[0]))
+			{
+				break;
+			}
 			/*fix the initial condition*/
 			SetCAIC(GCA,&i,EXPLICIT_IC_TYPE);
 			ResetCA(GCA);
 			/*Garden-of-Eden test*/
 			G += IsGOE(GCA);
 		}
-		return ((float)G)/((float)ics[1]-ics[0]);
+		return (i > ics[0]) ? ((float)G)/((float)(i - ics[0])) : 0.0;
 
 	}
 }
@@ -2450,6 +3861,8 @@ float G_density(GraphCellularAutomaton *GCA,chunk* ics,unsigned int n)
  * @param t Max time step to simulate before search for an attractor is halted.
  *
  * @returns The average attractor cycle length.
+ *
+ * @remark If stopped by the progress callback the average is over the configurations done.
  */
 float AttLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigned int t)
 {
@@ -2462,6 +3875,10 @@ float AttLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigned
 		{
 			for (i=0;i<n;i++)
 			{
+				if (i % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(i,n))
+				{
+					break;
+				}
 				/*fix the initial condition*/
 				SetCAIC(GCA,ics+i*(GCA->size),EXPLICIT_IC_TYPE);
 				ResetCA(GCA);
@@ -2478,6 +3895,10 @@ float AttLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigned
 		{
 			for (i=0;i<n;i++)
 			{
+				if (i % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(i,n))
+				{
+					break;
+				}
 				/*fix the initial condition*/
 				SetCAIC(GCA,NULL,NOISE_IC_TYPE);
 				ResetCA(GCA);
@@ -2493,8 +3914,18 @@ float AttLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigned
 	}
 	else
 	{
+		float C;
+		/*trajectories through the range merge quickly, so memoise if we can*/
+		if (AttTransLength(GCA,ics,t,&C,NULL))
+		{
+			return C;
+		}
 		for (i=ics[0];i<ics[1];i++)
 		{
+			if ((i - ics[0]) % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(i - ics[0],ics[1] - ics[0]))
+			{
+				break;
+			}
 			/*fix the initial condition*/
 			SetCAIC(GCA,&i,EXPLICIT_IC_TYPE);
 			ResetCA(GCA);
@@ -2520,6 +3951,8 @@ float AttLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigned
  * @param t Max time step to simulate before search for an attractor is halted.
  * 
  * @returns The average transient path length.
+ *
+ * @remark If stopped by the progress callback the average is over the configurations done.
  */
 float TransLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigned int t)
 {
@@ -2532,6 +3965,10 @@ float TransLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigne
 		{
 			for (i=0;i<n;i++)
 			{
+				if (i % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(i,n))
+				{
+					break;
+				}
 				/*fix the initial condition*/
 				SetCAIC(GCA,ics+i*(GCA->size),EXPLICIT_IC_TYPE);
 				ResetCA(GCA);
@@ -2553,6 +3990,10 @@ float TransLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigne
 		{
 			for (i=0;i<n;i++)
 			{
+				if (i % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(i,n))
+				{
+					break;
+				}
 				/*fix the initial condition*/
 				SetCAIC(GCA,NULL,NOISE_IC_TYPE);
 				ResetCA(GCA);
@@ -2573,8 +4014,18 @@ float TransLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigne
 	}
 	else
 	{
+		float T;
+		/*trajectories through the range merge quickly, so memoise if we can*/
+		if (AttTransLength(GCA,ics,t,NULL,&T))
+		{
+			return T;
+		}
 		for (i=ics[0];i<ics[1];i++)
 		{
+			if ((i - ics[0]) % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(i - ics[0],ics[1] - ics[0]))
+			{
+				break;
+			}
 			/*fix the initial condition*/
 			SetCAIC(GCA,&i,EXPLICIT_IC_TYPE);
 			ResetCA(GCA);
@@ -2596,6 +4047,252 @@ float TransLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigne
 	return (numtrans > 0) ? ((float)totaloflengths)/((float)numtrans) : 0.0;
 }
 
+/*memo table entry states*/
+#define ATT_MEMO_EMPTY 0
+#define ATT_MEMO_KNOWN 1
+#define ATT_MEMO_BOUND 2
+#define ATT_MEMO_ONPATH 3
+
+/*a visited configuration of a size == 1 GCA*/
+typedef struct
+{
+	chunk config;
+	/*KNOWN: distance to the cycle, ONPATH: index on the current path*/
+	unsigned int tau;
+	/*KNOWN: cycle length, BOUND: lower bound on the number of distinct states reached*/
+	unsigned int len;
+	unsigned char flag;
+} AttMemoEntry;
+
+typedef struct
+{
+	AttMemoEntry *table;
+	size_t size;
+	size_t count;
+} AttMemo;
+
+/*slot of a configuration in a table of size entries (a power of two)*/
+#define ATT_MEMO_SLOT(config,size) ((size_t)(((unsigned long long)(config))*0x9E3779B97F4A7C15ULL) & ((size) - 1))
+
+/**
+ * @brief Finds the entry of a configuration in the memo table, inserting it if needed.
+ *
+ * @returns The entry, or NULL if out of memory or the table can not grow any further.
+ */
+static AttMemoEntry *AttMemoGet(AttMemo *memo,chunk config)
+{
+	register size_t i;
+	if (2*(memo->count + 1) > memo->size)
+	{
+		AttMemoEntry *old;
+		size_t j,size;
+		old = memo->table;
+		size = memo->size;
+		/*the doubled size must still be a power of two whose bytes fit in a size_t*/
+		if (size > ((size_t)-1)/(2*sizeof(AttMemoEntry)))
+		{
+			return NULL;
+		}
+		memo->table = (AttMemoEntry *)calloc(2*size,sizeof(AttMemoEntry));
+		if (!(memo->table))
+		{
+			memo->table = old;
+			return NULL;
+		}
+		memo->size = 2*size;
+		for (j=0;j<size;j++)
+		{
+			if (old[j].flag != ATT_MEMO_EMPTY)
+			{
+				i = ATT_MEMO_SLOT(old[j].config,memo->size);
+				while (memo->table[i].flag != ATT_MEMO_EMPTY)
+				{
+					i = (i + 1) & (memo->size - 1);
+				}
+				memo->table[i] = old[j];
+			}
+		}
+		free(old);
+	}
+	i = ATT_MEMO_SLOT(config,memo->size);
+	while (memo->table[i].flag != ATT_MEMO_EMPTY && memo->table[i].config != config)
+	{
+		i = (i + 1) & (memo->size - 1);
+	}
+	if (memo->table[i].flag == ATT_MEMO_EMPTY)
+	{
+		memo->table[i].config = config;
+		memo->count++;
+	}
+	return memo->table + i;
+}
+
+/**
+ * @brief Computes the average attractor cycle length and average transient path length 
+ * over a range of configurations in a single memoised pass.
+ *
+ * @details Every configuration visited is recorded with its distance to the attractor 
+ * cycle and the cycle length, so a trajectory stops as soon as it reaches a configuration 
+ * seen by an earlier one. Results are identical to AttLength() and TransLength() over the 
+ * same range, including the limits on cycle detection imposed by \a t and the window size.
+ *
+ * @param GCA A Graph Cellular Automaton, must have \a GCA->size == 1.
+ * @param ics The range of configurations [ics[0],ics[1]).
+ * @param t Max time step to simulate before search for an attractor is halted.
+ * @param C Returns the average attractor cycle length (can be NULL).
+ * @param T Returns the average transient path length (can be NULL).
+ *
+ * @retval 1 Success.
+ * @retval 0 \a GCA->size != 1, out of memory, or stopped by the progress callback.
+ */
+unsigned char AttTransLength(GraphCellularAutomaton *GCA,chunk *ics,unsigned int t,float *C,float *T)
+{
+	AttMemo memo;
+	AttMemoEntry *e;
+	chunk *path;
+	chunk x,cur,mask;
+	unsigned int i,k,tau,len,maxlen,numcycles,numtrans;
+	unsigned long long totalC,totalT;
+	unsigned char found;
+
+	if (GCA->size != 1)
+	{
+		return 0;
+	}
+	/*only the bits of the N cells are part of the configuration*/
+	k = (GCA->params->N)*(GCA->log2s);
+	mask = (k >= CHUNK_SIZE_BITS) ? ~((chunk)0) : (((chunk)1) << k) - 1;
+	/*longest cycle IsAttCyc() can detect*/
+	maxlen = GCA->params->WSIZE - 1;
+
+	memo.size = 1024;
+	memo.count = 0;
+	memo.table = (AttMemoEntry *)calloc(memo.size,sizeof(AttMemoEntry));
+	path = (chunk *)malloc((t + 2)*sizeof(chunk));
+	if (!(memo.table) || !path)
+	{
+		free(memo.table);
+		free(path);
+		return 0;
+	}
+
+	numcycles = 0;
+	numtrans = 0;
+	totalC = 0;
+	totalT = 0;
+	for (x=ics[0];x<ics[1];x++)
+	{
+		if ((x - ics[0]) % GCA_PROGRESS_INTERVAL == 0 && GCA_ReportProgress(x - ics[0],ics[1] - ics[0]))
+		{
+			free(memo.table);
+			free(path);
+			return 0;
+		}
+		cur = x & mask;
+		/*walk until a known configuration, a repeat, or more than t distinct configurations*/
+		i = 0;
+		while (1)
+		{
+			e = AttMemoGet(&memo,cur);
+			if (!e)
+			{
+				free(memo.table);
+				free(path);
+				return 0;
+			}
+			if (e->flag == ATT_MEMO_KNOWN)
+			{
+				tau = e->tau + i;
+				len = e->len;
+				break;
+			}
+			else if (e->flag == ATT_MEMO_ONPATH)
+			{
+				/*path[e->tau..i-1] is the cycle*/
+				len = i - e->tau;
+				for (k=e->tau;k<i;k++)
+				{
+					e = AttMemoGet(&memo,path[k]);
+					e->flag = ATT_MEMO_KNOWN;
+					e->tau = 0;
+					e->len = len;
+				}
+				tau = i - len;
+				i -= len;
+				break;
+			}
+			else if ((e->flag == ATT_MEMO_BOUND && e->len > t) || i > t)
+			{
+				/*too many distinct configurations to be detected from here*/
+				if (e->flag != ATT_MEMO_BOUND)
+				{
+					/*the new entry is not part of the path*/
+					e->flag = ATT_MEMO_BOUND;
+					e->len = 1;
+				}
+				len = e->len;
+				/*path[k] reaches i-k+1 distinct configurations, and at least as many as the 
+				 *entry, but not their sum as the entry's cycle may run back through the path*/
+				for (k=0;k<i;k++)
+				{
+					e = AttMemoGet(&memo,path[k]);
+					e->flag = ATT_MEMO_BOUND;
+					e->len = (e->len > i - k + 1) ? e->len : i - k + 1;
+					e->len = (e->len > len) ? e->len : len;
+				}
+				i = 0;
+				tau = t + 1;
+				len = 0;
+				break;
+			}
+			e->flag = ATT_MEMO_ONPATH;
+			e->tau = i;
+			if (i == 0)
+			{
+				SetCAIC(GCA,&cur,EXPLICIT_IC_TYPE);
+				ResetCA(GCA);
+			}
+			path[i++] = cur;
+			CANextStep(GCA);
+			cur = GCA->config[0] & mask;
+		}
+		/*the transient of path[k] is one less than that of path[k-1]*/
+		for (k=0;k<i;k++)
+		{
+			e = AttMemoGet(&memo,path[k]);
+			e->flag = ATT_MEMO_KNOWN;
+			e->tau = tau - k;
+			e->len = len;
+		}
+
+		/*same detection rules as simulating with IsAttCyc()*/
+		found = (len > 0 && len <= maxlen && tau + len <= t);
+		if (found)
+		{
+			totalC += len;
+			numcycles++;
+			totalT += tau + 1;
+		}
+		else
+		{
+			totalT += t + 1;
+		}
+		numtrans++;
+	}
+
+	if (C)
+	{
+		*C = (numcycles > 0) ? (float)(((double)totalC)/((double)numcycles)) : 0.0;
+	}
+	if (T)
+	{
+		*T = (numtrans > 0) ? (float)(((double)totalT)/((double)numtrans)) : 0.0;
+	}
+	free(memo.table);
+	free(path);
+	return 1;
+}
+
 /**
  * @brief Calculates the "live" population density.
  *
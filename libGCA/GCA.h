@@ -108,6 +108,11 @@
 	#define DEFAULT_IC_TYPE POINT_IC_TYPE
 #endif
 
+#ifndef MAX_CANONICAL_STATES
+/** @brief Max number of states for which all state permutations are tried by CanonicalRuleLUT().*/
+	#define MAX_CANONICAL_STATES 4
+#endif
+
 /** @brief Limit on the number of pre-images returned by the EDEN-DET() algorithm.*/
 #define MAX_PRE_IMAGE_RETURN 1000
 
@@ -116,6 +121,11 @@
 	#define DEFAULT_WINDOW_SIZE 1200
 #endif
 
+#ifndef GCA_PROGRESS_INTERVAL
+/** @brief Number of loop iterations between progress reports.*/
+	#define GCA_PROGRESS_INTERVAL 4096
+#endif
+
 
 #ifndef CHUNK_SIZE_BITS
     /** @brief The number of bits in a memory chunk*/
@@ -151,6 +161,158 @@ typedef struct GraphCellularAutomaton_struct GraphCellularAutomaton;
 /** @brief Graph Cellular Automaton Parameters.*/
 typedef struct CellularAutomatonParameters_struct CellularAutomatonParameters; 
 
+/** @brief Flags that the parameter structure is borrowed.*/
+#define GCA_SHARED_PARAMS 0x1
+/** @brief Flags that the rule look-up table is borrowed.*/
+#define GCA_SHARED_LUT 0x2
+/** @brief Flags that the graph is borrowed.*/
+#define GCA_SHARED_GRAPH 0x4
+/** @brief Flags that the GCA owns a file mapping (see MapGCA()).*/
+#define GCA_MAPPED 0x8
+/** @brief Flags that the window rows are borrowed (see MapGCA()).*/
+#define GCA_SHARED_WINDOW 0x10
+/** @brief Flags that the GCA owns a file mapping holding its rows (see OutOfCoreGCA()).*/
+#define GCA_OUT_OF_CORE 0x20
+
+#ifndef GCA_OOC_BLOCK
+/** @brief Number of cells an out-of-core GCA updates between access hints.*/
+#define GCA_OOC_BLOCK 65536
+#endif
+
+/** @brief A counter-based random number stream.*/
+typedef struct GCA_RandStream_struct GCA_RandStream;
+
+#ifndef GCA_WINDOW_DENSE
+/** @brief Number of the most recent rows a compressed window keeps uncompressed (at least 2).*/
+#define GCA_WINDOW_DENSE 2
+#endif
+#ifndef GCA_WINDOW_KEYINT
+/** @brief Default number of compressed rows between keyframes.*/
+#define GCA_WINDOW_KEYINT 64
+#endif
+#ifndef GCA_WINDOW_CACHE
+/** @brief Number of decompressed rows a compressed window caches.*/
+#define GCA_WINDOW_CACHE 4
+#endif
+
+/** @brief Compressed row types.*/
+#define GCA_WINDOW_KEY 0
+#define GCA_WINDOW_SPARSE 1
+#define GCA_WINDOW_XOR 2
+
+/** @brief A compressed window row.*/
+typedef struct GCA_WindowRow_struct GCA_WindowRow;
+/** @brief A compressed window.*/
+typedef struct GCA_Window_struct GCA_Window;
+
+/** @brief Work counters.*/
+typedef struct GCA_Counters_struct GCA_Counters;
+
+/** @brief Work counters structure.
+ *  @details Counters are per thread, a thread only counts its work after 
+ *  GCA_SetCounters() has been called, see GCA_AddCounters() for merging.
+ */
+struct GCA_Counters_struct
+{
+	/** @brief Number of CANextStep() calls.*/
+	unsigned long long steps;
+	/** @brief Number of cell state updates.*/
+	unsigned long long cellupdates;
+	/** @brief Number of NhElim() sweeps.*/
+	unsigned long long nhelim;
+	/** @brief Number of candidate pre-images tested.*/
+	unsigned long long preimages;
+};
+
+/** @brief Progress callback, returns 1 to stop the operation.*/
+typedef unsigned char (*GCA_ProgressFunc)(void *arg,unsigned long long done,unsigned long long total);
+
+/** @brief Progress reporting.*/
+typedef struct GCA_Progress_struct GCA_Progress;
+
+/** @brief Progress reporting structure.
+ *  @details Like the work counters this is per thread, see GCA_SetProgress(). Long
+ *  loops call \a f every GCA_PROGRESS_INTERVAL iterations with the number of 
+ *  iterations done out of \a total (\a total is 0 if unknown), if it returns 1 
+ *  the loop stops early and the result only covers the iterations done.
+ */
+struct GCA_Progress_struct
+{
+	/** @brief The callback.*/
+	GCA_ProgressFunc f;
+	/** @brief User data passed to the callback.*/
+	void *arg;
+};
+
+/** @brief A counter-based random number stream structure.
+ *  @details The \a ith output of the stream is a pure function of (\a key, \a i), so 
+ *  streams derived from the same seed are reproducible and independent of the order 
+ *  (or thread) in which they are consumed.
+ */
+struct GCA_RandStream_struct
+{
+	/** @brief Stream key derived from the user seed and stream id.*/
+	unsigned long long key;
+	/** @brief Number of values drawn so far.*/
+	unsigned long long ctr;
+};
+
+/** @brief A compressed window row structure.
+ *  @details A keyframe holds the row. Other rows hold the row XOR the next newer 
+ *  row, either as \a n (index, chunk) pairs for the chunks that differ or, if most
+ *  of them do, as a whole row.
+ */
+struct GCA_WindowRow_struct
+{
+	/** @brief Hash of the row (not of the delta).*/
+	unsigned long long hash;
+	/** @brief Chunks of the row or delta.*/
+	chunk *data;
+	/** @brief Chunk indices of a sparse delta.*/
+	unsigned int *idx;
+	/** @brief Number of chunks stored.*/
+	unsigned int n;
+	/** @brief Number of chunks and indices allocated.*/
+	unsigned int cap;
+	unsigned int icap;
+	/** @brief GCA_WINDOW_KEY, GCA_WINDOW_SPARSE or GCA_WINDOW_XOR.*/
+	unsigned char type;
+};
+
+/** @brief A compressed window structure.
+ *  @details Only the GCA_WINDOW_DENSE most recent rows are kept in \a st_pattern. 
+ *  Older rows are pushed into a ring of compressed rows as they leave, the row of
+ *  age t (t >= GCA_WINDOW_DENSE) being push number \a pushed - 1 - (t - GCA_WINDOW_DENSE).
+ *  Rows are rebuilt from the nearest newer keyframe, cached row or the oldest dense
+ *  row, so reading a row costs at most \a keyint deltas.
+ */
+struct GCA_Window_struct
+{
+	/** @brief The ring of compressed rows.*/
+	GCA_WindowRow *rows;
+	/** @brief Number of rows in the ring, WSIZE - GCA_WINDOW_DENSE.*/
+	unsigned int nrows;
+	/** @brief Number of compressed rows between keyframes.*/
+	unsigned int keyint;
+	/** @brief Number of rows pushed since the window was cleared.*/
+	unsigned long long pushed;
+	/** @brief Decompressed rows and their push numbers (~0 if unused).*/
+	chunk *cache[GCA_WINDOW_CACHE];
+	unsigned long long cache_id[GCA_WINDOW_CACHE];
+	/** @brief Next cache slot to replace.*/
+	unsigned int next;
+	/** @brief A row of zeros, for rows not yet pushed.*/
+	chunk *zero;
+	/** @brief Hash of a row of zeros.*/
+	unsigned long long zero_hash;
+	/** @brief A row kept in reserve, so a row can still be stored whole if its delta can 
+	 *  not be allocated (NULL once used, until it can be replaced).*/
+	chunk *spare;
+	/** @brief Rows with push numbers below this were lost to a failed allocation, they 
+	 *  read as zeros and are never matched by IsAttCyc().*/
+	unsigned long long lost;
+};
+
 /** @brief A Graph Cellular Automaton parameter structure.*/
 struct CellularAutomatonParameters_struct
 {
@@ -189,8 +351,22 @@ struct GraphCellularAutomaton_struct
 	chunk *config; 
 	/** @brief Spatio-temporal pattern.*/
 	chunk **st_pattern;
+	/** @brief Compressed window (see CompressWindow()), NULL if the window is dense.*/
+	GCA_Window *win;
 	/** @brief Cellular Automaton Parameters.*/
 	CellularAutomatonParameters *params;
+	/** @brief Random stream used for noise initial conditions, rand() is used if NULL.*/
+	GCA_RandStream *rng;
+	/** @brief Flags memory borrowed from another GCA (see CloneGCA()).*/
+	unsigned char shared;
+	/** @brief File mapping the graph and LUT were borrowed from (see MapGCA()).*/
+	void *map;
+	/** @brief Length of the file mapping.*/
+	size_t maplen;
+	/** @brief File mapping the rows (and possibly graph) were moved to (see OutOfCoreGCA()).*/
+	void *rowmap;
+	/** @brief Length of the row mapping.*/
+	size_t rowmaplen;
 };
 
 /*function prototypes*/
@@ -202,6 +378,28 @@ CellularAutomatonParameters *CreateCAParams(unsigned char nh_type,mesh *m,state
 GraphCellularAutomaton *CreateECA(unsigned int N,unsigned int k,unsigned int rule,unsigned int ws);
 GraphCellularAutomaton *CreateGCA(CellularAutomatonParameters *params);
 GraphCellularAutomaton *CopyGCA(GraphCellularAutomaton *GCA);
+GraphCellularAutomaton *CloneGCA(GraphCellularAutomaton *GCA);
+GraphCellularAutomaton *CloneGCAWindow(GraphCellularAutomaton *GCA,unsigned int ws);
+GraphCellularAutomaton *MapGCA(CellularAutomatonParameters *params,state *LUT,chunk *window,void *map,size_t maplen);
+void FreeGCA(GraphCellularAutomaton *GCA);
+unsigned char OutOfCoreGCA(GraphCellularAutomaton *GCA,int fd);
+unsigned char CompressWindow(GraphCellularAutomaton *GCA,unsigned int keyint);
+void ClearWindow(GraphCellularAutomaton *GCA);
+chunk *GetWindowRow(GraphCellularAutomaton *GCA,unsigned int t);
+unsigned char BuildRuleLUT(GraphCellularAutomaton *GCA,state *LUT,unsigned char rule_type,unsigned int rule);
+unsigned char SetCARule(GraphCellularAutomaton *GCA,unsigned char rule_type,unsigned int rule);
+unsigned char IsRingTopology(GraphCellularAutomaton *GCA);
+unsigned char CanonicalRuleLUT(GraphCellularAutomaton *GCA,state *LUT,state *canon,unsigned char reflect);
+
+/*random streams*/
+void SeedRandStream(GCA_RandStream *rs,unsigned long long seed,unsigned long long stream);
+void GCA_SetCounters(GCA_Counters *c);
+GCA_Counters *GCA_GetCounters(void);
+void GCA_AddCounters(GCA_Counters *dst,GCA_Counters *src);
+void GCA_SetProgress(GCA_Progress *p);
+GCA_Progress *GCA_GetProgress(void);
+unsigned char GCA_ReportProgress(unsigned long long done,unsigned long long total);
+unsigned long long RandStreamNext(GCA_RandStream *rs);
 
 /* cell and config get/sets functions*/
 void SetCAIC(GraphCellularAutomaton *GCA,chunk *ic,unsigned char type);
@@ -219,7 +417,8 @@ unsigned int GetNeighbourhood_config_external(GraphCellularAutomaton * GCA,chunk
 void CASimTSteps(GraphCellularAutomaton *GCA,unsigned int t);
 unsigned int CANextStep(GraphCellularAutomaton *GCA);
 chunk* CASimToAttCyc(GraphCellularAutomaton *GCA,unsigned int t);
-unsigned char IsAttCyc(GraphCellularAutomaton *GCA);
+unsigned int CASimToAttLength(GraphCellularAutomaton *GCA,unsigned int t);
+unsigned int IsAttCyc(GraphCellularAutomaton *GCA);
 chunk *CAGetPreImages(GraphCellularAutomaton *GCA,unsigned int* n,unsigned char* flags);
 unsigned char NhElim(GraphCellularAutomaton *GCA,unsigned char *flags,state *theta_i,state *theta_j,unsigned int startcell);
 unsigned char *GetFlags(GraphCellularAutomaton *GCA);
@@ -237,6 +436,7 @@ float Z_param(GraphCellularAutomaton *GCA);
 float G_density(GraphCellularAutomaton *GCA,chunk* ics, unsigned int n);
 float AttLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigned int t);
 float TransLength(GraphCellularAutomaton *GCA,chunk *ics, unsigned int n,unsigned int t);
+unsigned char AttTransLength(GraphCellularAutomaton *GCA,chunk *ics,unsigned int t,float *C,float *T);
 float* PopDensity(GraphCellularAutomaton *GCA,chunk* ics,unsigned int T, float *dense);
 
 #endif
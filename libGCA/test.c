@@ -15,6 +15,8 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 #include <time.h>
 #include "GCA.h"
 #define P 50
@@ -865,8 +867,264 @@ int benchmarkRevAlg(int argc,char **argv)
 	}
 }
 
+/* checkAttTransLength(): the memoised pass over an IC range must agree with 
+ * AttLength() and TransLength() simulating each IC in turn, including the limits
+ * set by t and the window size*/
+int checkAttTransLength(void)
+{
+	unsigned int N[3] = {8,10,10};
+	unsigned int ws[3] = {16,32,64};
+	unsigned int tmax[3] = {40,20,5};
+	unsigned int c,r,n,fails;
+	chunk range[2];
+	chunk *ics;
+	float C,T,C0,T0;
+	GraphCellularAutomaton *ECA;
+
+	fails = 0;
+	for (c=0;c<3;c++)
+	{
+		n = 0x1u << N[c];
+		ics = (chunk *)malloc(n*sizeof(chunk));
+		for (r=0;r<n;r++)
+		{
+			ics[r] = (chunk)r;
+		}
+		range[0] = 0;
+		range[1] = (chunk)n;
+		for (r=0;r<256;r++)
+		{
+			ECA = CreateECA(N[c],3,r,ws[c]);
+			C0 = AttLength(ECA,ics,n,tmax[c]);
+			T0 = TransLength(ECA,ics,n,tmax[c]);
+			if (!AttTransLength(ECA,range,tmax[c],&C,&T) 
+				|| fabs(C - C0) > 1e-5*C0 || fabs(T - T0) > 1e-5*T0)
+			{
+				printf("AttTransLength: N=%u rule=%u t=%u C=%f (%f) T=%f (%f)\n",N[c],r,tmax[c],C,C0,T,T0);
+				fails++;
+			}
+			FreeGCA(ECA);
+		}
+		free(ics);
+	}
+	return fails;
+}
+
+/* checkCompressWindow(): a compressed window must read back the same rows and
+ * detect the same cycles as the dense window*/
+int checkCompressWindow(void)
+{
+	unsigned int rules[5] = {30,45,90,110,184};
+	unsigned int keyint[2] = {0,3};
+	unsigned int r,c,i,t,tn,step,fails;
+	unsigned int a,b;
+	chunk *ic;
+	GraphCellularAutomaton *dense,*comp;
+
+	fails = 0;
+	srand(1);
+	for (r=0;r<5;r++)
+	{
+		for (c=0;c<2;c++)
+		{
+			dense = CreateECA(24,3,rules[r],150);
+			comp = CreateECA(24,3,rules[r],150);
+			if (!CompressWindow(comp,keyint[c]))
+			{
+				printf("CompressWindow: failed\n");
+				FreeGCA(dense);
+				FreeGCA(comp);
+				return fails + 1;
+			}
+			ic = (chunk *)malloc((dense->size)*sizeof(chunk));
+			for (i=0;i<dense->size;i++)
+			{
+				ic[i] = (chunk)rand();
+			}
+			SetCAIC(dense,ic,EXPLICIT_IC_TYPE);
+			SetCAIC(comp,ic,EXPLICIT_IC_TYPE);
+			ResetCA(dense);
+			ResetCA(comp);
+			free(ic);
+			for (step=0;step<400;step++)
+			{
+				a = IsAttCyc(dense);
+				b = IsAttCyc(comp);
+				if (a != b)
+				{
+					printf("IsAttCyc: rule=%u keyint=%u t=%u %u != %u\n",rules[r],keyint[c],dense->t,b,a);
+					fails++;
+					break;
+				}
+				tn = (dense->t < 150) ? dense->t : 149;
+				for (t=0;t<=tn;t++)
+				{
+					for (i=0;i<24;i++)
+					{
+						if (GetCellStatePacked(dense,i,t) != GetCellStatePacked(comp,i,t))
+						{
+							break;
+						}
+					}
+					if (i < 24)
+					{
+						printf("GetCellStatePacked: rule=%u keyint=%u t=%u row %u differs\n",rules[r],keyint[c],dense->t,t);
+						fails++;
+						break;
+					}
+				}
+				if (t <= tn)
+				{
+					break;
+				}
+				CANextStep(dense);
+				CANextStep(comp);
+			}
+			FreeGCA(dense);
+			FreeGCA(comp);
+		}
+	}
+	return fails;
+}
+
+/* checkPaddedNeighbourhoods(): cells with fewer than k-1 neighbours have rows 
+ * padded with 0xFFFFFFFF, only their real neighbours may be read*/
+int checkPaddedNeighbourhoods(void)
+{
+	/*a star, cell 0 joined to 1,2,3,4, cell 4 also to 3*/
+	unsigned int graph[20] = {1,2,3,4, 0,0xFFFFFFFF,0xFFFFFFFF,0xFFFFFFFF, 0,0xFFFFFFFF,0xFFFFFFFF,0xFFFFFFFF,
+		0,4,0xFFFFFFFF,0xFFFFFFFF, 0,3,0xFFFFFFFF,0xFFFFFFFF};
+	unsigned int i,j,x,nhood,expect,fails;
+	chunk ic;
+	CellularAutomatonParameters *params;
+	GraphCellularAutomaton *GCA;
+
+	fails = 0;
+	params = (CellularAutomatonParameters *)malloc(sizeof(CellularAutomatonParameters));
+	params->N = 5;
+	params->WSIZE = 8;
+	params->rule = 0x6996A55A;
+	params->s = 2;
+	params->rule_type = CODE_RULE_TYPE;
+	params->k = 5;
+	params->graph = (unsigned int *)malloc(sizeof(graph));
+	memcpy((void *)(params->graph),(void *)graph,sizeof(graph));
+	GCA = CreateGCA(params);
+	for (x=0;x<32;x++)
+	{
+		ic = (chunk)x;
+		SetCAIC(GCA,&ic,EXPLICIT_IC_TYPE);
+		ResetCA(GCA);
+		for (i=0;i<5;i++)
+		{
+			/*the cell itself is in the middle, missing neighbours read as 0*/
+			expect = ((x >> i) & 0x1) << 2;
+			for (j=0;j<4 && graph[i*4+j] != 0xFFFFFFFF;j++)
+			{
+				expect |= ((x >> graph[i*4+j]) & 0x1) << ((j < 2) ? j : j+1);
+			}
+			nhood = GetNeighbourhood_config(GCA,i,0);
+			if (nhood != expect || GetNeighbourhood_config_external(GCA,GCA->config,i) != expect)
+			{
+				printf("GetNeighbourhood_config: x=%u cell=%u %x != %x\n",x,i,nhood,expect);
+				fails++;
+			}
+		}
+		/*the update must read the same neighbourhoods*/
+		CANextStep(GCA);
+		for (i=0;i<5;i++)
+		{
+			if (GetCellStatePacked(GCA,i,0) != GCA->ruleLUT[GetNeighbourhood_config(GCA,i,1)])
+			{
+				printf("CANextStep: x=%u cell=%u\n",x,i);
+				fails++;
+			}
+		}
+	}
+	FreeGCA(GCA);
+	return fails;
+}
+
+/* checkCanonicalRules(): the ECA rules fall into 88 classes under complement 
+ * and reflection (136 under complement alone)*/
+int checkCanonicalRules(void)
+{
+	state LUT[8],canon[256][8],again[8];
+	unsigned int r,q,reflect,classes,fails;
+	unsigned int expect[2] = {136,88};
+	GraphCellularAutomaton *ECA,*ECA4;
+
+	fails = 0;
+	ECA = CreateECA(16,3,0,4);
+	if (!IsRingTopology(ECA))
+	{
+		printf("IsRingTopology: ECA is not a ring\n");
+		fails++;
+	}
+	/*with an even k the cell is not in the middle, so reflection is not a symmetry*/
+	ECA4 = CreateECA(16,4,0,4);
+	if (IsRingTopology(ECA4))
+	{
+		printf("IsRingTopology: k = 4 accepted as a ring\n");
+		fails++;
+	}
+	FreeGCA(ECA4);
+	for (reflect=0;reflect<2;reflect++)
+	{
+		classes = 0;
+		for (r=0;r<256;r++)
+		{
+			BuildRuleLUT(ECA,LUT,CODE_RULE_TYPE,r);
+			if (!CanonicalRuleLUT(ECA,LUT,canon[r],(unsigned char)reflect))
+			{
+				printf("CanonicalRuleLUT: rule %u failed\n",r);
+				fails++;
+			}
+			/*the canonical table is its own representative*/
+			CanonicalRuleLUT(ECA,canon[r],again,(unsigned char)reflect);
+			if (memcmp((void *)again,(void *)canon[r],sizeof(again)))
+			{
+				printf("CanonicalRuleLUT: rule %u not idempotent\n",r);
+				fails++;
+			}
+			for (q=0;q<r && memcmp((void *)canon[q],(void *)canon[r],sizeof(again));q++);
+			classes += (q == r);
+		}
+		if (classes != expect[reflect])
+		{
+			printf("CanonicalRuleLUT: %u classes, expected %u\n",classes,expect[reflect]);
+			fails++;
+		}
+	}
+	/*110, its complement 137, reflection 124 and both 193 are one class*/
+	if (memcmp((void *)canon[110],(void *)canon[137],sizeof(again)) || memcmp((void *)canon[110],(void *)canon[124],sizeof(again))
+		|| memcmp((void *)canon[110],(void *)canon[193],sizeof(again)) || !memcmp((void *)canon[110],(void *)canon[30],sizeof(again)))
+	{
+		printf("CanonicalRuleLUT: rule 110 class is wrong\n");
+		fails++;
+	}
+	FreeGCA(ECA);
+	return fails;
+}
+
+/* testChecks(): runs the self checks, returns non-zero if any fail*/
+int testChecks(void)
+{
+	unsigned int fails;
+	fails = checkAttTransLength();
+	fails += checkCompressWindow();
+	fails += checkPaddedNeighbourhoods();
+	fails += checkCanonicalRules();
+	printf("libGCA checks: %s\n",(fails == 0) ? "passed" : "FAILED");
+	return (fails != 0);
+}
+
 int main(int argc, char** argv)
 {
+	if (argc == 2 && !strcmp(argv[1],"-check"))
+	{
+		return testChecks();
+	}
 	/*testbitaccess(argc,argv);*/
 	/*testECA(argc,argv);*/
 	/*testRevAlgorithm(argc,argv);*/
@@ -47,6 +47,10 @@
  *       v 0.060 (13/02/2013) - Added support for genus-2 topolog mesh creation.
  *       v 0.075 (19/06/2013) - Modified routines with use the vectorMath libraries to 
  *                              use the new memory passing to avoid mallocs.
+ *       v 0.080 (19/10/2026) - Readers map the file and parse it in one pass, 
+ *                              implemented ReadOBJ, ReadSTL, ReadVRML, ReadPLY,
+ *                              WritePLY, MeshFormat and FreeMesh. Lists grow 
+ *                              geometrically.
  *
  *
  * Descritpion: Implementation of mesh construction and manipulation functions
@@ -65,6 +69,12 @@
  */
  
 #include "mesh.h"
+#include <stdlib.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 /** @brief Allocates memory for a vertex list.
  *
@@ -114,7 +124,7 @@ r_code InsertVertex(vertexList *vList,float *v)
 	{
 		int newsize;
 		float *newverts;
-		newsize = vList->size + REALLOC_EXTRA;
+		newsize = vList->size + ((vList->size > REALLOC_EXTRA) ? vList->size : REALLOC_EXTRA);
 		newverts = (float*)realloc(vList->verts,newsize*(vList->dim)*sizeof(float));
 		if (!newverts)
 		{
@@ -278,7 +288,7 @@ r_code InsertFace(faceList *fList,int *face,unsigned char type)
 		int newsize;
 		int *newfaces;
 		unsigned char *newtypes;
-		newsize = fList->size + REALLOC_EXTRA;
+		newsize = fList->size + ((fList->size > REALLOC_EXTRA) ? fList->size : REALLOC_EXTRA);
 		newfaces = (int*)realloc(fList->faces,newsize*(fList->maxVerts)*sizeof(int));
 		if (!newfaces)
 		{
@@ -536,6 +546,30 @@ mesh * CreateMesh(int numVerts,int dim,int numFaces, int maxVerts)
 	return m;
 }
 
+/** @brief Frees a mesh and its vertex and face lists.
+ *
+ * @param m The mesh to free (can be NULL).
+ */
+void FreeMesh(mesh *m)
+{
+	if (!m)
+	{
+		return;
+	}
+	if (m->vList)
+	{
+		free(m->vList->verts);
+		free(m->vList);
+	}
+	if (m->fList)
+	{
+		free(m->fList->faces);
+		free(m->fList->faceTypes);
+		free(m->fList);
+	}
+	free(m);
+}
+
 /** @brief Creates a new mesh structure which is an exact copy for the 
  *  given mesh m.
  * 
@@ -1551,244 +1585,873 @@ mesh * CreateMeshTopology(int numFaces,int genus)
 	return m;
 }
 
-/** @brief Reads a mesh from given format.
- *
- * @param filename The name of input file.
- * @param format The format of the input file.
- *
- * @returns A pointer to a valid mesh if successful.
- * @retVal NULL If and error occurred.
- *
- * @note This is basically a wrapper for fixed format readers.
+/** @brief A mesh file mapped into memory for parsing.*/
+typedef struct meshScanner_struct meshScanner;
+struct meshScanner_struct
+{
+	/** @brief The file contents (not null terminated).*/
+	char *buf;
+	/** @brief The length of the file.*/
+	size_t len;
+	/** @brief The parse position.*/
+	size_t pos;
+	/** @brief Character starting a comment that runs to the end of the line, 0 for none.*/
+	char comment;
+};
+
+/** @brief Maps a file for parsing.
+ *
+ * @retVal READ_SUCCESS on success.
+ * @retVal READ_FAILED if the file could not be mapped.
  */
-mesh * LoadMesh(char *filename,unsigned char format)
+static r_code OpenScanner(meshScanner *sc,char *filename,char comment)
 {
-	mesh *m;
-	int rc;
-	switch (format)
+	int fd;
+	struct stat st;
+	sc->buf = NULL;
+	sc->len = 0;
+	sc->pos = 0;
+	sc->comment = comment;
+	if ((fd = open(filename,O_RDONLY)) < 0)
 	{
-		default:
-		case OFF_FORMAT:
-			rc = ReadOFF(filename,&m);
-			break;
-		case OBJ_FORMAT:
-			rc = ReadOBJ(filename,&m);
-			break;
-		case STL_FORMAT:
-			rc = ReadSTL(filename,&m);
-			break;
-		case VRML_FORMAT:
-			rc = ReadVRML(filename,&m);
-			break;
+		return READ_FAILED;
 	}
-	if (CheckErr(rc))
+	if (fstat(fd,&st) < 0)
 	{
-		return NULL;
+		close(fd);
+		return READ_FAILED;
 	}
-	return m;
+	sc->len = (size_t)st.st_size;
+	if (sc->len > 0)
+	{
+		sc->buf = (char *)mmap(NULL,sc->len,PROT_READ,MAP_PRIVATE,fd,0);
+		if (sc->buf == MAP_FAILED)
+		{
+			sc->buf = NULL;
+			close(fd);
+			return READ_FAILED;
+		}
+		madvise((void *)(sc->buf),sc->len,MADV_SEQUENTIAL);
+	}
+	close(fd);
+	return READ_SUCCESS;
 }
 
-/** @brief writes mesh to given format.
- *
- * @param filename The name of output file.
- * @param m The mesh to write to file.
- * @param format The format of the output file.
- *
- * @retVal rc>0 on success.
- * @retVal rc<=0 on failure.
- *
- * @note This is basically a wrapper for fixed format writers.
- */
-r_code SaveMesh(char *filename, mesh *m,unsigned char format)
+/** @brief Unmaps a file.*/
+static void CloseScanner(meshScanner *sc)
 {
-	switch (format)
+	if (sc->buf != NULL)
 	{
-		default:
-		case OFF_FORMAT:
-			return WriteOFF(filename,m);
-			break;
-		case OBJ_FORMAT:
-			return WriteOBJ(filename,m);
-			break;
-		case STL_FORMAT:
-			return WriteSTL(filename,m);
-			break;
-		case VRML_FORMAT:
-			return WriteVRML(filename,m);
+		munmap((void *)(sc->buf),sc->len);
+	}
+}
+
+/** @brief Skips white space (including commas) and comments.*/
+static void ScanSpace(meshScanner *sc)
+{
+	char c;
+	while (sc->pos < sc->len)
+	{
+		c = sc->buf[sc->pos];
+		if (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',')
+		{
+			sc->pos++;
+		}
+		else if (c == sc->comment && c != 0)
+		{
+			while (sc->pos < sc->len && sc->buf[sc->pos] != '\n') sc->pos++;
+		}
+		else
+		{
 			break;
+		}
 	}
 }
 
-/** @brief writes mesh in *.off format.
- *
- * @param filename The name of the .off file.
- * @param m The mesh structure to write to file.
- * 
- * @retVal rc>0 on success.
- * @retVal rc<=0 on failure.
- *
- * @note In general this function should not be required to be called directly.
+/** @brief Skips spaces and tabs only.
+ * @returns 1 if the line has more to read, 0 at the end of the line (or a comment).
  */
-r_code WriteOFF(char *filename,mesh *m)
+static int ScanBlank(meshScanner *sc)
 {
-
-	FILE* fp;
-	int i,j,nv,nf,ne;
-	float *vert;
-	int *face;
-	int lastvert;
-	nv = m->vList->numVerts;
-	nf = m->fList->numFaces;
-
-	ne = 0;
-	for (i=0;i<nf;i++)
+	char c;
+	while (sc->pos < sc->len && (sc->buf[sc->pos] == ' ' || sc->buf[sc->pos] == '\t'))
 	{
-		ne += (int)(m->fList->faceTypes[i]);
+		sc->pos++;
 	}
+	if (sc->pos >= sc->len)
+	{
+		return 0;
+	}
+	c = sc->buf[sc->pos];
+	return !(c == '\n' || c == '\r' || (c == sc->comment && c != 0));
+}
 
-	if (!(fp = fopen(filename,"w")))
+/** @brief Moves to the start of the next line.*/
+static void ScanLine(meshScanner *sc)
+{
+	while (sc->pos < sc->len && sc->buf[sc->pos] != '\n') sc->pos++;
+	if (sc->pos < sc->len) sc->pos++;
+}
+
+/** @brief Reads a white space delimited word, truncated to \a n-1 characters.
+ * @returns The length of the word, 0 at the end of the file.
+ */
+static size_t ScanWord(meshScanner *sc,char *word,size_t n)
+{
+	size_t len;
+	char c;
+	ScanSpace(sc);
+	len = 0;
+	while (sc->pos < sc->len)
 	{
-		return WRITE_FAILED;
+		c = sc->buf[sc->pos];
+		if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+		{
+			break;
+		}
+		if (len + 1 < n)
+		{
+			word[len] = c;
+		}
+		len++;
+		sc->pos++;
 	}
-	fprintf(fp,"OFF\n");
-	fprintf(fp,"# no comment :)\n");
-	fprintf(fp,"%d %d %d\n",nv,nf,ne);
-	for (i=0;i<nv;i++)
+	word[(len < n) ? len : n-1] = '\0';
+	return len;
+}
+
+/** @brief Reads an integer.
+ * @returns 1 on success, 0 if there is no integer to read.
+ */
+static int ScanInt(meshScanner *sc,int *v)
+{
+	long long x;
+	int neg,any;
+	char c;
+	ScanSpace(sc);
+	neg = 0;
+	if (sc->pos < sc->len && (sc->buf[sc->pos] == '-' || sc->buf[sc->pos] == '+'))
 	{
-		vert = GetVertex_ptr(m->vList,i); 
-		fprintf(fp,"%f %f %f\n",vert[X],vert[Y],vert[Z]);
+		neg = (sc->buf[sc->pos++] == '-');
 	}
-	for (i=0;i<nf;i++)
+	x = 0;
+	any = 0;
+	while (sc->pos < sc->len && (c = sc->buf[sc->pos]) >= '0' && c <= '9')
 	{
-		face = GetFace_ptr(m->fList,i);
-		fprintf(fp,"%u",m->fList->faceTypes[i]);
-
-		for (j=0;j<m->fList->faceTypes[i];j++)
+		if (x < 0x80000000LL)
 		{
-			fprintf(fp," %d",face[j]);
+			x = x*10 + (c - '0');
 		}
-		fprintf(fp,"\n");
+		any = 1;
+		sc->pos++;
 	}
-	fclose(fp);
-	return WRITE_SUCCESS;
+	if (!any || x > 0x7FFFFFFFLL + neg)
+	{
+		return 0;
+	}
+	*v = (int)((neg) ? -x : x);
+	return 1;
 }
 
-/** @brief writes mesh in *.obj format.
+/** @brief Reads a decimal floating point number.
  *
- * @param filename The name of the .obj file.
- * @param m The mesh structure to write to file.
- * 
- * @retVal rc>0 on success.
- * @retVal rc<=0 on failure.
+ * @details Numbers of up to 15 significant digits with small exponents, i.e.,
+ * those any mesh writer produces, are converted exactly with one multiplication
+ * or division. Anything else is handed to strtod().
  *
- * @note In general this function should not be required to be called directly.
+ * @returns 1 on success, 0 if there is no number to read.
  */
-r_code WriteOBJ(char *filename,mesh *m)
+static int ScanDouble(meshScanner *sc,double *v)
 {
-	FILE* fp;
-	int i,j,nv,nf,ne;
-	float *vert;
-	int *face;
-
-	nv = m->vList->numVerts;
-	nf = m->fList->numFaces;
-	ne = 0;
-	for (i=0;i<nf;i++)
-	{
-		ne += (int)(m->fList->faceTypes[i]);
-	}
+	static const double pow10[] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,
+		1e11,1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+	unsigned long long mant;
+	int ndig,exp,e,esign,neg,any;
+	size_t start,p,q;
+	double x;
+	char c;
 
-	if (!(fp = fopen(filename,"w")))
+	ScanSpace(sc);
+	start = p = sc->pos;
+	neg = 0;
+	if (p < sc->len && (sc->buf[p] == '-' || sc->buf[p] == '+'))
 	{
-		return WRITE_FAILED;
+		neg = (sc->buf[p++] == '-');
 	}
-	fprintf(fp,"# no comment :)\n");
-	for (i=0;i<nv;i++)
+	mant = 0;
+	ndig = 0;
+	exp = 0;
+	any = 0;
+	while (p < sc->len && (c = sc->buf[p]) >= '0' && c <= '9')
 	{
-		vert = GetVertex_ptr(m->vList,i); 
-		fprintf(fp,"v %f %f %f\n",vert[X],vert[Y],vert[Z]);
+		if (ndig < 18)
+		{
+			mant = mant*10 + (c - '0');
+			ndig += (mant != 0);
+		}
+		else
+		{
+			exp++;
+		}
+		any = 1;
+		p++;
 	}
-	for (i=0;i<nf;i++)
+	if (p < sc->len && sc->buf[p] == '.')
 	{
-		face = GetFace_ptr(m->fList,i);
-		fprintf(fp,"f");
-		for (j=0;j<m->fList->faceTypes[i];j++)
+		p++;
+		while (p < sc->len && (c = sc->buf[p]) >= '0' && c <= '9')
 		{
-			fprintf(fp," %d",face[j]+1);
+			if (ndig < 18)
+			{
+				mant = mant*10 + (c - '0');
+				ndig += (mant != 0);
+				exp--;
+			}
+			any = 1;
+			p++;
 		}
-		fprintf(fp,"\n");
 	}
-	fclose(fp);
-	return WRITE_SUCCESS;
-}
-
-/** @brief writes mesh in *.stl format.
- *
- * @param filename The name of the .stl file.
- * @param m The mesh structure to write to file.
- * 
- * @retVal rc>0 on success.
- * @retVal rc<=0 on failure.
- *
- * @note In general this function should not be required to be called directly.
- */
-r_code WriteSTL(char *filename,mesh *m)
-{
-	FILE* fp;
-	int i,j,nv,nf,ne;
-	float *vert;
-	int *face;
-	float *v0,*v1,*vn;
-	int * e0,*e1,*en;
-	float *norm;
-	
-	if (!(fp = fopen(filename,"w")))
+	if (!any)
 	{
-		return WRITE_FAILED;
+		return 0;
 	}
-
-	if (!(norm = (float*)malloc(3*sizeof(float))))
+	if (p < sc->len && (sc->buf[p] == 'e' || sc->buf[p] == 'E'))
 	{
-		return OUT_OF_MEMORY;
+		q = p + 1;
+		esign = 1;
+		if (q < sc->len && (sc->buf[q] == '-' || sc->buf[q] == '+'))
+		{
+			esign = (sc->buf[q++] == '-') ? -1 : 1;
+		}
+		if (q < sc->len && sc->buf[q] >= '0' && sc->buf[q] <= '9')
+		{
+			e = 0;
+			while (q < sc->len && (c = sc->buf[q]) >= '0' && c <= '9')
+			{
+				if (e < 100000) e = e*10 + (c - '0');
+				q++;
+			}
+			exp += esign*e;
+			p = q;
+		}
 	}
-
-	
-	nv = m->vList->numVerts;
-	nf = m->fList->numFaces;
-	ne = 0;
-	for (i=0;i<nf;i++)
+	if (ndig <= 15 && exp >= -22 && exp <= 22)
 	{
-		ne += (int)(m->fList->faceTypes[i]);
+		x = (double)mant;
+		x = (exp < 0) ? x/pow10[-exp] : x*pow10[exp];
 	}
-	
-	fprintf(fp,"solid mesh\n");
-	for (i=0;i<nf;i++)
+	else
 	{
-		face = GetFace_ptr(m->fList,i);
-		v0 = GetVertex_ptr(m->vList,face[0]);
-		v1 = GetVertex_ptr(m->vList,face[1]);
-		vn = GetVertex_ptr(m->vList,face[m->fList->faceTypes[i]-1]);
-				
-		norm = Normal_f(v0, v1,vn,norm);
-		fprintf(fp,"facet ");
-		fprintf(fp,"normal %f %f %f\n",norm[X],norm[Y],norm[Z]);
-		fprintf(fp,"outer loop\n");
-		for (j=0;j<m->fList->faceTypes[i];j++)
+		char tmp[64];
+		if (p - start < sizeof(tmp))
 		{
-			vert = GetVertex_ptr(m->vList,face[j]);
-			fprintf(fp,"vertex %f %f %f\n",vert[X],vert[Y],vert[Z]);
+			memcpy((void *)tmp,(void *)(sc->buf + start),p - start);
+			tmp[p - start] = '\0';
+			x = strtod(tmp,NULL);
+			neg = 0;
+		}
+		else
+		{
+			x = (double)mant*pow(10.0,(double)exp);
 		}
-		fprintf(fp,"endloop\n");
-		fprintf(fp,"endfacet\n");
 	}
-	fprintf(fp,"endsolid mesh");
-	fclose(fp);
+	sc->pos = p;
+	*v = (neg) ? -x : x;
+	return 1;
+}
 
-	return WRITE_SUCCESS;
+/** @brief Reads a floating point number (see ScanDouble()).*/
+static int ScanFloat(meshScanner *sc,float *v)
+{
+	double x;
+	if (!ScanDouble(sc,&x))
+	{
+		return 0;
+	}
+	*v = (float)x;
+	return 1;
 }
 
-/** @brief writes mesh in *.vrml format.
- *
+/** @brief Moves past the next occurrence of the keyword \a key.
+ * @returns 1 if found, 0 otherwise.
+ */
+static int ScanFind(meshScanner *sc,const char *key)
+{
+	size_t n;
+	char c;
+	n = strlen(key);
+	while (sc->pos + n <= sc->len)
+	{
+		if (!memcmp((void *)(sc->buf + sc->pos),(void *)key,n)
+			&& (sc->pos == 0 || !isalnum((unsigned char)(sc->buf[sc->pos-1])))
+			&& (sc->pos + n == sc->len || !isalnum((unsigned char)(sc->buf[sc->pos+n]))))
+		{
+			sc->pos += n;
+			return 1;
+		}
+		c = sc->buf[sc->pos];
+		/*keywords in comments do not count*/
+		if (c == sc->comment && c != 0)
+		{
+			ScanLine(sc);
+			continue;
+		}
+		sc->pos++;
+	}
+	return 0;
+}
+
+/** @brief Stores a face at the end of the face list, growing the list (geometrically)
+ *  and its \a maxVerts as needed.
+ *
+ * @retVal INSERT_SUCCESS On success.
+ * @retVal INSERT_FAILED On failure.
+ */
+static r_code StoreFace(faceList *fList,int *face,int n)
+{
+	int i,j,size,maxVerts;
+	int *row;
+	if (fList->numFaces >= fList->size || n > fList->maxVerts)
+	{
+		int *newfaces;
+		unsigned char *newtypes;
+		size = (fList->numFaces >= fList->size) ? 2*(fList->size) + REALLOC_EXTRA : fList->size;
+		maxVerts = (n > fList->maxVerts) ? n : fList->maxVerts;
+		newfaces = (int *)realloc(fList->faces,(size_t)size*maxVerts*sizeof(int));
+		if (!newfaces)
+		{
+			return INSERT_FAILED;
+		}
+		fList->faces = newfaces;
+		newtypes = (unsigned char *)realloc(fList->faceTypes,size*sizeof(unsigned char));
+		if (!newtypes)
+		{
+			return INSERT_FAILED;
+		}
+		fList->faceTypes = newtypes;
+		/*faces move to wider rows, from the last so nothing is overwritten*/
+		if (maxVerts != fList->maxVerts)
+		{
+			for (i=fList->numFaces-1;i>=0;i--)
+			{
+				for (j=maxVerts-1;j>=0;j--)
+				{
+					newfaces[i*maxVerts+j] = (j < fList->maxVerts) ? newfaces[i*(fList->maxVerts)+j] : 0;
+				}
+			}
+		}
+		fList->size = size;
+		fList->maxVerts = maxVerts;
+	}
+	row = fList->faces + (size_t)(fList->numFaces)*(fList->maxVerts);
+	for (j=0;j<fList->maxVerts;j++)
+	{
+		row[j] = (j < n) ? face[j] : 0;
+	}
+	fList->faceTypes[fList->numFaces] = (unsigned char)n;
+	fList->numFaces++;
+	return INSERT_SUCCESS;
+}
+
+/** @brief Checks every face only references vertices of the mesh.*/
+static r_code CheckFaces(mesh *m)
+{
+	int i,j;
+	int *face;
+	for (i=0;i<m->fList->numFaces;i++)
+	{
+		face = GetFace_ptr(m->fList,i);
+		for (j=0;j<m->fList->faceTypes[i];j++)
+		{
+			if (face[j] < 0 || face[j] >= m->vList->numVerts)
+			{
+				return DATA_CORRUPTION;
+			}
+		}
+	}
+	return SUCCESS;
+}
+
+/** @brief A vertex and its index, for sorting.*/
+typedef struct meshWeldKey_struct meshWeldKey;
+struct meshWeldKey_struct
+{
+	float v[3];
+	int i;
+};
+
+static int CompareWeldKeys(const void *a,const void *b)
+{
+	const meshWeldKey *ka,*kb;
+	int j;
+	ka = (const meshWeldKey *)a;
+	kb = (const meshWeldKey *)b;
+	for (j=0;j<3;j++)
+	{
+		if (ka->v[j] < kb->v[j]) return -1;
+		if (ka->v[j] > kb->v[j]) return 1;
+	}
+	return (ka->i > kb->i) - (ka->i < kb->i);
+}
+
+/** @brief Merges identical vertices of a 3D mesh.
+ *
+ * @details Gives the same mesh as RemoveDuplicateVertices(), i.e., the first 
+ * of each set of identical vertices is kept and the order is preserved, but 
+ * finds them by sorting so it is fit for the millions of vertices of an STL file.
+ */
+static r_code WeldVertices(mesh *m)
+{
+	meshWeldKey *keys;
+	int *rep;
+	int i,j,k,n,N;
+	int *face;
+	float *verts;
+
+	N = m->vList->numVerts;
+	if (N == 0)
+	{
+		return SUCCESS;
+	}
+	keys = (meshWeldKey *)malloc(N*sizeof(meshWeldKey));
+	rep = (int *)malloc(N*sizeof(int));
+	if (!keys || !rep)
+	{
+		free(keys);
+		free(rep);
+		return OUT_OF_MEMORY;
+	}
+	verts = m->vList->verts;
+	for (i=0;i<N;i++)
+	{
+		memcpy((void *)(keys[i].v),(void *)(verts + 3*i),3*sizeof(float));
+		keys[i].i = i;
+	}
+	qsort((void *)keys,N,sizeof(meshWeldKey),&CompareWeldKeys);
+	/*each vertex is represented by the first identical one*/
+	for (i=0;i<N;i=j)
+	{
+		rep[keys[i].i] = keys[i].i;
+		for (j=i+1;j<N && keys[j].v[0] == keys[i].v[0] && keys[j].v[1] == keys[i].v[1] && keys[j].v[2] == keys[i].v[2];j++)
+		{
+			rep[keys[j].i] = keys[i].i;
+		}
+	}
+	free(keys);
+	/*close up the kept vertices, rep becomes the new index*/
+	for (i=0,n=0;i<N;i++)
+	{
+		if (rep[i] == i)
+		{
+			for (k=0;k<3;k++)
+			{
+				verts[3*n+k] = verts[3*i+k];
+			}
+			rep[i] = n++;
+		}
+		else
+		{
+			rep[i] = rep[rep[i]];
+		}
+	}
+	m->vList->numVerts = n;
+	for (i=0;i<m->fList->numFaces;i++)
+	{
+		face = GetFace_ptr(m->fList,i);
+		for (j=0;j<m->fList->faceTypes[i];j++)
+		{
+			face[j] = rep[face[j]];
+		}
+	}
+	free(rep);
+	return SUCCESS;
+}
+
+
+/*PLY file formats, binary files are either in the byte order of the host or not*/
+#define PLY_ASCII 	0
+#define PLY_LITTLE 	1
+#define PLY_BIG 	2
+#define PLY_NATIVE 	3
+#define PLY_SWAPPED 4
+/*PLY element and property roles, vertex coordinates are X, Y and Z*/
+#define PLY_OTHER 	3
+#define PLY_VERTEX 	4
+#define PLY_FACE 	5
+#define PLY_INDICES 6
+/*the largest PLY header read*/
+#define PLY_MAX_ELEMENTS 	16
+#define PLY_MAX_PROPERTIES 	32
+
+/** @brief A PLY property, lists have a count type.*/
+typedef struct plyProperty_struct plyProperty;
+struct plyProperty_struct
+{
+	int type;
+	int count;
+	int role;
+};
+
+/** @brief A PLY element.*/
+typedef struct plyElement_struct plyElement;
+struct plyElement_struct
+{
+	int role;
+	int count;
+	int nprops;
+	plyProperty props[PLY_MAX_PROPERTIES];
+};
+
+/** @brief Sizes of PLY property types, the type is an index.*/
+static const int plyTypeSize[] = {0,1,1,2,2,4,4,4,8};
+
+/** @brief Looks up a PLY property type.
+ * @returns The type, 0 if unknown.
+ */
+static int PlyType(char *word)
+{
+	static const char *names[] = {"","char","uchar","short","ushort","int","uint","float","double",
+		"","int8","uint8","int16","uint16","int32","uint32","float32","float64"};
+	int i;
+	for (i=1;i<18;i++)
+	{
+		if (!strcmp(word,names[i]))
+		{
+			return i % 9;
+		}
+	}
+	return 0;
+}
+
+/** @brief Reads a PLY property value.
+ * @returns 1 on success, 0 at the end of the file.
+ */
+static int ScanPly(meshScanner *sc,int format,int type,double *v)
+{
+	union
+	{
+		unsigned char b[8];
+		signed char i8;
+		unsigned char u8;
+		short i16;
+		unsigned short u16;
+		int i32;
+		unsigned int u32;
+		float f32;
+		double f64;
+	} u;
+	int size,i;
+	if (format == PLY_ASCII)
+	{
+		return ScanDouble(sc,v);
+	}
+	size = plyTypeSize[type];
+	if (sc->pos + size > sc->len)
+	{
+		return 0;
+	}
+	for (i=0;i<size;i++)
+	{
+		u.b[(format == PLY_SWAPPED) ? size-1-i : i] = (unsigned char)(sc->buf[sc->pos + i]);
+	}
+	sc->pos += size;
+	switch (type)
+	{
+		case 1: *v = (double)u.i8; break;
+		case 2: *v = (double)u.u8; break;
+		case 3: *v = (double)u.i16; break;
+		case 4: *v = (double)u.u16; break;
+		case 5: *v = (double)u.i32; break;
+		case 6: *v = (double)u.u32; break;
+		case 7: *v = (double)u.f32; break;
+		default: *v = u.f64; break;
+	}
+	return 1;
+}
+
+/** @brief Determines a mesh file format from the file name extension.
+ *
+ * @param filename The name of the mesh file.
+ *
+ * @returns The format, OFF_FORMAT if the extension is not known.
+ */
+unsigned char MeshFormat(char *filename)
+{
+	char ext[8];
+	char *dot;
+	int i;
+	if (!(dot = strrchr(filename,'.')) || strchr(dot,'/') || strlen(dot+1) >= sizeof(ext))
+	{
+		return OFF_FORMAT;
+	}
+	for (i=0;dot[i+1] != '\0';i++)
+	{
+		ext[i] = (char)tolower((unsigned char)dot[i+1]);
+	}
+	ext[i] = '\0';
+	if (!strcmp(ext,"obj"))
+	{
+		return OBJ_FORMAT;
+	}
+	else if (!strcmp(ext,"stl"))
+	{
+		return STL_FORMAT;
+	}
+	else if (!strcmp(ext,"wrl") || !strcmp(ext,"vrml"))
+	{
+		return VRML_FORMAT;
+	}
+	else if (!strcmp(ext,"ply"))
+	{
+		return PLY_FORMAT;
+	}
+	return OFF_FORMAT;
+}
+
+/** @brief Reads a mesh from given format.
+ *
+ * @param filename The name of input file.
+ * @param format The format of the input file.
+ *
+ * @returns A pointer to a valid mesh if successful.
+ * @retVal NULL If and error occurred.
+ *
+ * @note This is basically a wrapper for fixed format readers.
+ */
+mesh * LoadMesh(char *filename,unsigned char format)
+{
+	mesh *m;
+	int rc;
+	switch (format)
+	{
+		default:
+		case OFF_FORMAT:
+			rc = ReadOFF(filename,&m);
+			break;
+		case OBJ_FORMAT:
+			rc = ReadOBJ(filename,&m);
+			break;
+		case STL_FORMAT:
+			rc = ReadSTL(filename,&m);
+			break;
+		case VRML_FORMAT:
+			rc = ReadVRML(filename,&m);
+			break;
+		case PLY_FORMAT:
+			rc = ReadPLY(filename,&m);
+			break;
+	}
+	if (CheckErr(rc))
+	{
+		return NULL;
+	}
+	return m;
+}
+
+/** @brief writes mesh to given format.
+ *
+ * @param filename The name of output file.
+ * @param m The mesh to write to file.
+ * @param format The format of the output file.
+ *
+ * @retVal rc>0 on success.
+ * @retVal rc<=0 on failure.
+ *
+ * @note This is basically a wrapper for fixed format writers.
+ */
+r_code SaveMesh(char *filename, mesh *m,unsigned char format)
+{
+	switch (format)
+	{
+		default:
+		case OFF_FORMAT:
+			return WriteOFF(filename,m);
+			break;
+		case OBJ_FORMAT:
+			return WriteOBJ(filename,m);
+			break;
+		case STL_FORMAT:
+			return WriteSTL(filename,m);
+			break;
+		case VRML_FORMAT:
+			return WriteVRML(filename,m);
+			break;
+		case PLY_FORMAT:
+			return WritePLY(filename,m);
+			break;
+	}
+}
+
+/** @brief writes mesh in *.off format.
+ *
+ * @param filename The name of the .off file.
+ * @param m The mesh structure to write to file.
+ * 
+ * @retVal rc>0 on success.
+ * @retVal rc<=0 on failure.
+ *
+ * @note In general this function should not be required to be called directly.
+ */
+r_code WriteOFF(char *filename,mesh *m)
+{
+
+	FILE* fp;
+	int i,j,nv,nf,ne;
+	float *vert;
+	int *face;
+	int lastvert;
+	nv = m->vList->numVerts;
+	nf = m->fList->numFaces;
+
+	ne = 0;
+	for (i=0;i<nf;i++)
+	{
+		ne += (int)(m->fList->faceTypes[i]);
+	}
+
+	if (!(fp = fopen(filename,"w")))
+	{
+		return WRITE_FAILED;
+	}
+	fprintf(fp,"OFF\n");
+	fprintf(fp,"# no comment :)\n");
+	fprintf(fp,"%d %d %d\n",nv,nf,ne);
+	for (i=0;i<nv;i++)
+	{
+		vert = GetVertex_ptr(m->vList,i); 
+		fprintf(fp,"%f %f %f\n",vert[X],vert[Y],vert[Z]);
+	}
+	for (i=0;i<nf;i++)
+	{
+		face = GetFace_ptr(m->fList,i);
+		fprintf(fp,"%u",m->fList->faceTypes[i]);
+
+		for (j=0;j<m->fList->faceTypes[i];j++)
+		{
+			fprintf(fp," %d",face[j]);
+		}
+		fprintf(fp,"\n");
+	}
+	fclose(fp);
+	return WRITE_SUCCESS;
+}
+
+/** @brief writes mesh in *.obj format.
+ *
+ * @param filename The name of the .obj file.
+ * @param m The mesh structure to write to file.
+ * 
+ * @retVal rc>0 on success.
+ * @retVal rc<=0 on failure.
+ *
+ * @note In general this function should not be required to be called directly.
+ */
+r_code WriteOBJ(char *filename,mesh *m)
+{
+	FILE* fp;
+	int i,j,nv,nf,ne;
+	float *vert;
+	int *face;
+
+	nv = m->vList->numVerts;
+	nf = m->fList->numFaces;
+	ne = 0;
+	for (i=0;i<nf;i++)
+	{
+		ne += (int)(m->fList->faceTypes[i]);
+	}
+
+	if (!(fp = fopen(filename,"w")))
+	{
+		return WRITE_FAILED;
+	}
+	fprintf(fp,"# no comment :)\n");
+	for (i=0;i<nv;i++)
+	{
+		vert = GetVertex_ptr(m->vList,i); 
+		fprintf(fp,"v %f %f %f\n",vert[X],vert[Y],vert[Z]);
+	}
+	for (i=0;i<nf;i++)
+	{
+		face = GetFace_ptr(m->fList,i);
+		fprintf(fp,"f");
+		for (j=0;j<m->fList->faceTypes[i];j++)
+		{
+			fprintf(fp," %d",face[j]+1);
+		}
+		fprintf(fp,"\n");
+	}
+	fclose(fp);
+	return WRITE_SUCCESS;
+}
+
+/** @brief writes mesh in *.stl format.
+ *
+ * @param filename The name of the .stl file.
+ * @param m The mesh structure to write to file.
+ * 
+ * @retVal rc>0 on success.
+ * @retVal rc<=0 on failure.
+ *
+ * @note In general this function should not be required to be called directly.
+ */
+r_code WriteSTL(char *filename,mesh *m)
+{
+	FILE* fp;
+	int i,j,nv,nf,ne;
+	float *vert;
+	int *face;
+	float *v0,*v1,*vn;
+	int * e0,*e1,*en;
+	float *norm;
+	
+	if (!(fp = fopen(filename,"w")))
+	{
+		return WRITE_FAILED;
+	}
+
+	if (!(norm = (float*)malloc(3*sizeof(float))))
+	{
+		return OUT_OF_MEMORY;
+	}
+
+	
+	nv = m->vList->numVerts;
+	nf = m->fList->numFaces;
+	ne = 0;
+	for (i=0;i<nf;i++)
+	{
+		ne += (int)(m->fList->faceTypes[i]);
+	}
+	
+	fprintf(fp,"solid mesh\n");
+	for (i=0;i<nf;i++)
+	{
+		face = GetFace_ptr(m->fList,i);
+		v0 = GetVertex_ptr(m->vList,face[0]);
+		v1 = GetVertex_ptr(m->vList,face[1]);
+		vn = GetVertex_ptr(m->vList,face[m->fList->faceTypes[i]-1]);
+				
+		norm = Normal_f(v0, v1,vn,norm);
+		fprintf(fp,"facet ");
+		fprintf(fp,"normal %f %f %f\n",norm[X],norm[Y],norm[Z]);
+		fprintf(fp,"outer loop\n");
+		for (j=0;j<m->fList->faceTypes[i];j++)
+		{
+			vert = GetVertex_ptr(m->vList,face[j]);
+			fprintf(fp,"vertex %f %f %f\n",vert[X],vert[Y],vert[Z]);
+		}
+		fprintf(fp,"endloop\n");
+		fprintf(fp,"endfacet\n");
+	}
+	fprintf(fp,"endsolid mesh");
+	fclose(fp);
+
+	return WRITE_SUCCESS;
+}
+
+/** @brief writes mesh in *.vrml format.
+ *
  * @param filename The name of the .vrml file.
  * @param m The mesh structure to write to file.
  * 
@@ -1802,7 +2465,68 @@ r_code WriteVRML(char *filename,mesh *m)
 	return NOT_IMPLEMENTED;
 }
 
+/** @brief writes mesh in binary *.ply format.
+ *
+ * @param filename The name of the .ply file.
+ * @param m The mesh structure to write to file.
+ * 
+ * @retVal rc>0 on success.
+ * @retVal rc<=0 on failure.
+ *
+ * @note The file is written in the byte order of the host.
+ * @note In general this function should not be required to be called directly.
+ */
+r_code WritePLY(char *filename,mesh *m)
+{
+	FILE* fp;
+	int i,nv,nf;
+	unsigned char n;
+	unsigned int one;
+	r_code rc;
+
+	nv = m->vList->numVerts;
+	nf = m->fList->numFaces;
+	if (!(fp = fopen(filename,"wb")))
+	{
+		return WRITE_FAILED;
+	}
+	one = 1;
+	fprintf(fp,"ply\n");
+	fprintf(fp,"format %s 1.0\n",(*(unsigned char *)&one) ? "binary_little_endian" : "binary_big_endian");
+	fprintf(fp,"comment no comment :)\n");
+	fprintf(fp,"element vertex %d\n",nv);
+	fprintf(fp,"property float x\nproperty float y\nproperty float z\n");
+	fprintf(fp,"element face %d\n",nf);
+	fprintf(fp,"property list uchar int vertex_indices\n");
+	fprintf(fp,"end_header\n");
+	rc = WRITE_SUCCESS;
+	for (i=0;i<nv && rc == WRITE_SUCCESS;i++)
+	{
+		if (fwrite((void *)GetVertex_ptr(m->vList,i),sizeof(float),3,fp) != 3)
+		{
+			rc = WRITE_FAILED;
+		}
+	}
+	for (i=0;i<nf && rc == WRITE_SUCCESS;i++)
+	{
+		n = m->fList->faceTypes[i];
+		if (fwrite((void *)&n,sizeof(unsigned char),1,fp) != 1 
+			|| fwrite((void *)GetFace_ptr(m->fList,i),sizeof(int),n,fp) != n)
+		{
+			rc = WRITE_FAILED;
+		}
+	}
+	if (fclose(fp) != 0)
+	{
+		rc = WRITE_FAILED;
+	}
+	return rc;
+}
+
 /** @brief Imports a mesh from a  *.off file.
+ *
+ * @details The file is mapped and parsed in a single pass, the vertex and face
+ * lists are sized from the header and filled in place.
  *
  * @param filename The name of the .off file.
  * @param m A pointer to store the address of the new mesh.
@@ -1814,85 +2538,88 @@ r_code WriteVRML(char *filename,mesh *m)
  */
 r_code ReadOFF(char *filename, mesh **m)
 {
-	FILE *fp;
+	meshScanner sc;
 	int nv,nf,ne;
-	float vert[3];
-	int face[8];
-	char c;
+	int face[MAX_FACE_TYPE];
 	char buffer[25];
 	int i,j,k;
 	int faceVerts;
-	int maxVerts;
-    fpos_t pos;	
-	if (!(fp = fopen(filename,"r")))
+	float *vert;
+	r_code rc;
+
+	*m = NULL;
+	if (OpenScanner(&sc,filename,'#') != READ_SUCCESS)
 	{
 		return READ_FAILED; 	
 	}
-	/*first like must be this*/
-	fscanf(fp,"%s\n",buffer);
-	if ((buffer[0] != 'O') || (buffer[1] != 'F') || (buffer[2] != 'F'))
+	/*first word must be this*/
+	ScanWord(&sc,buffer,sizeof(buffer));
+	if (strncmp(buffer,"OFF",3) || !ScanInt(&sc,&nv) || !ScanInt(&sc,&nf) || !ScanInt(&sc,&ne) 
+		|| nv < 0 || nf < 0)
 	{
+		CloseScanner(&sc);
 		return READ_FAILED;
 	}
-
-	c = fgetc(fp);
-	while (c == '#')
-	{
-		/*read to the end of the line*/
-		while(c != '\n') c = fgetc(fp);
-		/*check next line*/
-		c = fgetc(fp);
-	}
-	/*rewind one step*/
-	fseek(fp,-1,SEEK_CUR);
-	/*read numVerts numFaces and numEdges*/
-	fscanf(fp,"%d %d %d\n",&nv,&nf,&ne);
-	/*find the max number of vertices per face*/
-	fgetpos(fp,&pos);
-	for(i=0;i<nv;i++)
-	{
-		c = fgetc(fp);
-		while(c != '\n') c = fgetc(fp);
-	}
-	maxVerts = 0;
-	for (i=0;i<nf;i++)
+	ScanLine(&sc);
+	/*faces are nearly always triangles, StoreFace() widens the rows if not*/
+	if (!(*m = CreateMesh(nv,3,nf,3)))
 	{
-		fscanf(fp,"%d",&faceVerts);
-		if (maxVerts < faceVerts) maxVerts = faceVerts;
-		c = fgetc(fp);
-		while(c != '\n') c = fgetc(fp);
-
+		CloseScanner(&sc);
+		return OUT_OF_MEMORY;
 	}
-	fsetpos(fp,&pos);/*return the beginning of data*/
-	*m = CreateMesh(nv,3,nf,maxVerts);
+	rc = READ_SUCCESS;
 	/*read and store vertices*/
-	for (i=0;i<nv;i++)
+	vert = (*m)->vList->verts;
+	for (i=0;i<nv && rc == READ_SUCCESS;i++)
 	{
-		fscanf(fp,"%f %f %f\n",vert,vert+1,vert+2);
-		InsertVertex((*m)->vList,vert);
+		for (k=0;k<3;k++)
+		{
+			if (!ScanFloat(&sc,vert++))
+			{
+				rc = READ_FAILED;
+			}
+		}
+		/*skip anything else on the line, e.g., colours*/
+		ScanLine(&sc);
 	}
+	(*m)->vList->numVerts = nv;
 
 	/*now read faces*/
-	for (i=0;i<nf;i++)
+	for (i=0;i<nf && rc == READ_SUCCESS;i++)
 	{
 		/*n,v0,v1,v2,...,v(n-1)[,R,G,B,A]*/
-		fscanf(fp,"%d",&faceVerts);
+		if (!ScanInt(&sc,&faceVerts) || faceVerts < 1 || faceVerts > MAX_FACE_TYPE)
+		{
+			rc = READ_FAILED;
+			break;
+		}
 		for (j=0;j<faceVerts;j++)
 		{
-			fscanf(fp,"%d",face+j);
+			if (!ScanInt(&sc,face+j) || face[j] < 0 || face[j] >= nv)
+			{
+				rc = DATA_CORRUPTION;
+				break;
+			}
+		}
+		ScanLine(&sc);
+		if (rc == READ_SUCCESS && StoreFace((*m)->fList,face,faceVerts) != INSERT_SUCCESS)
+		{
+			rc = OUT_OF_MEMORY;
 		}
-		/*re to end of the line... in case of RGBA data*/
-		c = fgetc(fp);
-		while(c != '\n') c = fgetc(fp);
-		/*insert the face*/
-		InsertFace((*m)->fList,face,(unsigned char)faceVerts);
 	}
-	fclose(fp);	
-	return READ_SUCCESS;
+	CloseScanner(&sc);
+	if (rc != READ_SUCCESS)
+	{
+		FreeMesh(*m);
+		*m = NULL;
+	}
+	return rc;
 }
 
-
 /** @brief Imports a mesh from a  *.obj file.
+ *
+ * @details Only vertices (v) and faces (f) are read, texture and normal indices
+ * of face vertices are ignored and negative (relative) indices are supported.
  *
  * @param filename The name of the .obj file.
  * @param m A pointer to store the address of the new mesh.
@@ -1900,15 +2627,95 @@ r_code ReadOFF(char *filename, mesh **m)
  * @retVal rc>0 on success.
  * @retVal rc<=0 on failure.
  *
- * @note This funtion is not yet supported.
  * @note In general this function should not be required to be called directly.
  */
 r_code ReadOBJ(char *filename,mesh **m)
 {
-	return NOT_IMPLEMENTED;
+	meshScanner sc;
+	int face[MAX_FACE_TYPE];
+	float vert[3];
+	int n,k;
+	char c;
+	r_code rc;
+
+	*m = NULL;
+	if (OpenScanner(&sc,filename,'#') != READ_SUCCESS)
+	{
+		return READ_FAILED;
+	}
+	if (!(*m = CreateMesh(0,3,0,3)))
+	{
+		CloseScanner(&sc);
+		return OUT_OF_MEMORY;
+	}
+	rc = READ_SUCCESS;
+	while (sc.pos < sc.len && rc == READ_SUCCESS)
+	{
+		if (!ScanBlank(&sc) || sc.pos + 1 >= sc.len 
+			|| (sc.buf[sc.pos+1] != ' ' && sc.buf[sc.pos+1] != '\t'))
+		{
+			ScanLine(&sc);
+			continue;
+		}
+		c = sc.buf[sc.pos];
+		sc.pos++;
+		if (c == 'v')
+		{
+			for (k=0;k<3;k++)
+			{
+				if (!ScanBlank(&sc) || !ScanFloat(&sc,vert+k))
+				{
+					rc = READ_FAILED;
+				}
+			}
+			if (rc == READ_SUCCESS && InsertVertex((*m)->vList,vert) != INSERT_SUCCESS)
+			{
+				rc = OUT_OF_MEMORY;
+			}
+		}
+		else if (c == 'f')
+		{
+			/*v, v/vt, v//vn or v/vt/vn*/
+			for (n=0;ScanBlank(&sc) && rc == READ_SUCCESS;n++)
+			{
+				if (n == MAX_FACE_TYPE || !ScanInt(&sc,face+n) || face[n] == 0)
+				{
+					rc = READ_FAILED;
+					break;
+				}
+				face[n] = (face[n] > 0) ? face[n] - 1 : (*m)->vList->numVerts + face[n];
+				while (sc.pos < sc.len && sc.buf[sc.pos] != ' ' && sc.buf[sc.pos] != '\t' 
+					&& sc.buf[sc.pos] != '\r' && sc.buf[sc.pos] != '\n')
+				{
+					sc.pos++;
+				}
+			}
+			if (rc == READ_SUCCESS && (n == 0 || StoreFace((*m)->fList,face,n) != INSERT_SUCCESS))
+			{
+				rc = (n == 0) ? READ_FAILED : OUT_OF_MEMORY;
+			}
+		}
+		ScanLine(&sc);
+	}
+	CloseScanner(&sc);
+	/*faces may refer to vertices defined after them*/
+	if (rc == READ_SUCCESS)
+	{
+		rc = (CheckFaces(*m) > 0) ? READ_SUCCESS : DATA_CORRUPTION;
+	}
+	if (rc != READ_SUCCESS)
+	{
+		FreeMesh(*m);
+		*m = NULL;
+	}
+	return rc;
 }
 
 /** @brief Imports a mesh from a  *.stl file.
+ *
+ * @details Both ASCII and binary files are read (a file is binary if its size
+ * matches the facet count in its header). STL facets do not share vertices, so 
+ * identical vertices are merged to recover the topology.
  *
  * @param filename The name of the .stl file.
  * @param m A pointer to store the address of the new mesh.
@@ -1916,15 +2723,109 @@ r_code ReadOBJ(char *filename,mesh **m)
  * @retVal rc>0 on success.
  * @retVal rc<=0 on failure.
  *
- * @note This funtion is not yet supported.
+ * @note Binary files are assumed to be little endian, as the format requires, 
+ * and the host to be little endian too.
  * @note In general this function should not be required to be called directly.
  */
 r_code ReadSTL(char *filename,mesh **m)
 {
-	return NOT_IMPLEMENTED;
+	meshScanner sc;
+	int face[MAX_FACE_TYPE];
+	float vert[3];
+	char word[16];
+	unsigned int nf;
+	int i,k,n;
+	r_code rc;
+
+	*m = NULL;
+	if (OpenScanner(&sc,filename,0) != READ_SUCCESS)
+	{
+		return READ_FAILED;
+	}
+	rc = READ_SUCCESS;
+	if (sc.len >= 84)
+	{
+		memcpy((void *)&nf,(void *)(sc.buf + 80),sizeof(unsigned int));
+	}
+	if (sc.len >= 84 && (unsigned long long)sc.len == 84 + 50*(unsigned long long)nf)
+	{
+		/*normal, three vertices and an attribute count per facet*/
+		if (!(*m = CreateMesh(3*nf,3,nf,3)))
+		{
+			CloseScanner(&sc);
+			return OUT_OF_MEMORY;
+		}
+		for (i=0;i<(int)nf;i++)
+		{
+			memcpy((void *)((*m)->vList->verts + 9*i),(void *)(sc.buf + 84 + 50*i + 12),9*sizeof(float));
+			(*m)->fList->faces[3*i] = 3*i;
+			(*m)->fList->faces[3*i+1] = 3*i+1;
+			(*m)->fList->faces[3*i+2] = 3*i+2;
+			(*m)->fList->faceTypes[i] = 3;
+		}
+		(*m)->vList->numVerts = 3*nf;
+		(*m)->fList->numFaces = nf;
+	}
+	else
+	{
+		if (!(*m = CreateMesh(0,3,0,3)))
+		{
+			CloseScanner(&sc);
+			return OUT_OF_MEMORY;
+		}
+		/*solid, facet normal ..., outer loop, vertex x y z..., endloop, endfacet*/
+		n = 0;
+		while (rc == READ_SUCCESS && ScanWord(&sc,word,sizeof(word)) > 0)
+		{
+			if (!strcmp(word,"vertex"))
+			{
+				for (k=0;k<3;k++)
+				{
+					if (!ScanFloat(&sc,vert+k))
+					{
+						rc = READ_FAILED;
+					}
+				}
+				if (rc == READ_SUCCESS && n < MAX_FACE_TYPE)
+				{
+					face[n++] = (*m)->vList->numVerts;
+					if (InsertVertex((*m)->vList,vert) != INSERT_SUCCESS)
+					{
+						rc = OUT_OF_MEMORY;
+					}
+				}
+			}
+			else if (!strcmp(word,"loop"))
+			{
+				n = 0;
+			}
+			else if (!strcmp(word,"endloop") && n > 0)
+			{
+				if (StoreFace((*m)->fList,face,n) != INSERT_SUCCESS)
+				{
+					rc = OUT_OF_MEMORY;
+				}
+				n = 0;
+			}
+		}
+	}
+	CloseScanner(&sc);
+	if (rc == READ_SUCCESS && WeldVertices(*m) <= 0)
+	{
+		rc = OUT_OF_MEMORY;
+	}
+	if (rc != READ_SUCCESS)
+	{
+		FreeMesh(*m);
+		*m = NULL;
+	}
+	return rc;
 }
 
 /** @brief Imports a mesh from a  *.vrml file.
+ *
+ * @details The points and coordIndex of the first IndexedFaceSet are read, other 
+ * nodes and transforms are ignored.
  *
  * @param filename The name of the .vrml file.
  * @param m A pointer to store the address of the new mesh.
@@ -1932,12 +2833,310 @@ r_code ReadSTL(char *filename,mesh **m)
  * @retVal rc>0 on success.
  * @retVal rc<=0 on failure.
  *
- * @note This funtion is not yet supported.
  * @note In general this function should not be required to be called directly.
  */
 r_code ReadVRML(char *filename, mesh **m)
 {
-	return NOT_IMPLEMENTED;
+	meshScanner sc;
+	int face[MAX_FACE_TYPE];
+	float vert[3];
+	int n,k,idx;
+	size_t start;
+	r_code rc;
+
+	*m = NULL;
+	if (OpenScanner(&sc,filename,'#') != READ_SUCCESS)
+	{
+		return READ_FAILED;
+	}
+	if (!ScanFind(&sc,"IndexedFaceSet"))
+	{
+		CloseScanner(&sc);
+		return READ_FAILED;
+	}
+	start = sc.pos;
+	if (!(*m = CreateMesh(0,3,0,3)))
+	{
+		CloseScanner(&sc);
+		return OUT_OF_MEMORY;
+	}
+	rc = READ_FAILED;
+	/*point [ x y z, x y z, ... ]*/
+	if (ScanFind(&sc,"point"))
+	{
+		ScanSpace(&sc);
+		if (sc.pos < sc.len && sc.buf[sc.pos] == '[')
+		{
+			sc.pos++;
+			rc = READ_SUCCESS;
+			for (k=0;rc == READ_SUCCESS;k=0)
+			{
+				ScanSpace(&sc);
+				if (sc.pos >= sc.len || sc.buf[sc.pos] == ']')
+				{
+					break;
+				}
+				for (;k<3 && ScanFloat(&sc,vert+k);k++);
+				if (k < 3)
+				{
+					rc = READ_FAILED;
+				}
+				else if (InsertVertex((*m)->vList,vert) != INSERT_SUCCESS)
+				{
+					rc = OUT_OF_MEMORY;
+				}
+			}
+		}
+	}
+	/*coordIndex [ a, b, c, -1, ... ], it may come before the points*/
+	sc.pos = start;
+	if (rc == READ_SUCCESS)
+	{
+		rc = READ_FAILED;
+		if (ScanFind(&sc,"coordIndex"))
+		{
+			ScanSpace(&sc);
+			if (sc.pos < sc.len && sc.buf[sc.pos] == '[')
+			{
+				sc.pos++;
+				rc = READ_SUCCESS;
+				n = 0;
+				while (rc == READ_SUCCESS)
+				{
+					ScanSpace(&sc);
+					if (sc.pos >= sc.len || sc.buf[sc.pos] == ']' || !ScanInt(&sc,&idx))
+					{
+						break;
+					}
+					if (idx >= 0)
+					{
+						if (n == MAX_FACE_TYPE)
+						{
+							rc = READ_FAILED;
+						}
+						face[n++] = idx;
+						continue;
+					}
+					if (n > 0 && StoreFace((*m)->fList,face,n) != INSERT_SUCCESS)
+					{
+						rc = OUT_OF_MEMORY;
+					}
+					n = 0;
+				}
+				/*the last face need not be terminated*/
+				if (rc == READ_SUCCESS && n > 0 && StoreFace((*m)->fList,face,n) != INSERT_SUCCESS)
+				{
+					rc = OUT_OF_MEMORY;
+				}
+			}
+		}
+	}
+	CloseScanner(&sc);
+	if (rc == READ_SUCCESS)
+	{
+		rc = (CheckFaces(*m) > 0) ? READ_SUCCESS : DATA_CORRUPTION;
+	}
+	if (rc != READ_SUCCESS)
+	{
+		FreeMesh(*m);
+		*m = NULL;
+	}
+	return rc;
+}
+
+/** @brief Imports a mesh from a  *.ply file.
+ *
+ * @details ASCII and binary (either byte order) files are read. The x, y and z
+ * properties of the vertex element and the vertex_indices list of the face 
+ * element are used, other properties and elements are skipped.
+ *
+ * @param filename The name of the .ply file.
+ * @param m A pointer to store the address of the new mesh.
+ * 
+ * @retVal rc>0 on success.
+ * @retVal rc<=0 on failure.
+ *
+ * @note In general this function should not be required to be called directly.
+ */
+r_code ReadPLY(char *filename, mesh **m)
+{
+	meshScanner sc;
+	plyElement elem[PLY_MAX_ELEMENTS];
+	plyElement *e;
+	plyProperty *p;
+	int face[MAX_FACE_TYPE];
+	char word[32];
+	int ne,format,nv,nf;
+	int i,j,k,n;
+	double x;
+	unsigned int one;
+	r_code rc;
+
+	*m = NULL;
+	if (OpenScanner(&sc,filename,0) != READ_SUCCESS)
+	{
+		return READ_FAILED;
+	}
+	ScanWord(&sc,word,sizeof(word));
+	if (strcmp(word,"ply"))
+	{
+		CloseScanner(&sc);
+		return READ_FAILED;
+	}
+	/*the header*/
+	rc = READ_FAILED;
+	ne = 0;
+	format = -1;
+	nv = nf = 0;
+	while (ScanWord(&sc,word,sizeof(word)) > 0)
+	{
+		if (!strcmp(word,"format"))
+		{
+			ScanWord(&sc,word,sizeof(word));
+			format = (!strcmp(word,"ascii")) ? PLY_ASCII : (!strcmp(word,"binary_little_endian")) ? PLY_LITTLE
+				: (!strcmp(word,"binary_big_endian")) ? PLY_BIG : -1;
+			ScanLine(&sc);
+		}
+		else if (!strcmp(word,"element"))
+		{
+			if (ne == PLY_MAX_ELEMENTS)
+			{
+				break;
+			}
+			e = elem + (ne++);
+			ScanWord(&sc,word,sizeof(word));
+			e->role = (!strcmp(word,"vertex")) ? PLY_VERTEX : (!strcmp(word,"face")) ? PLY_FACE : PLY_OTHER;
+			e->nprops = 0;
+			if (!ScanInt(&sc,&(e->count)) || e->count < 0)
+			{
+				break;
+			}
+			nv = (e->role == PLY_VERTEX) ? e->count : nv;
+			nf = (e->role == PLY_FACE) ? e->count : nf;
+		}
+		else if (!strcmp(word,"property"))
+		{
+			if (ne == 0 || elem[ne-1].nprops == PLY_MAX_PROPERTIES)
+			{
+				break;
+			}
+			p = elem[ne-1].props + (elem[ne-1].nprops++);
+			ScanWord(&sc,word,sizeof(word));
+			p->count = 0;
+			if (!strcmp(word,"list"))
+			{
+				ScanWord(&sc,word,sizeof(word));
+				p->count = PlyType(word);
+				ScanWord(&sc,word,sizeof(word));
+				if (p->count == 0)
+				{
+					break;
+				}
+			}
+			if ((p->type = PlyType(word)) == 0)
+			{
+				break;
+			}
+			ScanWord(&sc,word,sizeof(word));
+			p->role = PLY_OTHER;
+			if (elem[ne-1].role == PLY_VERTEX && p->count == 0 && word[0] >= 'x' && word[0] <= 'z' && word[1] == '\0')
+			{
+				p->role = word[0] - 'x';
+			}
+			else if (elem[ne-1].role == PLY_FACE && p->count != 0 
+				&& (!strcmp(word,"vertex_indices") || !strcmp(word,"vertex_index")))
+			{
+				p->role = PLY_INDICES;
+			}
+		}
+		else if (!strcmp(word,"end_header"))
+		{
+			ScanLine(&sc);
+			rc = (format >= 0) ? READ_SUCCESS : READ_FAILED;
+			break;
+		}
+		else
+		{
+			/*comment, obj_info, ...*/
+			ScanLine(&sc);
+		}
+	}
+	if (rc != READ_SUCCESS)
+	{
+		CloseScanner(&sc);
+		return rc;
+	}
+	/*values are swapped if the file is not in the byte order of the host*/
+	one = 1;
+	if (format != PLY_ASCII)
+	{
+		format = (format == ((*(unsigned char *)&one) ? PLY_LITTLE : PLY_BIG)) ? PLY_NATIVE : PLY_SWAPPED;
+	}
+	if (!(*m = CreateMesh(nv,3,nf,3)))
+	{
+		CloseScanner(&sc);
+		return OUT_OF_MEMORY;
+	}
+
+	/*the data, element by element*/
+	for (k=0;k<ne && rc == READ_SUCCESS;k++)
+	{
+		e = elem + k;
+		for (i=0;i<e->count && rc == READ_SUCCESS;i++)
+		{
+			for (p=e->props;p<e->props + e->nprops;p++)
+			{
+				if (p->count == 0)
+				{
+					if (!ScanPly(&sc,format,p->type,&x))
+					{
+						rc = READ_FAILED;
+						break;
+					}
+					if (p->role <= Z)
+					{
+						(*m)->vList->verts[3*i + p->role] = (float)x;
+					}
+					continue;
+				}
+				if (!ScanPly(&sc,format,p->count,&x) || x < 0 
+					|| (p->role == PLY_INDICES && (x < 1 || x > MAX_FACE_TYPE)))
+				{
+					rc = READ_FAILED;
+					break;
+				}
+				n = (int)x;
+				for (j=0;j<n;j++)
+				{
+					if (!ScanPly(&sc,format,p->type,&x))
+					{
+						rc = READ_FAILED;
+						break;
+					}
+					face[(p->role == PLY_INDICES) ? j : 0] = (int)x;
+				}
+				if (rc == READ_SUCCESS && p->role == PLY_INDICES && StoreFace((*m)->fList,face,n) != INSERT_SUCCESS)
+				{
+					rc = OUT_OF_MEMORY;
+				}
+			}
+		}
+		if (e->role == PLY_VERTEX)
+		{
+			(*m)->vList->numVerts = nv;
+		}
+	}
+	CloseScanner(&sc);
+	if (rc == READ_SUCCESS)
+	{
+		rc = (CheckFaces(*m) > 0) ? READ_SUCCESS : DATA_CORRUPTION;
+	}
+	if (rc != READ_SUCCESS)
+	{
+		FreeMesh(*m);
+		*m = NULL;
+	}
+	return rc;
 }
 
 /** @brief Checks if the return code contains an error code.
@@ -41,7 +41,7 @@
 #include <stdio.h>
 #include <string.h>
 #include "vectorMath.h"
-/** @brief extra memory allocted when buffers fill up.*/
+/** @brief least extra memory allocted when buffers fill up, lists grow by their size if larger.*/
 #define REALLOC_EXTRA 1000
 /** @brief maximum number of vertices per face.*/
 #define MAX_FACE_TYPE 8
@@ -86,6 +86,8 @@
 #define STL_FORMAT 2
 /** @brief Virtual Reality Modeling Language file flag.*/
 #define VRML_FORMAT 3
+/** @brief Polygon File Format file flag.*/
+#define PLY_FORMAT 4
 
 
 
@@ -167,6 +169,7 @@ float FaceArea(faceList *fList, int i,vertexList *vList);
 /*mesh functions*/
 mesh * CreateMesh(int numVerts,int dim,int numFaces, int maxVerts);
 mesh * CopyMesh(mesh *m);
+void FreeMesh(mesh *m);
 mesh * CreateDual(mesh *m);
 r_code SubDivideFaces(mesh *m);
 r_code RemoveDuplicateVertices(mesh *m);
@@ -181,6 +184,7 @@ mesh * CreateDoubleTorus(void);
 mesh * CreateMeshTopology(int numFaces,int genus);
 
 /*I/O functions*/
+unsigned char MeshFormat(char *filename);
 mesh * LoadMesh(char *filename,unsigned char format);
 r_code SaveMesh(char *filename,mesh *m, unsigned char format);
 
@@ -188,10 +192,12 @@ r_code WriteOFF(char *filename,mesh *m);
 r_code WriteOBJ(char *filename,mesh *m);
 r_code WriteSTL(char *filename,mesh *m);
 r_code WriteVRML(char *filename, mesh *m);
+r_code WritePLY(char *filename,mesh *m);
 r_code ReadOFF(char *filename,mesh **m);
 r_code ReadOBJ(char *filename,mesh **m);
 r_code ReadSTL(char *filename,mesh **m);
 r_code ReadVRML(char *filename, mesh **m);
+r_code ReadPLY(char *filename,mesh **m);
 /*Error check codes*/
 unsigned char CheckErr(r_code rc);
 void PrintErrorMsg(r_code err);
@@ -18,6 +18,163 @@
 #include <string.h>
 #include "mesh.h"
 
+/*fixtures: the same tetrahedron in each format, with CRLF line ends and comments*/
+float tetVerts[12] = {0,0,0, 1,0,0, 0,1,0, 0,0,1};
+int tetFaces[12] = {0,2,1, 0,1,3, 0,3,2, 1,2,3};
+
+char *offFixture = "OFF\r\n# a tetrahedron\r\n4 4 6\r\n0 0 0\r\n1 0 0\r\n# vertex 2\r\n0 1 0\r\n"
+	"0 0 1\r\n3 0 2 1\r\n3 0 1 3 # trailing comment\r\n3 0 3 2\r\n3 1 2 3\r\n";
+char *objFixture = "# a tetrahedron\r\nv 0 0 0\r\nv 1 0 0\r\nv 0 1 0\r\nv 0 0 1\r\nvt 0 0\r\nvn 0 0 1\r\n"
+	"f 1 3 2\r\n# mixed index forms\r\nf 1/1 2/1/1 4//1\r\nf 1 4 3\r\nf -3 -2 -1\r\n";
+char *stlFixture = "solid tet\r\nfacet normal 0 0 -1\r\nouter loop\r\nvertex 0 0 0\r\nvertex 0 1 0\r\nvertex 1 0 0\r\n"
+	"endloop\r\nendfacet\r\nfacet normal 0 -1 0\r\nouter loop\r\nvertex 0 0 0\r\nvertex 1 0 0\r\nvertex 0 0 1\r\n"
+	"endloop\r\nendfacet\r\nfacet normal -1 0 0\r\nouter loop\r\nvertex 0 0 0\r\nvertex 0 0 1\r\nvertex 0 1 0\r\n"
+	"endloop\r\nendfacet\r\nfacet normal 1 1 1\r\nouter loop\r\nvertex 1 0 0\r\nvertex 0 1 0\r\nvertex 0 0 1\r\n"
+	"endloop\r\nendfacet\r\nendsolid tet\r\n";
+char *vrmlFixture = "#VRML V2.0 utf8\r\n# a tetrahedron\r\nShape {\r\n geometry IndexedFaceSet {\r\n"
+	"  coordIndex [ 0, 2, 1, -1, 0, 1, 3, -1, # comment\r\n 0, 3, 2, -1, 1, 2, 3 ]\r\n"
+	"  coord Coordinate {\r\n   point [ 0 0 0, 1 0 0, 0 1 0, 0 0 1 ]\r\n  }\r\n }\r\n}\r\n";
+char *plyFixture = "ply\r\nformat ascii 1.0\r\ncomment a tetrahedron\r\nelement vertex 4\r\n"
+	"property float x\r\nproperty float y\r\nproperty float z\r\nproperty uchar red\r\n"
+	"element face 4\r\nproperty list uchar int vertex_indices\r\nend_header\r\n"
+	"0 0 0 255\r\n1 0 0 255\r\n0 1 0 255\r\n0 0 1 255\r\n3 0 2 1\r\n3 0 1 3\r\n3 0 3 2\r\n3 1 2 3\r\n";
+
+/* WriteFixture(): writes a fixture to a file*/
+int WriteFixture(char *filename,void *data,size_t len)
+{
+	FILE *fp;
+	size_t n;
+	if (!(fp = fopen(filename,"wb")))
+	{
+		return 0;
+	}
+	n = fwrite(data,1,len,fp);
+	fclose(fp);
+	return (n == len);
+}
+
+/* CheckTetra(): tests a mesh is the fixture tetrahedron, vertices may be numbered 
+ * differently (e.g., welded STL facets) but faces must be in order*/
+int CheckTetra(mesh *m)
+{
+	int i,j;
+	int *face;
+	float *v,*w;
+	if (m == NULL || m->vList->numVerts != 4 || m->fList->numFaces != 4)
+	{
+		return 0;
+	}
+	for (i=0;i<4;i++)
+	{
+		if (m->fList->faceTypes[i] != 3)
+		{
+			return 0;
+		}
+		face = GetFace_ptr(m->fList,i);
+		for (j=0;j<3;j++)
+		{
+			if (face[j] < 0 || face[j] >= 4)
+			{
+				return 0;
+			}
+			v = GetVertex_ptr(m->vList,face[j]);
+			w = tetVerts + 3*tetFaces[3*i+j];
+			if (v[0] != w[0] || v[1] != w[1] || v[2] != w[2])
+			{
+				return 0;
+			}
+		}
+	}
+	return 1;
+}
+
+/* TestReaders(): reads each fixture back with its reader and the format LoadMesh() picks*/
+int TestReaders(void)
+{
+	char *names[5] = {"fixture.off","fixture.obj","fixture.stl","fixture.vrml","fixture.ply"};
+	char *data[5];
+	unsigned char formats[5] = {OFF_FORMAT,OBJ_FORMAT,STL_FORMAT,VRML_FORMAT,PLY_FORMAT};
+	r_code (*readers[5])(char *,mesh **) = {ReadOFF,ReadOBJ,ReadSTL,ReadVRML,ReadPLY};
+	unsigned char bin[84+4*50];
+	unsigned int nf;
+	int i,j,fails;
+	mesh *m;
+	r_code rc;
+
+	data[0] = offFixture;
+	data[1] = objFixture;
+	data[2] = stlFixture;
+	data[3] = vrmlFixture;
+	data[4] = plyFixture;
+	fails = 0;
+	for (i=0;i<5;i++)
+	{
+		if (!WriteFixture(names[i],(void *)data[i],strlen(data[i])))
+		{
+			printf("%s: could not write fixture\n",names[i]);
+			return 1;
+		}
+		rc = readers[i](names[i],&m);
+		if (rc <= 0 || !CheckTetra(m))
+		{
+			printf("%s: read failed (%d)\n",names[i],rc);
+			fails++;
+		}
+		FreeMesh(m);
+		m = LoadMesh(names[i],MeshFormat(names[i]));
+		if (MeshFormat(names[i]) != formats[i] || !CheckTetra(m))
+		{
+			printf("%s: LoadMesh failed\n",names[i]);
+			fails++;
+		}
+		FreeMesh(m);
+		remove(names[i]);
+	}
+
+	/*binary STL, the same facets*/
+	memset((void *)bin,0,sizeof(bin));
+	nf = 4;
+	memcpy((void *)(bin + 80),(void *)&nf,sizeof(unsigned int));
+	for (i=0;i<4;i++)
+	{
+		for (j=0;j<3;j++)
+		{
+			memcpy((void *)(bin + 84 + 50*i + 12 + 12*j),(void *)(tetVerts + 3*tetFaces[3*i+j]),3*sizeof(float));
+		}
+	}
+	if (!WriteFixture("fixture_bin.stl",(void *)bin,sizeof(bin)))
+	{
+		printf("fixture_bin.stl: could not write fixture\n");
+		return 1;
+	}
+	rc = ReadSTL("fixture_bin.stl",&m);
+	if (rc <= 0 || !CheckTetra(m))
+	{
+		printf("fixture_bin.stl: read failed (%d)\n",rc);
+		fails++;
+	}
+	FreeMesh(m);
+	remove("fixture_bin.stl");
+
+	/*a face that names a missing vertex is rejected*/
+	data[0] = "OFF\r\n3 1 0\r\n0 0 0\r\n1 0 0\r\n0 1 0\r\n3 0 1 3\r\n";
+	if (!WriteFixture("fixture_bad.off",(void *)data[0],strlen(data[0])))
+	{
+		printf("fixture_bad.off: could not write fixture\n");
+		return 1;
+	}
+	rc = ReadOFF("fixture_bad.off",&m);
+	if (rc > 0 || m != NULL)
+	{
+		printf("fixture_bad.off: bad face accepted\n");
+		fails++;
+	}
+	remove("fixture_bad.off");
+
+	printf("mesh readers: %s\n",(fails == 0) ? "passed" : "FAILED");
+	return (fails != 0);
+}
+
 int main(int argc,char **argv)
 {
 	r_code rc;
@@ -27,6 +184,10 @@ int main(int argc,char **argv)
 	int *face;
 	mesh *m,*m2;
 	char name[255];
+	if (argc == 2 && !strcmp(argv[1],"-readers"))
+	{
+		return TestReaders();
+	}
 	if (argc == 1)
 	{
 		m = CreateIcosahedron();